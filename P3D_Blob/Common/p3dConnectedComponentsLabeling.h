@@ -70,6 +70,8 @@
 #include "p3dBoundingBoxT.h"
 #include "p3dUIntList.h"
 
+struct VolumeView;
+
 int p3dConnectedComponentsLabeling_ushort (
 	 unsigned char* in_rev,
 	 unsigned short* out_rev,	 
@@ -98,4 +100,26 @@ int p3dConnectedComponentsLabeling_uint (
 	 const int skip_borders
 	 );
 
+int p3dConnectedComponentsLabeling_ushort_view (
+	 struct VolumeView* in_view,
+	 unsigned short* out_rev,	 
+	 unsigned int* numOfConnectedComponents,	// OUT: dim of arrays
+	 unsigned int** volumes,	    // OUT: array of sizes (voxel counting)
+	 bb_t** boundingBoxes,          // OUT: array of bounding boxes
+	 const int conn,
+     const int random_lbl,
+	 const int skip_borders
+	 );
+
+int p3dConnectedComponentsLabeling_uint_view (
+	 struct VolumeView* in_view,
+	 unsigned int* out_rev,	 
+	 unsigned int* numOfConnectedComponents,	// OUT: dim of arrays
+	 unsigned int** volumes,	// OUT: array of sizes (voxel counting)
+	 bb_t** boundingBoxes,          // OUT: array of bounding boxes
+	 const int conn,
+     const int random_lbl,
+	 const int skip_borders
+	 );
+
 
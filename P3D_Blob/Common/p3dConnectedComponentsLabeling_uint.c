@@ -368,7 +368,8 @@ int first_unlabeled_uint(
     bb_t curr_bb;
 
     unsigned short m; // Current label
-    int ct, offset; // Counter for local subvolume size
+    int offset;
+    long long ct; // Counter for local subvolume size
     int a, b, c;
     int i, j, k;
     int m_ct; // Counter for volume counting
@@ -417,16 +418,16 @@ int first_unlabeled_uint(
     a_dimz = dimz + a_rad * 2;
 
     // Initialize input:
-    P3D_TRY(tmp_in_rev = (unsigned char*) malloc(a_dimx * a_dimy * a_dimz * sizeof (unsigned char)));
+    P3D_TRY(tmp_in_rev = (unsigned char*) malloc((size_t) a_dimx * a_dimy * a_dimz * sizeof (unsigned char)));
     p3dZeroPadding3D_uchar2uchar(in_rev, tmp_in_rev, dimx, dimy, dimz, a_rad);
 
 
     // Initialize output label volume with ON_LABEL on non-zero values
     // of input volume:
-    P3D_TRY(tmp_out_rev = (unsigned short*) malloc(a_dimx * a_dimy * a_dimz * sizeof (unsigned short)));
+    P3D_TRY(tmp_out_rev = (unsigned short*) malloc((size_t) a_dimx * a_dimy * a_dimz * sizeof (unsigned short)));
 
 #pragma omp parallel for
-    for (ct = 0; ct < (a_dimx * a_dimy * a_dimz); ct++)
+    for (ct = 0; ct < ((long long) a_dimx * a_dimy * a_dimz); ct++)
         tmp_out_rev[ct] = (tmp_in_rev[ct]) ? ON_LABEL : 0;
 
 
@@ -565,19 +566,21 @@ MEM_ERROR:
     return P3D_MEM_ERROR;
 }*/
 
-int p3dConnectedComponentsLabeling_uint(
-        unsigned char* in_rev,
+int p3dConnectedComponentsLabeling_uint_view(
+        struct VolumeView* in_view, // IN: input view
         unsigned int* out_rev,
         unsigned int* numOfConnectedComponents, // OUT: dim of arrays
         unsigned int** volumes, // OUT: array of sizes (voxel counting)
         bb_t** boundingBoxes, // OUT: array of bounding boxes
-        const int dimx,
-        const int dimy,
-        const int dimz,
         const int conn,
         const int random_lbl,
         const int skip_borders
         ) {
+    // Input is addressed through origin and strides of its view:
+    unsigned char* in_rev = (unsigned char*) in_view->base + IV(0, 0, 0, in_view);
+    const size_t in_sy = in_view->stridey, in_sz = in_view->stridez;
+    const int dimx = in_view->dimx, dimy = in_view->dimy, dimz = in_view->dimz;
+
     // Size of local window (3 in current implementation).
     // Modify this value with 5,7,... if memory problem
     // occurs. Uncomment also some code (see further).
@@ -591,7 +594,8 @@ int p3dConnectedComponentsLabeling_uint(
     bb_t curr_bb;
 
     unsigned int m; // Current label
-    int ct, offset; // Counter for local subvolume size
+    int offset;
+    long long ct; // Counter for local subvolume size
     int a, b, c;
     int i, j, k;
     unsigned int m_ct; // Counter for volume counting
@@ -601,9 +605,8 @@ int p3dConnectedComponentsLabeling_uint(
     int a_dimx, a_dimy, a_dimz;
     const int a_rad = 1;
 
-    // Padded and cropped temporary input and output:
-    unsigned char* tmp_in_rev;
-    unsigned int* tmp_out_rev;
+    // Padded and cropped temporary output:
+    unsigned int* tmp_out_rev = NULL;
 
     // Pointer to a function for kind of connectivity:
     void (*conn_fun) (
@@ -639,18 +642,18 @@ int p3dConnectedComponentsLabeling_uint(
     a_dimy = dimy + a_rad * 2;
     a_dimz = dimz + a_rad * 2;
 
-    // Initialize input:
-    P3D_TRY(tmp_in_rev = (unsigned char*) malloc(a_dimx * a_dimy * a_dimz * sizeof (unsigned char)));
-    p3dZeroPadding3D_uchar2uchar(in_rev, tmp_in_rev, dimx, dimy, dimz, a_rad);
-
-
     // Initialize output label volume with ON_LABEL on non-zero values
-    // of input volume:
-    P3D_TRY(tmp_out_rev = (unsigned int*) malloc(a_dimx * a_dimy * a_dimz * sizeof (unsigned int)));
+    // of input volume. The zero border is set directly, i.e. without a
+    // zero padded copy of the input:
+    P3D_TRY(tmp_out_rev = (unsigned int*) malloc((size_t) a_dimx * a_dimy * a_dimz * sizeof (unsigned int)));
 
-#pragma omp parallel for
-    for (ct = 0; ct < (a_dimx * a_dimy * a_dimz); ct++)
-        tmp_out_rev[ct] = (tmp_in_rev[ct] == OBJECT) ? ON_LABEL : 0;
+#pragma omp parallel for private(a, b)
+    for (c = 0; c < a_dimz; c++)
+        for (b = 0; b < a_dimy; b++)
+            for (a = 0; a < a_dimx; a++)
+                tmp_out_rev[ I(a, b, c, a_dimx, a_dimy) ] = ((a < a_rad) || (b < a_rad) || (c < a_rad) ||
+                        (a >= (dimx + a_rad)) || (b >= (dimy + a_rad)) || (c >= (dimz + a_rad))) ? 0 :
+                        ((in_rev[ IS(a - a_rad, b - a_rad, c - a_rad, in_sy, in_sz) ] == OBJECT) ? ON_LABEL : 0);
 
 
 
@@ -783,7 +786,6 @@ int p3dConnectedComponentsLabeling_uint(
 
 
     // Release resources:
-    if (tmp_in_rev != NULL) free(tmp_in_rev);
     if (tmp_out_rev != NULL) free(tmp_out_rev);
 
     // Return OK:
@@ -802,9 +804,38 @@ MEM_ERROR:
         bb_list_clear(&bb_list);
 
     // Release resources:
-    if (tmp_in_rev != NULL) free(tmp_in_rev);
-    if (tmp_out_rev != NULL) free(tmp_in_rev);
+    if (tmp_out_rev != NULL) free(tmp_out_rev);
 
     // Return error code:
     return P3D_MEM_ERROR;
-}
\ No newline at end of file
+}
+
+int p3dConnectedComponentsLabeling_uint(
+        unsigned char* in_rev,
+        unsigned int* out_rev,
+        unsigned int* numOfConnectedComponents, // OUT: dim of arrays
+        unsigned int** volumes, // OUT: array of sizes (voxel counting)
+        bb_t** boundingBoxes, // OUT: array of bounding boxes
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int conn,
+        const int random_lbl,
+        const int skip_borders
+        ) {
+    struct VolumeView in_view;
+
+    // The whole input volume is a view of itself:
+    in_view.base = in_rev;
+    in_view.dimx = dimx;
+    in_view.dimy = dimy;
+    in_view.dimz = dimz;
+    in_view.orgx = 0;
+    in_view.orgy = 0;
+    in_view.orgz = 0;
+    in_view.stridey = (size_t) dimx;
+    in_view.stridez = (size_t) dimx * dimy;
+
+    return p3dConnectedComponentsLabeling_uint_view(&in_view, out_rev, numOfConnectedComponents, volumes, boundingBoxes,
+            conn, random_lbl, skip_borders);
+}
@@ -995,7 +995,7 @@ int p3dZeroPadding3D_uchar2float (
 	a_dimz = dimz + size*2;
 
 	// Set to zero all values:
-	memset( out_rev, 0, a_dimx*a_dimy*a_dimz*sizeof(float) );
+	memset( out_rev, 0, (size_t) a_dimx*a_dimy*a_dimz*sizeof(float) );
 
 
 	// Copy original (internal) values:
@@ -1028,7 +1028,7 @@ int p3dZeroPadding3D_uchar2uchar (
 	a_dimz = dimz + size*2;
 
 	// Set to zero all values:
-	memset( out_rev, 0, a_dimx*a_dimy*a_dimz*sizeof(unsigned char) );
+	memset( out_rev, 0, (size_t) a_dimx*a_dimy*a_dimz*sizeof(unsigned char) );
 
 
 	// Copy original (internal) values:
@@ -1306,7 +1306,7 @@ int p3dSpecialPadding3D_uchar2uchar (
 
 
 	// Set to zero all values:
-	memset( out_rev, 0, a_dimx*a_dimy*a_dimz*sizeof(unsigned char) );
+	memset( out_rev, 0, (size_t) a_dimx*a_dimy*a_dimz*sizeof(unsigned char) );
 
 
 	// Copy original (internal) values converting 255 to 1:
@@ -82,7 +82,7 @@
 #ifndef P3D_GVF_MACROS
 	#define P3D_GVF_MACROS
 
-	#define I(i,j,k,N,M)    ( (j)*(N) + (i) + (k)*(N)*(M) ) 
+	#define I(i,j,k,N,M)    ( (size_t)(j)*(N) + (i) + (size_t)(k)*(N)*(M) ) 
 	#define MIN(x,y)        (((x) < (y))?(x):(y))
 	#define MAX(x,y)        (((x) > (y))?(x):(y))
 
@@ -98,6 +98,9 @@
 
 #endif
 
+	// Strided sub-volumes (struct VolumeView):
+	#include "../../P3D_Common/p3dVolumeView.h"
+
 /*
 	Functions:
 */
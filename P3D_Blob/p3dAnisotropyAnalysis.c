@@ -712,7 +712,7 @@ void _getMILs(
         const unsigned int dimz,
         const double voxelsize
         ) {
-    int i;
+    long long i;
     double s;
 
     // Indexes for volume scanning:
@@ -752,10 +752,10 @@ void _getMILs(
     // Get BV/TV:
     s = 0.0;
 #pragma omp parallel for reduction (+ : s)
-    for (i = 0; i < (dimx * dimy * dimz); i++)
+    for (i = 0; i < ((long long) dimx * dimy * dimz); i++)
         if (in_im[i] == OBJECT) s++;
 
-    bvf = s / ((double) (dimx * dimy * dimz));
+    bvf = s / ((double) dimx * (double) dimy * (double) dimz);
 
     /*t_totlength = 0.0;
     t_intersect_ct = 0.0;*/
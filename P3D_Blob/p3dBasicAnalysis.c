@@ -53,13 +53,13 @@ void ghist(
         ) {
     int i, j, k;
     int l;
-    int ct;
+    long long ct;
 
     // Convert image to int:
-    unsigned char* tmp_im = (unsigned char*) malloc(dimx * dimy * dimz * sizeof (unsigned char));
+    unsigned char* tmp_im = (unsigned char*) malloc((size_t) dimx * dimy * dimz * sizeof (unsigned char));
 
 #pragma omp parallel for private( ct )
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         tmp_im [ ct ] = (im [ ct ] == OBJECT) ? 1 : 0;
 
     // Compute histogram:
@@ -63,7 +63,7 @@ extern "C" {
 #ifndef P3D_BLOB_MACROS
 #define P3D_BLOB_MACROS
 
-#define I(i,j,k,N,M)    ( (j)*(N) + (i) + (k)*(N)*(M) ) 
+#define I(i,j,k,N,M)    ( (size_t)(j)*(N) + (i) + (size_t)(k)*(N)*(M) ) 
 #define MIN(x,y)        (((x) < (y))?(x):(y))
 #define MAX(x,y)        (((x) > (y))?(x):(y))
 
@@ -71,6 +71,9 @@ extern "C" {
 #define P3D_TRY( function ) if ( (function) == P3D_MEM_ERROR) { goto MEM_ERROR; }
 #endif
 
+// Strided sub-volumes (struct VolumeView):
+#include "../P3D_Common/p3dVolumeView.h"
+
 #ifndef P3D_BLOB_STRUCTS_DEFINED
 #define P3D_BLOB_STRUCTS_DEFINED
 
@@ -223,6 +226,24 @@ extern "C" {
             int (*wr_log)(const char*, ...)
             );
 
+    int p3dBlobLabeling_ushort_view(
+            struct VolumeView* in_view, // IN: input view
+            unsigned short* out_im, // OUT: labels (dimensions of the view)
+            const int conn,
+            const int random_lbl, // Flag for random labels
+            const int skip_borders,
+            int (*wr_log)(const char*, ...)
+            );
+
+    int p3dBlobLabeling_uint_view(
+            struct VolumeView* in_view, // IN: input view
+            unsigned int* out_im, // OUT: labels (dimensions of the view)
+            const int conn,
+            const int random_lbl, // Flag for random labels
+            const int skip_borders,
+            int (*wr_log)(const char*, ...)
+            );
+
 
     int p3dGetMaxVolumeBlob3D(
             unsigned char* in_rev,
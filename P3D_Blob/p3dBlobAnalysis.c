@@ -274,7 +274,7 @@ int p3dBlobAnalysis(
     }
 
     // Get distance transform and allocate memory for related image:
-    P3D_TRY(dt_im = (unsigned short*) malloc(dimx * dimy * dimz * sizeof (unsigned short)));
+    P3D_TRY(dt_im = (unsigned short*) malloc((size_t) dimx * dimy * dimz * sizeof (unsigned short)));
     p3dSquaredEuclideanDT(in_im, dt_im, dimx, dimy, dimz, NULL);
 
 	if (wr_log != NULL) {
@@ -283,13 +283,13 @@ int p3dBlobAnalysis(
 	}
 
     // Get connected components labeled image and allocate memory for related image:
-    P3D_TRY(lbl_im = (unsigned int*) malloc(dimx * dimy * dimz * sizeof (unsigned int)));
+    P3D_TRY(lbl_im = (unsigned int*) malloc((size_t) dimx * dimy * dimz * sizeof (unsigned int)));
 	P3D_TRY(p3dConnectedComponentsLabeling_uint(in_im, lbl_im, &num_el, &volumes, &bbs,
             dimx, dimy, dimz, conn, P3D_FALSE, skip_borders));	
 
     if (blob_im == NULL) {
         free_flag = P3D_TRUE;
-        P3D_TRY(blob_im = (unsigned char*) calloc(dimx * dimy * dimz, sizeof (unsigned char)));
+        P3D_TRY(blob_im = (unsigned char*) calloc((size_t) dimx * dimy * dimz, sizeof (unsigned char)));
     }
 
 	if (wr_log != NULL) {
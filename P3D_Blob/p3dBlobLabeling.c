@@ -39,12 +39,9 @@
 
 // Wrapper for the extern:
 
-int p3dBlobLabeling_ushort(
-        unsigned char* in_im,
-        unsigned short* out_im,
-        const int dimx,
-        const int dimy,
-        const int dimz,
+int p3dBlobLabeling_ushort_view(
+        struct VolumeView* in_view, // IN: input view
+        unsigned short* out_im, // OUT: labels (dimensions of the view)
         const int conn,
         const int random_lbl, // Flag for random labels
         const int skip_borders,
@@ -76,7 +73,7 @@ int p3dBlobLabeling_ushort(
     }
 
 
-    P3D_TRY( p3dConnectedComponentsLabeling_ushort(in_im, out_im, NULL, NULL, NULL, dimx, dimy, dimz,
+    P3D_TRY( p3dConnectedComponentsLabeling_ushort_view(in_view, out_im, NULL, NULL, NULL,
             conn, random_lbl, skip_borders));
 
     // Print elapsed time (if required):
@@ -106,9 +103,9 @@ MEM_ERROR:
     return P3D_AUTH_ERROR;*/
 }
 
-int p3dBlobLabeling_uint(
+int p3dBlobLabeling_ushort(
         unsigned char* in_im,
-        unsigned int* out_im,
+        unsigned short* out_im,
         const int dimx,
         const int dimy,
         const int dimz,
@@ -117,6 +114,30 @@ int p3dBlobLabeling_uint(
         const int skip_borders,
         int (*wr_log)(const char*, ...)
         ) {
+    struct VolumeView in_view;
+
+    // The whole input volume is a view of itself:
+    in_view.base = in_im;
+    in_view.dimx = dimx;
+    in_view.dimy = dimy;
+    in_view.dimz = dimz;
+    in_view.orgx = 0;
+    in_view.orgy = 0;
+    in_view.orgz = 0;
+    in_view.stridey = (size_t) dimx;
+    in_view.stridez = (size_t) dimx * dimy;
+
+    return p3dBlobLabeling_ushort_view(&in_view, out_im, conn, random_lbl, skip_borders, wr_log);
+}
+
+int p3dBlobLabeling_uint_view(
+        struct VolumeView* in_view, // IN: input view
+        unsigned int* out_im, // OUT: labels (dimensions of the view)
+        const int conn,
+        const int random_lbl, // Flag for random labels
+        const int skip_borders,
+        int (*wr_log)(const char*, ...)
+        ) {
 
     //char auth_code;
 
@@ -144,7 +165,7 @@ int p3dBlobLabeling_uint(
     }
 
 
-    P3D_TRY( p3dConnectedComponentsLabeling_uint(in_im, out_im, NULL, NULL, NULL, dimx, dimy, dimz,
+    P3D_TRY( p3dConnectedComponentsLabeling_uint_view(in_view, out_im, NULL, NULL, NULL,
             conn, random_lbl, skip_borders) );
 
     // Print elapsed time (if required):
@@ -174,3 +195,30 @@ MEM_ERROR:
     return P3D_AUTH_ERROR;*/
 }
 
+int p3dBlobLabeling_uint(
+        unsigned char* in_im,
+        unsigned int* out_im,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int conn,
+        const int random_lbl, // Flag for random labels
+        const int skip_borders,
+        int (*wr_log)(const char*, ...)
+        ) {
+    struct VolumeView in_view;
+
+    // The whole input volume is a view of itself:
+    in_view.base = in_im;
+    in_view.dimx = dimx;
+    in_view.dimy = dimy;
+    in_view.dimz = dimz;
+    in_view.orgx = 0;
+    in_view.orgy = 0;
+    in_view.orgz = 0;
+    in_view.stridey = (size_t) dimx;
+    in_view.stridez = (size_t) dimx * dimy;
+
+    return p3dBlobLabeling_uint_view(&in_view, out_im, conn, random_lbl, skip_borders, wr_log);
+}
+
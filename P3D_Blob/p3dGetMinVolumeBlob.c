@@ -78,10 +78,10 @@ int p3dGetMinVolumeBlob3D(
             wr_log("\t26-connectivity used. ");
     }
     // Initialize output cloning input:
-    memcpy(out_rev, in_rev, dimx * dimy * dimz * sizeof (unsigned char));
+    memcpy(out_rev, in_rev, (size_t) dimx * dimy * dimz * sizeof (unsigned char));
 
     // Allocate memory for labels:
-    P3D_TRY(lbl_rev = (unsigned short*) malloc(dimx * dimy * dimz * sizeof (unsigned short)));
+    P3D_TRY(lbl_rev = (unsigned short*) malloc((size_t) dimx * dimy * dimz * sizeof (unsigned short)));
 
     // Perform connected component labeling:
     P3D_TRY(p3dConnectedComponentsLabeling_ushort(in_rev, lbl_rev, &num_el, &volumes, NULL, dimx,
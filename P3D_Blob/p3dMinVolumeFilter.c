@@ -177,11 +177,11 @@ int p3dMinVolumeFilter3D(
     }
 
     // Initialize output cloning input:
-    memcpy(out_im, in_im, dimx * dimy * dimz * sizeof (unsigned char));
+    memcpy(out_im, in_im, (size_t) dimx * dimy * dimz * sizeof (unsigned char));
 
 
     // Allocate memory for labels:
-    P3D_TRY(lbl_im = (unsigned short*) malloc(dimx * dimy * dimz * sizeof (unsigned short)));
+    P3D_TRY(lbl_im = (unsigned short*) malloc((size_t) dimx * dimy * dimz * sizeof (unsigned short)));
 
     // Perform connected component labeling:
     P3D_TRY(p3dConnectedComponentsLabeling_ushort(in_im, lbl_im, &num_el, &volumes, &bbs, dimx,
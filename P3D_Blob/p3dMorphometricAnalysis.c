@@ -73,15 +73,15 @@
         a_dimz = dimz + a_rad*2;
 
         // Try to allocate memory for distance transform:
-        dt_im = (unsigned short*) malloc(dimx*dimy*dimz*sizeof(unsigned short));
+        dt_im = (unsigned short*) malloc((size_t) dimx*dimy*dimz*sizeof(unsigned short));
         if ( dt_im == NULL ) goto ON_MEM_ERROR;
 
         // Try to allocate memory for temporary dilated transform:
-        tmp_im = (unsigned char*) calloc(a_dimx*a_dimy*a_dimz,sizeof(unsigned char));
+        tmp_im = (unsigned char*) calloc((size_t) a_dimx*a_dimy*a_dimz,sizeof(unsigned char));
         if ( tmp_im == NULL ) goto ON_MEM_ERROR;
 
         // Try to allocate memory for dilated transform:
-        dil_im = (unsigned char*) malloc(dimx*dimy*dimz*sizeof(unsigned char));
+        dil_im = (unsigned char*) malloc((size_t) dimx*dimy*dimz*sizeof(unsigned char));
         if ( dil_im == NULL ) goto ON_MEM_ERROR;
 
 
@@ -176,7 +176,8 @@ int p3dMorphometricAnalysis(
         int (*wr_log)(const char*, ...)
         ) {
 
-    unsigned int s, t, i;
+    size_t s, t;
+    long long i;
 
     // Indexes for volume scanning:
     double x, y, z;
@@ -238,14 +239,14 @@ int p3dMorphometricAnalysis(
     // Get BV/TV:
     if (msk_im == NULL) {
         s = 0;
-        for (i = 0; i < (dimx * dimy * dimz); i++)
+        for (i = 0; i < ((long long) dimx * dimy * dimz); i++)
             if (in_im[i] == OBJECT) s++;
 
-        bvf = s / ((double) (dimx * dimy * dimz));
+        bvf = s / ((double) dimx * (double) dimy * (double) dimz);
     } else {
         s = 0;
         t = 0;
-        for (i = 0; i < (dimx * dimy * dimz); i++) {
+        for (i = 0; i < ((long long) dimx * dimy * dimz); i++) {
             if (msk_im[i] == OBJECT) {
                 t++;
                 if (in_im[i] == OBJECT) s++;
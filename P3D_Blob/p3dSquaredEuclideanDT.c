@@ -391,7 +391,7 @@ int p3dSquaredEuclideanDT(
     int* tmp_out_rev;
 
     // Counter:
-    int i;
+    long long i;
 
     int err_code;
 
@@ -410,10 +410,10 @@ int p3dSquaredEuclideanDT(
     }
 
     // Allocate temporary output:
-    P3D_TRY(tmp_out_rev = (int*) malloc(dimx * dimy * dimz * sizeof (int)));
+    P3D_TRY(tmp_out_rev = (int*) malloc((size_t) dimx * dimy * dimz * sizeof (int)));
 
     // Initialize temporary:
-    P3D_TRY(tmp_rev = (int*) malloc(dimx * dimy * dimz * sizeof (int)));
+    P3D_TRY(tmp_rev = (int*) malloc((size_t) dimx * dimy * dimz * sizeof (int)));
 
     // Compute transform:
     P3D_TRY(err_code = stepX(in_rev, tmp_out_rev, dimx, dimy, dimz, wr_log));
@@ -421,7 +421,7 @@ int p3dSquaredEuclideanDT(
     P3D_TRY(err_code = stepZ(tmp_rev, tmp_out_rev, dimx, dimy, dimz, wr_log));
 
     // Cast output from int to unsigned short:
-    for (i = 0; i < (dimx * dimy * dimz); i++)
+    for (i = 0; i < ((long long) dimx * dimy * dimz); i++)
         out_rev[i] = (tmp_out_rev[i] > USHRT_MAX) ? USHRT_MAX : (unsigned short) (tmp_out_rev[i]);
 
 
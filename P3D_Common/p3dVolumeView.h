@@ -0,0 +1,101 @@
+/***************************************************************************/
+/* (C) 2016 Elettra - Sincrotrone Trieste S.C.p.A.. All rights reserved.   */
+/*                                                                         */
+/*                                                                         */
+/* This file is part of Pore3D, a software library for quantitative        */
+/* analysis of 3D (volume) images.                                         */
+/*                                                                         */
+/* Pore3D is free software: you can redistribute it and/or modify it       */
+/* under the terms of the GNU General Public License as published by the   */
+/* Free Software Foundation, either version 3 of the License, or (at your  */
+/* option) any later version.                                              */
+/*                                                                         */
+/* Pore3D is distributed in the hope that it will be useful, but WITHOUT   */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or   */
+/* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License    */
+/* for more details.                                                       */
+/*                                                                         */
+/* You should have received a copy of the GNU General Public License       */
+/* along with Pore3D. If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                         */
+/***************************************************************************/
+
+//
+// Author: Francesco Brun
+// Last modified: October, 16th 2026
+//
+
+// Strided sub-volume (view) shared by P3D_Filt, P3D_Blob and P3D_Skel. It is
+// included by p3dFilt.h, p3dBlob.h, p3dSkel.h and by the Common utility
+// headers after their constants (P3D_SUCCESS and P3D_FALSE). The constructor
+// is inline so that each library (and its callers) gets it without exports.
+
+#ifndef P3D_VIEW_DEFINED
+#define P3D_VIEW_DEFINED
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    // Voxel (i,j,k) of the view is base[ IV(i,j,k,v) ]: no data is copied.
+    // Strides are in voxels:
+    struct VolumeView {
+        void* base;                 // First voxel of the parent volume
+        int dimx, dimy, dimz;       // Dimensions of the view
+        int orgx, orgy, orgz;       // Origin of the view within the parent
+        size_t stridey, stridez;    // Row and slice strides of the parent
+    };
+
+#define IS(i,j,k,SY,SZ) ( (size_t)(k)*(SZ) + (size_t)(j)*(SY) + (i) )
+#define IV(i,j,k,V)     IS((V)->orgx + (i), (V)->orgy + (j), (V)->orgz + (k), (V)->stridey, (V)->stridez)
+
+    // Describes the sub-volume of IN_IM (DIMX x DIMY x DIMZ) with origin
+    // (ORGX, ORGY, ORGZ) and dimensions A_DIMX x A_DIMY x A_DIMZ. Returns
+    // P3D_FALSE if the view does not lie within the parent volume:
+    static __inline int p3dVolumeView(
+            struct VolumeView* view, // OUT: view descriptor
+            void* in_im, // IN: parent volume
+            const int dimx, // IN: parent ncols
+            const int dimy, // IN: parent nrows
+            const int dimz, // IN: parent nplanes
+            const int orgx, // IN: origin of the view
+            const int orgy,
+            const int orgz,
+            const int a_dimx, // IN: dimensions of the view
+            const int a_dimy,
+            const int a_dimz
+            ) {
+
+        // The view must lie within the parent volume:
+        if ((orgx < 0) || (orgy < 0) || (orgz < 0) || (a_dimx < 1) || (a_dimy < 1) || (a_dimz < 1) ||
+                ((orgx + a_dimx) > dimx) || ((orgy + a_dimy) > dimy) || ((orgz + a_dimz) > dimz))
+            return P3D_FALSE;
+
+        // Describe the sub-volume without copying it:
+        view->base = in_im;
+        view->dimx = a_dimx;
+        view->dimy = a_dimy;
+        view->dimz = a_dimz;
+        view->orgx = orgx;
+        view->orgy = orgy;
+        view->orgz = orgz;
+        view->stridey = (size_t) dimx;
+        view->stridez = (size_t) dimx * dimy;
+
+        // Return OK:
+        return P3D_SUCCESS;
+    }
+
+    // P3D_TRUE if views A and B have the same dimensions (e.g. input and
+    // output of a filter), P3D_FALSE otherwise:
+    static __inline int p3dVolumeViewSameDims(const struct VolumeView* a, const struct VolumeView* b) {
+        return ((a->dimx == b->dimx) && (a->dimy == b->dimy) && (a->dimz == b->dimz)) ? P3D_TRUE : P3D_FALSE;
+    }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // P3D_VIEW_DEFINED
@@ -0,0 +1,50 @@
+/***************************************************************************/
+/* (C) 2016 Elettra - Sincrotrone Trieste S.C.p.A.. All rights reserved.   */
+/*                                                                         */
+/*                                                                         */
+/* This file is part of Pore3D, a software library for quantitative        */
+/* analysis of 3D (volume) images.                                         */
+/*                                                                         */
+/* Pore3D is free software: you can redistribute it and/or modify it       */
+/* under the terms of the GNU General Public License as published by the   */
+/* Free Software Foundation, either version 3 of the License, or (at your  */
+/* option) any later version.                                              */
+/*                                                                         */
+/* Pore3D is distributed in the hope that it will be useful, but WITHOUT   */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or   */
+/* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License    */
+/* for more details.                                                       */
+/*                                                                         */
+/* You should have received a copy of the GNU General Public License       */
+/* along with Pore3D. If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                         */
+/***************************************************************************/
+
+//
+// Author: Francesco Brun
+// Last modified: October, 16th 2026
+//
+
+#include <stdlib.h>
+
+#include "p3dClampIndex.h"
+
+int* p3dClampTable(const int dim, const int rad) {
+    int* tbl;
+    int t;
+
+    tbl = (int*) malloc((dim + 2 * rad) * sizeof (int));
+    if (tbl == NULL)
+        return NULL;
+
+    for (t = -rad; t < (dim + rad); t++)
+        tbl[t + rad] = (t < 0) ? 0 : ((t >= dim) ? (dim - 1) : t);
+
+    // Shifted so that valid indexes are [-rad, dim + rad):
+    return tbl + rad;
+}
+
+void p3dClampTableFree(int* tbl, const int rad) {
+    if (tbl != NULL)
+        free(tbl - rad);
+}
@@ -0,0 +1,44 @@
+/***************************************************************************/
+/* (C) 2016 Elettra - Sincrotrone Trieste S.C.p.A.. All rights reserved.   */
+/*                                                                         */
+/*                                                                         */
+/* This file is part of Pore3D, a software library for quantitative        */
+/* analysis of 3D (volume) images.                                         */
+/*                                                                         */
+/* Pore3D is free software: you can redistribute it and/or modify it       */
+/* under the terms of the GNU General Public License as published by the   */
+/* Free Software Foundation, either version 3 of the License, or (at your  */
+/* option) any later version.                                              */
+/*                                                                         */
+/* Pore3D is distributed in the hope that it will be useful, but WITHOUT   */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or   */
+/* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License    */
+/* for more details.                                                       */
+/*                                                                         */
+/* You should have received a copy of the GNU General Public License       */
+/* along with Pore3D. If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                         */
+/***************************************************************************/
+
+//
+// Author: Francesco Brun
+// Last modified: October, 16th 2026
+//
+
+// Virtual (padding-free) replicate borders for neighborhood filters. Instead
+// of materializing a padded copy of the input, kernels split the volume into
+// an interior region, where the whole window lies inside the volume and plain
+// indexing is used, and a boundary region, where each coordinate goes through
+// a clamp table. The table returned by p3dClampTable(dim, rad) can be indexed
+// with any coordinate in [-rad, dim + rad) and returns the nearest coordinate
+// in [0, dim), which is what p3dReplicatePadding2D/3D stores in the padding.
+
+#ifndef P3D_CLAMPINDEX_DEFINED
+#define P3D_CLAMPINDEX_DEFINED
+
+// Returns NULL if memory is not enough:
+int* p3dClampTable(const int dim, const int rad);
+
+void p3dClampTableFree(int* tbl, const int rad);
+
+#endif
@@ -0,0 +1,355 @@
+/***************************************************************************/
+/* (C) 2016 Elettra - Sincrotrone Trieste S.C.p.A.. All rights reserved.   */
+/*                                                                         */
+/*                                                                         */
+/* This file is part of Pore3D, a software library for quantitative        */
+/* analysis of 3D (volume) images.                                         */
+/*                                                                         */
+/* Pore3D is free software: you can redistribute it and/or modify it       */
+/* under the terms of the GNU General Public License as published by the   */
+/* Free Software Foundation, either version 3 of the License, or (at your  */
+/* option) any later version.                                              */
+/*                                                                         */
+/* Pore3D is distributed in the hope that it will be useful, but WITHOUT   */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or   */
+/* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License    */
+/* for more details.                                                       */
+/*                                                                         */
+/* You should have received a copy of the GNU General Public License       */
+/* along with Pore3D. If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                         */
+/***************************************************************************/
+
+//
+// Author: Francesco Brun
+// Last modified: October, 16th 2026
+//
+
+#include <math.h>
+
+#ifdef __AVX2__
+	#include <immintrin.h>
+#endif
+
+#include "p3dEigen3x3.h"
+
+// The solver is written once on the "lane" type V: a vector of 8 floats with
+// AVX2, a single float otherwise. Comparisons return masks to be used with
+// _p3dVSel(m, a, b), i.e. m ? a : b for each lane:
+#ifdef __AVX2__
+
+#define P3D_EIG3_WIDTH	8
+
+typedef __m256 V;
+
+static __inline V _p3dVSet(const float a) { return _mm256_set1_ps(a); }
+static __inline V _p3dVLoad(const float* p) { return _mm256_loadu_ps(p); }
+static __inline void _p3dVStore(float* p, const V a) { _mm256_storeu_ps(p, a); }
+static __inline V _p3dVAdd(const V a, const V b) { return _mm256_add_ps(a, b); }
+static __inline V _p3dVSub(const V a, const V b) { return _mm256_sub_ps(a, b); }
+static __inline V _p3dVMul(const V a, const V b) { return _mm256_mul_ps(a, b); }
+static __inline V _p3dVDiv(const V a, const V b) { return _mm256_div_ps(a, b); }
+static __inline V _p3dVSqrt(const V a) { return _mm256_sqrt_ps(a); }
+static __inline V _p3dVMax(const V a, const V b) { return _mm256_max_ps(a, b); }
+static __inline V _p3dVMin(const V a, const V b) { return _mm256_min_ps(a, b); }
+static __inline V _p3dVAbs(const V a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+static __inline V _p3dVGt(const V a, const V b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+static __inline V _p3dVGe(const V a, const V b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+static __inline V _p3dVSel(const V m, const V a, const V b) { return _mm256_blendv_ps(b, a, m); }
+
+#else
+
+#define P3D_EIG3_WIDTH	1
+
+typedef float V;
+
+static __inline V _p3dVSet(const float a) { return a; }
+static __inline V _p3dVLoad(const float* p) { return *p; }
+static __inline void _p3dVStore(float* p, const V a) { *p = a; }
+static __inline V _p3dVAdd(const V a, const V b) { return a + b; }
+static __inline V _p3dVSub(const V a, const V b) { return a - b; }
+static __inline V _p3dVMul(const V a, const V b) { return a * b; }
+static __inline V _p3dVDiv(const V a, const V b) { return a / b; }
+static __inline V _p3dVSqrt(const V a) { return (float) sqrt(a); }
+static __inline V _p3dVMax(const V a, const V b) { return (a > b) ? a : b; }
+static __inline V _p3dVMin(const V a, const V b) { return (a < b) ? a : b; }
+static __inline V _p3dVAbs(const V a) { return (float) fabs(a); }
+static __inline V _p3dVGt(const V a, const V b) { return (a > b) ? 1.0f : 0.0f; }
+static __inline V _p3dVGe(const V a, const V b) { return (a >= b) ? 1.0f : 0.0f; }
+static __inline V _p3dVSel(const V m, const V a, const V b) { return (m != 0.0f) ? a : b; }
+
+#endif
+
+#define P3D_EIG3_PI		3.14159265358979f
+#define P3D_EIG3_SQRT3	1.73205080756888f
+
+// Multiply-add A * B + C:
+static __inline V _p3dVMad(const V a, const V b, const V c) {
+    return _p3dVAdd(_p3dVMul(a, b), c);
+}
+
+// Arc cosine of X in [-1, 1] (Abramowitz and Stegun 4.4.46, |error| < 2e-8):
+static __inline V _p3dVAcos(const V x) {
+    const V ax = _p3dVAbs(x);
+    V r;
+
+    r = _p3dVSet(-0.0012624911f);
+    r = _p3dVMad(r, ax, _p3dVSet(0.0066700901f));
+    r = _p3dVMad(r, ax, _p3dVSet(-0.0170881256f));
+    r = _p3dVMad(r, ax, _p3dVSet(0.0308918810f));
+    r = _p3dVMad(r, ax, _p3dVSet(-0.0501743046f));
+    r = _p3dVMad(r, ax, _p3dVSet(0.0889789874f));
+    r = _p3dVMad(r, ax, _p3dVSet(-0.2145988016f));
+    r = _p3dVMad(r, ax, _p3dVSet(1.5707963050f));
+    r = _p3dVMul(r, _p3dVSqrt(_p3dVMax(_p3dVSub(_p3dVSet(1.0f), ax), _p3dVSet(0.0f))));
+
+    return _p3dVSel(_p3dVGe(x, _p3dVSet(0.0f)), r, _p3dVSub(_p3dVSet(P3D_EIG3_PI), r));
+}
+
+// Cosine and sine of T in [0, pi/3] (Taylor series, |error| < 1e-8):
+static __inline void _p3dVCosSin(const V t, V* c, V* s) {
+    const V t2 = _p3dVMul(t, t);
+    V r;
+
+    r = _p3dVSet(-1.0f / 3628800.0f);
+    r = _p3dVMad(r, t2, _p3dVSet(1.0f / 40320.0f));
+    r = _p3dVMad(r, t2, _p3dVSet(-1.0f / 720.0f));
+    r = _p3dVMad(r, t2, _p3dVSet(1.0f / 24.0f));
+    r = _p3dVMad(r, t2, _p3dVSet(-0.5f));
+    *c = _p3dVMad(r, t2, _p3dVSet(1.0f));
+
+    r = _p3dVSet(-1.0f / 39916800.0f);
+    r = _p3dVMad(r, t2, _p3dVSet(1.0f / 362880.0f));
+    r = _p3dVMad(r, t2, _p3dVSet(-1.0f / 5040.0f));
+    r = _p3dVMad(r, t2, _p3dVSet(1.0f / 120.0f));
+    r = _p3dVMad(r, t2, _p3dVSet(-1.0f / 6.0f));
+    *s = _p3dVMul(_p3dVMad(r, t2, _p3dVSet(1.0f)), t);
+}
+
+// C = A x B:
+static __inline void _p3dVCross(const V* a, const V* b, V* c) {
+    c[0] = _p3dVSub(_p3dVMul(a[1], b[2]), _p3dVMul(a[2], b[1]));
+    c[1] = _p3dVSub(_p3dVMul(a[2], b[0]), _p3dVMul(a[0], b[2]));
+    c[2] = _p3dVSub(_p3dVMul(a[0], b[1]), _p3dVMul(a[1], b[0]));
+}
+
+static __inline V _p3dVDot(const V* a, const V* b) {
+    return _p3dVMad(a[0], b[0], _p3dVMad(a[1], b[1], _p3dVMul(a[2], b[2])));
+}
+
+// Y = A X, with A stored as (xx, yy, zz, xy, xz, yz):
+static __inline void _p3dVMatVec(const V* a, const V* x, V* y) {
+    y[0] = _p3dVMad(a[0], x[0], _p3dVMad(a[3], x[1], _p3dVMul(a[4], x[2])));
+    y[1] = _p3dVMad(a[3], x[0], _p3dVMad(a[1], x[1], _p3dVMul(a[5], x[2])));
+    y[2] = _p3dVMad(a[4], x[0], _p3dVMad(a[5], x[1], _p3dVMul(a[2], x[2])));
+}
+
+// Unit eigenvector V0 of eigenvalue E, with E well separated from the other
+// two eigenvalues: the largest cross product of two rows of A - E*I. If A is
+// a multiple of I any vector is an eigenvector and (1, 0, 0) is returned:
+static void _p3dEigenvector0(const V* a, const V e, V* v0) {
+    V r0[3], r1[3], r2[3], c[3], best[3];
+    V d, dmax, m, inv;
+    int i;
+
+    r0[0] = _p3dVSub(a[0], e); r0[1] = a[3]; r0[2] = a[4];
+    r1[0] = a[3]; r1[1] = _p3dVSub(a[1], e); r1[2] = a[5];
+    r2[0] = a[4]; r2[1] = a[5]; r2[2] = _p3dVSub(a[2], e);
+
+    _p3dVCross(r0, r1, best);
+    dmax = _p3dVDot(best, best);
+
+    _p3dVCross(r0, r2, c);
+    d = _p3dVDot(c, c);
+    m = _p3dVGt(d, dmax);
+    for (i = 0; i < 3; i++)
+        best[i] = _p3dVSel(m, c[i], best[i]);
+    dmax = _p3dVMax(d, dmax);
+
+    _p3dVCross(r1, r2, c);
+    d = _p3dVDot(c, c);
+    m = _p3dVGt(d, dmax);
+    for (i = 0; i < 3; i++)
+        best[i] = _p3dVSel(m, c[i], best[i]);
+    dmax = _p3dVMax(d, dmax);
+
+    m = _p3dVGt(dmax, _p3dVSet(0.0f));
+    inv = _p3dVDiv(_p3dVSet(1.0f), _p3dVSqrt(_p3dVSel(m, dmax, _p3dVSet(1.0f))));
+    v0[0] = _p3dVSel(m, _p3dVMul(best[0], inv), _p3dVSet(1.0f));
+    v0[1] = _p3dVSel(m, _p3dVMul(best[1], inv), _p3dVSet(0.0f));
+    v0[2] = _p3dVSel(m, _p3dVMul(best[2], inv), _p3dVSet(0.0f));
+}
+
+// Unit eigenvector V1 of eigenvalue E orthogonal to the unit eigenvector V0:
+// null vector of the 2x2 matrix (A - E*I) restricted to the plane (U, W)
+// orthogonal to V0:
+static void _p3dEigenvector1(const V* a, const V* v0, const V e, V* v1) {
+    V u[3], w[3], au[3], aw[3];
+    V m, inv, m00, m01, m11, ra, rb, nrm;
+    int i;
+
+    m = _p3dVGt(_p3dVAbs(v0[0]), _p3dVAbs(v0[1]));
+    inv = _p3dVDiv(_p3dVSet(1.0f), _p3dVSqrt(_p3dVSel(m,
+            _p3dVMad(v0[0], v0[0], _p3dVMul(v0[2], v0[2])),
+            _p3dVMad(v0[1], v0[1], _p3dVMul(v0[2], v0[2])))));
+    u[0] = _p3dVSel(m, _p3dVMul(_p3dVSub(_p3dVSet(0.0f), v0[2]), inv), _p3dVSet(0.0f));
+    u[1] = _p3dVSel(m, _p3dVSet(0.0f), _p3dVMul(v0[2], inv));
+    u[2] = _p3dVSel(m, _p3dVMul(v0[0], inv), _p3dVMul(_p3dVSub(_p3dVSet(0.0f), v0[1]), inv));
+    _p3dVCross(v0, u, w);
+
+    _p3dVMatVec(a, u, au);
+    _p3dVMatVec(a, w, aw);
+    m00 = _p3dVSub(_p3dVDot(u, au), e);
+    m01 = _p3dVDot(u, aw);
+    m11 = _p3dVSub(_p3dVDot(w, aw), e);
+
+    // Use the row with the largest diagonal entry:
+    m = _p3dVGe(_p3dVAbs(m00), _p3dVAbs(m11));
+    ra = _p3dVSel(m, m00, m01);
+    rb = _p3dVSel(m, m01, m11);
+
+    nrm = _p3dVMad(ra, ra, _p3dVMul(rb, rb));
+    m = _p3dVGt(nrm, _p3dVSet(0.0f));
+    inv = _p3dVDiv(_p3dVSet(1.0f), _p3dVSqrt(_p3dVSel(m, nrm, _p3dVSet(1.0f))));
+    ra = _p3dVMul(ra, inv);
+    rb = _p3dVMul(rb, inv);
+
+    for (i = 0; i < 3; i++)
+        v1[i] = _p3dVSel(m, _p3dVSub(_p3dVMul(rb, u[i]), _p3dVMul(ra, w[i])), u[i]);
+}
+
+// Swaps eigenpairs (E1, V1) and (E2, V2) where |E1| > |E2|:
+static __inline void _p3dEigenSort(V* e1, V* v1, V* e2, V* v2) {
+    const V m = _p3dVGt(_p3dVAbs(*e1), _p3dVAbs(*e2));
+    V t;
+    int i;
+
+    t = *e1;
+    *e1 = _p3dVSel(m, *e2, t);
+    *e2 = _p3dVSel(m, t, *e2);
+    for (i = 0; i < 3; i++) {
+        t = v1[i];
+        v1[i] = _p3dVSel(m, v2[i], t);
+        v2[i] = _p3dVSel(m, t, v2[i]);
+    }
+}
+
+// Decomposes the P3D_EIG3_WIDTH matrices starting at index OFF:
+static void _p3dSymEigen3x3_lanes(const float* const* a, float* const* eval, float* const* evec,
+        const int off) {
+    V m[6], v[3][3], e[3], vl[3];
+    V scale, inv, mask, q, p, pinv, c00, c11, c22, c01, c02, c12, hd, cs, sn, ef, t;
+    int i;
+
+    for (i = 0; i < 6; i++)
+        m[i] = _p3dVLoad(a[i] + off);
+
+    // Scale to [-1, 1] to avoid overflow and underflow:
+    scale = _p3dVAbs(m[0]);
+    for (i = 1; i < 6; i++)
+        scale = _p3dVMax(scale, _p3dVAbs(m[i]));
+    mask = _p3dVGt(scale, _p3dVSet(0.0f));
+    inv = _p3dVDiv(_p3dVSet(1.0f), _p3dVSel(mask, scale, _p3dVSet(1.0f)));
+    for (i = 0; i < 6; i++)
+        m[i] = _p3dVMul(m[i], inv);
+
+    // Eigenvalues: with B = (A - q*I) / p, they are q + 2 p cos(t + 2 k pi / 3)
+    // where t = acos(det(B) / 2) / 3:
+    q = _p3dVMul(_p3dVAdd(_p3dVAdd(m[0], m[1]), m[2]), _p3dVSet(1.0f / 3.0f));
+    c00 = _p3dVSub(m[0], q);
+    c11 = _p3dVSub(m[1], q);
+    c22 = _p3dVSub(m[2], q);
+    p = _p3dVMad(c00, c00, _p3dVMad(c11, c11, _p3dVMul(c22, c22)));
+    t = _p3dVMad(m[3], m[3], _p3dVMad(m[4], m[4], _p3dVMul(m[5], m[5])));
+    p = _p3dVSqrt(_p3dVMul(_p3dVMad(_p3dVSet(2.0f), t, p), _p3dVSet(1.0f / 6.0f)));
+
+    mask = _p3dVGt(p, _p3dVSet(0.0f));
+    pinv = _p3dVDiv(_p3dVSet(1.0f), _p3dVSel(mask, p, _p3dVSet(1.0f)));
+    c00 = _p3dVMul(c00, pinv);
+    c11 = _p3dVMul(c11, pinv);
+    c22 = _p3dVMul(c22, pinv);
+    c01 = _p3dVMul(m[3], pinv);
+    c02 = _p3dVMul(m[4], pinv);
+    c12 = _p3dVMul(m[5], pinv);
+
+    hd = _p3dVMul(c00, _p3dVSub(_p3dVMul(c11, c22), _p3dVMul(c12, c12)));
+    hd = _p3dVSub(hd, _p3dVMul(c01, _p3dVSub(_p3dVMul(c01, c22), _p3dVMul(c12, c02))));
+    hd = _p3dVAdd(hd, _p3dVMul(c02, _p3dVSub(_p3dVMul(c01, c12), _p3dVMul(c11, c02))));
+    hd = _p3dVMin(_p3dVMax(_p3dVMul(hd, _p3dVSet(0.5f)), _p3dVSet(-1.0f)), _p3dVSet(1.0f));
+
+    _p3dVCosSin(_p3dVMul(_p3dVAcos(hd), _p3dVSet(1.0f / 3.0f)), &cs, &sn);
+    sn = _p3dVMul(sn, _p3dVSet(P3D_EIG3_SQRT3));
+    e[2] = _p3dVMad(_p3dVMul(_p3dVSet(2.0f), p), cs, q);
+    e[0] = _p3dVSub(q, _p3dVMul(p, _p3dVAdd(cs, sn)));
+    e[1] = _p3dVSub(q, _p3dVMul(p, _p3dVSub(cs, sn)));
+
+    // Eigenvectors: first the one of the most separated eigenvalue (the
+    // largest if det(B) >= 0, the smallest otherwise), then the middle one
+    // and finally their cross product:
+    mask = _p3dVGe(hd, _p3dVSet(0.0f));
+    ef = _p3dVSel(mask, e[2], e[0]);
+    _p3dEigenvector0(m, ef, v[0]);
+    _p3dEigenvector1(m, v[0], e[1], v[1]);
+    _p3dVCross(v[0], v[1], vl);
+    for (i = 0; i < 3; i++) {
+        v[2][i] = _p3dVSel(mask, v[0][i], vl[i]);
+        v[0][i] = _p3dVSel(mask, vl[i], v[0][i]);
+    }
+
+    // The trigonometric formula loses accuracy on close eigenvalues, so they
+    // are refined with the Rayleigh quotients of the (orthonormal)
+    // eigenvectors. Then undo scaling and sort by absolute value:
+    for (i = 0; i < 3; i++) {
+        _p3dVMatVec(m, v[i], vl);
+        e[i] = _p3dVMul(_p3dVDot(v[i], vl), scale);
+    }
+    _p3dEigenSort(&e[0], v[0], &e[1], v[1]);
+    _p3dEigenSort(&e[1], v[1], &e[2], v[2]);
+    _p3dEigenSort(&e[0], v[0], &e[1], v[1]);
+
+    for (i = 0; i < 3; i++) {
+        _p3dVStore(eval[i] + off, e[i]);
+        _p3dVStore(evec[3 * i] + off, v[i][0]);
+        _p3dVStore(evec[3 * i + 1] + off, v[i][1]);
+        _p3dVStore(evec[3 * i + 2] + off, v[i][2]);
+    }
+}
+
+void p3dSymEigen3x3_float(
+        const float* const* a,
+        float* const* eval,
+        float* const* evec,
+        const int count
+        ) {
+    float ta[6][P3D_EIG3_WIDTH], tl[3][P3D_EIG3_WIDTH], tv[9][P3D_EIG3_WIDTH];
+    const float* pa[6];
+    float* pl[3];
+    float* pv[9];
+    int i, j, l, rem;
+
+    for (l = 0; l + P3D_EIG3_WIDTH <= count; l += P3D_EIG3_WIDTH)
+        _p3dSymEigen3x3_lanes(a, eval, evec, l);
+
+    // Last matrices through zero-padded buffers:
+    rem = count - l;
+    if (rem > 0) {
+        for (i = 0; i < 6; i++) {
+            for (j = 0; j < P3D_EIG3_WIDTH; j++)
+                ta[i][j] = (j < rem) ? a[i][l + j] : 0.0f;
+            pa[i] = ta[i];
+        }
+        for (i = 0; i < 3; i++)
+            pl[i] = tl[i];
+        for (i = 0; i < 9; i++)
+            pv[i] = tv[i];
+
+        _p3dSymEigen3x3_lanes(pa, pl, pv, 0);
+
+        for (j = 0; j < rem; j++) {
+            for (i = 0; i < 3; i++)
+                eval[i][l + j] = tl[i][j];
+            for (i = 0; i < 9; i++)
+                evec[i][l + j] = tv[i][j];
+        }
+    }
+}
@@ -0,0 +1,50 @@
+/***************************************************************************/
+/* (C) 2016 Elettra - Sincrotrone Trieste S.C.p.A.. All rights reserved.   */
+/*                                                                         */
+/*                                                                         */
+/* This file is part of Pore3D, a software library for quantitative        */
+/* analysis of 3D (volume) images.                                         */
+/*                                                                         */
+/* Pore3D is free software: you can redistribute it and/or modify it       */
+/* under the terms of the GNU General Public License as published by the   */
+/* Free Software Foundation, either version 3 of the License, or (at your  */
+/* option) any later version.                                              */
+/*                                                                         */
+/* Pore3D is distributed in the hope that it will be useful, but WITHOUT   */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or   */
+/* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License    */
+/* for more details.                                                       */
+/*                                                                         */
+/* You should have received a copy of the GNU General Public License       */
+/* along with Pore3D. If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                         */
+/***************************************************************************/
+
+//
+// Author: Francesco Brun
+// Last modified: October, 16th 2026
+//
+
+// Closed-form eigen decomposition of batches of real symmetric 3x3 matrices
+// in single precision. Eigenvalues are computed with the trigonometric
+// (Smith) formula and eigenvectors with cross products of the rows of
+// A - lambda*I followed by a 2x2 problem in the orthogonal complement of the
+// first eigenvector (Kopp, Eberly), so that the three vectors are always
+// orthonormal, also for repeated eigenvalues. The code has no branches on
+// the data and processes 8 matrices at once with AVX2.
+
+#ifndef P3D_EIGEN3X3_DEFINED
+#define P3D_EIGEN3X3_DEFINED
+
+// Decomposes the COUNT matrices stored as six arrays A[0..5] (xx, yy, zz,
+// xy, xz, yz). EVAL[0..2] receive the eigenvalues sorted by increasing
+// absolute value and EVEC[3*c + r] the component r (x, y, z) of the unit
+// eigenvector of EVAL[c]:
+void p3dSymEigen3x3_float(
+        const float* const* a,
+        float* const* eval,
+        float* const* evec,
+        const int count
+        );
+
+#endif // P3D_EIGEN3X3_DEFINED
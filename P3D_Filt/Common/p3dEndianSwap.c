@@ -0,0 +1,185 @@
+/***************************************************************************/
+/* (C) 2016 Elettra - Sincrotrone Trieste S.C.p.A.. All rights reserved.   */
+/*                                                                         */
+/*                                                                         */
+/* This file is part of Pore3D, a software library for quantitative        */
+/* analysis of 3D (volume) images.                                         */
+/*                                                                         */
+/* Pore3D is free software: you can redistribute it and/or modify it       */
+/* under the terms of the GNU General Public License as published by the   */
+/* Free Software Foundation, either version 3 of the License, or (at your  */
+/* option) any later version.                                              */
+/*                                                                         */
+/* Pore3D is distributed in the hope that it will be useful, but WITHOUT   */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or   */
+/* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License    */
+/* for more details.                                                       */
+/*                                                                         */
+/* You should have received a copy of the GNU General Public License       */
+/* along with Pore3D. If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                         */
+/***************************************************************************/
+
+//
+// Author: Francesco Brun
+// Last modified: October, 16th 2026
+//
+
+#include <stdlib.h>
+#include <limits.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+	#define P3D_HAVE_SSE2
+	#include <emmintrin.h>
+#endif
+#ifdef __AVX2__
+	#include <immintrin.h>
+#endif
+
+#include "p3dEndianSwap.h"
+
+// Signed offsets (same values of USHRT_MAX/2 and UINT_MAX/2):
+#define P3D_OFFSET16	0x7FFF
+#define P3D_OFFSET32	0x7FFFFFFFU
+
+static __inline unsigned short _p3dSwap16(unsigned short v) {
+    return (unsigned short) ((v << 8) | (v >> 8));
+}
+
+static __inline unsigned int _p3dSwap32(unsigned int v) {
+    v = ((v << 8) & 0xFF00FF00) | ((v >> 8) & 0xFF00FF);
+    return (v << 16) | (v >> 16);
+}
+
+void p3dRawDecode16(
+        unsigned short* dst,
+        const unsigned short* src,
+        const size_t n,
+        const int flagSwap,
+        const int flagSigned
+        ) {
+    const unsigned short off = (flagSigned) ? P3D_OFFSET16 : 0;
+    size_t ct = 0;
+
+#ifdef __AVX2__
+    const __m256i a_mask = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+            1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    const __m256i a_off = _mm256_set1_epi16((short) off);
+    __m256i a_v;
+
+    for (; ct + 16 <= n; ct += 16) {
+        a_v = _mm256_loadu_si256((const __m256i*) (src + ct));
+        if (flagSwap) a_v = _mm256_shuffle_epi8(a_v, a_mask);
+        a_v = _mm256_add_epi16(a_v, a_off);
+        _mm256_storeu_si256((__m256i*) (dst + ct), a_v);
+    }
+#endif
+#ifdef P3D_HAVE_SSE2
+    {
+        const __m128i s_off = _mm_set1_epi16((short) off);
+        __m128i s_v;
+
+        for (; ct + 8 <= n; ct += 8) {
+            s_v = _mm_loadu_si128((const __m128i*) (src + ct));
+            if (flagSwap) s_v = _mm_or_si128(_mm_slli_epi16(s_v, 8), _mm_srli_epi16(s_v, 8));
+            s_v = _mm_add_epi16(s_v, s_off);
+            _mm_storeu_si128((__m128i*) (dst + ct), s_v);
+        }
+    }
+#endif
+    // Scalar tail (or whole buffer without SIMD support):
+    for (; ct < n; ct++) {
+        dst[ct] = (unsigned short) (((flagSwap) ? _p3dSwap16(src[ct]) : src[ct]) + off);
+    }
+}
+
+void p3dRawEncode16(
+        unsigned short* dst,
+        const unsigned short* src,
+        const size_t n,
+        const int flagSwap,
+        const int flagSigned
+        ) {
+    const unsigned short off = (flagSigned) ? P3D_OFFSET16 : 0;
+    unsigned short v;
+    size_t ct = 0;
+
+#ifdef __AVX2__
+    const __m256i a_mask = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+            1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    const __m256i a_off = _mm256_set1_epi16((short) off);
+    __m256i a_v;
+
+    for (; ct + 16 <= n; ct += 16) {
+        a_v = _mm256_loadu_si256((const __m256i*) (src + ct));
+        a_v = _mm256_sub_epi16(a_v, a_off);
+        if (flagSwap) a_v = _mm256_shuffle_epi8(a_v, a_mask);
+        _mm256_storeu_si256((__m256i*) (dst + ct), a_v);
+    }
+#endif
+#ifdef P3D_HAVE_SSE2
+    {
+        const __m128i s_off = _mm_set1_epi16((short) off);
+        __m128i s_v;
+
+        for (; ct + 8 <= n; ct += 8) {
+            s_v = _mm_loadu_si128((const __m128i*) (src + ct));
+            s_v = _mm_sub_epi16(s_v, s_off);
+            if (flagSwap) s_v = _mm_or_si128(_mm_slli_epi16(s_v, 8), _mm_srli_epi16(s_v, 8));
+            _mm_storeu_si128((__m128i*) (dst + ct), s_v);
+        }
+    }
+#endif
+    for (; ct < n; ct++) {
+        v = (unsigned short) (src[ct] - off);
+        dst[ct] = (flagSwap) ? _p3dSwap16(v) : v;
+    }
+}
+
+void p3dRawEncode32(
+        unsigned int* dst,
+        const unsigned int* src,
+        const size_t n,
+        const int flagSwap,
+        const int flagSigned
+        ) {
+    const unsigned int off = (flagSigned) ? P3D_OFFSET32 : 0;
+    unsigned int v;
+    size_t ct = 0;
+
+#ifdef __AVX2__
+    const __m256i a_mask = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    const __m256i a_off = _mm256_set1_epi32((int) off);
+    __m256i a_v;
+
+    for (; ct + 8 <= n; ct += 8) {
+        a_v = _mm256_loadu_si256((const __m256i*) (src + ct));
+        a_v = _mm256_sub_epi32(a_v, a_off);
+        if (flagSwap) a_v = _mm256_shuffle_epi8(a_v, a_mask);
+        _mm256_storeu_si256((__m256i*) (dst + ct), a_v);
+    }
+#endif
+#ifdef P3D_HAVE_SSE2
+    {
+        const __m128i s_off = _mm_set1_epi32((int) off);
+        __m128i s_v;
+
+        for (; ct + 4 <= n; ct += 4) {
+            s_v = _mm_loadu_si128((const __m128i*) (src + ct));
+            s_v = _mm_sub_epi32(s_v, s_off);
+            if (flagSwap) {
+                // Swap bytes within 16-bit words and then the two words:
+                s_v = _mm_or_si128(_mm_slli_epi16(s_v, 8), _mm_srli_epi16(s_v, 8));
+                s_v = _mm_shufflelo_epi16(s_v, _MM_SHUFFLE(2, 3, 0, 1));
+                s_v = _mm_shufflehi_epi16(s_v, _MM_SHUFFLE(2, 3, 0, 1));
+            }
+            _mm_storeu_si128((__m128i*) (dst + ct), s_v);
+        }
+    }
+#endif
+    for (; ct < n; ct++) {
+        v = src[ct] - off;
+        dst[ct] = (flagSwap) ? _p3dSwap32(v) : v;
+    }
+}
@@ -0,0 +1,71 @@
+/***************************************************************************/
+/* (C) 2016 Elettra - Sincrotrone Trieste S.C.p.A.. All rights reserved.   */
+/*                                                                         */
+/*                                                                         */
+/* This file is part of Pore3D, a software library for quantitative        */
+/* analysis of 3D (volume) images.                                         */
+/*                                                                         */
+/* Pore3D is free software: you can redistribute it and/or modify it       */
+/* under the terms of the GNU General Public License as published by the   */
+/* Free Software Foundation, either version 3 of the License, or (at your  */
+/* option) any later version.                                              */
+/*                                                                         */
+/* Pore3D is distributed in the hope that it will be useful, but WITHOUT   */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or   */
+/* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License    */
+/* for more details.                                                       */
+/*                                                                         */
+/* You should have received a copy of the GNU General Public License       */
+/* along with Pore3D. If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                         */
+/***************************************************************************/
+
+//
+// Author: Francesco Brun
+// Last modified: October, 16th 2026
+//
+
+// Conversion kernels between the in-memory representation of Pore3D images
+// (host-endian unsigned values) and the on-disk representation of RAW files
+// (little or big endian, signed or unsigned). Signed data are shifted by
+// USHRT_MAX/2 (16-bit) or UINT_MAX/2 (32-bit) as in p3dReadRaw16 and
+// p3dWriteRaw16/32. The kernels are meant to be called on chunks small
+// enough to stay in cache and SRC may be equal to DST (in place).
+
+#ifndef P3D_ENDIANSWAP_DEFINED
+#define P3D_ENDIANSWAP_DEFINED
+
+#include <stddef.h>
+
+// Number of voxels converted at once by chunked RAW readers/writers:
+#define P3D_RAW_CHUNK	1048576
+
+// From file to memory: swap bytes (if FLAGSWAP) and then add the signed offset
+// (if FLAGSIGNED):
+void p3dRawDecode16(
+        unsigned short* dst,
+        const unsigned short* src,
+        const size_t n,
+        const int flagSwap,
+        const int flagSigned
+        );
+
+// From memory to file: subtract the signed offset (if FLAGSIGNED) and then
+// swap bytes (if FLAGSWAP):
+void p3dRawEncode16(
+        unsigned short* dst,
+        const unsigned short* src,
+        const size_t n,
+        const int flagSwap,
+        const int flagSigned
+        );
+
+void p3dRawEncode32(
+        unsigned int* dst,
+        const unsigned int* src,
+        const size_t n,
+        const int flagSwap,
+        const int flagSigned
+        );
+
+#endif // P3D_ENDIANSWAP_DEFINED
@@ -0,0 +1,214 @@
+/***************************************************************************/
+/* (C) 2016 Elettra - Sincrotrone Trieste S.C.p.A.. All rights reserved.   */
+/*                                                                         */
+/*                                                                         */
+/* This file is part of Pore3D, a software library for quantitative        */
+/* analysis of 3D (volume) images.                                         */
+/*                                                                         */
+/* Pore3D is free software: you can redistribute it and/or modify it       */
+/* under the terms of the GNU General Public License as published by the   */
+/* Free Software Foundation, either version 3 of the License, or (at your  */
+/* option) any later version.                                              */
+/*                                                                         */
+/* Pore3D is distributed in the hope that it will be useful, but WITHOUT   */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or   */
+/* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License    */
+/* for more details.                                                       */
+/*                                                                         */
+/* You should have received a copy of the GNU General Public License       */
+/* along with Pore3D. If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                         */
+/***************************************************************************/
+
+
+//
+// Author: Francesco Brun
+// Last modified: October, 16th 2026
+//
+
+#include <math.h>
+#include <string.h>
+
+#ifdef __AVX2__
+	#include <immintrin.h>
+#endif
+
+#include "p3dFFT.h"
+
+#define P3D_FFT_PI		3.1415926535897932384626433
+
+// Radix-2 butterfly on rows: D0 = A + B and D1 = (A - B) * W:
+static __inline void _p3dFFTRadix2(
+        const float* ar, const float* ai,
+        const float* br, const float* bi,
+        float* d0r, float* d0i,
+        float* d1r, float* d1i,
+        const float wr, const float wi,
+        const int width
+        ) {
+    float tr, ti;
+    int x = 0;
+
+#ifdef __AVX2__
+    const __m256 vwr = _mm256_set1_ps(wr);
+    const __m256 vwi = _mm256_set1_ps(wi);
+    __m256 var, vai, vbr, vbi, vtr, vti;
+
+    for (; x <= (width - 8); x += 8) {
+        var = _mm256_loadu_ps(ar + x);
+        vai = _mm256_loadu_ps(ai + x);
+        vbr = _mm256_loadu_ps(br + x);
+        vbi = _mm256_loadu_ps(bi + x);
+
+        _mm256_storeu_ps(d0r + x, _mm256_add_ps(var, vbr));
+        _mm256_storeu_ps(d0i + x, _mm256_add_ps(vai, vbi));
+
+        vtr = _mm256_sub_ps(var, vbr);
+        vti = _mm256_sub_ps(vai, vbi);
+        _mm256_storeu_ps(d1r + x, _mm256_sub_ps(_mm256_mul_ps(vtr, vwr), _mm256_mul_ps(vti, vwi)));
+        _mm256_storeu_ps(d1i + x, _mm256_add_ps(_mm256_mul_ps(vtr, vwi), _mm256_mul_ps(vti, vwr)));
+    }
+#endif
+    for (; x < width; x++) {
+        d0r[x] = ar[x] + br[x];
+        d0i[x] = ai[x] + bi[x];
+
+        tr = ar[x] - br[x];
+        ti = ai[x] - bi[x];
+        d1r[x] = tr * wr - ti * wi;
+        d1i[x] = tr * wi + ti * wr;
+    }
+}
+
+// Complex multiply-add on rows: D = A * C (FLAGFIRST) or D += A * C:
+static __inline void _p3dFFTMulAdd(
+        const float* ar, const float* ai,
+        float* dr, float* di,
+        const float cr, const float ci,
+        const int width,
+        const int flagFirst
+        ) {
+    float tr, ti;
+    int x = 0;
+
+#ifdef __AVX2__
+    const __m256 vcr = _mm256_set1_ps(cr);
+    const __m256 vci = _mm256_set1_ps(ci);
+    __m256 var, vai, vtr, vti;
+
+    for (; x <= (width - 8); x += 8) {
+        var = _mm256_loadu_ps(ar + x);
+        vai = _mm256_loadu_ps(ai + x);
+
+        vtr = _mm256_sub_ps(_mm256_mul_ps(var, vcr), _mm256_mul_ps(vai, vci));
+        vti = _mm256_add_ps(_mm256_mul_ps(var, vci), _mm256_mul_ps(vai, vcr));
+        if (!flagFirst) {
+            vtr = _mm256_add_ps(vtr, _mm256_loadu_ps(dr + x));
+            vti = _mm256_add_ps(vti, _mm256_loadu_ps(di + x));
+        }
+        _mm256_storeu_ps(dr + x, vtr);
+        _mm256_storeu_ps(di + x, vti);
+    }
+#endif
+    for (; x < width; x++) {
+        tr = ar[x] * cr - ai[x] * ci;
+        ti = ar[x] * ci + ai[x] * cr;
+        dr[x] = (flagFirst) ? tr : (dr[x] + tr);
+        di[x] = (flagFirst) ? ti : (di[x] + ti);
+    }
+}
+
+// Smallest prime factor of N (N > 1):
+static int _p3dFFTFactor(const int n) {
+    int p;
+
+    if ((n % 2) == 0) return 2;
+    for (p = 3; p * p <= n; p += 2)
+        if ((n % p) == 0) return p;
+
+    return n;
+}
+
+void p3dFFTColumns_float(
+        float* re,
+        float* im,
+        float* wre,
+        float* wim,
+        const int n,
+        const int width,
+        const int stride,
+        const int flagInverse
+        ) {
+    const double sign = (flagInverse) ? 1.0 : -1.0;
+    float *sr = re, *si = im, *dr = wre, *di = wim, *tmp;
+    double ang;
+    float scale;
+    int len, r, m, s, p, q, j, k;
+    size_t a, b;
+
+    // Stockham stages: a sub-transform of length LEN (and stride S in rows)
+    // is split into R interleaved ones of length M = LEN / R:
+    s = 1;
+    for (len = n; len > 1; len = m) {
+        r = _p3dFFTFactor(len);
+        m = len / r;
+
+        for (p = 0; p < m; p++) {
+            for (q = 0; q < s; q++) {
+                if (r == 2) {
+                    ang = sign * 2.0 * P3D_FFT_PI * p / len;
+                    a = (size_t) (q + s * p) * stride;
+                    b = (size_t) (q + s * (p + m)) * stride;
+
+                    _p3dFFTRadix2(sr + a, si + a, sr + b, si + b,
+                            dr + (size_t) (q + s * (2 * p)) * stride, di + (size_t) (q + s * (2 * p)) * stride,
+                            dr + (size_t) (q + s * (2 * p + 1)) * stride, di + (size_t) (q + s * (2 * p + 1)) * stride,
+                            (float) cos(ang), (float) sin(ang), width);
+                } else {
+                    // Output K is the sum over J of input J times the DFT
+                    // coefficient (JK mod R) and the twiddle factor PK:
+                    for (k = 0; k < r; k++) {
+                        b = (size_t) (q + s * (r * p + k)) * stride;
+
+                        for (j = 0; j < r; j++) {
+                            ang = sign * 2.0 * P3D_FFT_PI * ((double) ((j * k) % r) / r + (double) (p * k) / len);
+                            a = (size_t) (q + s * (p + j * m)) * stride;
+
+                            _p3dFFTMulAdd(sr + a, si + a, dr + b, di + b, (float) cos(ang), (float) sin(ang),
+                                    width, j == 0);
+                        }
+                    }
+                }
+            }
+        }
+
+        // Swap input and output planes:
+        tmp = sr; sr = dr; dr = tmp;
+        tmp = si; si = di; di = tmp;
+        s *= r;
+    }
+
+    // Result has to be in RE and IM (scaled if inverse):
+    scale = (flagInverse) ? (float) (1.0 / n) : 1.0f;
+    if ((sr != re) || (flagInverse)) {
+        for (j = 0; j < n; j++) {
+            for (k = 0; k < width; k++) {
+                re[ (size_t) j * stride + k ] = sr[ (size_t) j * stride + k ] * scale;
+                im[ (size_t) j * stride + k ] = si[ (size_t) j * stride + k ] * scale;
+            }
+        }
+    }
+}
+
+int p3dFFTGoodSize(const int n) {
+    int m, k;
+
+    for (m = (n > 1) ? n : 1;; m++) {
+        k = m;
+        while ((k % 2) == 0) k /= 2;
+        while ((k % 3) == 0) k /= 3;
+        while ((k % 5) == 0) k /= 5;
+        if (k == 1)
+            return m;
+    }
+}
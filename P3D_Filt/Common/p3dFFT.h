@@ -0,0 +1,59 @@
+/***************************************************************************/
+/* (C) 2016 Elettra - Sincrotrone Trieste S.C.p.A.. All rights reserved.   */
+/*                                                                         */
+/*                                                                         */
+/* This file is part of Pore3D, a software library for quantitative        */
+/* analysis of 3D (volume) images.                                         */
+/*                                                                         */
+/* Pore3D is free software: you can redistribute it and/or modify it       */
+/* under the terms of the GNU General Public License as published by the   */
+/* Free Software Foundation, either version 3 of the License, or (at your  */
+/* option) any later version.                                              */
+/*                                                                         */
+/* Pore3D is distributed in the hope that it will be useful, but WITHOUT   */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or   */
+/* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License    */
+/* for more details.                                                       */
+/*                                                                         */
+/* You should have received a copy of the GNU General Public License       */
+/* along with Pore3D. If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                         */
+/***************************************************************************/
+
+
+//
+// Author: Francesco Brun
+// Last modified: October, 16th 2026
+//
+
+// Complex FFT in single precision applied at once to the columns of a 2D
+// array stored as two planes (real and imaginary parts). The transform runs
+// along y with the self-sorting (Stockham) mixed-radix algorithm: each
+// butterfly combines whole rows, so that the innermost loops run along x
+// on contiguous data (8 columns at once with AVX2). Any length is accepted:
+// factors 2 have a dedicated butterfly and any other prime factor P a
+// generic one costing P*P complex multiply-adds per row, so lengths with
+// small factors (2, 3, 5) should be preferred.
+
+#ifndef P3D_FFT_DEFINED
+#define P3D_FFT_DEFINED
+
+// Transforms in place the WIDTH columns of length N of the planes RE and IM
+// (rows are STRIDE floats apart). WRE and WIM are work planes with the same
+// layout. The inverse transform (FLAGINVERSE) is scaled by 1/N, so that it
+// inverts the direct one:
+void p3dFFTColumns_float(
+        float* re,
+        float* im,
+        float* wre,
+        float* wim,
+        const int n,
+        const int width,
+        const int stride,
+        const int flagInverse
+        );
+
+// Smallest integer not less than N having 2, 3 and 5 as only prime factors:
+int p3dFFTGoodSize(const int n);
+
+#endif // P3D_FFT_DEFINED
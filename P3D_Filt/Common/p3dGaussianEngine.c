@@ -0,0 +1,334 @@
+/***************************************************************************/
+/* (C) 2016 Elettra - Sincrotrone Trieste S.C.p.A.. All rights reserved.   */
+/*                                                                         */
+/*                                                                         */
+/* This file is part of Pore3D, a software library for quantitative        */
+/* analysis of 3D (volume) images.                                         */
+/*                                                                         */
+/* Pore3D is free software: you can redistribute it and/or modify it       */
+/* under the terms of the GNU General Public License as published by the   */
+/* Free Software Foundation, either version 3 of the License, or (at your  */
+/* option) any later version.                                              */
+/*                                                                         */
+/* Pore3D is distributed in the hope that it will be useful, but WITHOUT   */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or   */
+/* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License    */
+/* for more details.                                                       */
+/*                                                                         */
+/* You should have received a copy of the GNU General Public License       */
+/* along with Pore3D. If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                         */
+/***************************************************************************/
+
+//
+// Author: Francesco Brun
+// Last modified: October, 16th 2026
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <omp.h>
+
+#ifdef __AVX2__
+	#include <immintrin.h>
+#endif
+
+#include "../p3dFilt.h"
+#include "p3dClampIndex.h"
+#include "p3dGaussianEngine.h"
+
+// Number of lines filtered at once by the x pass of the recursive filter:
+#define P3D_GAUSS_LINES	8
+
+// Coefficients of the recursive filter:
+//   w[n] = B x[n] + c1 w[n-1] + c2 w[n-2] + c3 w[n-3]   (causal)
+//   y[n] = B w[n] + c1 y[n+1] + c2 y[n+2] + c3 y[n+3]   (anti-causal)
+struct GaussIIR {
+    float B, c1, c2, c3;
+};
+
+static void _p3dGaussIIRCoeffs(struct GaussIIR* g, const double sigma) {
+    double q, b0, b1, b2, b3;
+
+    // Young and van Vliet, Signal Processing 44 (1995):
+    if (sigma >= 2.5)
+        q = 0.98711 * sigma - 0.96330;
+    else
+        q = 3.97156 - 4.14554 * sqrt(1.0 - 0.26891 * sigma);
+
+    b0 = 1.57825 + 2.44413 * q + 1.4281 * q * q + 0.422205 * q * q * q;
+    b1 = 2.44413 * q + 2.85619 * q * q + 1.26661 * q * q * q;
+    b2 = -(1.4281 * q * q + 1.26661 * q * q * q);
+    b3 = 0.422205 * q * q * q;
+
+    g->B = (float) (1.0 - (b1 + b2 + b3) / b0);
+    g->c1 = (float) (b1 / b0);
+    g->c2 = (float) (b2 / b0);
+    g->c3 = (float) (b3 / b0);
+}
+
+// DST = K * SRC:
+static void _p3dScaleRow(float* dst, const float* src, const float k, const int w) {
+    int i = 0;
+
+#ifdef __AVX2__
+    const __m256 a_k = _mm256_set1_ps(k);
+
+    for (; i + 8 <= w; i += 8)
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(a_k, _mm256_loadu_ps(src + i)));
+#endif
+    for (; i < w; i++)
+        dst[i] = k * src[i];
+}
+
+// DST += K * SRC:
+static void _p3dAxpyRow(float* dst, const float* src, const float k, const int w) {
+    int i = 0;
+
+#ifdef __AVX2__
+    const __m256 a_k = _mm256_set1_ps(k);
+
+    for (; i + 8 <= w; i += 8)
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i),
+                _mm256_mul_ps(a_k, _mm256_loadu_ps(src + i))));
+#endif
+    for (; i < w; i++)
+        dst[i] += k * src[i];
+}
+
+// FIR along a line of N samples. The line is first copied (with replicated
+// borders) into LINE, which must hold N + 2*RAD samples:
+static void _p3dGaussFIRLine(float* row, const int n, const float* kernel, const int rad, const int* c, float* line) {
+    float* p = line + rad;
+    float sum;
+    int i, t;
+
+    for (t = -rad; t < (n + rad); t++)
+        p[t] = row[ c[t] ];
+
+    i = 0;
+#ifdef __AVX2__
+    for (; i + 8 <= n; i += 8) {
+        __m256 a_sum = _mm256_setzero_ps();
+
+        for (t = 0; t <= 2 * rad; t++)
+            a_sum = _mm256_add_ps(a_sum, _mm256_mul_ps(_mm256_set1_ps(kernel[t]),
+                    _mm256_loadu_ps(p + i - rad + t)));
+        _mm256_storeu_ps(row + i, a_sum);
+    }
+#endif
+    for (; i < n; i++) {
+        sum = 0.0f;
+        for (t = 0; t <= 2 * rad; t++)
+            sum += kernel[t] * p[i - rad + t];
+        row[i] = sum;
+    }
+}
+
+// FIR across N rows of W samples, STRIDE samples apart. RING must hold
+// 2*RAD + 1 rows: virtual row t in [-rad, n + rad) is kept in slot
+// (t + rad) mod (2*rad + 1). Row t + rad is loaded just before row t is
+// overwritten, so the window always holds input values:
+static void _p3dGaussFIRRows(float* first, const size_t stride, const int n, const int w,
+        const float* kernel, const int rad, const int* c, float* ring) {
+    const int r_size = 2 * rad + 1;
+    float* out;
+    int j, t;
+
+    for (t = -rad; t < rad; t++)
+        memcpy(ring + (size_t) ((t + rad) % r_size) * w, first + c[t] * stride, w * sizeof (float));
+
+    for (j = 0; j < n; j++) {
+        memcpy(ring + (size_t) ((j + 2 * rad) % r_size) * w, first + c[j + rad] * stride, w * sizeof (float));
+
+        out = first + j * stride;
+        _p3dScaleRow(out, ring + (size_t) (j % r_size) * w, kernel[0], w);
+        for (t = 1; t < r_size; t++)
+            _p3dAxpyRow(out, ring + (size_t) ((j + t) % r_size) * w, kernel[t], w);
+    }
+}
+
+// OUT = B X + c1 R1 + c2 R2 + c3 R3 (OUT may be equal to X):
+static void _p3dGaussIIRStep(float* out, const float* x, const float* r1, const float* r2, const float* r3,
+        const struct GaussIIR* g, const int w) {
+    int i = 0;
+
+#ifdef __AVX2__
+    const __m256 a_B = _mm256_set1_ps(g->B);
+    const __m256 a_c1 = _mm256_set1_ps(g->c1);
+    const __m256 a_c2 = _mm256_set1_ps(g->c2);
+    const __m256 a_c3 = _mm256_set1_ps(g->c3);
+    __m256 a_v;
+
+    for (; i + 8 <= w; i += 8) {
+        a_v = _mm256_mul_ps(a_B, _mm256_loadu_ps(x + i));
+        a_v = _mm256_add_ps(a_v, _mm256_mul_ps(a_c1, _mm256_loadu_ps(r1 + i)));
+        a_v = _mm256_add_ps(a_v, _mm256_mul_ps(a_c2, _mm256_loadu_ps(r2 + i)));
+        a_v = _mm256_add_ps(a_v, _mm256_mul_ps(a_c3, _mm256_loadu_ps(r3 + i)));
+        _mm256_storeu_ps(out + i, a_v);
+    }
+#endif
+    for (; i < w; i++)
+        out[i] = g->B * x[i] + g->c1 * r1[i] + g->c2 * r2[i] + g->c3 * r3[i];
+}
+
+// IIR across N rows of W samples, STRIDE samples apart. Both passes are
+// computed in place on whole rows, so they vectorize along the rows. The
+// causal pass continues for PAD rows beyond the last one (replicated) so that
+// the anti-causal pass starts from a nearly steady state. BUF must hold
+// PAD + 5 rows: copies of the first and of the last input row followed by the
+// PAD + 3 rows beyond the end of the volume:
+static void _p3dGaussIIRRows(float* first, const size_t stride, const int n, const int w,
+        const struct GaussIIR* g, const int pad, float* buf) {
+    float* x_first = buf;
+    float* x_last = buf + w;
+    float* tail = buf + 2 * (size_t) w;
+    float* r[4];
+    int j, t;
+
+    memcpy(x_first, first, w * sizeof (float));
+    memcpy(x_last, first + (n - 1) * stride, w * sizeof (float));
+
+    // Causal pass (rows before the first one are steady state):
+    for (j = 0; j < (n + pad); j++) {
+        for (t = 0; t < 4; t++)
+            r[t] = ((j - t) < 0) ? x_first : (((j - t) < n) ? first + (j - t) * stride : tail + (size_t) (j - t - n) * w);
+        _p3dGaussIIRStep(r[0], (j < n) ? r[0] : x_last, r[1], r[2], r[3], g, w);
+    }
+
+    for (t = 0; t < 3; t++)
+        memcpy(tail + (size_t) (pad + t) * w, tail + (size_t) (pad - 1) * w, w * sizeof (float));
+
+    // Anti-causal pass:
+    for (j = (n + pad - 1); j >= 0; j--) {
+        for (t = 0; t < 4; t++)
+            r[t] = ((j + t) < n) ? first + (j + t) * stride : tail + (size_t) (j + t - n) * w;
+
+        _p3dGaussIIRStep(r[0], r[0], r[1], r[2], r[3], g, w);
+    }
+}
+
+int p3dGaussianSmooth3D_float(
+        float* im,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const double sigma,
+        const int rad,
+        const int flagIIR
+        ) {
+    struct GaussIIR g;
+    float* kernel = NULL;
+    float* buf = NULL;
+    float* t_buf;
+    int* cx = NULL;
+    int* cy = NULL;
+    int* cz = NULL;
+
+    size_t buf_size;
+    int i, j, k, t, jw;
+    int useIIR, pad = 0;
+    double sum_w;
+
+    if (sigma <= 0.0)
+        return P3D_SUCCESS;
+
+    useIIR = (flagIIR == P3D_TRUE) && (sigma >= P3D_GAUSS_IIR_SIGMA) && (rad >= 3.0 * sigma);
+
+    if (useIIR) {
+        _p3dGaussIIRCoeffs(&g, sigma);
+        pad = (int) ceil(6.0 * sigma);
+
+        buf_size = MAX((size_t) (dimx + pad + 5) * P3D_GAUSS_LINES, (size_t) (pad + 5) * dimx);
+    } else {
+        P3D_TRY(kernel = (float*) malloc((2 * rad + 1) * sizeof (float)));
+        P3D_TRY(cx = p3dClampTable(dimx, rad));
+        P3D_TRY(cy = p3dClampTable(dimy, rad));
+        P3D_TRY(cz = p3dClampTable(dimz, rad));
+
+        // Create normalized gaussian kernel:
+        sum_w = 0.0;
+        for (t = -rad; t <= rad; t++) {
+            kernel[t + rad] = (float) exp(-(t * t) / (2.0 * sigma * sigma));
+            sum_w += kernel[t + rad];
+        }
+        for (t = 0; t <= 2 * rad; t++)
+            kernel[t] = (float) (kernel[t] / sum_w);
+
+        buf_size = MAX((size_t) dimx + 2 * rad, (size_t) (2 * rad + 1) * dimx);
+    }
+    P3D_TRY(buf = (float*) malloc(omp_get_max_threads() * buf_size * sizeof (float)));
+
+    // X-direction scanning, one line at a time. The recursive filter instead
+    // processes P3D_GAUSS_LINES lines at once, interleaved so that each sample
+    // of the lines becomes a short row:
+#pragma omp parallel for private(i, j, t, jw, t_buf)
+    for (k = 0; k < dimz; k++) {
+        t_buf = buf + omp_get_thread_num() * buf_size;
+
+        if (useIIR) {
+            for (j = 0; j < dimy; j += P3D_GAUSS_LINES) {
+                jw = MIN(P3D_GAUSS_LINES, dimy - j);
+
+                for (t = 0; t < jw; t++)
+                    for (i = 0; i < dimx; i++)
+                        t_buf[ I2(t, i, jw) ] = im[ I(i, j + t, k, dimx, dimy) ];
+
+                _p3dGaussIIRRows(t_buf, jw, dimx, jw, &g, pad, t_buf + (size_t) dimx * jw);
+
+                for (t = 0; t < jw; t++)
+                    for (i = 0; i < dimx; i++)
+                        im[ I(i, j + t, k, dimx, dimy) ] = t_buf[ I2(t, i, jw) ];
+            }
+        } else {
+            for (j = 0; j < dimy; j++)
+                _p3dGaussFIRLine(im + I(0, j, k, dimx, dimy), dimx, kernel, rad, cx, t_buf);
+        }
+    }
+
+    // Y-direction scanning, one plane at a time:
+#pragma omp parallel for private(t_buf)
+    for (k = 0; k < dimz; k++) {
+        t_buf = buf + omp_get_thread_num() * buf_size;
+
+        if (useIIR)
+            _p3dGaussIIRRows(im + I(0, 0, k, dimx, dimy), dimx, dimy, dimx, &g, pad, t_buf);
+        else
+            _p3dGaussFIRRows(im + I(0, 0, k, dimx, dimy), dimx, dimy, dimx, kernel, rad, cy, t_buf);
+    }
+
+    // Z-direction scanning, one xz section at a time:
+#pragma omp parallel for private(t_buf)
+    for (j = 0; j < dimy; j++) {
+        t_buf = buf + omp_get_thread_num() * buf_size;
+
+        if (useIIR)
+            _p3dGaussIIRRows(im + I(0, j, 0, dimx, dimy), (size_t) dimx * dimy, dimz, dimx, &g, pad, t_buf);
+        else
+            _p3dGaussFIRRows(im + I(0, j, 0, dimx, dimy), (size_t) dimx * dimy, dimz, dimx, kernel, rad, cz, t_buf);
+    }
+
+    // Release resources:
+    if (kernel != NULL) free(kernel);
+    if (buf != NULL) free(buf);
+    p3dClampTableFree(cx, rad);
+    p3dClampTableFree(cy, rad);
+    p3dClampTableFree(cz, rad);
+
+    // Return success:
+    return P3D_SUCCESS;
+
+
+MEM_ERROR:
+
+    // Release resources:
+    if (kernel != NULL) free(kernel);
+    if (buf != NULL) free(buf);
+    p3dClampTableFree(cx, rad);
+    p3dClampTableFree(cy, rad);
+    p3dClampTableFree(cz, rad);
+
+    // Return error:
+    return P3D_MEM_ERROR;
+}
@@ -0,0 +1,60 @@
+/***************************************************************************/
+/* (C) 2016 Elettra - Sincrotrone Trieste S.C.p.A.. All rights reserved.   */
+/*                                                                         */
+/*                                                                         */
+/* This file is part of Pore3D, a software library for quantitative        */
+/* analysis of 3D (volume) images.                                         */
+/*                                                                         */
+/* Pore3D is free software: you can redistribute it and/or modify it       */
+/* under the terms of the GNU General Public License as published by the   */
+/* Free Software Foundation, either version 3 of the License, or (at your  */
+/* option) any later version.                                              */
+/*                                                                         */
+/* Pore3D is distributed in the hope that it will be useful, but WITHOUT   */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or   */
+/* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License    */
+/* for more details.                                                       */
+/*                                                                         */
+/* You should have received a copy of the GNU General Public License       */
+/* along with Pore3D. If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                         */
+/***************************************************************************/
+
+//
+// Author: Francesco Brun
+// Last modified: October, 16th 2026
+//
+
+// Separable gaussian smoothing of float volumes, shared by the gaussian
+// filters and by the anisotropic diffusion filter. The volume is filtered in
+// place along x, y and z with replicate borders. No padded copy is made: each
+// pass works on buffers of a few lines (x) or rows (y and z) private to each
+// OpenMP thread. Two engines are available:
+//   - FIR: gaussian kernel truncated to [-rad, rad] and normalized. The y and
+//     z passes read the window from a ring of 2*rad+1 rows. Vectorized with
+//     AVX2 when available;
+//   - IIR: Young-van Vliet recursive gaussian, whose cost per voxel does not
+//     depend on sigma. It approximates the whole (untruncated) gaussian, so
+//     its output is not the one of the FIR engine: it is only used when the
+//     caller asks for it (FLAGIIR) and only when sigma is at least
+//     P3D_GAUSS_IIR_SIGMA and the kernel radius covers 3 sigma. The support
+//     of each output voxel is then about 6 sigma instead of RAD.
+
+#ifndef P3D_GAUSSIANENGINE_DEFINED
+#define P3D_GAUSSIANENGINE_DEFINED
+
+// Smallest sigma handled by the recursive engine:
+#define P3D_GAUSS_IIR_SIGMA	2.0
+
+// Returns P3D_SUCCESS or P3D_MEM_ERROR:
+int p3dGaussianSmooth3D_float(
+        float* im,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const double sigma,
+        const int rad,
+        const int flagIIR // IN: P3D_TRUE to allow the recursive engine
+        );
+
+#endif // P3D_GAUSSIANENGINE_DEFINED
@@ -29,6 +29,7 @@
 #include <string.h>
 #include <stdio.h>
 #include <limits.h>
+#include <math.h>
 #include <omp.h>
 
 #include <sys/types.h>
@@ -36,9 +37,19 @@
 #include <fcntl.h>
 
 #include "../p3dFilt.h"
+#include "../p3dSlabIO.h"
+#include "p3dRingRemoverCommon.h"
 
 #define PI 3.1415926535897932384626433
 
+#ifdef _WINDOWS
+	#define _p3dFseek	_fseeki64
+	#define _p3dFtell	_ftelli64
+#else
+	#define _p3dFseek	fseeko
+	#define _p3dFtell	ftello
+#endif
+
 /*int _isPath(char* path)
 {
     struct stat statbuf;
@@ -463,4 +474,401 @@ void p3dPolar2cartesian_16(
             (*out_im)[ I2(i, j, original_dimx) ] = p3dBicubicInterpolation_p2c_16(in_im, polarX, polarX, r, phi);
 
         }
-}
\ No newline at end of file
+}
+
+
+
+// Support position (U0, V0) and weights W[0..7] of the bicubic interpolation
+// at (X0, Y0), as computed by p3dBicubicInterpolation_*:
+static void _p3dPlanWeights(const double x0, const double y0, int* u0, int* v0, float* w) {
+    int i;
+
+    *u0 = (int) x0;
+    *v0 = (int) y0;
+
+    for (i = 0; i < 4; i++) {
+        w[i] = (float) _cubic(x0 - (*u0 + i - 1));
+        w[4 + i] = (float) _cubic(y0 - (*v0 + i - 1));
+    }
+}
+
+int _p3dPolarPlanRadii(
+        const int dimx,
+        const int dimy,
+        const double centerX,
+        const double centerY,
+        const double precision
+        ) {
+    double r1, r2, r3, r4;
+
+    // The greatest radius is the semi-width of the polar image (as in
+    // p3dCartesian2polar_*):
+    r1 = sqrt((centerX - 0)*(centerX - 0) + (centerY - 0)*(centerY - 0));
+    r2 = sqrt((centerX - dimx)*(centerX - dimx) + (centerY - 0)*(centerY - 0));
+    r3 = sqrt((centerX - 0)*(centerX - 0) + (centerY - dimy)*(centerY - dimy));
+    r4 = sqrt((centerX - dimx)*(centerX - dimx) + (centerY - dimy)*(centerY - dimy));
+
+    return (int) (precision * (MAX(MAX(MAX(r1, r2), r3), r4) + 0.5));
+}
+
+int _p3dPolarPlanCreate(
+        struct PolarPlan** plan,
+        const int dimx,
+        const int dimy,
+        const double centerX,
+        const double centerY,
+        const double precision,
+        const int angles
+        ) {
+    struct PolarPlan* p = NULL;
+    double r, phi, x, y;
+    int i, j;
+    size_t n;
+
+    P3D_TRY(p = (struct PolarPlan*) calloc(1, sizeof (struct PolarPlan)));
+
+    p->dimx = dimx;
+    p->dimy = dimy;
+    p->centerX = centerX;
+    p->centerY = centerY;
+    p->polarX = _p3dPolarPlanRadii(dimx, dimy, centerX, centerY, precision);
+    p->polarY = (angles > 0) ? angles : p->polarX;
+
+    n = (size_t) p->polarX * p->polarY;
+    P3D_TRY(p->c2p_u = (int*) malloc(n * sizeof (int)));
+    P3D_TRY(p->c2p_v = (int*) malloc(n * sizeof (int)));
+    P3D_TRY(p->c2p_w = (float*) malloc(8 * n * sizeof (float)));
+
+    n = (size_t) dimx * dimy;
+    P3D_TRY(p->p2c_u = (int*) malloc(n * sizeof (int)));
+    P3D_TRY(p->p2c_v = (int*) malloc(n * sizeof (int)));
+    P3D_TRY(p->p2c_w = (float*) malloc(8 * n * sizeof (float)));
+
+    // Cartesian to polar:
+#pragma omp parallel for private(i, r, phi, x, y)
+    for (j = 0; j < p->polarY; j++)
+        for (i = 0; i < p->polarX; i++) {
+            r = (double) (i);
+            phi = ((double) (j) / p->polarY) * PI * 2;
+            x = r * cos(phi) + centerX;
+            y = r * sin(phi) + centerY;
+
+            _p3dPlanWeights(x, y, p->c2p_u + I2(i, j, p->polarX), p->c2p_v + I2(i, j, p->polarX),
+                    p->c2p_w + 8 * I2(i, j, p->polarX));
+        }
+
+    // Polar to cartesian:
+#pragma omp parallel for private(i, r, phi, x, y)
+    for (j = 0; j < dimy; j++)
+        for (i = 0; i < dimx; i++) {
+            x = (double) (i) - centerX;
+            y = (double) (j) - centerY;
+            r = sqrt(x * x + y * y);
+            phi = (atan2(y, x) * p->polarY) / (PI * 2);
+            if (phi < 0)
+                phi += p->polarY;
+
+            _p3dPlanWeights(r, phi, p->p2c_u + I2(i, j, dimx), p->p2c_v + I2(i, j, dimx),
+                    p->p2c_w + 8 * I2(i, j, dimx));
+        }
+
+    *plan = p;
+
+    return P3D_SUCCESS;
+
+MEM_ERROR:
+
+    p3dPolarPlanFree(p);
+    *plan = NULL;
+
+    return P3D_MEM_ERROR;
+}
+
+int p3dPolarPlanCreate(
+        struct PolarPlan** plan,
+        const int dimx,
+        const int dimy,
+        const double centerX,
+        const double centerY,
+        const double precision
+        ) {
+    return _p3dPolarPlanCreate(plan, dimx, dimy, centerX, centerY, precision, 0);
+}
+
+void p3dPolarPlanFree(struct PolarPlan* plan) {
+    if (plan == NULL) return;
+
+    if (plan->c2p_u != NULL) free(plan->c2p_u);
+    if (plan->c2p_v != NULL) free(plan->c2p_v);
+    if (plan->c2p_w != NULL) free(plan->c2p_w);
+    if (plan->p2c_u != NULL) free(plan->p2c_u);
+    if (plan->p2c_v != NULL) free(plan->p2c_v);
+    if (plan->p2c_w != NULL) free(plan->p2c_w);
+    free(plan);
+}
+
+// Weighted sum of the 4x4 support (U0, V0) of image IM (DIMX x DIMY). Columns
+// are replicated at the borders, rows as well or, if FLAGWRAP, wrapped
+// around (polar images):
+#define P3D_PLAN_SAMPLE(TYPE, NAME) \
+static double NAME(const TYPE* im, const int dimx, const int dimy, const int u0, const int v0, \
+        const float* w, const int flagWrap) { \
+    const TYPE* row; \
+    int c0, c1, c2, c3, v, j; \
+    double q = 0.0; \
+    \
+    c0 = MIN(MAX(u0 - 1, 0), dimx - 1); \
+    c1 = MIN(MAX(u0, 0), dimx - 1); \
+    c2 = MIN(MAX(u0 + 1, 0), dimx - 1); \
+    c3 = MIN(MAX(u0 + 2, 0), dimx - 1); \
+    \
+    for (j = 0; j < 4; j++) { \
+        v = v0 + j - 1; \
+        if (flagWrap) \
+            v = (v < 0) ? v + dimy : ((v > (dimy - 1)) ? v - dimy : v); \
+        else \
+            v = MIN(MAX(v, 0), dimy - 1); \
+        row = im + I2(0, v, dimx); \
+        q += (w[0] * row[c0] + w[1] * row[c1] + w[2] * row[c2] + w[3] * row[c3]) * w[4 + j]; \
+    } \
+    \
+    return q + 0.5; \
+}
+
+P3D_PLAN_SAMPLE(unsigned char, _p3dPlanSample_8)
+P3D_PLAN_SAMPLE(unsigned short, _p3dPlanSample_16)
+
+void p3dCartesian2polarPlan_8(const struct PolarPlan* plan, const unsigned char* in_im, unsigned char* out_im) {
+    const long long n = (long long) plan->polarX * plan->polarY;
+    long long i;
+    double q;
+
+#pragma omp parallel for private(q)
+    for (i = 0; i < n; i++) {
+        q = _p3dPlanSample_8(in_im, plan->dimx, plan->dimy, plan->c2p_u[i], plan->c2p_v[i], plan->c2p_w + 8 * i, 0);
+        out_im[i] = (unsigned char) ((q < 0.0) ? 0.0 : ((q >= UCHAR_MAX) ? UCHAR_MAX : q));
+    }
+}
+
+void p3dCartesian2polarPlan_16(const struct PolarPlan* plan, const unsigned short* in_im, unsigned short* out_im) {
+    const long long n = (long long) plan->polarX * plan->polarY;
+    long long i;
+    double q;
+
+#pragma omp parallel for private(q)
+    for (i = 0; i < n; i++) {
+        q = _p3dPlanSample_16(in_im, plan->dimx, plan->dimy, plan->c2p_u[i], plan->c2p_v[i], plan->c2p_w + 8 * i, 0);
+        out_im[i] = (unsigned short) ((q < 0.0) ? 0.0 : ((q >= USHRT_MAX) ? USHRT_MAX : q));
+    }
+}
+
+void p3dPolar2cartesianPlan_8(const struct PolarPlan* plan, const unsigned char* in_im, unsigned char* out_im) {
+    const long long n = (long long) plan->dimx * plan->dimy;
+    long long i;
+    double q;
+
+#pragma omp parallel for private(q)
+    for (i = 0; i < n; i++) {
+        q = _p3dPlanSample_8(in_im, plan->polarX, plan->polarY, plan->p2c_u[i], plan->p2c_v[i], plan->p2c_w + 8 * i, 1);
+        out_im[i] = (unsigned char) ((q < 0.0) ? 0.0 : ((q >= UCHAR_MAX) ? UCHAR_MAX : q));
+    }
+}
+
+void p3dPolar2cartesianPlan_16(const struct PolarPlan* plan, const unsigned short* in_im, unsigned short* out_im) {
+    const long long n = (long long) plan->dimx * plan->dimy;
+    long long i;
+    double q;
+
+#pragma omp parallel for private(q)
+    for (i = 0; i < n; i++) {
+        q = _p3dPlanSample_16(in_im, plan->polarX, plan->polarY, plan->p2c_u[i], plan->p2c_v[i], plan->p2c_w + 8 * i, 1);
+        out_im[i] = (unsigned short) ((q < 0.0) ? 0.0 : ((q >= USHRT_MAX) ? USHRT_MAX : q));
+    }
+}
+
+// Accumulates the pixels of row J of IN_IM into the sums (ACC) and counts
+// (ACC + polarX) of the radial profile, each pixel at its nearest radius
+// (from the support of the inverse map):
+#define P3D_PLAN_PROFILE_ROW(TYPE, NAME) \
+static void NAME(const struct PolarPlan* plan, const TYPE* in_im, const int j, double* acc) { \
+    const int last = plan->polarX - 1; \
+    const float* w; \
+    size_t k; \
+    int i, u; \
+    \
+    for (i = 0; i < plan->dimx; i++) { \
+        k = I2(i, j, plan->dimx); \
+        w = plan->p2c_w + 8 * k; \
+        u = MIN(MAX(plan->p2c_u[k] + ((w[2] > w[1]) ? 1 : 0), 0), last); \
+        \
+        acc[u] += in_im[k]; \
+        acc[plan->polarX + u] += 1.0; \
+    } \
+}
+
+P3D_PLAN_PROFILE_ROW(unsigned char, _p3dPlanProfileRow_8)
+P3D_PLAN_PROFILE_ROW(unsigned short, _p3dPlanProfileRow_16)
+
+// Multiplies the pixels of row J of IN_IM by the gain at their radius (the
+// angular weights of the inverse map sum to one) and saturates them to
+// [0, MAXVAL]:
+#define P3D_PLAN_APPLY_ROW(TYPE, MAXVAL, NAME) \
+static void NAME(const struct PolarPlan* plan, const TYPE* in_im, TYPE* out_im, const int j, const double* gain) { \
+    const int last = plan->polarX - 1; \
+    const float* w; \
+    size_t k; \
+    double g, q; \
+    int i, u0; \
+    \
+    for (i = 0; i < plan->dimx; i++) { \
+        k = I2(i, j, plan->dimx); \
+        u0 = plan->p2c_u[k]; \
+        w = plan->p2c_w + 8 * k; \
+        \
+        g = w[0] * gain[ MIN(MAX(u0 - 1, 0), last) ] + w[1] * gain[ MIN(MAX(u0, 0), last) ] + \
+                w[2] * gain[ MIN(MAX(u0 + 1, 0), last) ] + w[3] * gain[ MIN(MAX(u0 + 2, 0), last) ]; \
+        \
+        q = in_im[k] * g + 0.5; \
+        out_im[k] = (TYPE) ((q < 0.0) ? 0.0 : ((q >= MAXVAL) ? MAXVAL : q)); \
+    } \
+}
+
+P3D_PLAN_APPLY_ROW(unsigned char, UCHAR_MAX, _p3dPlanApplyRow_8)
+P3D_PLAN_APPLY_ROW(unsigned short, USHRT_MAX, _p3dPlanApplyRow_16)
+
+int _p3dPolarPlanProfile(const struct PolarPlan* plan, const void* in_im, const int bytes, double* profile) {
+    const int nthreads = omp_get_max_threads();
+    const int last = plan->polarX - 1;
+    double* partial = NULL;
+    double* acc;
+    double sum, ct;
+    int j, u, t;
+
+    // One profile (sums and counts) for each thread, reduced at the end:
+    P3D_TRY(partial = (double*) calloc((size_t) nthreads * 2 * plan->polarX, sizeof (double)));
+
+#pragma omp parallel for private(acc)
+    for (j = 0; j < plan->dimy; j++) {
+        acc = partial + (size_t) omp_get_thread_num() * 2 * plan->polarX;
+
+        if (bytes == 2)
+            _p3dPlanProfileRow_16(plan, (const unsigned short*) in_im, j, acc);
+        else
+            _p3dPlanProfileRow_8(plan, (const unsigned char*) in_im, j, acc);
+    }
+
+    for (u = 0; u <= last; u++) {
+        sum = 0.0;
+        ct = 0.0;
+        for (t = 0; t < nthreads; t++) {
+            sum += partial[ (size_t) t * 2 * plan->polarX + u ];
+            ct += partial[ (size_t) t * 2 * plan->polarX + plan->polarX + u ];
+        }
+
+        // Radii without pixels replicate the previous one:
+        profile[u] = (ct > 0.0) ? (sum / ct) : ((u > 0) ? profile[u - 1] : 0.0);
+    }
+
+    // Release resources:
+    free(partial);
+
+    return P3D_SUCCESS;
+
+MEM_ERROR:
+
+    return P3D_MEM_ERROR;
+}
+
+void _p3dPolarPlanApplyProfile(const struct PolarPlan* plan, const void* in_im, void* out_im, const int bytes, const double* gain) {
+    int j;
+
+#pragma omp parallel for
+    for (j = 0; j < plan->dimy; j++) {
+        if (bytes == 2)
+            _p3dPlanApplyRow_16(plan, (const unsigned short*) in_im, (unsigned short*) out_im, j, gain);
+        else
+            _p3dPlanApplyRow_8(plan, (const unsigned char*) in_im, (unsigned char*) out_im, j, gain);
+    }
+}
+
+struct RingRemoverBatch {
+    int (*remover)(void*, void*, const int, const int, void*);
+    void* params;
+    int bytes;
+    int threads;
+};
+
+// Slab function for _p3dSlabFilter: the slices of the slab are corrected
+// concurrently, one per thread (nested parallelism is not required, so the
+// loops within the 2D remover run serially in each worker):
+static int _p3dRingRemoverBatch_slab(void* in_im, void* out_im, const int dimx, const int dimy, const int dimz, void* params) {
+    struct RingRemoverBatch* b = (struct RingRemoverBatch*) params;
+    const size_t slice_size = (size_t) dimx * dimy * b->bytes;
+    int k, err_ct = 0;
+
+#pragma omp parallel for schedule(dynamic) num_threads(b->threads) reduction(+ : err_ct)
+    for (k = 0; k < dimz; k++) {
+        if (b->remover((unsigned char*) in_im + k * slice_size, (unsigned char*) out_im + k * slice_size,
+                dimx, dimy, b->params) != P3D_SUCCESS)
+            err_ct++;
+    }
+
+    if (err_ct > 0)
+        return P3D_MEM_ERROR;
+
+    return P3D_SUCCESS;
+}
+
+int _p3dRingRemoverBatch(
+        char* in_filename,
+        char* out_filename,
+        const int dimx,
+        const int dimy,
+        const int bytes,
+        const int flagLittle,
+        const int flagSigned,
+        const int threads,
+        int (*remover)(void*, void*, const int, const int, void*),
+        void* params,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    struct RingRemoverBatch b;
+    FILE* fvol;
+    long long length;
+    int dimz;
+
+    // The number of slices is given by the size of the input file:
+    if ((fvol = fopen(in_filename, "rb")) == NULL) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - IO error: cannot open input file %s. Program will exit.", in_filename);
+        }
+
+        return P3D_IO_ERROR;
+    }
+    length = (_p3dFseek(fvol, 0, SEEK_END) == 0) ? (long long) _p3dFtell(fvol) : -1;
+    fclose(fvol);
+
+    dimz = (int) (length / ((long long) dimx * dimy * bytes));
+    if (dimz < 1) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - IO error: file %s is smaller than a %dx%d slice. Program will exit.", in_filename, dimx, dimy);
+        }
+
+        return P3D_IO_ERROR;
+    }
+
+    b.remover = remover;
+    b.params = params;
+    b.bytes = bytes;
+    b.threads = (threads > 0) ? threads : omp_get_max_threads();
+
+    if (wr_log != NULL) {
+        wr_log("\tSlices: %d (%d corrected concurrently).", dimz, b.threads);
+    }
+
+    // Slabs of two slices per worker without halo: the next slab is read
+    // while the current one is corrected and the slices are written in order:
+    return _p3dSlabFilter(in_filename, out_filename, dimx, dimy, dimz, bytes, flagLittle, flagSigned,
+            2 * b.threads, 0, _p3dRingRemoverBatch_slab, (void*) &b, wr_log, wr_progress);
+}
@@ -25,6 +25,9 @@
 // Last modified: Sept, 28th 2016
 //
 
+#ifndef P3D_RINGREMOVERCOMMON_DEFINED
+#define P3D_RINGREMOVERCOMMON_DEFINED
+
 // A square image with dimensions POLARX x POLARX is returned. Due to the fact
 // the POLARX is not known a priori, memory image is allocated within this
 // procedure so parameter OUT_IM should be passed as reference. The out parameter
@@ -76,4 +79,64 @@ void p3dPolar2cartesian_16(
         const double centerY, // IN: Y coordinate for center of polar transform
         const int original_dimx, // IN: width of the output cartesian image
         const int original_dimy // IN: heigth of the output cartesian image
-        );
\ No newline at end of file
+        );
+
+// Resampling plan between cartesian images of DIMX x DIMY pixels and their
+// POLARX x POLARY polar transform around (CENTERX, CENTERY), having the
+// radius along x and the angle along y. Unless stated otherwise at creation
+// POLARY equals POLARX (square polar images). For each pixel
+// of both transforms it stores the position of the bicubic support and its
+// 4 + 4 separable weights (x weights first), so that transforming a slice
+// needs neither trigonometry nor weight evaluation. A plan is read-only once
+// created and it can be shared by all the slices (and threads) having the
+// same geometry. It takes 40 bytes per polar and per cartesian pixel:
+struct PolarPlan {
+    int dimx, dimy;
+    int polarX, polarY;
+    double centerX, centerY;
+
+    int* c2p_u; // Cartesian to polar (POLARX x POLARY pixels)
+    int* c2p_v;
+    float* c2p_w;
+
+    int* p2c_u; // Polar to cartesian (DIMX x DIMY pixels)
+    int* p2c_v;
+    float* p2c_w;
+};
+
+// Plans are created with p3dPolarPlanCreate and released with
+// p3dPolarPlanFree (see p3dFilt.h). The following returns the number of
+// radii (POLARX) of the plans for a given geometry and creates plans having
+// ANGLES angular samples (POLARX if not positive):
+int _p3dPolarPlanRadii(const int, const int, const double, const double, const double);
+int _p3dPolarPlanCreate(struct PolarPlan**, const int, const int, const double, const double, const double, const int);
+
+// Same results of p3dCartesian2polar_* and p3dPolar2cartesian_* (weights are
+// stored in single precision) on images allocated by the caller:
+void p3dCartesian2polarPlan_8(const struct PolarPlan* plan, const unsigned char* in_im, unsigned char* out_im);
+void p3dCartesian2polarPlan_16(const struct PolarPlan* plan, const unsigned short* in_im, unsigned short* out_im);
+void p3dPolar2cartesianPlan_8(const struct PolarPlan* plan, const unsigned char* in_im, unsigned char* out_im);
+void p3dPolar2cartesianPlan_16(const struct PolarPlan* plan, const unsigned short* in_im, unsigned short* out_im);
+
+// Fused transforms for removers working on the radial profile only, so that
+// the polar image is never stored. The first one stores in PROFILE (POLARX
+// values) the mean along the angles of the BYTES per pixel image IN_IM, each
+// pixel contributing to its nearest radius (returns P3D_SUCCESS or
+// P3D_MEM_ERROR). The second one multiplies each pixel of IN_IM by GAIN
+// (POLARX values) interpolated at the radius of the pixel through the
+// inverse map:
+int _p3dPolarPlanProfile(const struct PolarPlan*, const void*, const int, double*);
+void _p3dPolarPlanApplyProfile(const struct PolarPlan*, const void*, void*, const int, const double*);
+
+// Applies the 2D ring remover REMOVER (called with the parameters pointed by
+// PARAMS and returning P3D_SUCCESS or P3D_MEM_ERROR) to each slice of a RAW
+// volume of DIMX x DIMY slices, writing the results to another RAW file. The
+// number of slices is taken from the size of the input file. THREADS slices
+// (all the available processors if not positive) are corrected concurrently
+// while the following ones are read from disk. Returns P3D_SUCCESS,
+// P3D_MEM_ERROR or P3D_IO_ERROR:
+int _p3dRingRemoverBatch(char*, char*, const int, const int, const int, const int, const int, const int,
+        int (*remover)(void*, void*, const int, const int, void*), void*,
+        int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+
+#endif // P3D_RINGREMOVERCOMMON_DEFINED
@@ -22,27 +22,31 @@
 
 //
 // Author: Francesco Brun
-// Last modified: Sept, 28th 2016
+// Last modified: October, 16th 2026
 //
 
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <omp.h>
-#include <pthread.h>
 #include <math.h>
 #include <limits.h>
 
+#ifdef __AVX2__
+	#include <immintrin.h>
+#endif
+
 #include "p3dFilt.h"
 #include "p3dTime.h"
+#include "p3dSlabIO.h"
+
+#include "Common/p3dGaussianEngine.h"
+#include "Common/p3dEigen3x3.h"
 
 #define clamp(a, b1, b2) min(max(a, b1), b2);
 #define absd(a) ((a)>(-a)?(a):(-a))
 #define pow2(a) (a*a)
 #define pow4(a) (pow2(a)*pow2(a))
-#define n 3
-#define inv3 0.3333333333333333
-#define root3 1.7320508075688772
 #ifndef min
 #define min(a,b)        ((a) < (b) ? (a): (b))
 #endif
@@ -50,6 +54,21 @@
 #define max(a,b)        ((a) > (b) ? (a): (b))
 #endif
 
+// Integration scale of the structure tensor:
+#define P3D_AD_RHO 1.0
+
+// The smoothed structure tensor is stored as bfloat16 (the upper half of a
+// float) when P3D_AD_BF16 is defined at build time. It halves the memory of
+// the six tensor volumes and the bandwidth of the flux computation. The
+// rounding error of each component is at most 2^-9 relative, so the
+// eigenvalues move by at most 2^-9 |J| (Frobenius norm) and the eigenvectors
+// by an angle of about 2^-9 |J| / gap. bfloat16 keeps the exponent range of
+// float: fp16 would flush the tensor of weak gradients to zero, as values
+// of 16-bit images are scaled to [0, 1]. Agreed tolerance with respect to
+// the float path (see test/p3dAnisotropicDiffusionBF16Test.c): at most 1
+// grey level on 0.5% of the voxels of 8-bit images, at most 8 grey levels
+// and 0.1 on average for 16-bit images.
+
 struct options {
     double T;
     double dt;
@@ -62,1028 +81,183 @@ struct options {
     double lambda_e;
     double lambda_h;
     double lambda_c;
+    int bf16;
 };
 
-__inline int mindex3(int x, int y, int z, int sizx, int sizy) {
-    return z * sizx * sizy + y * sizx + x;
-}
-
-float * mallocf(int a) {
-    float *ptr = (float*) calloc(a, sizeof (float));
-    //if (ptr == NULL) { mexErrMsgTxt("Out of Memory"); }
-    return ptr;
+// Kernel radius used by GaussianFiltering3D_float for SIZE:
+static int _p3dGaussianRadius(const double size) {
+    if (size < 1.0)
+        return 1*3;
+    else
+        return (int) ceil(size / 2)*3;
 }
 
-void GaussianFiltering3D_float(
+// Smooths IN_IM into OUT_IM with the separable gaussian engine (IN_IM may be
+// equal to OUT_IM). Returns P3D_SUCCESS or P3D_MEM_ERROR:
+int GaussianFiltering3D_float(
         float* in_im,
         float* out_im,
         int* dimsI,
         double sigma,
         double size
         ) {
-    // Padded input and related dims:
-    float* tmp_im = NULL;
-    float* kernel = NULL;
-
-    int dimx = dimsI[0];
-    int dimy = dimsI[1];
-    int dimz = dimsI[2];
-    int a_dimx, a_dimy, a_dimz;
-    int i, j, k;
-    int x, y, z;
-    int ct, a_rad, a_size;
-    double d;
-    double f, w, sum, sum_w;
-
-    // Set kernel size and variance:
-    if (size < 1.0)
-        a_rad = 1*3;
-    else
-        a_rad = ceil(size / 2)*3;
-    a_size = 2 * a_rad + 1;
-
-    d = (2.0 * sigma * sigma);
-       
-
-    // Compute dimensions of padded volume:
-    a_dimx = dimx + a_rad * 2;
-    a_dimy = dimy + a_rad * 2;
-    a_dimz = dimz + a_rad * 2;
-
-
-    // Initialize input:
-    tmp_im = (float*) malloc(a_dimx*a_dimy*a_dimz*sizeof (float));
-    kernel = (float*) malloc(a_size*sizeof(float));
-
-    _p3dReplicatePadding3D_float(in_im, tmp_im, dimx, dimy, dimz, a_rad, NULL, NULL);
-
-    ct = 0;
-    sum_w = 0.0;
-    
-    // Create gausssian kernel:
-    for (x = (-a_rad); x <= a_rad; x++) {
-       
-       f = (x)*(x) / d;
-       kernel[ct] = exp(-f);
-       sum_w = sum_w + kernel[ct++];
-    }
-    ct = 0;
-    // Normalize kernel
-    for (x = (-a_rad); x <= a_rad; x++) 
-        kernel[ct] = kernel[ct++]/sum_w;
-
-    // X-direction scanning
-    #pragma omp parallel for private(i, j, x, sum, ct)
-    for (k = a_rad; k < (a_dimz - a_rad); k++)
-        for (j = a_rad; j < (a_dimy - a_rad); j++)
-            for (i = a_rad; i < (a_dimx - a_rad); i++) {
-                sum = 0.0; 
-                ct = 0;
-
-                // Process kernel:
-                for (x = (i - a_rad); x <= (i + a_rad); x++) {
-                     // Gausssian kernel:                       
-                     sum = sum + kernel[ct++] * tmp_im[ I(x, j, k, a_dimx, a_dimy) ];
-                }
-
-                // Set out voxel with the mean of the sorted temporary array:                
-                tmp_im[ I(i, j, k, a_dimx, a_dimy) ] = sum;
-            }
-
-    // Y-direction scanning
-    #pragma omp parallel for private(i, j, y, sum, ct)
-    for (k = a_rad; k < (a_dimz - a_rad); k++)
-        for (j = a_rad; j < (a_dimy - a_rad); j++)
-            for (i = a_rad; i < (a_dimx - a_rad); i++) {
-                sum = 0.0;
-                ct = 0;
-
-                // Process kernel:
-                for (y = (j - a_rad); y <= (j + a_rad); y++) {
-                     // Gausssian kernel:
-                     sum = sum + kernel[ct++] * tmp_im[ I(i, y, k, a_dimx, a_dimy) ];
-                }
-
-                // Set out voxel with the mean of the sorted temporary array:             
-                tmp_im[ I(i, j, k, a_dimx, a_dimy) ] = sum; 
-            }
-
-    // Z-direction scanning
-    #pragma omp parallel for private(i, j, z, sum, ct)
-    for (k = a_rad; k < (a_dimz - a_rad); k++)
-        for (j = a_rad; j < (a_dimy - a_rad); j++)
-            for (i = a_rad; i < (a_dimx - a_rad); i++) {
-                sum = 0.0;
-                ct = 0;
-
-                // Process kernel:
-                for (z = (k - a_rad); z <= (k + a_rad); z++) {
-                     // Gausssian kernel:
-                     sum = sum + kernel[ct++] * tmp_im[ I(i, j, z, a_dimx, a_dimy) ];
-                }
-
-                // Set out voxel with the mean of the sorted temporary array:           
-                out_im[ I(i-a_rad, j-a_rad, k-a_rad, dimx, dimy) ] = sum; 
-            }
-
-
+    if (out_im != in_im)
+        memcpy(out_im, in_im, (size_t) dimsI[0] * dimsI[1] * dimsI[2] * sizeof (float));
 
-    // Release resources:
-    if (tmp_im != NULL) free(tmp_im);
-    if (kernel != NULL) free(kernel);
+    return p3dGaussianSmooth3D_float(out_im, dimsI[0], dimsI[1], dimsI[2], sigma, _p3dGaussianRadius(size), P3D_FALSE);
 }
 
-void gradient3Dx_float(float *I, int *sizeI, float *Ix) {
-    int x, y, z;
-    int xp, xn, yp, yn;
-    int i;
-    int indexn, indexc, indexp;
-    float *Irow, *Islices;
-    int nSlice;
-    int offsetz, offset_slice;
-    int slice_select = 0;
-    int slice_select_p1 = 0;
-    int slice_select_p2 = 0;
-
-    const float smoothfilter[3] = {0.187500f, 0.625000f, 0.187500f};
-    const float derivafilter[3] = {-0.5f, 0.0f, 0.5f};
-
-    nSlice = sizeI[0] * sizeI[1];
-    Islices = mallocf(4 * nSlice);
-    Irow = mallocf(sizeI[0]);
-
-    //#pragma omp parallel for private (offsetz, offset_slice, y, yn, yp, indexn, indexc, indexp, x, xn, xp, i, slice_selec slice_select_p1, slice_select_p2)
-    for (z = 0; z < sizeI[2]; z++) {
-
-        offsetz = nSlice*z;
-        offset_slice = nSlice*slice_select;
-
-        for (y = 0; y < sizeI[1]; y++) {
-            /* Smooth y - direction  */
-            yn = max(y - 1, 0);
-            yp = min(y + 1, sizeI[1] - 1);
-
-            indexn = yn * sizeI[0] + offsetz;
-            indexc = y * sizeI[0] + offsetz;
-            indexp = yp * sizeI[0] + offsetz;
-
-            for (x = 0; x < sizeI[0]; x++) {
-                Irow[x] = smoothfilter[0] * I[indexn + x];
-                Irow[x] += smoothfilter[1] * I[indexc + x];
-                Irow[x] += smoothfilter[2] * I[indexp + x];
-            }
-
-            indexc = y * sizeI[0] + offset_slice;
-            /*  Gradient in x - direction  */
-            for (x = 0; x < sizeI[0]; x++) {
-                xn = max(x - 1, 0);
-                xp = min(x + 1, sizeI[0] - 1);
-                Islices[indexc + x] = derivafilter[0] * Irow[xn] + derivafilter[1] * Irow[x] + derivafilter[2] * Irow[xp];
-            }
-        }
-
-        /* Smooth in z - direction  */
-        if (z == 1) /* Forward          */ {
-            indexn = slice_select_p1*nSlice;
-            indexc = slice_select_p1*nSlice;
-            indexp = slice_select*nSlice;
-            for (i = 0; i < nSlice; i++) {
-                Ix[i] = smoothfilter[0] * Islices[i + indexn] + smoothfilter[1] * Islices[i + indexc] + smoothfilter[2] * Islices[i + indexp];
-            }
-        } else if (z > 1) /* Central  */ {
-            indexn = slice_select_p2*nSlice;
-            indexc = slice_select_p1*nSlice;
-            indexp = slice_select*nSlice;
-            offsetz = nSlice * (z - 1);
-            for (i = 0; i < nSlice; i++) {
-                Ix[offsetz + i] = smoothfilter[0] * Islices[i + indexn] + smoothfilter[1] * Islices[i + indexc] + smoothfilter[2] * Islices[i + indexp];
-            }
-        }
-
-        if (z == (sizeI[2] - 1)) /* Backward  */ {
-            indexn = slice_select_p1*nSlice;
-            indexc = slice_select*nSlice;
-            indexp = slice_select*nSlice;
-            offsetz = nSlice*z;
-            for (i = 0; i < nSlice; i++) {
-                Ix[offsetz + i] = smoothfilter[0] * Islices[i + indexn] + smoothfilter[1] * Islices[i + indexc] + smoothfilter[2] * Islices[i + indexp];
-            }
-        }
-
-        slice_select_p2 = slice_select_p1;
-        slice_select_p1 = slice_select;
-        slice_select++;
-        if (slice_select > 3) {
-            slice_select = 0;
-        }
-
-    }
-    free(Irow);
-    free(Islices);
-    //}
+// Number of slices above and below a voxel that affect it after one
+// iteration: the smoothing of u (SIGMA) and of the structure tensor (RHO),
+// the gradient of the smoothed image and the divergence of the flux:
+static int _p3dAnisotropicDiffusionReach(const double sigma) {
+    return _p3dGaussianRadius(4 * sigma) + _p3dGaussianRadius(4 * P3D_AD_RHO) + 2;
 }
 
-void gradient3Dy_float(float *I, int *sizeI, float *Iy) {
-    int x, y, z;
-    int xp, xn, yp, yn;
-    int i;
-    int indexn, indexc, indexp;
-    float *Irow, *Islices;
-    int nSlice;
-    int offsetz, offset_slice;
-    int slice_select = 0, slice_select_p1 = 0, slice_select_p2 = 0;
-
-    const float smoothfilter[3] = {0.187500f, 0.625000f, 0.187500f};
-    const float derivafilter[3] = {-0.5f, 0.0f, 0.5f};
-
-    nSlice = sizeI[0] * sizeI[1];
-    Islices = mallocf(4 * nSlice);
-    Irow = mallocf(sizeI[0]);
-
-    for (z = 0; z < sizeI[2]; z++) {
-        offsetz = nSlice*z;
-        offset_slice = nSlice*slice_select;
-
-        for (y = 0; y < sizeI[1]; y++) {
-            /* Smooth y - direction  */
-            yn = max(y - 1, 0);
-            yp = min(y + 1, sizeI[1] - 1);
-
-            indexn = yn * sizeI[0] + offsetz;
-            indexc = y * sizeI[0] + offsetz;
-            indexp = yp * sizeI[0] + offsetz;
-
-            for (x = 0; x < sizeI[0]; x++) {
-                Irow[x] = derivafilter[0] * I[indexn + x];
-                Irow[x] += derivafilter[1] * I[indexc + x];
-                Irow[x] += derivafilter[2] * I[indexp + x];
-            }
-
-            indexc = y * sizeI[0] + offset_slice;
-            /*  Gradient in x - direction  */
-            for (x = 0; x < sizeI[0]; x++) {
-                xn = max(x - 1, 0);
-                xp = min(x + 1, sizeI[0] - 1);
-                Islices[indexc + x] = smoothfilter[0] * Irow[xn] + smoothfilter[1] * Irow[x] + smoothfilter[2] * Irow[xp];
-            }
-        }
-
-        /* Smooth in z - direction  */
-        if (z == 1) /* Forward          */ {
-            indexn = slice_select_p1*nSlice;
-            indexc = slice_select_p1*nSlice;
-            indexp = slice_select*nSlice;
-            for (i = 0; i < nSlice; i++) {
-                Iy[i] = smoothfilter[0] * Islices[i + indexn] + smoothfilter[1] * Islices[i + indexc] + smoothfilter[2] * Islices[i + indexp];
-            }
-        } else if (z > 1) /* Central  */ {
-            indexn = slice_select_p2*nSlice;
-            indexc = slice_select_p1*nSlice;
-            indexp = slice_select*nSlice;
-            offsetz = nSlice * (z - 1);
-            for (i = 0; i < nSlice; i++) {
-                Iy[offsetz + i] = smoothfilter[0] * Islices[i + indexn] + smoothfilter[1] * Islices[i + indexc] + smoothfilter[2] * Islices[i + indexp];
-            }
-        }
-
-        if (z == (sizeI[2] - 1)) /* Backward  */ {
-            indexn = slice_select_p1*nSlice;
-            indexc = slice_select*nSlice;
-            indexp = slice_select*nSlice;
-            offsetz = nSlice*z;
-            for (i = 0; i < nSlice; i++) {
-                Iy[offsetz + i] = smoothfilter[0] * Islices[i + indexn] + smoothfilter[1] * Islices[i + indexc] + smoothfilter[2] * Islices[i + indexp];
-            }
-        }
-
-        slice_select_p2 = slice_select_p1;
-        slice_select_p1 = slice_select;
-        slice_select++;
-        if (slice_select > 3) {
-            slice_select = 0;
-        }
+// Float to bfloat16 (round to nearest even) and back:
+static void _p3dFloatToBF16(const float* in, unsigned short* out, const long long n) {
+    unsigned int b;
+    long long i = 0;
+
+#ifdef __AVX2__
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i half = _mm256_set1_epi32(0x7FFF);
+    __m256i lo, hi;
+
+    for (; i + 16 <= n; i += 16) {
+        lo = _mm256_castps_si256(_mm256_loadu_ps(in + i));
+        hi = _mm256_castps_si256(_mm256_loadu_ps(in + i + 8));
+        lo = _mm256_add_epi32(lo, _mm256_add_epi32(half, _mm256_and_si256(_mm256_srli_epi32(lo, 16), one)));
+        hi = _mm256_add_epi32(hi, _mm256_add_epi32(half, _mm256_and_si256(_mm256_srli_epi32(hi, 16), one)));
+        lo = _mm256_packus_epi32(_mm256_srli_epi32(lo, 16), _mm256_srli_epi32(hi, 16));
+        _mm256_storeu_si256((__m256i*) (out + i), _mm256_permute4x64_epi64(lo, 0xD8));
+    }
+#endif
+    for (; i < n; i++) {
+        memcpy(&b, in + i, sizeof (float));
+        out[i] = (unsigned short) ((b + 0x7FFF + ((b >> 16) & 1)) >> 16);
     }
-    free(Irow);
-    free(Islices);
 }
 
-void gradient3Dz_float(float *I, int *sizeI, float *Iz) {
-    int x, y, z;
-    int xp, xn, yp, yn;
-    int i;
-    int indexn, indexc, indexp;
-    float *Irow, *Islices;
-    int nSlice;
-    int offsetz, offset_slice;
-    int slice_select = 0, slice_select_p1 = 0, slice_select_p2 = 0;
-
-    const float smoothfilter[3] = {0.187500f, 0.625000f, 0.187500f};
-    const float derivafilter[3] = {-0.5f, 0.0f, 0.5f};
-
-    nSlice = sizeI[0] * sizeI[1];
-    Islices = mallocf(4 * nSlice);
-    Irow = mallocf(sizeI[0]);
-
-    for (z = 0; z < sizeI[2]; z++) {
-        offsetz = nSlice*z;
-        offset_slice = nSlice*slice_select;
-
-        for (y = 0; y < sizeI[1]; y++) {
-            /* Smooth y - direction  */
-            yn = max(y - 1, 0);
-            yp = min(y + 1, sizeI[1] - 1);
-
-            indexn = yn * sizeI[0] + offsetz;
-            indexc = y * sizeI[0] + offsetz;
-            indexp = yp * sizeI[0] + offsetz;
-
-            for (x = 0; x < sizeI[0]; x++) {
-                Irow[x] = smoothfilter[0] * I[indexn + x];
-                Irow[x] += smoothfilter[1] * I[indexc + x];
-                Irow[x] += smoothfilter[2] * I[indexp + x];
-            }
-
-            indexc = y * sizeI[0] + offset_slice;
-            /*  Gradient in x - direction  */
-            for (x = 0; x < sizeI[0]; x++) {
-                xn = max(x - 1, 0);
-                xp = min(x + 1, sizeI[0] - 1);
-                Islices[indexc + x] = smoothfilter[0] * Irow[xn] + smoothfilter[1] * Irow[x] + smoothfilter[2] * Irow[xp];
-            }
-        }
-
-        /* Smooth in z - direction  */
-        if (z == 1) /* Forward          */ {
-            indexn = slice_select_p1*nSlice;
-            indexc = slice_select_p1*nSlice;
-            indexp = slice_select*nSlice;
-            for (i = 0; i < nSlice; i++) {
-                Iz[i] = derivafilter[0] * Islices[i + indexn] + derivafilter[1] * Islices[i + indexc] + derivafilter[2] * Islices[i + indexp];
-            }
-        } else if (z > 1) /* Central  */ {
-            indexn = slice_select_p2*nSlice;
-            indexc = slice_select_p1*nSlice;
-            indexp = slice_select*nSlice;
-            offsetz = nSlice * (z - 1);
-            for (i = 0; i < nSlice; i++) {
-                Iz[offsetz + i] = derivafilter[0] * Islices[i + indexn] + derivafilter[1] * Islices[i + indexc] + derivafilter[2] * Islices[i + indexp];
-            }
-        }
-
-        if (z == (sizeI[2] - 1)) /* Backward  */ {
-            indexn = slice_select_p1*nSlice;
-            indexc = slice_select*nSlice;
-            indexp = slice_select*nSlice;
-            offsetz = nSlice*z;
-            for (i = 0; i < nSlice; i++) {
-                Iz[offsetz + i] = derivafilter[0] * Islices[i + indexn] + derivafilter[1] * Islices[i + indexc] + derivafilter[2] * Islices[i + indexp];
-            }
-        }
-
-        slice_select_p2 = slice_select_p1;
-        slice_select_p1 = slice_select;
-        slice_select++;
-        if (slice_select > 3) {
-            slice_select = 0;
-        }
+static void _p3dBF16ToFloat(const unsigned short* in, float* out, const long long n) {
+    unsigned int b;
+    long long i = 0;
 
+#ifdef __AVX2__
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(out + i, _mm256_castsi256_ps(_mm256_slli_epi32(
+                _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*) (in + i))), 16)));
+#endif
+    for (; i < n; i++) {
+        b = ((unsigned int) in[i]) << 16;
+        memcpy(out + i, &b, sizeof (float));
     }
-    free(Irow);
-    free(Islices);
 }
 
-void StructureTensor3D(float *ux, float *uy, float *uz, float **J, int *dimsu, double rho) {
-    int npixelsu;
-    int i;
-    float *Jxx, *Jxy, *Jxz, *Jyy, *Jyz, *Jzz; /* Structure tensor */
+// The derivative operators of the scheme are separable: a central difference
+// along one axis and the smoothing filter along the other two, with
+// replicated borders. They are applied one plane at a time by the following
+// 1D passes, each of them parallelized over the plane:
+static const float smoothfilter[3] = {0.187500f, 0.625000f, 0.187500f};
+static const float derivafilter[3] = {-0.5f, 0.0f, 0.5f};
 
-    npixelsu = dimsu[0] * dimsu[1] * dimsu[2];
+// OUT = c[0] * PM + c[1] * P0 + c[2] * PP (planes z - 1, z and z + 1):
+static void _p3dFilterPlaneZ(const float* pm, const float* p0, const float* pp, float* out, const float* c, const long long np) {
+    long long i;
 
-    Jxx = mallocf(npixelsu);
-    Jyy = mallocf(npixelsu);
-    Jzz = mallocf(npixelsu);
-    Jxy = mallocf(npixelsu);
-    Jxz = mallocf(npixelsu);
-    Jyz = mallocf(npixelsu);
-
-    /* J(grad u_sigma) */
 #pragma omp parallel for
-    for (i = 0; i < npixelsu; i++) {
-        Jxx[i] = ux[i] * ux[i];
-        Jxy[i] = ux[i] * uy[i];
-        Jxz[i] = ux[i] * uz[i];
-        Jyy[i] = uy[i] * uy[i];
-        Jyz[i] = uy[i] * uz[i];
-        Jzz[i] = uz[i] * uz[i];
-    }
-
-    /* Do the gaussian smoothing */
-    J[0] = mallocf(npixelsu);
-    GaussianFiltering3D_float(Jxx, J[0], dimsu, rho, 4 * rho);
-    free(Jxx);
-    J[1] = mallocf(npixelsu);
-    GaussianFiltering3D_float(Jyy, J[1], dimsu, rho, 4 * rho);
-    free(Jyy);
-    J[2] = mallocf(npixelsu);
-    GaussianFiltering3D_float(Jzz, J[2], dimsu, rho, 4 * rho);
-    free(Jzz);
-    J[3] = mallocf(npixelsu);
-    GaussianFiltering3D_float(Jxy, J[3], dimsu, rho, 4 * rho);
-    free(Jxy);
-    J[4] = mallocf(npixelsu);
-    GaussianFiltering3D_float(Jxz, J[4], dimsu, rho, 4 * rho);
-    free(Jxz);
-    J[5] = mallocf(npixelsu);
-    GaussianFiltering3D_float(Jyz, J[5], dimsu, rho, 4 * rho);
-    free(Jyz);
-}
-
-/* domain Java Matrix library JAMA. */
-static double hypot2(double x, double y) {
-    return sqrt(x * x + y * y);
+    for (i = 0; i < np; i++)
+        out[i] = c[0] * pm[i] + c[1] * p0[i] + c[2] * pp[i];
 }
 
-/* Symmetric Householder reduction to tridiagonal form. */
-static void tred2(double V[n][n], double d[n], double e[n]) {
-
-    /*  This is derived from the Algol procedures tred2 by */
-    /*  Bowdler, Martin, Reinsch, and Wilkinson, Handbook for */
-    /*  Auto. Comp., Vol.ii-Linear Algebra, and the corresponding */
-    /*  Fortran subroutine in EISPACK. */
-    int i, j, k;
-    double scale;
-    double f, g, h;
-    double hh;
-    for (j = 0; j < n; j++) {
-        d[j] = V[n - 1][j];
-    }
-
-    /* Householder reduction to tridiagonal form. */
-
-    for (i = n - 1; i > 0; i--) {
-        /* Scale to avoid under/overflow. */
-        scale = 0.0;
-        h = 0.0;
-        for (k = 0; k < i; k++) {
-            scale = scale + fabs(d[k]);
-        }
-        if (scale == 0.0) {
-            e[i] = d[i - 1];
-            for (j = 0; j < i; j++) {
-                d[j] = V[i - 1][j];
-                V[i][j] = 0.0;
-                V[j][i] = 0.0;
-            }
-        } else {
-
-            /* Generate Householder vector. */
+static void _p3dFilterPlaneY(const float* in, float* out, const float* c, const int dimx, const int dimy) {
+    const float* rn;
+    const float* rp;
+    int x, y;
 
-            for (k = 0; k < i; k++) {
-                d[k] /= scale;
-                h += d[k] * d[k];
-            }
-            f = d[i - 1];
-            g = sqrt(h);
-            if (f > 0) {
-                g = -g;
-            }
-            e[i] = scale * g;
-            h = h - f * g;
-            d[i - 1] = f - g;
-            for (j = 0; j < i; j++) {
-                e[j] = 0.0;
-            }
+#pragma omp parallel for private(x, rn, rp)
+    for (y = 0; y < dimy; y++) {
+        rn = in + I2(0, max(y - 1, 0), dimx);
+        rp = in + I2(0, min(y + 1, dimy - 1), dimx);
 
-            /* Apply similarity transformation to remaining columns. */
-
-            for (j = 0; j < i; j++) {
-                f = d[j];
-                V[j][i] = f;
-                g = e[j] + V[j][j] * f;
-                for (k = j + 1; k <= i - 1; k++) {
-                    g += V[k][j] * d[k];
-                    e[k] += V[k][j] * f;
-                }
-                e[j] = g;
-            }
-            f = 0.0;
-            for (j = 0; j < i; j++) {
-                e[j] /= h;
-                f += e[j] * d[j];
-            }
-            hh = f / (h + h);
-            for (j = 0; j < i; j++) {
-                e[j] -= hh * d[j];
-            }
-            for (j = 0; j < i; j++) {
-                f = d[j];
-                g = e[j];
-                for (k = j; k <= i - 1; k++) {
-                    V[k][j] -= (f * e[k] + g * d[k]);
-                }
-                d[j] = V[i - 1][j];
-                V[i][j] = 0.0;
-            }
-        }
-        d[i] = h;
+        for (x = 0; x < dimx; x++)
+            out[ I2(x, y, dimx) ] = c[0] * rn[x] + c[1] * in[ I2(x, y, dimx) ] + c[2] * rp[x];
     }
-
-    /* Accumulate transformations. */
-
-    for (i = 0; i < n - 1; i++) {
-        V[n - 1][i] = V[i][i];
-        V[i][i] = 1.0;
-        h = d[i + 1];
-        if (h != 0.0) {
-            for (k = 0; k <= i; k++) {
-                d[k] = V[k][i + 1] / h;
-            }
-            for (j = 0; j <= i; j++) {
-                g = 0.0;
-                for (k = 0; k <= i; k++) {
-                    g += V[k][i + 1] * V[k][j];
-                }
-                for (k = 0; k <= i; k++) {
-                    V[k][j] -= g * d[k];
-                }
-            }
-        }
-        for (k = 0; k <= i; k++) {
-            V[k][i + 1] = 0.0;
-        }
-    }
-    for (j = 0; j < n; j++) {
-        d[j] = V[n - 1][j];
-        V[n - 1][j] = 0.0;
-    }
-    V[n - 1][n - 1] = 1.0;
-    e[0] = 0.0;
 }
 
-/* Symmetric tridiagonal QL algorithm. */
-static void tql2(double V[n][n], double d[n], double e[n]) {
-
-    /*  This is derived from the Algol procedures tql2, by */
-    /*  Bowdler, Martin, Reinsch, and Wilkinson, Handbook for */
-    /*  Auto. Comp., Vol.ii-Linear Algebra, and the corresponding */
-    /*  Fortran subroutine in EISPACK. */
-
-    int i, j, k, l, m;
-    double f;
-    double tst1;
-    double eps;
-    int iter;
-    double g, p, r;
-    double dl1, h, c, c2, c3, el1, s, s2;
-
-    for (i = 1; i < n; i++) {
-        e[i - 1] = e[i];
-    }
-    e[n - 1] = 0.0;
-
-    f = 0.0;
-    tst1 = 0.0;
-    eps = pow(2.0, -52.0);
-    for (l = 0; l < n; l++) {
-
-        /* Find small subdiagonal element */
-
-        tst1 = max(tst1, fabs(d[l]) + fabs(e[l]));
-        m = l;
-        while (m < n) {
-            if (fabs(e[m]) <= eps * tst1) {
-                break;
-            }
-            m++;
-        }
-
-        /* If m == l, d[l] is an eigenvalue, */
-        /* otherwise, iterate. */
-
-        if (m > l) {
-            iter = 0;
-            do {
-                iter = iter + 1; /* (Could check iteration count here.) */
-                /* Compute implicit shift */
-                g = d[l];
-                p = (d[l + 1] - g) / (2.0 * e[l]);
-                r = hypot2(p, 1.0);
-                if (p < 0) {
-                    r = -r;
-                }
-                d[l] = e[l] / (p + r);
-                d[l + 1] = e[l] * (p + r);
-                dl1 = d[l + 1];
-                h = g - d[l];
-                for (i = l + 2; i < n; i++) {
-                    d[i] -= h;
-                }
-                f = f + h;
-                /* Implicit QL transformation. */
-                p = d[m];
-                c = 1.0;
-                c2 = c;
-                c3 = c;
-                el1 = e[l + 1];
-                s = 0.0;
-                s2 = 0.0;
-                for (i = m - 1; i >= l; i--) {
-                    c3 = c2;
-                    c2 = c;
-                    s2 = s;
-                    g = c * e[i];
-                    h = c * p;
-                    r = hypot2(p, e[i]);
-                    e[i + 1] = s * r;
-                    s = e[i] / r;
-                    c = p / r;
-                    p = c * d[i] - s * g;
-                    d[i + 1] = h + s * (c * g + s * d[i]);
-                    /* Accumulate transformation. */
-                    for (k = 0; k < n; k++) {
-                        h = V[k][i + 1];
-                        V[k][i + 1] = s * V[k][i] + c * h;
-                        V[k][i] = c * V[k][i] - s * h;
-                    }
-                }
-                p = -s * s2 * c3 * el1 * e[l] / dl1;
-                e[l] = s * p;
-                d[l] = c * p;
-
-                /* Check for convergence. */
-            } while (fabs(e[l]) > eps * tst1);
+// As above along x. If FLAGACC the result is added to OUT:
+static void _p3dFilterPlaneX(const float* in, float* out, const float* c, const int dimx, const int dimy, const int flagAcc) {
+    const float* r;
+    float* o;
+    float val;
+    int x, y;
+
+#pragma omp parallel for private(x, r, o, val)
+    for (y = 0; y < dimy; y++) {
+        r = in + I2(0, y, dimx);
+        o = out + I2(0, y, dimx);
+
+        for (x = 0; x < dimx; x++) {
+            val = c[0] * r[ max(x - 1, 0) ] + c[1] * r[x] + c[2] * r[ min(x + 1, dimx - 1) ];
+            o[x] = (flagAcc) ? o[x] + val : val;
         }
-        d[l] = d[l] + f;
-        e[l] = 0.0;
-    }
-
-    /* Sort eigenvalues and corresponding vectors. */
-    for (i = 0; i < n - 1; i++) {
-        k = i;
-        p = d[i];
-        for (j = i + 1; j < n; j++) {
-            if (d[j] < p) {
-                k = j;
-                p = d[j];
-            }
-        }
-        if (k != i) {
-            d[k] = d[i];
-            d[i] = p;
-            for (j = 0; j < n; j++) {
-                p = V[j][i];
-                V[j][i] = V[j][k];
-                V[j][k] = p;
-            }
-        }
-    }
-}
-
-void roots3(double d[3], double c0, double c1, double c2) {
-    double c2Div3, aDiv3, mbDiv2, q, magnitude, angle, cs, sn;
-
-    /* Solve the roots of  y^3 + c2 * y^2 + c1 *y + c0  */
-    c2Div3 = -c2*inv3;
-    aDiv3 = (c1 + c2 * c2Div3) * inv3;
-    if (aDiv3 > 0.0) {
-        aDiv3 = 0.0;
-    }
-    mbDiv2 = 0.5 * (-c0 + c2Div3 * (2.0 * c2Div3 * c2Div3 - c1));
-    q = mbDiv2 * mbDiv2 + aDiv3 * aDiv3*aDiv3;
-    if (q > 0.0) {
-        q = 0.0;
     }
-    magnitude = sqrt(-aDiv3);
-    angle = atan2(sqrt(-q), mbDiv2) * inv3;
-    cs = cos(angle);
-    sn = sin(angle);
-    d[0] = c2Div3 + 2.0 * magnitude*cs;
-    d[1] = c2Div3 - magnitude * (cs + root3 * sn);
-    d[2] = c2Div3 - magnitude * (cs - root3 * sn);
 }
 
-int  fast_eigen3x3(double A[3][3], double V[3][3], double d[3]) {
-    const double smallv = 1e-12;
-    double c0, c1, c2;
-    int check;
-    double l1, l2, l3;
-    double t;
-    double a1, a2, a3, b1, b2;
-    double da[3];
-    check = (absd(A[0][1]) < smallv)+(absd(A[0][2]) < smallv)+(absd(A[1][2]) < smallv);
-    if (check > 1) {
-        return 0;
-    }
-
-    /* 0 = - det (A - yI) = y^3 + c2 * y^2 + c1 *y + c0 */
-    c0 = -(A[0][0] * A[1][1] * A[2][2] + 2 * A[0][1] * A[0][2] * A[1][2] - A[0][0] * pow2(A[1][2]) - A[1][1] * pow2(A[0][2]) - A[2][2] * pow2(A[0][1]));
-    c1 = A[0][0] * A[1][1] - pow2(A[0][1]) + A[0][0] * A[2][2] - pow2(A[0][2]) + A[1][1] * A[2][2] - pow2(A[1][2]);
-    c2 = -(A[0][0] + A[1][1] + A[2][2]);
-
-    /* Solve the roots of  y^3 + c2 * y^2 + c1 *y + c0  */
-    roots3(d, c0, c1, c2);
-
-    da[0] = absd(d[0]);
-    da[1] = absd(d[1]);
-    da[2] = absd(d[2]);
-    /* Sort eigenvalues */
-    if (da[0] >= da[1]) {
-        if (da[0] > da[2]) {
-            t = d[0];
-            d[0] = d[2];
-            d[2] = t;
-            t = da[0];
-            da[0] = da[2];
-            da[2] = t;
-        }
-    } else if (da[1] > da[2]) {
-        t = d[1];
-        d[1] = d[2];
-        d[2] = t;
-        t = da[1];
-        da[1] = da[2];
-        da[2] = t;
+// Gradient of volume IM on plane Z. SCRATCH must hold 3 planes:
+static void _p3dGradientPlane(const float* im, const int dimx, const int dimy, const int dimz, const int z,
+        float* gx, float* gy, float* gz, float* scratch) {
+    const long long np = (long long) dimx * dimy;
+    float* sz = scratch;
+    float* dz = scratch + np;
+    float* t = scratch + 2 * np;
 
-    }
+    const float* pm = im + np * max(z - 1, 0);
+    const float* p0 = im + np * z;
+    const float* pp = im + np * min(z + 1, dimz - 1);
 
-    if (da[0] >= da[1]) {
-        t = d[0];
-        d[0] = d[1];
-        d[1] = t;
-        t = da[0];
-        da[0] = da[1];
-        da[1] = t;
-    }
+    _p3dFilterPlaneZ(pm, p0, pp, sz, smoothfilter, np);
+    _p3dFilterPlaneZ(pm, p0, pp, dz, derivafilter, np);
 
-    if ((da[1] - da[0]) < smallv) {
-        return 0;
-    }
-    if ((da[2] - da[1]) < smallv) {
-        return 0;
-    }
+    _p3dFilterPlaneY(sz, t, smoothfilter, dimx, dimy);
+    _p3dFilterPlaneX(t, gx, derivafilter, dimx, dimy, 0);
 
-    /* Calculate eigen vectors */
-    a1 = A[0][1] * A[1][2];
-    a2 = A[0][1] * A[0][2];
-    a3 = pow2(A[0][1]);
-
-    b1 = A[0][0] - d[0];
-    b2 = A[1][1] - d[0];
-    V[0][0] = a1 - A[0][2] * b2;
-    V[1][0] = a2 - A[1][2] * b1;
-    V[2][0] = b1 * b2 - a3;
-
-    b1 = A[0][0] - d[1];
-    b2 = A[1][1] - d[1];
-    V[0][1] = a1 - A[0][2] * b2;
-    V[1][1] = a2 - A[1][2] * b1;
-    V[2][1] = b1 * b2 - a3;
-
-    b1 = A[0][0] - d[2];
-    b2 = A[1][1] - d[2];
-    V[0][2] = a1 - A[0][2] * b2;
-    V[1][2] = a2 - A[1][2] * b1;
-    V[2][2] = b1 * b2 - a3;
-
-
-    /* Eigen vector normalization */
-    l1 = sqrt(pow2(V[0][0]) + pow2(V[1][0]) + pow2(V[2][0]));
-    l2 = sqrt(pow2(V[0][1]) + pow2(V[1][1]) + pow2(V[2][1]));
-    l3 = sqrt(pow2(V[0][2]) + pow2(V[1][2]) + pow2(V[2][2]));
-
-    /* Detect fail : eigenvectors with only zeros */
-    if (l1 < smallv) {
-        return 0;
-    }
-    if (l2 < smallv) {
-        return 0;
-    }
-    if (l3 < smallv) {
-        return 0;
-    }
+    _p3dFilterPlaneY(sz, t, derivafilter, dimx, dimy);
+    _p3dFilterPlaneX(t, gy, smoothfilter, dimx, dimy, 0);
 
-    V[0][0] /= l1;
-    V[0][1] /= l2;
-    V[0][2] /= l3;
-    V[1][0] /= l1;
-    V[1][1] /= l2;
-    V[1][2] /= l3;
-    V[2][0] /= l1;
-    V[2][1] /= l2;
-    V[2][2] /= l3;
-
-    /* Succes    */
-    return 1;
+    _p3dFilterPlaneY(dz, t, smoothfilter, dimx, dimy);
+    _p3dFilterPlaneX(t, gz, smoothfilter, dimx, dimy, 0);
 }
 
-void eigen_decomposition(double A[n][n], double V[n][n], double d[n]) {
-    double e[n];
-    double da[3];
-    double dt, dat;
-    double vet[3];
-    int i, j;
-
-    if (fast_eigen3x3(A, V, d)) {
-        return;
-    }
-    for (i = 0; i < n; i++) {
-        for (j = 0; j < n; j++) {
-            V[i][j] = A[i][j];
-        }
-    }
-    tred2(V, d, e);
-    tql2(V, d, e);
-
-    /* Sort the eigen values and vectors by abs eigen value */
-    da[0] = absd(d[0]);
-    da[1] = absd(d[1]);
-    da[2] = absd(d[2]);
-    if ((da[0] >= da[1]) && (da[0] > da[2])) {
-        dt = d[2];
-        dat = da[2];
-        vet[0] = V[0][2];
-        vet[1] = V[1][2];
-        vet[2] = V[2][2];
-        d[2] = d[0];
-        da[2] = da[0];
-        V[0][2] = V[0][0];
-        V[1][2] = V[1][0];
-        V[2][2] = V[2][0];
-        d[0] = dt;
-        da[0] = dat;
-        V[0][0] = vet[0];
-        V[1][0] = vet[1];
-        V[2][0] = vet[2];
-    } else if ((da[1] >= da[0]) && (da[1] > da[2])) {
-        dt = d[2];
-        dat = da[2];
-        vet[0] = V[0][2];
-        vet[1] = V[1][2];
-        vet[2] = V[2][2];
-        d[2] = d[1];
-        da[2] = da[1];
-        V[0][2] = V[0][1];
-        V[1][2] = V[1][1];
-        V[2][2] = V[2][1];
-        d[1] = dt;
-        da[1] = dat;
-        V[0][1] = vet[0];
-        V[1][1] = vet[1];
-        V[2][1] = vet[2];
-    }
-    if (da[0] > da[1]) {
-        dt = d[1];
-        dat = da[1];
-        vet[0] = V[0][1];
-        vet[1] = V[1][1];
-        vet[2] = V[2][1];
-        d[1] = d[0];
-        da[1] = da[0];
-        V[0][1] = V[0][0];
-        V[1][1] = V[1][0];
-        V[2][1] = V[2][0];
-        d[0] = dt;
-        da[0] = dat;
-        V[0][0] = vet[0];
-        V[1][0] = vet[1];
-        V[2][0] = vet[2];
-    }
+// Divergence of the flux (J1, J2, J3) on the plane whose neighbours are
+// JM[], J0[] and JP[]. SCRATCH must hold 2 planes:
+static void _p3dDivergencePlane(float** jm, float** j0, float** jp, const int dimx, const int dimy,
+        float* du, float* scratch) {
+    const long long np = (long long) dimx * dimy;
+    float* s = scratch;
+    float* t = scratch + np;
+
+    _p3dFilterPlaneZ(jm[0], j0[0], jp[0], s, smoothfilter, np);
+    _p3dFilterPlaneY(s, t, smoothfilter, dimx, dimy);
+    _p3dFilterPlaneX(t, du, derivafilter, dimx, dimy, 0);
+
+    _p3dFilterPlaneZ(jm[1], j0[1], jp[1], s, smoothfilter, np);
+    _p3dFilterPlaneY(s, t, derivafilter, dimx, dimy);
+    _p3dFilterPlaneX(t, du, smoothfilter, dimx, dimy, 1);
+
+    _p3dFilterPlaneZ(jm[2], j0[2], jp[2], s, derivafilter, np);
+    _p3dFilterPlaneY(s, t, smoothfilter, dimx, dimy);
+    _p3dFilterPlaneX(t, du, smoothfilter, dimx, dimy, 1);
 }
 
-void diffusion_scheme_3D_rotation_invariance(float *u, float *u_new, int *dimsu, float *Dxx, float *Dxy, float *Dxz, float *Dyy, float *Dyz, float *Dzz, double dt_d) {
-    float *j1, *j2, *j3, *ud, *du;
-    int npixels;
-    float dt = 0.5f;
-    int i;
-    int x, y, z, index;
-
-    dt = (float) dt_d;
-    npixels = dimsu[0] * dimsu[1] * dimsu[2];
-
-    j1 = mallocf(npixels);
-    j2 = mallocf(npixels);
-    j3 = mallocf(npixels);
-    ud = mallocf(npixels);
-
-    /* 3 : Calculate the flux components */
-    /* j1 = Dxx .* ux + Dxy .*uy + Dxz .*uz; */
-    /* j2 = Dxy .* ux + Dyy .*uy + Dyz .*uz; */
-    /* j3 = Dxz .* ux + Dyz .*uy + Dzz .*uz; */
-
-    gradient3Dx_float(u, dimsu, ud);
-#pragma omp parallel for
-    for (i = 0; i < npixels; i++) {
-        j1[i] = Dxx[i] * ud[i];
-        j2[i] = Dxy[i] * ud[i];
-        j3[i] = Dxz[i] * ud[i];
-    }
-    gradient3Dy_float(u, dimsu, ud);
-#pragma omp parallel for
-    for (i = 0; i < npixels; i++) {
-        j1[i] += Dxy[i] * ud[i];
-        j2[i] += Dyy[i] * ud[i];
-        j3[i] += Dyz[i] * ud[i];
-    }
-    gradient3Dz_float(u, dimsu, ud);
-#pragma omp parallel for
-    for (i = 0; i < npixels; i++) {
-        j1[i] += Dxz[i] * ud[i];
-        j2[i] += Dyz[i] * ud[i];
-        j3[i] += Dzz[i] * ud[i];
-    }
-
-    /*j1(:,:,1)=0; j1(:,:,end)=0; j1(:,1,:)=0; j1(:,end,:)=0; j1(1,:,:)=0; j1(end,:,:)=0; */
-    /*j2(:,:,1)=0; j2(:,:,end)=0; j2(:,1,:)=0; j2(:,end,:)=0; j2(1,:,:)=0; j2(end,:,:)=0; */
-    /*j3(:,:,1)=0; j3(:,:,end)=0; j3(:,1,:)=0; j3(:,end,:)=0; j3(1,:,:)=0; j3(end,:,:)=0; */
-
-#pragma omp parallel for private (x, index)
-    for (y = 0; y < dimsu[1]; y++) {
-        for (x = 0; x < dimsu[0]; x++) {
-            index = mindex3(x, y, 0, dimsu[0], dimsu[1]);
-            j1[index] = 0;
-            j2[index] = 0;
-            j3[index] = 0;
-            index = mindex3(x, y, dimsu[2] - 1, dimsu[0], dimsu[1]);
-            j1[index] = 0;
-            j2[index] = 0;
-            j3[index] = 0;
-        }
-    }
-
-#pragma omp parallel for private(x,index)
-    for (z = 0; z < dimsu[2]; z++) {
-        for (x = 0; x < dimsu[0]; x++) {
-            index = mindex3(x, 0, z, dimsu[0], dimsu[1]);
-            j1[index] = 0;
-            j2[index] = 0;
-            j3[index] = 0;
-            index = mindex3(x, dimsu[1] - 1, z, dimsu[0], dimsu[1]);
-            j1[index] = 0;
-            j2[index] = 0;
-            j3[index] = 0;
-        }
-    }
-
-#pragma omp parallel for private(y,index)
-    for (z = 0; z < dimsu[2]; z++) {
-        for (y = 0; y < dimsu[1]; y++) {
-            index = mindex3(0, y, z, dimsu[0], dimsu[1]);
-            j1[index] = 0;
-            j2[index] = 0;
-            j3[index] = 0;
-            index = mindex3(dimsu[0] - 1, y, z, dimsu[0], dimsu[1]);
-            j1[index] = 0;
-            j2[index] = 0;
-            j3[index] = 0;
-        }
-    }
-
-    /* 4 : Calculate ... by means of the optimized derivative filters */
-    /* du = derivatives(j1,'x')+derivatives(j2,'y')+derivatives(j3,'z'); */
-    du = mallocf(npixels);
-    gradient3Dx_float(j1, dimsu, du);
-    gradient3Dy_float(j2, dimsu, ud);
-#pragma omp parallel for
-    for (i = 0; i < npixels; i++) {
-        du[i] += ud[i];
-    }
-    gradient3Dz_float(j3, dimsu, ud);
-#pragma omp parallel for
-    for (i = 0; i < npixels; i++) {
-        du[i] += ud[i];
-    }
-
-    /* Free memory */
-    free(j1);
-    free(j2);
-    free(j3);
-    free(ud);
-
-    /* 5 : Update in an explicit way. */
-    /* u=u+du*dt; */
-
-#pragma omp parallel for
-    for (i = 0; i < npixels; i++) {
-        u_new[i] += u[i] + du[i] * dt;
-    }
-
-    /* Free memory */
-    free(du);
-}
-
-void StructureTensor2DiffusionTensorThread(float **Args) {
-
-    /* Matrices of Eigenvector calculation */
-    double Ma[3][3];
-    double Davec[3][3];
-    double Daeig[3];
+// Diffusion tensor D (xx, yy, zz, xy, xz, yz) of a voxel from the eigenvalues
+// MU (by increasing absolute value) and eigenvectors V (V[3*c + r]) of its
+// structure tensor and from its squared gradient magnitude GRADA:
+static void _p3dDiffusionTensor(const float* mu, const float* V, const float gradA, const struct options* o, float* D) {
 
     /* Eigenvector and eigenvalues as scalars */
     double mu1, mu2, mu3, v1x, v1y, v1z, v2x, v2y, v2z, v3x, v3y, v3z;
 
-    /* Magnitude of gradient */
-    float *gradA;
-
     /* Amplitudes of diffustion tensor */
     double lambda1, lambda2, lambda3;
     double lambdac1, lambdac2, lambdac3;
@@ -1092,262 +266,316 @@ void StructureTensor2DiffusionTensorThread(float **Args) {
     /* Eps for finite values */
     const float eps = (float) 1e-20;
 
-    /* Loop variable */
-    int i;
-
-    /* Number of pixels */
-    int npixels = 1;
-
-    /* The diffusion tensors and structure tensors */
-    float *Jxx, *Jxy, *Jxz, *Jyy, *Jyz, *Jzz;
-    float *Dxx, *Dxy, *Dxz, *Dyy, *Dyz, *Dzz;
-
-    int dimsu[3];
-    float *dimsu_f, *constants_f, *Nthreads_f, *ThreadID_f;
-
-    /* Number of threads */
-    int ThreadOffset, Nthreads;
-
-    /* Constants */
-    double C, m, alpha, lambda_h, lambda_e, lambda_c;
-
-    /* Choice of eigenvalue equation */
-    int eigenmode;
-
     /* Temporary variables */
     double di, epsilon, xi;
 
-    //float **Args = (float**) Args_void;
-
-    Jxx = Args[0];
-    Jxy = Args[1];
-    Jxz = Args[2];
-    Jyy = Args[3];
-    Jyz = Args[4];
-    Jzz = Args[5];
-    Dxx = Args[6];
-    Dxy = Args[7];
-    Dxz = Args[8];
-    Dyy = Args[9];
-    Dyz = Args[10];
-    Dzz = Args[11];
-    gradA = Args[12];
-    dimsu_f = Args[13];
-    constants_f = Args[14];
-    ThreadID_f = Args[15];
-    Nthreads_f = Args[16];
-
-    for (i = 0; i < 3; i++) {
-        dimsu[i] = (int) dimsu_f[i];
-    }
-    eigenmode = (int) constants_f[0];
-    C = (double) constants_f[1];
-    m = (double) constants_f[2];
-    alpha = (double) constants_f[3];
-    lambda_e = (double) constants_f[4];
-    lambda_h = (double) constants_f[5];
-    lambda_c = (double) constants_f[6];
-
-
-    ThreadOffset = (int) ThreadID_f[0];
-    Nthreads = (int) Nthreads_f[0];
-
-    npixels = dimsu[0] * dimsu[1] * dimsu[2];
-
-    for (i = ThreadOffset; i < npixels; i = i + Nthreads) {
-        /* Calculate eigenvectors and values of local Hessian */
-        Ma[0][0] = (double) Jxx[i] + eps;
-        Ma[0][1] = (double) Jxy[i];
-        Ma[0][2] = (double) Jxz[i];
-        Ma[1][0] = (double) Jxy[i];
-        Ma[1][1] = (double) Jyy[i] + eps;
-        Ma[1][2] = (double) Jyz[i];
-        Ma[2][0] = (double) Jxz[i];
-        Ma[2][1] = (double) Jyz[i];
-        Ma[2][2] = (double) Jzz[i] + eps;
-        eigen_decomposition(Ma, Davec, Daeig);
-
-        /* Convert eigenvector and eigenvalue matrices back to scalar variables */
-        mu1 = Daeig[2];
-        mu2 = Daeig[1];
-        mu3 = Daeig[0];
-        v1x = Davec[0][0];
-        v1y = Davec[1][0];
-        v1z = Davec[2][0];
-        v2x = Davec[0][1];
-        v2y = Davec[1][1];
-        v2z = Davec[2][1];
-        v3x = Davec[0][2];
-        v3y = Davec[1][2];
-        v3z = Davec[2][2];
-
-        /* Scaling of diffusion tensor */
-        if (eigenmode == 0) /* Weickert line shaped */ {
-            di = (mu1 - mu3);
-            if ((di < eps) && (di>-eps)) {
-                lambda1 = alpha;
-            } else {
-                lambda1 = alpha + (1.0 - alpha) * exp(-C / pow(di, (2.0 * m)));
-            }
-            lambda2 = alpha;
-            lambda3 = alpha;
-        } else if (eigenmode == 1) /* Weickert plane shaped */ {
-            di = (mu1 - mu3);
-            if ((di < eps) && (di>-eps)) {
-                lambda1 = alpha;
-            } else {
-                lambda1 = alpha + (1.0 - alpha) * exp(-C / pow(di, (2.0 * m)));
-            }
-            di = (mu2 - mu3);
-            if ((di < eps) && (di>-eps)) {
-                lambda2 = alpha;
-            } else {
-                lambda2 = alpha + (1.0 - alpha) * exp(-C / pow(di, (2.0 * m)));
-            }
-            lambda3 = alpha;
-        } else if (eigenmode == 2) /* EED */ {
-            if (gradA[i] < eps) {
-                lambda3 = 1;
-            } else {
-                lambda3 = 1 - exp(-3.31488 / pow4(gradA[i] / pow2(lambda_e)));
-            }
-            lambda2 = 1;
+    mu1 = mu[2];
+    mu2 = mu[1];
+    mu3 = mu[0];
+    v1x = V[0];
+    v1y = V[1];
+    v1z = V[2];
+    v2x = V[3];
+    v2y = V[4];
+    v2z = V[5];
+    v3x = V[6];
+    v3y = V[7];
+    v3z = V[8];
+
+    /* Scaling of diffusion tensor */
+    if (o->eigenmode == 0) /* Weickert line shaped */ {
+        di = (mu1 - mu3);
+        if ((di < eps) && (di>-eps)) {
+            lambda1 = o->alpha;
+        } else {
+            lambda1 = o->alpha + (1.0 - o->alpha) * exp(-o->C / pow(di, (2.0 * o->m)));
+        }
+        lambda2 = o->alpha;
+        lambda3 = o->alpha;
+    } else if (o->eigenmode == 1) /* Weickert plane shaped */ {
+        di = (mu1 - mu3);
+        if ((di < eps) && (di>-eps)) {
+            lambda1 = o->alpha;
+        } else {
+            lambda1 = o->alpha + (1.0 - o->alpha) * exp(-o->C / pow(di, (2.0 * o->m)));
+        }
+        di = (mu2 - mu3);
+        if ((di < eps) && (di>-eps)) {
+            lambda2 = o->alpha;
+        } else {
+            lambda2 = o->alpha + (1.0 - o->alpha) * exp(-o->C / pow(di, (2.0 * o->m)));
+        }
+        lambda3 = o->alpha;
+    } else if (o->eigenmode == 2) /* EED */ {
+        if (gradA < eps) {
+            lambda3 = 1;
+        } else {
+            lambda3 = 1 - exp(-3.31488 / pow4(gradA / pow2(o->lambda_e)));
+        }
+        lambda2 = 1;
+        lambda1 = 1;
+    } else if (o->eigenmode == 3) /* CED */ {
+        lambda3 = o->alpha;
+        lambda2 = o->alpha;
+        if ((mu2 < eps) && (mu2>-eps)) {
             lambda1 = 1;
-        } else if (eigenmode == 3) /* CED */ {
-            lambda3 = alpha;
-            lambda2 = alpha;
-            if ((mu2 < eps) && (mu2>-eps)) {
-                lambda1 = 1;
-            } else if ((mu3 < eps) && (mu3>-eps)) {
-                lambda1 = 1;
-            } else {
-                lambda1 = alpha + (1.0 - alpha) * exp(-0.6931 * pow2(lambda_c) / pow4(mu2 / (alpha + mu3)));
-            }
-        } else if (eigenmode == 4) /* Hybrid Diffusion with Continous Switch */ {
-            if (gradA[i] < eps) {
-                lambdae3 = 1;
-            } else {
-                lambdae3 = 1 - exp(-3.31488 / pow4(gradA[i] / pow2(lambda_e)));
-            }
-            lambdae2 = 1;
-            lambdae1 = 1;
-
-            lambdac3 = alpha;
-            lambdac2 = alpha;
-            if ((mu2 < eps) && (mu2>-eps)) {
-                lambdac1 = 1;
-            } else if ((mu3 < eps) && (mu3>-eps)) {
-                lambdac1 = 1;
-            } else {
-                lambdac1 = alpha + (1.0 - alpha) * exp(-0.6931 * pow2(lambda_c) / pow4(mu2 / (alpha + mu3)));
-            }
-
-            xi = ((mu1 / (alpha + mu2)) - (mu2 / (alpha + mu3)));
-            di = 2.0 * pow4(lambda_h);
-            epsilon = exp(mu2 * (pow2(lambda_h)*(xi - absd(xi)) - 2.0 * mu3) / di);
-
-
-            lambda1 = (1 - epsilon) * lambdac1 + epsilon * lambdae1;
-            lambda2 = (1 - epsilon) * lambdac2 + epsilon * lambdae2;
-            lambda3 = (1 - epsilon) * lambdac3 + epsilon * lambdae3;
+        } else if ((mu3 < eps) && (mu3>-eps)) {
+            lambda1 = 1;
+        } else {
+            lambda1 = o->alpha + (1.0 - o->alpha) * exp(-0.6931 * pow2(o->lambda_c) / pow4(mu2 / (o->alpha + mu3)));
+        }
+    } else if (o->eigenmode == 4) /* Hybrid Diffusion with Continous Switch */ {
+        if (gradA < eps) {
+            lambdae3 = 1;
+        } else {
+            lambdae3 = 1 - exp(-3.31488 / pow4(gradA / pow2(o->lambda_e)));
+        }
+        lambdae2 = 1;
+        lambdae1 = 1;
+
+        lambdac3 = o->alpha;
+        lambdac2 = o->alpha;
+        if ((mu2 < eps) && (mu2>-eps)) {
+            lambdac1 = 1;
+        } else if ((mu3 < eps) && (mu3>-eps)) {
+            lambdac1 = 1;
+        } else {
+            lambdac1 = o->alpha + (1.0 - o->alpha) * exp(-0.6931 * pow2(o->lambda_c) / pow4(mu2 / (o->alpha + mu3)));
         }
 
+        xi = ((mu1 / (o->alpha + mu2)) - (mu2 / (o->alpha + mu3)));
+        di = 2.0 * pow4(o->lambda_h);
+        epsilon = exp(mu2 * (pow2(o->lambda_h)*(xi - absd(xi)) - 2.0 * mu3) / di);
+
+        lambda1 = (1 - epsilon) * lambdac1 + epsilon * lambdae1;
+        lambda2 = (1 - epsilon) * lambdac2 + epsilon * lambdae2;
+        lambda3 = (1 - epsilon) * lambdac3 + epsilon * lambdae3;
+    } else /* Unknown mode: isotropic diffusion */ {
+        lambda1 = 1;
+        lambda2 = 1;
+        lambda3 = 1;
+    }
 
+    /* Construct the diffusion tensor */
+    D[0] = (float) (lambda1 * v1x * v1x + lambda2 * v2x * v2x + lambda3 * v3x * v3x);
+    D[1] = (float) (lambda1 * v1y * v1y + lambda2 * v2y * v2y + lambda3 * v3y * v3y);
+    D[2] = (float) (lambda1 * v1z * v1z + lambda2 * v2z * v2z + lambda3 * v3z * v3z);
+    D[3] = (float) (lambda1 * v1x * v1y + lambda2 * v2x * v2y + lambda3 * v3x * v3y);
+    D[4] = (float) (lambda1 * v1x * v1z + lambda2 * v2x * v2z + lambda3 * v3x * v3z);
+    D[5] = (float) (lambda1 * v1y * v1z + lambda2 * v2y * v2z + lambda3 * v3y * v3z);
+}
+
+// Workspace of _p3dAnisotropicDiffusionFilter3D_float, allocated once per
+// call and reused by every iteration. Gradients are computed one plane at a
+// time and the diffusion tensor on the fly while computing the flux, so
+// neither is stored as a volume:
+struct ADWorkspace {
+    float* usigma;      // Gaussian filtered image volume
+    float* J[6];        // Structure tensor (xx, yy, zz, xy, xz, yz)
+    unsigned short* Jh[6]; // As above, in bfloat16 mode (J[] is not used)
+    float* planes;      // Scratch planes (see below)
+    float* eig;         // Eigenvalues and eigenvectors of a row, per thread
+};
 
-        /* Construct the diffusion tensor */
-        Dxx[i] = (float) (lambda1 * v1x * v1x + lambda2 * v2x * v2x + lambda3 * v3x * v3x);
-        Dyy[i] = (float) (lambda1 * v1y * v1y + lambda2 * v2y * v2y + lambda3 * v3y * v3y);
-        Dzz[i] = (float) (lambda1 * v1z * v1z + lambda2 * v2z * v2z + lambda3 * v3z * v3z);
-        Dxy[i] = (float) (lambda1 * v1x * v1y + lambda2 * v2x * v2y + lambda3 * v3x * v3y);
-        Dxz[i] = (float) (lambda1 * v1x * v1z + lambda2 * v2x * v2z + lambda3 * v3x * v3z);
-        Dyz[i] = (float) (lambda1 * v1y * v1z + lambda2 * v2y * v2z + lambda3 * v3y * v3z);
+// Scratch planes: a ring of three planes for each of the three flux
+// components, the gradients of u and of usigma and three planes used by the
+// derivative operators:
+#define P3D_AD_RING       0
+#define P3D_AD_GRAD_U     9
+#define P3D_AD_GRAD_S     12
+#define P3D_AD_SCRATCH    15
+#define P3D_AD_PLANES     18
+
+// Floats of ws->eig per thread and per voxel of a row: 3 eigenvalues,
+// 3 eigenvectors and 6 tensor components converted from bfloat16:
+#define P3D_AD_EIG        18
+
+// Flux components J[0..2] on plane Z (zero on the border of the volume):
+static void _p3dFluxPlane(const float* u, struct ADWorkspace* ws, const struct options* o,
+        const int dimx, const int dimy, const int dimz, const int z, float** j) {
+    const long long np = (long long) dimx * dimy;
+    float* ux = ws->planes + P3D_AD_GRAD_U * np;
+    float* uy = ux + np;
+    float* uz = uy + np;
+    float* sx = ws->planes + P3D_AD_GRAD_S * np;
+    float* sy = sx + np;
+    float* sz = sy + np;
+
+    const float* a[6];
+    float* ev[3];
+    float* vec[9];
+    float mu[3], V[9], D[6];
+    long long idx;
+    int x, y, t;
+
+    if ((z == 0) || (z == (dimz - 1))) {
+        for (t = 0; t < 3; t++)
+            memset(j[t], 0, (size_t) np * sizeof (float));
+        return;
     }
 
-    /*  explicit end thread, helps to ensure proper recovery of resources allocated for the thread */
+    // Gradients of the image (for the flux) and of the smoothed image (for
+    // the diffusion tensor):
+    _p3dGradientPlane(u, dimx, dimy, dimz, z, ux, uy, uz, ws->planes + P3D_AD_SCRATCH * np);
+    _p3dGradientPlane(ws->usigma, dimx, dimy, dimz, z, sx, sy, sz, ws->planes + P3D_AD_SCRATCH * np);
+
+    // The structure tensors of the inner voxels of a row are decomposed in a
+    // single batch, then the diffusion tensor and the flux are computed one
+    // voxel at a time:
+#pragma omp parallel for private(x, t, idx, a, ev, vec, mu, V, D)
+    for (y = 0; y < dimy; y++) {
+        idx = I2(0, y, dimx);
+
+        if ((y == 0) || (y == (dimy - 1)) || (dimx < 3)) {
+            for (t = 0; t < 3; t++)
+                memset(j[t] + idx, 0, (size_t) dimx * sizeof (float));
+            continue;
+        }
 
-    pthread_exit(NULL);
+        for (t = 0; t < 6; t++) {
+            if (o->bf16) {
+                a[t] = ws->eig + (long long) (omp_get_thread_num() * P3D_AD_EIG + 12 + t) * dimx;
+                _p3dBF16ToFloat(ws->Jh[t] + np * z + idx + 1, (float*) a[t], dimx - 2);
+            } else
+                a[t] = ws->J[t] + np * z + idx + 1;
+        }
+        for (t = 0; t < 3; t++)
+            ev[t] = ws->eig + (long long) (omp_get_thread_num() * P3D_AD_EIG + t) * dimx;
+        for (t = 0; t < 9; t++)
+            vec[t] = ws->eig + (long long) (omp_get_thread_num() * P3D_AD_EIG + 3 + t) * dimx;
+        p3dSymEigen3x3_float(a, ev, vec, dimx - 2);
+
+        for (t = 0; t < 3; t++) {
+            j[t][idx] = 0;
+            j[t][idx + dimx - 1] = 0;
+        }
 
+        for (x = 1; x < (dimx - 1); x++) {
+            idx = I2(x, y, dimx);
+
+            for (t = 0; t < 3; t++)
+                mu[t] = ev[t][x - 1];
+            for (t = 0; t < 9; t++)
+                V[t] = vec[t][x - 1];
+            _p3dDiffusionTensor(mu, V, sx[idx] * sx[idx] + sy[idx] * sy[idx] + sz[idx] * sz[idx], o, D);
+
+            /* j1 = Dxx .* ux + Dxy .*uy + Dxz .*uz; */
+            /* j2 = Dxy .* ux + Dyy .*uy + Dyz .*uz; */
+            /* j3 = Dxz .* ux + Dyz .*uy + Dzz .*uz; */
+            j[0][idx] = D[0] * ux[idx] + D[3] * uy[idx] + D[4] * uz[idx];
+            j[1][idx] = D[3] * ux[idx] + D[1] * uy[idx] + D[5] * uz[idx];
+            j[2][idx] = D[4] * ux[idx] + D[5] * uy[idx] + D[2] * uz[idx];
+        }
+    }
 }
 
-void StructureTensor2DiffusionTensor(float *Jxx, float *Jxy, float *Jxz, float *Jyy, float *Jyz, float *Jzz, float *Dxx, float *Dxy, float *Dxz, float *Dyy, float *Dyz, float *Dzz, float *gradA, int *dimsu, int eigenmode, double C, double m, double alpha, double lambda_e, double lambda_h, double lambda_c) {
-
+// One explicit diffusion step from U to U_NEW. CHANGE receives the mean
+// absolute change of the voxels of the image, i.e. excluding the replicate
+// border of width PAD:
+static int _p3dAnisotropicDiffusionStep(
+        float* u,
+        float* u_new,
+        int* dimsu,
+        const int pad,
+        struct ADWorkspace* ws,
+        const struct options* o,
+        double* change
+        ) {
+    const int dimx = dimsu[0], dimy = dimsu[1], dimz = dimsu[2];
+    const long long np = (long long) dimx * dimy;
+    float* gx = ws->planes + P3D_AD_GRAD_S * np;
+    float* gy = gx + np;
+    float* gz = gy + np;
+    float* ring[3][3];
+    float* g[3];
+    float* du;
+    static const int ta[6] = {0, 1, 2, 0, 0, 1};
+    static const int tb[6] = {0, 1, 2, 1, 2, 2};
+    const float dt = (float) o->dt;
+    double dsum = 0.0;
+
+    long long i;
+    int x, y, z, s, c;
+
+    /* Gaussian Filtering of input image volume*/
+    P3D_TRY(GaussianFiltering3D_float(u, ws->usigma, dimsu, o->sigma, 4 * o->sigma));
+
+    /* Compute the 3D structure tensors J of the image */
+    if (o->bf16) {
+        /* One component at a time in U_NEW, which is not needed until the
+           diffusion, then stored as bfloat16: */
+        for (c = 0; c < 6; c++) {
+            for (z = 0; z < dimz; z++) {
+                _p3dGradientPlane(ws->usigma, dimx, dimy, dimz, z, gx, gy, gz, ws->planes + P3D_AD_SCRATCH * np);
+                g[0] = gx;
+                g[1] = gy;
+                g[2] = gz;
 
-    /* ID of Threads */
-    float **ThreadID;
-    float *ThreadID1;
-    float ***ThreadArgs;
-    float **ThreadArgs1;
-    float Nthreads_f[1] = {0};
-    float dimsu_f[3];
-    float constants_f[7];
-    int Nthreads;
-    int i;
+#pragma omp parallel for
+                for (i = 0; i < np; i++)
+                    u_new[np * z + i] = g[ta[c]][i] * g[tb[c]][i];
+            }
+            P3D_TRY(GaussianFiltering3D_float(u_new, u_new, dimsu, o->rho, 4 * o->rho));
 
-    pthread_t *ThreadList;
+#pragma omp parallel for
+            for (z = 0; z < dimz; z++)
+                _p3dFloatToBF16(u_new + np * z, ws->Jh[c] + np * z, np);
+        }
+    } else {
+        for (z = 0; z < dimz; z++) {
+            _p3dGradientPlane(ws->usigma, dimx, dimy, dimz, z, gx, gy, gz, ws->planes + P3D_AD_SCRATCH * np);
 
-    Nthreads = omp_get_num_procs( );
-    Nthreads_f[0] = (float) Nthreads;
-    for (i = 0; i < 3; i++) {
-        dimsu_f[i] = (float) dimsu[i];
+#pragma omp parallel for
+            for (i = 0; i < np; i++) {
+                ws->J[0][np * z + i] = gx[i] * gx[i];
+                ws->J[1][np * z + i] = gy[i] * gy[i];
+                ws->J[2][np * z + i] = gz[i] * gz[i];
+                ws->J[3][np * z + i] = gx[i] * gy[i];
+                ws->J[4][np * z + i] = gx[i] * gz[i];
+                ws->J[5][np * z + i] = gy[i] * gz[i];
+            }
+        }
+        for (c = 0; c < 6; c++)
+            P3D_TRY(GaussianFiltering3D_float(ws->J[c], ws->J[c], dimsu, o->rho, 4 * o->rho));
     }
-    constants_f[0] = (float) eigenmode;
-    constants_f[1] = (float) C;
-    constants_f[2] = (float) m;
-    constants_f[3] = (float) alpha;
-    constants_f[4] = (float) lambda_e;
-    constants_f[5] = (float) lambda_h;
-    constants_f[6] = (float) lambda_c;
-
-    /* Reserve room for handles of threads in ThreadList  */
-    ThreadList = (pthread_t*) malloc(Nthreads * sizeof ( pthread_t));
-    ThreadID = (float **) malloc(Nthreads * sizeof (float *));
-    ThreadArgs = (float ***) malloc(Nthreads * sizeof (float **));
-
-    for (i = 0; i < Nthreads; i++) {
-        /*  Make Thread ID  */
-        ThreadID1 = (float *) malloc(1 * sizeof (float));
-        ThreadID1[0] = (float) i;
-        ThreadID[i] = ThreadID1;
-
-        /*  Make Thread Structure  */
-        ThreadArgs1 = (float **) malloc(17 * sizeof ( float *));
-        ThreadArgs1[0] = Jxx;
-        ThreadArgs1[1] = Jxy;
-        ThreadArgs1[2] = Jxz;
-        ThreadArgs1[3] = Jyy;
-        ThreadArgs1[4] = Jyz;
-        ThreadArgs1[5] = Jzz;
-        ThreadArgs1[6] = Dxx;
-        ThreadArgs1[7] = Dxy;
-        ThreadArgs1[8] = Dxz;
-        ThreadArgs1[9] = Dyy;
-        ThreadArgs1[10] = Dyz;
-        ThreadArgs1[11] = Dzz;
-        ThreadArgs1[12] = gradA;
-        ThreadArgs1[13] = dimsu_f;
-        ThreadArgs1[14] = constants_f;
-        ThreadArgs1[15] = ThreadID[i];
-        ThreadArgs1[16] = Nthreads_f;
-
-        /* Start a Thread  */
-        ThreadArgs[i] = ThreadArgs1;
-        pthread_create((pthread_t*) & ThreadList[i], NULL, (void *) &StructureTensor2DiffusionTensorThread, ThreadArgs[i]);
 
-    }
+    /* Perform the image diffusion. The flux of plane z + 1 is computed just
+       before the divergence of plane z, which needs planes z - 1, z and z + 1: */
+    for (s = 0; s < 3; s++)
+        for (c = 0; c < 3; c++)
+            ring[s][c] = ws->planes + (P3D_AD_RING + 3 * s + c) * np;
+
+    _p3dFluxPlane(u, ws, o, dimx, dimy, dimz, 0, ring[0]);
+
+    for (z = 0; z < dimz; z++) {
+        if ((z + 1) < dimz)
+            _p3dFluxPlane(u, ws, o, dimx, dimy, dimz, z + 1, ring[(z + 1) % 3]);
+
+        /* du = derivatives(j1,'x')+derivatives(j2,'y')+derivatives(j3,'z'); */
+        du = u_new + np * z;
+        _p3dDivergencePlane(ring[max(z - 1, 0) % 3], ring[z % 3], ring[min(z + 1, dimz - 1) % 3],
+                dimx, dimy, du, ws->planes + P3D_AD_SCRATCH * np);
+
+        /* Change of the voxels of the image: */
+        if ((z >= pad) && (z < (dimz - pad))) {
+#pragma omp parallel for private(x) reduction(+ : dsum)
+            for (y = pad; y < (dimy - pad); y++)
+                for (x = pad; x < (dimx - pad); x++)
+                    dsum += fabs(du[ I2(x, y, dimx) ] * dt);
+        }
 
-    for (i = 0; i < Nthreads; i++) {
-        pthread_join(ThreadList[i], NULL);
+        /* u=u+du*dt; */
+#pragma omp parallel for
+        for (i = 0; i < np; i++)
+            du[i] = u[np * z + i] + du[i] * dt;
     }
+    *change = dsum / ((double) (dimx - 2 * pad) * (dimy - 2 * pad) * (dimz - 2 * pad));
 
-    for (i = 0; i < Nthreads; i++) {
-        free(ThreadArgs[i]);
-        free(ThreadID[i]);
-    }
+    return P3D_SUCCESS;
 
-    free(ThreadArgs);
-    free(ThreadID);
-    free(ThreadList);
+MEM_ERROR:
 
+    return P3D_MEM_ERROR;
 }
 
 int _p3dAnisotropicDiffusionFilter3D_float(
@@ -1356,37 +584,44 @@ int _p3dAnisotropicDiffusionFilter3D_float(
         const int dimx,
         const int dimy,
         const int dimz,
+        const int pad, // IN: width of the replicate border of U
         const double lambda,
         const int m,
         const double sigma,
         const int iter,
+        const double tol,
+        struct IterationInfo* info,
         int (*wr_log)(const char*, ...),
         int (*wr_progress)(const int, ...)
         ) {
     /* Options structure variables */
     struct options Options;
 
+    /* Workspace reused by all the iterations */
+    struct ADWorkspace ws;
+
     /* Size input image volume */
-    int ndimsu;
     int dimsu[3];
-    int npixelsu;
-    int i, ct;
+    size_t npixelsu;
+    int ct, c;
+
+    /* Mean absolute change of the last iteration */
+    double change = 0.0;
 
-    float *usigma; /* Gaussian filtered image volume */
-    float *ux, *uy, *uz, *gradA; /* Gradients of smoothed image */
-    float *Jxx, *Jxy, *Jxz, *Jyy, *Jyz, *Jzz, *J[6]; /* Structure tensor */
-    float *Dxx, *Dxy, *Dxz, *Dyy, *Dyz, *Dzz; /* Diffusion tensor */
+    /* Iterations alternate between u and u_new */
+    float* src;
+    float* dst;
+    float* tmp;
 
-    ndimsu = 3;
     dimsu[0] = dimx;
     dimsu[1] = dimy;
     dimsu[2] = dimz;
-    npixelsu = dimsu[0] * dimsu[1] * dimsu[2];
+    npixelsu = (size_t) dimsu[0] * dimsu[1] * dimsu[2];
 
     Options.T = iter; // ok... call it iteration
     Options.dt = 0.24; // below 0.25 for stability //fix
     Options.sigma = sigma; // ok... call it sigma
-    Options.rho = 1.0; // fix
+    Options.rho = P3D_AD_RHO; // fix
     Options.C = 1e-10; // fix
     Options.m = m; // ok... call it mu
     Options.alpha = 0.01; // fix
@@ -1394,96 +629,87 @@ int _p3dAnisotropicDiffusionFilter3D_float(
     Options.lambda_e = lambda; // ok... call it lambda
     Options.lambda_h = 0.01; //delete
     Options.lambda_c = 0.5; //delete
+#ifdef P3D_AD_BF16
+    Options.bf16 = 1;
+#else
+    Options.bf16 = 0;
+#endif
+
+    // Allocate workspace:
+    ws.usigma = NULL;
+    ws.planes = NULL;
+    ws.eig = NULL;
+    for (c = 0; c < 6; c++) {
+        ws.J[c] = NULL;
+        ws.Jh[c] = NULL;
+    }
+
+    P3D_TRY(ws.usigma = (float*) malloc(npixelsu * sizeof (float)));
+    for (c = 0; c < 6; c++) {
+        if (Options.bf16) {
+            P3D_TRY(ws.Jh[c] = (unsigned short*) malloc(npixelsu * sizeof (unsigned short)));
+        } else {
+            P3D_TRY(ws.J[c] = (float*) malloc(npixelsu * sizeof (float)));
+        }
+    }
+    P3D_TRY(ws.planes = (float*) malloc((size_t) P3D_AD_PLANES * dimx * dimy * sizeof (float)));
+    P3D_TRY(ws.eig = (float*) malloc((size_t) omp_get_max_threads() * P3D_AD_EIG * dimx * sizeof (float)));
 
+    src = u;
+    dst = u_new;
     for (ct = 0; ct < Options.T; ct++) {
+        P3D_TRY(_p3dAnisotropicDiffusionStep(src, dst, dimsu, pad, &ws, &Options, &change));
 
-        memset(u_new, 0, dimx * dimy * dimz * sizeof (float));
-
-        /* Gaussian Filtering of input image volume*/
-        usigma = mallocf(npixelsu);
-        //wr_log("Eseguo il gaussian filtering 3D...");
-        GaussianFiltering3D_float(u, usigma, dimsu, Options.sigma, 4 * Options.sigma);
-        //wr_log("Done!\n");
-
-        /* Calculate the image gradients of the smoothed image volume */
-        ux = mallocf(npixelsu);
-        uy = mallocf(npixelsu);
-        uz = mallocf(npixelsu);
-
-        //wr_log("Eseguo il calcolo dei gradienti...");
-        gradient3Dx_float(usigma, dimsu, ux);
-        //wr_log("Done x!\n");
-        gradient3Dy_float(usigma, dimsu, uy);
-        //wr_log("Done y!\n");
-        gradient3Dz_float(usigma, dimsu, uz);
-        //wr_log("Done z!\n");
-
-        /* remove usigma from memory */
-        free(usigma);
-
-        /* Compute the 3D structure tensors J of the image */
-        // wr_log("Calcolato StructureTensor3D.\n");
-        StructureTensor3D(ux, uy, uz, J, dimsu, Options.rho);
-        //wr_log("Done!\n");
-
-        Jxx = J[0];
-        Jyy = J[1];
-        Jzz = J[2];
-        Jxy = J[3];
-        Jxz = J[4];
-        Jyz = J[5];
-
-        /* calculate gradient magnitude */
-        gradA = mallocf(npixelsu);
+        // Prepare for next step:
+        tmp = src;
+        src = dst;
+        dst = tmp;
 
-#pragma omp parallel for
-        for (i = 0; i < npixelsu; i++) {
-            gradA[i] = ux[i] * ux[i] + uy[i] * uy[i] + uz[i] * uz[i];
+        // Update any progress counter:
+        if (wr_progress != NULL) wr_progress((int) ((double) (ct + 1) / iter * 100 + 0.5));
+
+        // Stop when the mean change drops below the tolerance:
+        if ((tol > 0.0) && (change <= tol)) {
+            ct++;
+            break;
         }
+    }
 
-        /* remove gradients from memory */
-        free(ux);
-        free(uy);
-        free(uz);
-
-        /* Structure to Diffusion Tensor Weickert */
-        Dxx = mallocf(npixelsu);
-        Dyy = mallocf(npixelsu);
-        Dzz = mallocf(npixelsu);
-        Dxy = mallocf(npixelsu);
-        Dxz = mallocf(npixelsu);
-        Dyz = mallocf(npixelsu);
-
-        StructureTensor2DiffusionTensor(Jxx, Jxy, Jxz, Jyy, Jyz, Jzz, Dxx, Dxy, Dxz, Dyy, Dyz, Dzz, gradA, dimsu, Options.eigenmode, Options.C, Options.m, Options.alpha, Options.lambda_e, Options.lambda_h, Options.lambda_c);
-        //wr_log("Calcolato StructureTensor2DiffusionTensor.\n");
-        /* Gradient Magnitude no longer needed */
-        free(gradA);
-        /* remove structure tensor from memory */
-        free(Jxx);
-        free(Jyy);
-        free(Jzz);
-        free(Jxy);
-        free(Jxz);
-        free(Jyz);
-
-        /* Perform the image diffusion */
-        diffusion_scheme_3D_rotation_invariance(u, u_new, dimsu, Dxx, Dxy, Dxz, Dyy, Dyz, Dzz, Options.dt);
-        //wr_log("Calcolato diffusion_scheme_3D_rotation_invariance.\n");
-
-        /* remove diffusion tensor from memory */
-        free(Dxx);
-        free(Dyy);
-        free(Dzz);
-        free(Dxy);
-        free(Dxz);
-        free(Dyz);
+    if (info != NULL) {
+        info->iterations = ct;
+        info->change = change;
+    }
 
-        // Prepare for next step:
-        memcpy(u, u_new, dimx * dimy * dimz * sizeof (float));
+    // The result of the last step is in src:
+    if (src != u_new)
+        memcpy(u_new, src, npixelsu * sizeof (float));
+
+    // Release resources:
+    if (ws.usigma != NULL) free(ws.usigma);
+    if (ws.planes != NULL) free(ws.planes);
+    if (ws.eig != NULL) free(ws.eig);
+    for (c = 0; c < 6; c++) {
+        if (ws.J[c] != NULL) free(ws.J[c]);
+        if (ws.Jh[c] != NULL) free(ws.Jh[c]);
     }
+
+    return P3D_SUCCESS;
+
+MEM_ERROR:
+
+    // Release resources:
+    if (ws.usigma != NULL) free(ws.usigma);
+    if (ws.planes != NULL) free(ws.planes);
+    if (ws.eig != NULL) free(ws.eig);
+    for (c = 0; c < 6; c++) {
+        if (ws.J[c] != NULL) free(ws.J[c]);
+        if (ws.Jh[c] != NULL) free(ws.Jh[c]);
+    }
+
+    return P3D_MEM_ERROR;
 }
 
-int p3dAnisotropicDiffusionFilter3D_8(
+int p3dAnisotropicDiffusionFilter3D_8_tol(
         unsigned char* in_im,
         unsigned char* out_im,
         const int dimx,
@@ -1493,12 +719,15 @@ int p3dAnisotropicDiffusionFilter3D_8(
         const double lambda,
         const double sigma,
         const int iter,
+        const double tol, // IN: mean absolute change below which iterations stop (0: no check)
+        struct IterationInfo* info, // OUT: iterations run and last change (may be NULL)
         int (*wr_log)(const char*, ...),
         int (*wr_progress)(const int, ...)
         ) {
 
     float* u = NULL;
     float* u_new = NULL;
+    struct IterationInfo run;
 
     //float u_min = UCHAR_MAX;
     //float u_max = 0;
@@ -1506,7 +735,8 @@ int p3dAnisotropicDiffusionFilter3D_8(
     //float u_new_min = UCHAR_MAX;
     //float u_new_max = 0;
 
-    int ct, i, j, k;
+    int i, j, k;
+    long long ct;
     const int a_rad = 3;
     int a_dimx, a_dimy, a_dimz;
     /*char auth_code;
@@ -1525,6 +755,7 @@ int p3dAnisotropicDiffusionFilter3D_8(
         wr_log("\tMu: %d.", m);
         wr_log("\tSigma: %0.3f.", sigma);
         wr_log("\tNumber of iterations: %d.", iter);
+        if (tol > 0.0) wr_log("\tTolerance: %0.3f.", tol);
     }
 
     a_dimx = dimx + a_rad * 2;
@@ -1532,32 +763,40 @@ int p3dAnisotropicDiffusionFilter3D_8(
     a_dimz = dimz + a_rad * 2;
 
     // Allocate memory:
-    u = (float*) malloc(a_dimx * a_dimy * a_dimz * sizeof (float));
-    u_new = (float*) malloc(a_dimx * a_dimy * a_dimz * sizeof (float));
+    P3D_TRY(u = (float*) malloc((size_t) a_dimx * a_dimy * a_dimz * sizeof (float)));
+    P3D_TRY(u_new = (float*) malloc((size_t) a_dimx * a_dimy * a_dimz * sizeof (float)));
 
     _p3dReplicatePadding3D_uchar2float(in_im, u, dimx, dimy, dimz, a_rad);
 
     // Convert the input:
 #pragma omp parallel for
-    for (ct = 0; ct < (a_dimx * a_dimy * a_dimz); ct++) {
+    for (ct = 0; ct < ((long long) a_dimx * a_dimy * a_dimz); ct++) {
         u[ct] = u[ct] / UCHAR_MAX;
         //u_min = MIN(u_min, u[ct]);
         //u_max = MAX(u_max, u[ct]);
     }
 
     // Call the 32 bit version:
-    _p3dAnisotropicDiffusionFilter3D_float(u,
+    P3D_TRY(_p3dAnisotropicDiffusionFilter3D_float(u,
             u_new,
             a_dimx,
             a_dimy,
             a_dimz,
+            a_rad,
             lambda,
             m,
             sigma,
             iter,
+            tol / UCHAR_MAX,
+            &run,
             wr_log,
             wr_progress
-            );
+            ));
+
+    // Changes are reported in grey levels:
+    run.change *= UCHAR_MAX;
+    if (info != NULL)
+        *info = run;
 
     // Convert the input:
     /*for (ct = 0; ct < (a_dimx * a_dimy * a_dimz); ct++) {
@@ -1585,6 +824,7 @@ int p3dAnisotropicDiffusionFilter3D_8(
 
     // Print elapsed time (if required):
     if (wr_log != NULL) {
+        wr_log("\tIterations run: %d (mean change: %0.4f).", run.iterations, run.change);
         wr_log("Pore3D - Anisotropic diffusion filter applied successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
     }
 
@@ -1618,7 +858,23 @@ MEM_ERROR:
     return P3D_AUTH_ERROR;*/
 }
 
-int p3dAnisotropicDiffusionFilter3D_16(
+int p3dAnisotropicDiffusionFilter3D_8(
+        unsigned char* in_im,
+        unsigned char* out_im,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int m,
+        const double lambda,
+        const double sigma,
+        const int iter,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    return p3dAnisotropicDiffusionFilter3D_8_tol(in_im, out_im, dimx, dimy, dimz, m, lambda, sigma, iter, 0.0, NULL, wr_log, wr_progress);
+}
+
+int p3dAnisotropicDiffusionFilter3D_16_tol(
         unsigned short* in_im,
         unsigned short* out_im,
         const int dimx,
@@ -1628,12 +884,15 @@ int p3dAnisotropicDiffusionFilter3D_16(
         const double lambda,
         const double sigma,
         const int iter,
+        const double tol, // IN: mean absolute change below which iterations stop (0: no check)
+        struct IterationInfo* info, // OUT: iterations run and last change (may be NULL)
         int (*wr_log)(const char*, ...),
         int (*wr_progress)(const int, ...)
         ) {
 
     float* u = NULL;
     float* u_new = NULL;
+    struct IterationInfo run;
 
     //float u_min = UCHAR_MAX;
     //float u_max = 0;
@@ -1641,7 +900,8 @@ int p3dAnisotropicDiffusionFilter3D_16(
     //float u_new_min = UCHAR_MAX;
     //float u_new_max = 0;
 
-    int ct, i, j, k;
+    int i, j, k;
+    long long ct;
     const int a_rad = 1;
     int a_dimx, a_dimy, a_dimz;
     
@@ -1661,6 +921,7 @@ int p3dAnisotropicDiffusionFilter3D_16(
         wr_log("\tMu: %d.", m);
         wr_log("\tSigma: %0.3f.", sigma);
         wr_log("\tNumber of iterations: %d.", iter);
+        if (tol > 0.0) wr_log("\tTolerance: %0.3f.", tol);
     }
 
     a_dimx = dimx + a_rad * 2;
@@ -1668,32 +929,40 @@ int p3dAnisotropicDiffusionFilter3D_16(
     a_dimz = dimz + a_rad * 2;
 
     // Allocate memory:
-    u = (float*) malloc(a_dimx * a_dimy * a_dimz * sizeof (float));
-    u_new = (float*) malloc(a_dimx * a_dimy * a_dimz * sizeof (float));
+    P3D_TRY(u = (float*) malloc((size_t) a_dimx * a_dimy * a_dimz * sizeof (float)));
+    P3D_TRY(u_new = (float*) malloc((size_t) a_dimx * a_dimy * a_dimz * sizeof (float)));
 
     _p3dReplicatePadding3D_ushort2float(in_im, u, dimx, dimy, dimz, a_rad);
 
     // Convert the input:
 #pragma omp parallel for
-    for (ct = 0; ct < (a_dimx * a_dimy * a_dimz); ct++) {
+    for (ct = 0; ct < ((long long) a_dimx * a_dimy * a_dimz); ct++) {
         u[ct] = u[ct] / USHRT_MAX;
         //u_min = MIN(u_min, u[ct]);
         //u_max = MAX(u_max, u[ct]);
     }
 
     // Call the 32 bit version:
-    _p3dAnisotropicDiffusionFilter3D_float(u,
+    P3D_TRY(_p3dAnisotropicDiffusionFilter3D_float(u,
             u_new,
             a_dimx,
             a_dimy,
             a_dimz,
+            a_rad,
             lambda,
             m,
             sigma,
             iter,
+            tol / USHRT_MAX,
+            &run,
             wr_log,
             wr_progress
-            );
+            ));
+
+    // Changes are reported in grey levels:
+    run.change *= USHRT_MAX;
+    if (info != NULL)
+        *info = run;
 
     // Convert the input:
     /*for (ct = 0; ct < (a_dimx * a_dimy * a_dimz); ct++) {
@@ -1720,6 +989,7 @@ int p3dAnisotropicDiffusionFilter3D_16(
 
     // Print elapsed time (if required):
     if (wr_log != NULL) {
+        wr_log("\tIterations run: %d (mean change: %0.4f).", run.iterations, run.change);
         wr_log("Pore3D - Anisotropic diffusion filter applied successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
     }
 
@@ -1751,4 +1021,140 @@ MEM_ERROR:
     }
 
     return P3D_AUTH_ERROR;*/
-}
\ No newline at end of file
+}
+
+int p3dAnisotropicDiffusionFilter3D_16(
+        unsigned short* in_im,
+        unsigned short* out_im,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int m,
+        const double lambda,
+        const double sigma,
+        const int iter,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    return p3dAnisotropicDiffusionFilter3D_16_tol(in_im, out_im, dimx, dimy, dimz, m, lambda, sigma, iter, 0.0, NULL, wr_log, wr_progress);
+}
+
+// Parameters of the filter applied to each slab by the streaming variant:
+struct ADParams {
+    int m;
+    double lambda;
+    double sigma;
+    int iter;
+};
+
+int _p3dAnisotropicDiffusionFilter3D_16_slab(void* in_im, void* out_im, const int dimx, const int dimy, const int dimz, void* params) {
+    struct ADParams* p = (struct ADParams*) params;
+
+    return p3dAnisotropicDiffusionFilter3D_16((unsigned short*) in_im, (unsigned short*) out_im, dimx, dimy, dimz,
+            p->m, p->lambda, p->sigma, p->iter, NULL, NULL);
+}
+
+// Out-of-core variant: the file is processed by slabs of SLAB slices with a
+// halo as thick as the slices reached by the iterations applied in a pass,
+// so that only a few slabs (plus the float workspace of the in-core filter)
+// are in memory at once. Each pass applies FUSE iterations to each slab
+// (temporal blocking): a larger FUSE means fewer reads and writes of the
+// whole volume but a thicker halo. Between passes the volume is stored as
+// 16-bit in two temporary files next to OUT_FILENAME.
+int p3dAnisotropicDiffusionFilter3D_16_stream(
+        char* in_filename,
+        char* out_filename,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int m,
+        const double lambda,
+        const double sigma,
+        const int iter,
+        const int flagLittle,
+        const int flagSigned,
+        const int slab, // IN: number of slices filtered at once
+        const int fuse, // IN: number of iterations applied in each pass
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    struct ADParams params;
+    char* tmp_name[2] = {NULL, NULL};
+    char* src;
+    char* dst;
+    int steps, done, pass, c;
+    int err = P3D_SUCCESS;
+
+    steps = MAX(MIN(fuse, iter), 1);
+
+    // Start tracking computational time:
+    if (wr_log != NULL) {
+        p3dResetStartTime();
+        wr_log("Pore3D - Applying anisotropic diffusion filter (streaming)...");
+        wr_log("\tLambda: %0.3f", lambda);
+        wr_log("\tMu: %d.", m);
+        wr_log("\tSigma: %0.3f.", sigma);
+        wr_log("\tNumber of iterations: %d.", iter);
+        wr_log("\tSlab size: %d.", slab);
+        wr_log("\tIterations per pass: %d (halo: %d slices).", steps, steps * _p3dAnisotropicDiffusionReach(sigma));
+    }
+
+    // Intermediate volumes are needed only with more than one pass:
+    if (iter > steps) {
+        for (c = 0; c < 2; c++) {
+            P3D_TRY(tmp_name[c] = (char*) malloc((strlen(out_filename) + 16) * sizeof (char)));
+            sprintf(tmp_name[c], "%s.p3dtmp%d", out_filename, c);
+        }
+    }
+
+    params.m = m;
+    params.lambda = lambda;
+    params.sigma = sigma;
+
+    src = in_filename;
+    done = 0;
+    pass = 0;
+    do {
+        params.iter = MIN(steps, iter - done);
+        done += MAX(params.iter, 0);
+        dst = (done >= iter) ? out_filename : tmp_name[pass % 2];
+
+        err = _p3dSlabFilter(src, dst, dimx, dimy, dimz, 2, flagLittle, flagSigned, slab,
+                MAX(params.iter, 0) * _p3dAnisotropicDiffusionReach(sigma),
+                _p3dAnisotropicDiffusionFilter3D_16_slab, (void*) &params, wr_log, NULL);
+        if (err != P3D_SUCCESS) break;
+
+        src = dst;
+        pass++;
+
+        // Update any progress counter:
+        if (wr_progress != NULL) wr_progress((int) ((double) done / MAX(iter, 1) * 100 + 0.5));
+    } while (done < iter);
+
+    // Print elapsed time (if required):
+    if ((wr_log != NULL) && (err == P3D_SUCCESS)) {
+        wr_log("Pore3D - Anisotropic diffusion filter applied successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
+    }
+
+    // Release resources:
+    for (c = 0; c < 2; c++) {
+        if (tmp_name[c] != NULL) {
+            remove(tmp_name[c]);
+            free(tmp_name[c]);
+        }
+    }
+
+    return err;
+
+MEM_ERROR:
+
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Not enough (contiguous) memory. Program will exit.");
+    }
+
+    // Release resources:
+    for (c = 0; c < 2; c++)
+        if (tmp_name[c] != NULL) free(tmp_name[c]);
+
+    return P3D_MEM_ERROR;
+}
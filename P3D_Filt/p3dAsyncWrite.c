@@ -0,0 +1,614 @@
+/***************************************************************************/
+/* (C) 2016 Elettra - Sincrotrone Trieste S.C.p.A.. All rights reserved.   */
+/*                                                                         */
+/*                                                                         */
+/* This file is part of Pore3D, a software library for quantitative        */
+/* analysis of 3D (volume) images.                                         */
+/*                                                                         */
+/* Pore3D is free software: you can redistribute it and/or modify it       */
+/* under the terms of the GNU General Public License as published by the   */
+/* Free Software Foundation, either version 3 of the License, or (at your  */
+/* option) any later version.                                              */
+/*                                                                         */
+/* Pore3D is distributed in the hope that it will be useful, but WITHOUT   */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or   */
+/* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License    */
+/* for more details.                                                       */
+/*                                                                         */
+/* You should have received a copy of the GNU General Public License       */
+/* along with Pore3D. If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                         */
+/***************************************************************************/
+
+//
+// Author: Francesco Brun
+// Last modified: October, 16th 2026
+//
+
+// Asynchronous (write-behind) output of RAW volumes. Buffers (a whole volume
+// or consecutive slabs of it) are queued and written by a background I/O
+// thread, so that the caller can go on with the next computation meanwhile.
+// Signed offset and byte swap are applied by the I/O thread on large aligned
+// staging buffers. With flagDirect set to P3D_TRUE the file is opened
+// bypassing the OS cache (O_DIRECT or FILE_FLAG_NO_BUFFERING), which avoids
+// evicting the working set when volumes larger than RAM are written; if the
+// file system does not support it, a cached write is silently performed.
+//
+// Submitted buffers are NOT copied: they must not be modified or released
+// until p3dAsyncWriterWait (or p3dAsyncWriterTest returning P3D_TRUE).
+
+#ifndef _WINDOWS
+	#define _GNU_SOURCE /* O_DIRECT */
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#ifdef _WINDOWS
+	#include <windows.h>
+	#include <malloc.h>
+#else
+	#include <sys/types.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <errno.h>
+	#ifndef O_DIRECT
+		#define O_DIRECT 0
+	#endif
+#endif
+
+#include "p3dFilt.h"
+#include "p3dTime.h"
+
+#include "Common/p3dEndianSwap.h"
+
+#define P3D_ASYNC_ALIGN     4096            /* Sector/page alignment for direct I/O */
+#define P3D_ASYNC_BUFFER    (8*1048576)     /* Staging buffer size (multiple of P3D_ASYNC_ALIGN) */
+#define P3D_ASYNC_QUEUE     64              /* Max number of pending buffers */
+#define P3D_ASYNC_MAXWRITE  (1024*1048576)  /* Max bytes per system write call */
+
+struct AsyncRequest {
+    void* im;
+    long long n; // number of voxels
+};
+
+struct AsyncWriter {
+    char* filename;
+    int dimx, dimy, dimz;
+    int bytes; // 1, 2 or 4
+    int flagLittle, flagSigned;
+    int flagConvert, flagDirect;
+
+#ifdef _WINDOWS
+    HANDLE hfile;
+#else
+    int fd;
+#endif
+
+    // Aligned staging buffer (used by the I/O thread only):
+    unsigned char* stage;
+    size_t fill;
+    long long size; // bytes of RAW data written so far
+
+    // Queue of pending buffers:
+    struct AsyncRequest queue[P3D_ASYNC_QUEUE];
+    int head, count;
+    int submitted; // number of slices already queued
+    int closing;
+    int err;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond_work; // signaled on new requests and on closing
+    pthread_cond_t cond_done; // signaled when a request has been written
+    pthread_t thread;
+    int running;
+};
+
+static void* _p3dAlignedMalloc(const size_t size) {
+#ifdef _WINDOWS
+    return _aligned_malloc(size, P3D_ASYNC_ALIGN);
+#else
+    void* ptr;
+
+    if (posix_memalign(&ptr, P3D_ASYNC_ALIGN, size) != 0)
+        return NULL;
+
+    return ptr;
+#endif
+}
+
+static void _p3dAlignedFree(void* ptr) {
+#ifdef _WINDOWS
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+static int _p3dAsyncFileOpen(struct AsyncWriter* w) {
+#ifdef _WINDOWS
+    if (w->flagDirect == P3D_TRUE) {
+        w->hfile = CreateFileA(w->filename, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_NO_BUFFERING | FILE_FLAG_WRITE_THROUGH, NULL);
+        if (w->hfile != INVALID_HANDLE_VALUE)
+            return P3D_SUCCESS;
+        w->flagDirect = P3D_FALSE;
+    }
+    w->hfile = CreateFileA(w->filename, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+    return (w->hfile != INVALID_HANDLE_VALUE) ? P3D_SUCCESS : P3D_IO_ERROR;
+#else
+    if ((w->flagDirect == P3D_TRUE) && (O_DIRECT != 0)) {
+        w->fd = open(w->filename, O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+        if (w->fd >= 0)
+            return P3D_SUCCESS;
+    }
+    w->flagDirect = P3D_FALSE;
+    w->fd = open(w->filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    return (w->fd >= 0) ? P3D_SUCCESS : P3D_IO_ERROR;
+#endif
+}
+
+static int _p3dAsyncFileWrite(struct AsyncWriter* w, const unsigned char* buf, size_t len) {
+    size_t chunk;
+
+    while (len > 0) {
+        chunk = (len < P3D_ASYNC_MAXWRITE) ? len : P3D_ASYNC_MAXWRITE;
+#ifdef _WINDOWS
+        {
+            DWORD written;
+
+            if ((WriteFile(w->hfile, buf, (DWORD) chunk, &written, NULL) == 0) || (written == 0))
+                return P3D_IO_ERROR;
+            chunk = (size_t) written;
+        }
+#else
+        {
+            ssize_t written = write(w->fd, buf, chunk);
+
+            if (written < 0) {
+                if (errno == EINTR)
+                    continue;
+                return P3D_IO_ERROR;
+            }
+            if (written == 0)
+                return P3D_IO_ERROR;
+            chunk = (size_t) written;
+        }
+#endif
+        buf += chunk;
+        len -= chunk;
+    }
+
+    return P3D_SUCCESS;
+}
+
+// Writes the staging buffer. With direct I/O only whole aligned blocks can be
+// written: the tail is zero padded and the file is truncated on closing.
+static int _p3dAsyncFlush(struct AsyncWriter* w, const int last) {
+    size_t len = w->fill;
+
+    if (len == 0)
+        return P3D_SUCCESS;
+
+    if (w->flagDirect == P3D_TRUE) {
+        if (last == P3D_TRUE) {
+            len = ((w->fill + P3D_ASYNC_ALIGN - 1) / P3D_ASYNC_ALIGN) * P3D_ASYNC_ALIGN;
+            memset(w->stage + w->fill, 0, len - w->fill);
+        } else {
+            // Keep the unaligned tail for the next request:
+            len = (w->fill / P3D_ASYNC_ALIGN) * P3D_ASYNC_ALIGN;
+            if (len == 0)
+                return P3D_SUCCESS;
+        }
+    }
+
+    if (_p3dAsyncFileWrite(w, w->stage, len) != P3D_SUCCESS)
+        return P3D_IO_ERROR;
+
+    if (len < w->fill)
+        memmove(w->stage, w->stage + len, w->fill - len);
+    w->fill = (len < w->fill) ? (w->fill - len) : 0;
+
+    return P3D_SUCCESS;
+}
+
+static int _p3dAsyncFileClose(struct AsyncWriter* w) {
+    int err = P3D_SUCCESS;
+
+#ifdef _WINDOWS
+    LARGE_INTEGER li;
+
+    if (w->hfile == INVALID_HANDLE_VALUE)
+        return P3D_IO_ERROR;
+    CloseHandle(w->hfile);
+    w->hfile = INVALID_HANDLE_VALUE;
+
+    // Remove the padding of the last direct write (the file pointer cannot be
+    // moved at unaligned offsets on unbuffered handles):
+    if (w->flagDirect == P3D_TRUE) {
+        w->hfile = CreateFileA(w->filename, GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (w->hfile == INVALID_HANDLE_VALUE)
+            return P3D_IO_ERROR;
+        li.QuadPart = w->size;
+        if ((SetFilePointerEx(w->hfile, li, NULL, FILE_BEGIN) == 0) || (SetEndOfFile(w->hfile) == 0))
+            err = P3D_IO_ERROR;
+        CloseHandle(w->hfile);
+        w->hfile = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (w->fd < 0)
+        return P3D_IO_ERROR;
+
+    if ((w->flagDirect == P3D_TRUE) && (ftruncate(w->fd, (off_t) w->size) != 0))
+        err = P3D_IO_ERROR;
+    if (close(w->fd) != 0)
+        err = P3D_IO_ERROR;
+    w->fd = -1;
+#endif
+
+    return err;
+}
+
+// Writes one queued buffer (I/O thread):
+static int _p3dAsyncWriteRequest(struct AsyncWriter* w, struct AsyncRequest* req) {
+    const unsigned char* src = (const unsigned char*) req->im;
+    const long long n = req->n;
+    long long ct, chunk;
+
+    // Cached writes without conversion go straight from the caller's buffer:
+    if ((w->flagConvert == P3D_FALSE) && (w->flagDirect == P3D_FALSE)) {
+        if (_p3dAsyncFileWrite(w, src, (size_t) n * w->bytes) != P3D_SUCCESS)
+            return P3D_IO_ERROR;
+        w->size += n * w->bytes;
+
+        return P3D_SUCCESS;
+    }
+
+    for (ct = 0; ct < n; ct += chunk) {
+        chunk = (long long) ((P3D_ASYNC_BUFFER - w->fill) / w->bytes);
+        chunk = ((n - ct) < chunk) ? (n - ct) : chunk;
+
+        if ((w->flagConvert == P3D_TRUE) && (w->bytes == 2)) {
+            p3dRawEncode16((unsigned short*) (w->stage + w->fill), ((const unsigned short*) src) + ct, (size_t) chunk,
+                    (w->flagLittle == P3D_FALSE), (w->flagSigned == P3D_TRUE));
+        } else if ((w->flagConvert == P3D_TRUE) && (w->bytes == 4)) {
+            p3dRawEncode32((unsigned int*) (w->stage + w->fill), ((const unsigned int*) src) + ct, (size_t) chunk,
+                    (w->flagLittle == P3D_FALSE), (w->flagSigned == P3D_TRUE));
+        } else {
+            memcpy(w->stage + w->fill, src + ct * w->bytes, (size_t) chunk * w->bytes);
+        }
+        w->fill += (size_t) chunk * w->bytes;
+        w->size += chunk * w->bytes;
+
+        if ((w->fill == P3D_ASYNC_BUFFER) || (w->flagDirect == P3D_FALSE)) {
+            if (_p3dAsyncFlush(w, P3D_FALSE) != P3D_SUCCESS)
+                return P3D_IO_ERROR;
+        }
+    }
+
+    return P3D_SUCCESS;
+}
+
+static void* _p3dAsyncWriterThread(void* args) {
+    struct AsyncWriter* w = (struct AsyncWriter*) args;
+    struct AsyncRequest req;
+    int err;
+
+    for (;;) {
+        pthread_mutex_lock(&(w->mutex));
+        while ((w->count == 0) && (w->closing == P3D_FALSE))
+            pthread_cond_wait(&(w->cond_work), &(w->mutex));
+        if (w->count == 0) {
+            pthread_mutex_unlock(&(w->mutex));
+            break;
+        }
+        req = w->queue[w->head];
+        err = w->err;
+        pthread_mutex_unlock(&(w->mutex));
+
+        // After an error the remaining requests are just dequeued:
+        if (err == P3D_SUCCESS)
+            err = _p3dAsyncWriteRequest(w, &req);
+
+        pthread_mutex_lock(&(w->mutex));
+        w->err = err;
+        w->head = (w->head + 1) % P3D_ASYNC_QUEUE;
+        w->count--;
+        pthread_cond_broadcast(&(w->cond_done));
+        pthread_mutex_unlock(&(w->mutex));
+    }
+
+    // Last (padded) block and file closing:
+    err = w->err;
+    if (err == P3D_SUCCESS)
+        err = _p3dAsyncFlush(w, P3D_TRUE);
+    if (_p3dAsyncFileClose(w) != P3D_SUCCESS)
+        err = P3D_IO_ERROR;
+    w->err = err;
+
+    return NULL;
+}
+
+static void _p3dAsyncWriterFree(struct AsyncWriter* w) {
+    if (w->stage != NULL) _p3dAlignedFree(w->stage);
+    if (w->filename != NULL) free(w->filename);
+    free(w);
+}
+
+int p3dAsyncWriterOpen(
+        char* filename,
+        struct AsyncWriter** writer,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int bytes, // IN: 1, 2 or 4
+        const int flagLittle,
+        const int flagSigned,
+        const int flagDirect, // IN: P3D_TRUE to bypass the OS cache
+        int (*wr_log)(const char*, ...)
+        ) {
+    struct AsyncWriter* w = NULL;
+
+    (*writer) = NULL;
+
+    P3D_TRY(w = (struct AsyncWriter*) calloc(1, sizeof (struct AsyncWriter)));
+
+    w->dimx = dimx;
+    w->dimy = dimy;
+    w->dimz = dimz;
+    w->bytes = ((bytes == 2) || (bytes == 4)) ? bytes : 1;
+    w->flagLittle = flagLittle;
+    w->flagSigned = flagSigned;
+    w->flagConvert = ((w->bytes > 1) && ((flagLittle == P3D_FALSE) || (flagSigned == P3D_TRUE))) ? P3D_TRUE : P3D_FALSE;
+    w->flagDirect = (flagDirect == P3D_TRUE) ? P3D_TRUE : P3D_FALSE;
+    w->err = P3D_SUCCESS;
+    w->closing = P3D_FALSE;
+#ifdef _WINDOWS
+    w->hfile = INVALID_HANDLE_VALUE;
+#else
+    w->fd = -1;
+#endif
+
+    P3D_TRY(w->filename = (char*) malloc((strlen(filename) + 1) * sizeof (char)));
+    strcpy(w->filename, filename);
+
+    // Get a handler for the output file:
+    if (_p3dAsyncFileOpen(w) != P3D_SUCCESS) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - IO error: cannot open output file %s. Program will exit.", filename);
+        }
+        _p3dAsyncWriterFree(w);
+
+        return P3D_IO_ERROR;
+    }
+
+    if ((w->flagConvert == P3D_TRUE) || (w->flagDirect == P3D_TRUE)) {
+        P3D_TRY(w->stage = (unsigned char*) _p3dAlignedMalloc(P3D_ASYNC_BUFFER));
+    }
+
+    pthread_mutex_init(&(w->mutex), NULL);
+    pthread_cond_init(&(w->cond_work), NULL);
+    pthread_cond_init(&(w->cond_done), NULL);
+
+    if (pthread_create(&(w->thread), NULL, _p3dAsyncWriterThread, (void*) w) != 0) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - IO error: cannot start I/O thread for file %s. Program will exit.", filename);
+        }
+        _p3dAsyncFileClose(w);
+        pthread_mutex_destroy(&(w->mutex));
+        pthread_cond_destroy(&(w->cond_work));
+        pthread_cond_destroy(&(w->cond_done));
+        _p3dAsyncWriterFree(w);
+
+        return P3D_IO_ERROR;
+    }
+    w->running = P3D_TRUE;
+
+    (*writer) = w;
+
+    return P3D_SUCCESS;
+
+MEM_ERROR:
+
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Not enough (contiguous) memory. Program will exit.");
+    }
+
+    // Release resources:
+    if (w != NULL) {
+        _p3dAsyncFileClose(w);
+        _p3dAsyncWriterFree(w);
+    }
+
+    return P3D_MEM_ERROR;
+}
+
+// Queues NSLICES slices stored in IN_IM (blocks if too many buffers are
+// pending). The buffer must be kept unchanged until the write completes.
+int p3dAsyncWriterSubmit(
+        struct AsyncWriter* w,
+        void* in_im,
+        const int nslices
+        ) {
+    int err;
+
+    if ((nslices < 0) || ((w->submitted + nslices) > w->dimz))
+        return P3D_IO_ERROR;
+
+    if (nslices == 0)
+        return P3D_SUCCESS;
+
+    pthread_mutex_lock(&(w->mutex));
+    while ((w->count == P3D_ASYNC_QUEUE) && (w->err == P3D_SUCCESS))
+        pthread_cond_wait(&(w->cond_done), &(w->mutex));
+
+    err = w->err;
+    if (err == P3D_SUCCESS) {
+        w->queue[(w->head + w->count) % P3D_ASYNC_QUEUE].im = in_im;
+        w->queue[(w->head + w->count) % P3D_ASYNC_QUEUE].n = (long long) w->dimx * w->dimy * nslices;
+        w->count++;
+        w->submitted += nslices;
+        pthread_cond_signal(&(w->cond_work));
+    }
+    pthread_mutex_unlock(&(w->mutex));
+
+    return err;
+}
+
+// Returns P3D_TRUE if all the queued buffers have been written (so they can
+// be reused), P3D_FALSE otherwise. It never blocks.
+int p3dAsyncWriterTest(
+        struct AsyncWriter* w
+        ) {
+    int done;
+
+    pthread_mutex_lock(&(w->mutex));
+    done = (w->count == 0) ? P3D_TRUE : P3D_FALSE;
+    pthread_mutex_unlock(&(w->mutex));
+
+    return done;
+}
+
+// Waits for all the queued buffers to be written, closes the file and
+// releases the writer. Returns P3D_IO_ERROR if any write failed or if fewer
+// than DIMZ slices have been submitted.
+int p3dAsyncWriterWait(
+        struct AsyncWriter* w
+        ) {
+    int err;
+
+    if (w == NULL)
+        return P3D_SUCCESS;
+
+    pthread_mutex_lock(&(w->mutex));
+    w->closing = P3D_TRUE;
+    pthread_cond_signal(&(w->cond_work));
+    pthread_mutex_unlock(&(w->mutex));
+
+    if (w->running == P3D_TRUE)
+        pthread_join(w->thread, NULL);
+
+    err = ((w->err != P3D_SUCCESS) || (w->submitted != w->dimz)) ? P3D_IO_ERROR : P3D_SUCCESS;
+
+    pthread_mutex_destroy(&(w->mutex));
+    pthread_cond_destroy(&(w->cond_work));
+    pthread_cond_destroy(&(w->cond_done));
+    _p3dAsyncWriterFree(w);
+
+    return err;
+}
+
+int p3dAsyncWriteRaw8(
+        unsigned char* in_im,
+        char* filename,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int flagDirect,
+        struct AsyncWriter** handle, // OUT: completion handle for p3dAsyncWriterWait
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    int err;
+
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Writing 8-bit RAW file %s in background ...", filename);
+        if (flagDirect == P3D_TRUE)
+            wr_log("\tDirect I/O: Yes.");
+    }
+
+    P3D_TRY(err = p3dAsyncWriterOpen(filename, handle, dimx, dimy, dimz, 1, P3D_TRUE, P3D_FALSE, flagDirect, wr_log));
+    if (err != P3D_SUCCESS)
+        return err;
+
+    return p3dAsyncWriterSubmit(*handle, (void*) in_im, dimz);
+
+MEM_ERROR:
+
+    return P3D_MEM_ERROR;
+}
+
+int p3dAsyncWriteRaw16(
+        unsigned short* in_im,
+        char* filename,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int flagLittle,
+        const int flagSigned,
+        const int flagDirect,
+        struct AsyncWriter** handle, // OUT: completion handle for p3dAsyncWriterWait
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    int err;
+
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Writing 16-bit RAW file %s in background ...", filename);
+        if (flagSigned == P3D_TRUE)
+            wr_log("\tSigned/Unsigned: Signed.");
+        else
+            wr_log("\tSigned/Unsigned: Unsigned.");
+        if (flagLittle == P3D_TRUE)
+            wr_log("\tLittle/Big Endian: Little.");
+        else
+            wr_log("\tLittle/Big Endian: Big.");
+        if (flagDirect == P3D_TRUE)
+            wr_log("\tDirect I/O: Yes.");
+    }
+
+    P3D_TRY(err = p3dAsyncWriterOpen(filename, handle, dimx, dimy, dimz, 2, flagLittle, flagSigned, flagDirect, wr_log));
+    if (err != P3D_SUCCESS)
+        return err;
+
+    return p3dAsyncWriterSubmit(*handle, (void*) in_im, dimz);
+
+MEM_ERROR:
+
+    return P3D_MEM_ERROR;
+}
+
+int p3dAsyncWriteRaw32(
+        unsigned int* in_im,
+        char* filename,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int flagLittle,
+        const int flagSigned,
+        const int flagDirect,
+        struct AsyncWriter** handle, // OUT: completion handle for p3dAsyncWriterWait
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    int err;
+
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Writing 32-bit RAW file %s in background ...", filename);
+        if (flagSigned == P3D_TRUE)
+            wr_log("\tSigned/Unsigned: Signed.");
+        else
+            wr_log("\tSigned/Unsigned: Unsigned.");
+        if (flagLittle == P3D_TRUE)
+            wr_log("\tLittle/Big Endian: Little.");
+        else
+            wr_log("\tLittle/Big Endian: Big.");
+        if (flagDirect == P3D_TRUE)
+            wr_log("\tDirect I/O: Yes.");
+    }
+
+    P3D_TRY(err = p3dAsyncWriterOpen(filename, handle, dimx, dimy, dimz, 4, flagLittle, flagSigned, flagDirect, wr_log));
+    if (err != P3D_SUCCESS)
+        return err;
+
+    return p3dAsyncWriterSubmit(*handle, (void*) in_im, dimz);
+
+MEM_ERROR:
+
+    return P3D_MEM_ERROR;
+}
@@ -22,7 +22,7 @@
 
 //
 // Author: Francesco Brun
-// Last modified: Sept, 28th 2016
+// Last modified: October, 16th 2026
 //
 
 #include <stdlib.h>
@@ -30,11 +30,69 @@
 #include <stdio.h>
 #include <omp.h>
 #include <limits.h>
+#include <math.h>
 
 #include "p3dFilt.h"
 #include "p3dTime.h"
 
-int p3dBilateralFilter3D_8(
+#include "Common/p3dClampIndex.h"
+
+// Range (in units of sigma_r) and maximum size of the 16-bit range lookup
+// table:
+#define P3D_BILATERAL_RANGE	6.0
+#define P3D_BILATERAL_LUT	4096
+
+// Bilateral grid: empty cells around the data (half the width of the 5-tap
+// blurring kernel) and number of samples blurred at once along each line:
+#define P3D_GRID_PAD		2
+#define P3D_GRID_BLOCK		256
+
+// Minimum width of a spatial cell of the bilateral grid (in voxels) and
+// kernel radius (in units of sigma_d) of the lookup-table filter used when
+// the grid would not be smaller than the volume:
+#define P3D_GRID_MINCELL	4.0
+#define P3D_GRID_LUT_RAD	2.0
+
+// Blurs the grid with the binomial kernel [1 4 6 4 1]/16 (i.e. a gaussian
+// with unit variance in grid cells) along one axis. The grid is seen as OUTER
+// blocks of LEN rows of STRIDE samples, the axis running across rows. Each
+// thread keeps copies of the two previous input rows of a strip of
+// P3D_GRID_BLOCK samples, so the blur is in place:
+static void _p3dBilateralGridBlur(float* grid, const size_t len, const size_t stride, const size_t outer) {
+    float p1[P3D_GRID_BLOCK], p2[P3D_GRID_BLOCK], cur[P3D_GRID_BLOCK];
+    float* row;
+    float n1, n2;
+    long long nb, b;
+    size_t e, q, q0, w, o;
+
+    nb = (long long) ((stride + P3D_GRID_BLOCK - 1) / P3D_GRID_BLOCK);
+
+#pragma omp parallel for private(p1, p2, cur, row, n1, n2, e, q, q0, w, o)
+    for (b = 0; b < ((long long) outer * nb); b++) {
+        o = (size_t) (b / nb);
+        q0 = (size_t) (b % nb) * P3D_GRID_BLOCK;
+        w = MIN(P3D_GRID_BLOCK, stride - q0);
+
+        for (q = 0; q < w; q++)
+            p1[q] = p2[q] = 0.0f;
+
+        for (e = 0; e < len; e++) {
+            row = grid + (o * len + e) * stride + q0;
+
+            for (q = 0; q < w; q++) {
+                cur[q] = row[q];
+                n1 = ((e + 1) < len) ? row[q + stride] : 0.0f;
+                n2 = ((e + 2) < len) ? row[q + 2 * stride] : 0.0f;
+
+                row[q] = (p2[q] + 4.0f * p1[q] + 6.0f * cur[q] + 4.0f * n1 + n2) / 16.0f;
+                p2[q] = p1[q];
+                p1[q] = cur[q];
+            }
+        }
+    }
+}
+
+int p3dBilateralFilter3D_8_tol(
         unsigned char* in_im,
         unsigned char* out_im,
         const int dimx,
@@ -44,25 +102,39 @@ int p3dBilateralFilter3D_8(
         const double sigma_d,
         const double sigma_r,
         const int iter,
+        const double tol, // IN: mean absolute change below which iterations stop (0: no check)
+        struct IterationInfo* info, // OUT: iterations run and last change (may be NULL)
         int (*wr_log)(const char*, ...),
         int (*wr_progress)(const int, ...)
         ) {
-    // Temporary padded input-volume:
-    unsigned char* tmp_im;
-    unsigned char* tmp_im2;
+    // Temporary volume for iterations (no padding is needed since borders are
+    // handled by clamping coordinates):
+    unsigned char* tmp_im = NULL;
+    unsigned char* src_im;
+    unsigned char* dst_im;
+    int* cx = NULL;
+    int* cy = NULL;
+    int* cz = NULL;
+
+    // Lookup tables of the spatial weights (one for each kernel position) and
+    // of the range weights (one for each absolute difference):
+    float* d_lut = NULL;
+    float* r_lut = NULL;
 
-    int a_dimx, a_dimy, a_dimz;
     int i, j, k;
     int x, y, z;
-    int ct;
+    int ct, t, v, c, inner;
 
     // Variables for computing gaussian kernel:
-    int a_rad;
+    int a_rad, a_size;
     double tmp;
 
     // Variables for filter management:
     double w, sum_f, sum_fi;
 
+    // Sum of the absolute changes of an iteration:
+    double diff = 0.0;
+
     /*char auth_code;
 
     //
@@ -79,74 +151,119 @@ int p3dBilateralFilter3D_8(
         wr_log("\tDomain sigma: %0.3f.", sigma_d);
         wr_log("\tRange sigma: %0.3f.", sigma_r);
         wr_log("\tNumber of iterations: %d.", iter);
+        if (tol > 0.0) wr_log("\tTolerance: %0.3f.", tol);
     }
 
 
     // Init variables:
     a_rad = size / 2; // integer division
-
-    // Compute dimensions of padded REV:
-    a_dimx = dimx + a_rad * 2;
-    a_dimy = dimy + a_rad * 2;
-    a_dimz = dimz + a_rad * 2;
+    a_size = 2 * a_rad + 1;
 
     // Try to allocate memory:
-    P3D_TRY(tmp_im = (unsigned char*) malloc(a_dimx * a_dimy * a_dimz * sizeof (unsigned char)));
-    P3D_TRY(tmp_im2 = (unsigned char*) malloc(a_dimx * a_dimy * a_dimz * sizeof (unsigned char)));
-    P3D_TRY(p3dReplicatePadding3D_8(in_im, tmp_im, dimx, dimy, dimz, a_rad, NULL, NULL));
+    if (iter > 1) {
+        P3D_TRY(tmp_im = (unsigned char*) malloc((size_t) dimx * dimy * dimz * sizeof (unsigned char)));
+    }
+    P3D_TRY(cx = p3dClampTable(dimx, a_rad));
+    P3D_TRY(cy = p3dClampTable(dimy, a_rad));
+    P3D_TRY(cz = p3dClampTable(dimz, a_rad));
+    P3D_TRY(d_lut = (float*) malloc((size_t) a_size * a_size * a_size * sizeof (float)));
+    P3D_TRY(r_lut = (float*) malloc((UCHAR_MAX + 1) * sizeof (float)));
 
+    // Compute lookup tables:
+    t = 0;
+    for (z = -a_rad; z <= a_rad; z++)
+        for (y = -a_rad; y <= a_rad; y++)
+            for (x = -a_rad; x <= a_rad; x++)
+                d_lut[t++] = (float) exp(-(x * x + y * y + z * z) / (2.0 * sigma_d * sigma_d));
+    for (t = 0; t <= UCHAR_MAX; t++)
+        r_lut[t] = (float) exp(-(t * t) / (2.0 * sigma_r * sigma_r));
+
+    if (iter < 1)
+        memcpy(out_im, in_im, (size_t) dimx * dimy * dimz * sizeof (unsigned char));
+
+    // Iterations alternate between OUT_IM and TMP_IM so that the last one
+    // writes OUT_IM (if all of them are run):
+    src_im = in_im;
     for (ct = 0; ct < iter; ct++) {
+        dst_im = (((iter - 1 - ct) % 2) == 0) ? out_im : tmp_im;
+        diff = 0.0;
+
         // Volume scanning:
-#pragma omp parallel for private(i, j, x, y, z, sum_f, sum_fi, w)
-        for (k = a_rad; k < (a_dimz - a_rad); k++)
-            for (j = a_rad; j < (a_dimy - a_rad); j++)
-                for (i = a_rad; i < (a_dimx - a_rad); i++) {
+#pragma omp parallel for reduction(+ : diff) private(i, j, x, y, z, t, sum_f, sum_fi, w, v, c, inner, tmp)
+        for (k = 0; k < dimz; k++)
+            for (j = 0; j < dimy; j++)
+                for (i = 0; i < dimx; i++) {
                     // Init variables:
                     sum_f = 0.0;
                     sum_fi = 0.0;
+                    c = src_im[ I(i, j, k, dimx, dimy) ];
+
+                    // Interior voxels read the kernel directly, the others
+                    // through clamped coordinates:
+                    inner = (i >= a_rad) && (i < (dimx - a_rad)) && (j >= a_rad) && (j < (dimy - a_rad)) &&
+                            (k >= a_rad) && (k < (dimz - a_rad));
 
                     // Convolve (i,j,k) voxel:
+                    t = 0;
                     for (z = (k - a_rad); z <= (k + a_rad); z++)
                         for (y = (j - a_rad); y <= (j + a_rad); y++)
                             for (x = (i - a_rad); x <= (i + a_rad); x++) {
+                                v = (inner) ? src_im[ I(x, y, z, dimx, dimy) ] :
+                                        src_im[ I(cx[x], cy[y], cz[z], dimx, dimy) ];
+
                                 // Gaussian intensity weights:
-                                w = exp(-(
-                                        (tmp_im[ I(x, y, z, a_dimx, a_dimy) ] - tmp_im [ I(i, j, k, a_dimx, a_dimy) ])*
-                                        (tmp_im[ I(x, y, z, a_dimx, a_dimy) ] - tmp_im [ I(i, j, k, a_dimx, a_dimy) ]) /
-                                        (2.0 * sigma_r * sigma_r))
-                                        - ((x - i)*(x - i) + (y - j)*(y - j) + (z - k)*(z - k)) / (2.0 * sigma_d * sigma_d)
-                                        );
+                                w = d_lut[t++] * r_lut[ abs(v - c) ];
 
                                 // Bilateral filter response:
                                 sum_f  += w;
-                                sum_fi += w * tmp_im[ I(x, y, z, a_dimx, a_dimy) ];      
+                                sum_fi += w * v;
                             }
 
-                    // Set out voxel:                    
-                    if ((sum_fi / sum_f) < 0)
-                        tmp_im2[ I(i, j, k, a_dimx, a_dimy) ] = 0;
+                    // Set out voxel and accumulate its change:
+                    tmp = sum_fi / sum_f;
+                    if (tmp < 0)
+                        v = 0;
                     else if (tmp > UCHAR_MAX)
-                        tmp_im2[ I(i, j, k, a_dimx, a_dimy) ] = UCHAR_MAX;
+                        v = UCHAR_MAX;
                     else
-                        tmp_im2[ I(i, j, k, a_dimx, a_dimy) ] = (unsigned char) (sum_fi / sum_f);
+                        v = (int) tmp;
+                    dst_im[ I(i, j, k, dimx, dimy) ] = (unsigned char) v;
+                    diff += abs(v - c);
                 }
 
         // Prepare for next iteration:
-        memcpy(tmp_im, tmp_im2, a_dimx * a_dimy * a_dimz * sizeof (unsigned char));
+        src_im = dst_im;
+
+        // Stop when the mean change drops below the tolerance:
+        if ((tol > 0.0) && ((diff / ((double) dimx * dimy * dimz)) <= tol)) {
+            ct++;
+            break;
+        }
     }
 
-    // Crop image:
-    P3D_TRY(p3dCrop3D_8(tmp_im2, out_im, a_dimx, a_dimy, a_dimz, a_rad, NULL, NULL));
+    // An early stop may leave the result in TMP_IM:
+    if ((ct > 0) && (src_im != out_im))
+        memcpy(out_im, src_im, (size_t) dimx * dimy * dimz * sizeof (unsigned char));
+
+    if (info != NULL) {
+        info->iterations = MAX(ct, 0);
+        info->change = (ct > 0) ? diff / ((double) dimx * dimy * dimz) : 0.0;
+    }
 
 
     // Print elapsed time (if required):
     if (wr_log != NULL) {
+        wr_log("\tIterations run: %d (mean change: %0.4f).", MAX(ct, 0), (ct > 0) ? diff / ((double) dimx * dimy * dimz) : 0.0);
         wr_log("Pore3D - Bilateral filter applied successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
     }
 
     // Release resources:
     if (tmp_im != NULL) free(tmp_im);
-    if (tmp_im2 != NULL) free(tmp_im2);
+    if (d_lut != NULL) free(d_lut);
+    if (r_lut != NULL) free(r_lut);
+    p3dClampTableFree(cx, a_rad);
+    p3dClampTableFree(cy, a_rad);
+    p3dClampTableFree(cz, a_rad);
 
     // Return success:
     return P3D_SUCCESS;
@@ -160,7 +277,11 @@ MEM_ERROR:
 
     // Release resources:	
     if (tmp_im != NULL) free(tmp_im);
-    if (tmp_im2 != NULL) free(tmp_im2);
+    if (d_lut != NULL) free(d_lut);
+    if (r_lut != NULL) free(r_lut);
+    p3dClampTableFree(cx, a_rad);
+    p3dClampTableFree(cy, a_rad);
+    p3dClampTableFree(cz, a_rad);
 
     // Return error:
     return P3D_MEM_ERROR;
@@ -174,7 +295,23 @@ MEM_ERROR:
     return P3D_AUTH_ERROR;*/
 }
 
-int p3dBilateralFilter3D_16(
+int p3dBilateralFilter3D_8(
+        unsigned char* in_im,
+        unsigned char* out_im,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int size,
+        const double sigma_d,
+        const double sigma_r,
+        const int iter,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    return p3dBilateralFilter3D_8_tol(in_im, out_im, dimx, dimy, dimz, size, sigma_d, sigma_r, iter, 0.0, NULL, wr_log, wr_progress);
+}
+
+int p3dBilateralFilter3D_16_tol(
         unsigned short* in_im,
         unsigned short* out_im,
         const int dimx,
@@ -184,25 +321,43 @@ int p3dBilateralFilter3D_16(
         const double sigma_d,
         const double sigma_r,
         const int iter,
+        const double tol, // IN: mean absolute change below which iterations stop (0: no check)
+        struct IterationInfo* info, // OUT: iterations run and last change (may be NULL)
         int (*wr_log)(const char*, ...),
         int (*wr_progress)(const int, ...)
         ) {
-    // Temporary padded input-volume:
-    unsigned short* tmp_im;
-    unsigned short* tmp_im2;
+    // Temporary volume for iterations (no padding is needed since borders are
+    // handled by clamping coordinates):
+    unsigned short* tmp_im = NULL;
+    unsigned short* src_im;
+    unsigned short* dst_im;
+    int* cx = NULL;
+    int* cy = NULL;
+    int* cz = NULL;
+
+    // Lookup tables of the spatial weights (one for each kernel position) and
+    // of the range weights. The latter covers absolute differences up to
+    // P3D_BILATERAL_RANGE * sigma_r (beyond the weight is taken as zero),
+    // quantized in bins of 2^r_shift levels so that it has at most
+    // P3D_BILATERAL_LUT entries:
+    float* d_lut = NULL;
+    float* r_lut = NULL;
+    int r_shift, r_len;
 
-    int a_dimx, a_dimy, a_dimz;
     int i, j, k;
     int x, y, z;
-    int ct;
+    int ct, t, v, c, d, inner;
 
     // Variables for computing gaussian kernel:
-    int a_rad;
+    int a_rad, a_size;
     double tmp;
 
     // Variables for filter management:
     double w, sum_f, sum_fi;
 
+    // Sum of the absolute changes of an iteration:
+    double diff = 0.0;
+
     /*char auth_code;
 
     //
@@ -219,74 +374,125 @@ int p3dBilateralFilter3D_16(
         wr_log("\tDomain sigma: %0.3f.", sigma_d);
         wr_log("\tRange sigma: %0.3f.", sigma_r);
         wr_log("\tNumber of iterations: %d.", iter);
+        if (tol > 0.0) wr_log("\tTolerance: %0.3f.", tol);
     }
 
 
     // Init variables:
-    a_rad = size / 2; // integer division   
-
-    // Compute dimensions of padded REV:
-    a_dimx = dimx + a_rad * 2;
-    a_dimy = dimy + a_rad * 2;
-    a_dimz = dimz + a_rad * 2;
+    a_rad = size / 2; // integer division
+    a_size = 2 * a_rad + 1;
 
     // Try to allocate memory:
-    P3D_TRY(tmp_im = (unsigned short*) malloc(a_dimx * a_dimy * a_dimz * sizeof (unsigned short)));
-    P3D_TRY(tmp_im2 = (unsigned short*) malloc(a_dimx * a_dimy * a_dimz * sizeof (unsigned short)));
-    P3D_TRY(p3dReplicatePadding3D_16(in_im, tmp_im, dimx, dimy, dimz, a_rad, NULL, NULL));
+    if (iter > 1) {
+        P3D_TRY(tmp_im = (unsigned short*) malloc((size_t) dimx * dimy * dimz * sizeof (unsigned short)));
+    }
+    P3D_TRY(cx = p3dClampTable(dimx, a_rad));
+    P3D_TRY(cy = p3dClampTable(dimy, a_rad));
+    P3D_TRY(cz = p3dClampTable(dimz, a_rad));
+    r_len = (int) MIN(ceil(P3D_BILATERAL_RANGE * sigma_r), USHRT_MAX) + 1;
+    for (r_shift = 0; (r_len >> r_shift) > P3D_BILATERAL_LUT; r_shift++);
+    r_len = ((r_len - 1) >> r_shift) + 1;
+
+    P3D_TRY(d_lut = (float*) malloc((size_t) a_size * a_size * a_size * sizeof (float)));
+    P3D_TRY(r_lut = (float*) malloc(r_len * sizeof (float)));
 
+    // Compute lookup tables (range bins are sampled at their center):
+    t = 0;
+    for (z = -a_rad; z <= a_rad; z++)
+        for (y = -a_rad; y <= a_rad; y++)
+            for (x = -a_rad; x <= a_rad; x++)
+                d_lut[t++] = (float) exp(-(x * x + y * y + z * z) / (2.0 * sigma_d * sigma_d));
+    for (t = 0; t < r_len; t++) {
+        tmp = (t << r_shift) + ((1 << r_shift) - 1) / 2.0;
+        r_lut[t] = (float) exp(-(tmp * tmp) / (2.0 * sigma_r * sigma_r));
+    }
+
+    if (iter < 1)
+        memcpy(out_im, in_im, (size_t) dimx * dimy * dimz * sizeof (unsigned short));
+
+    // Iterations alternate between OUT_IM and TMP_IM so that the last one
+    // writes OUT_IM (if all of them are run):
+    src_im = in_im;
     for (ct = 0; ct < iter; ct++) {
+        dst_im = (((iter - 1 - ct) % 2) == 0) ? out_im : tmp_im;
+        diff = 0.0;
+
         // Volume scanning:
-#pragma omp parallel for private(i, j, x, y, z, sum_f, sum_fi, w, tmp)
-        for (k = a_rad; k < (a_dimz - a_rad); k++)
-            for (j = a_rad; j < (a_dimy - a_rad); j++)
-                for (i = a_rad; i < (a_dimx - a_rad); i++) {
+#pragma omp parallel for reduction(+ : diff) private(i, j, x, y, z, t, sum_f, sum_fi, w, v, c, d, inner, tmp)
+        for (k = 0; k < dimz; k++)
+            for (j = 0; j < dimy; j++)
+                for (i = 0; i < dimx; i++) {
                     // Init variables:
                     sum_f = 0.0;
                     sum_fi = 0.0;
+                    c = src_im[ I(i, j, k, dimx, dimy) ];
+
+                    // Interior voxels read the kernel directly, the others
+                    // through clamped coordinates:
+                    inner = (i >= a_rad) && (i < (dimx - a_rad)) && (j >= a_rad) && (j < (dimy - a_rad)) &&
+                            (k >= a_rad) && (k < (dimz - a_rad));
 
                     // Convolve (i,j,k) voxel:
+                    t = 0;
                     for (z = (k - a_rad); z <= (k + a_rad); z++)
                         for (y = (j - a_rad); y <= (j + a_rad); y++)
                             for (x = (i - a_rad); x <= (i + a_rad); x++) {
+                                v = (inner) ? src_im[ I(x, y, z, dimx, dimy) ] :
+                                        src_im[ I(cx[x], cy[y], cz[z], dimx, dimy) ];
+
                                 // Gaussian intensity weights:
-                                w = exp(-(
-                                        (tmp_im[ I(x, y, z, a_dimx, a_dimy) ] - tmp_im [ I(i, j, k, a_dimx, a_dimy) ])*
-                                        (tmp_im[ I(x, y, z, a_dimx, a_dimy) ] - tmp_im [ I(i, j, k, a_dimx, a_dimy) ]) /
-                                        (2.0 * sigma_r * sigma_r))
-                                        - ((x - i)*(x - i) + (y - j)*(y - j) + (z - k)*(z - k)) / (2.0 * sigma_d * sigma_d)
-                                        );
+                                w = d_lut[t++] * (((d = (abs(v - c) >> r_shift)) < r_len) ? r_lut[d] : 0.0f);
 
                                 // Bilateral filter response:
                                 sum_f  += w;
-                                sum_fi += w * tmp_im[ I(x, y, z, a_dimx, a_dimy) ];      
+                                sum_fi += w * v;
                             }
 
-                    // Set out voxel:                    
-                    if ((sum_fi / sum_f) < 0)
-                        tmp_im2[ I(i, j, k, a_dimx, a_dimy) ] = 0;
+                    // Set out voxel and accumulate its change:
+                    tmp = sum_fi / sum_f;
+                    if (tmp < 0)
+                        v = 0;
                     else if (tmp > USHRT_MAX)
-                        tmp_im2[ I(i, j, k, a_dimx, a_dimy) ] = USHRT_MAX;
+                        v = USHRT_MAX;
                     else
-                        tmp_im2[ I(i, j, k, a_dimx, a_dimy) ] = (unsigned short) (sum_fi / sum_f);
+                        v = (int) tmp;
+                    dst_im[ I(i, j, k, dimx, dimy) ] = (unsigned short) v;
+                    diff += abs(v - c);
                 }
 
         // Prepare for next iteration:
-        memcpy(tmp_im, tmp_im2, a_dimx * a_dimy * a_dimz * sizeof (unsigned short));
+        src_im = dst_im;
+
+        // Stop when the mean change drops below the tolerance:
+        if ((tol > 0.0) && ((diff / ((double) dimx * dimy * dimz)) <= tol)) {
+            ct++;
+            break;
+        }
     }
 
-    // Crop image:
-    P3D_TRY(p3dCrop3D_16(tmp_im2, out_im, a_dimx, a_dimy, a_dimz, a_rad, NULL, NULL));
+    // An early stop may leave the result in TMP_IM:
+    if ((ct > 0) && (src_im != out_im))
+        memcpy(out_im, src_im, (size_t) dimx * dimy * dimz * sizeof (unsigned short));
+
+    if (info != NULL) {
+        info->iterations = MAX(ct, 0);
+        info->change = (ct > 0) ? diff / ((double) dimx * dimy * dimz) : 0.0;
+    }
 
 
     // Print elapsed time (if required):
     if (wr_log != NULL) {
+        wr_log("\tIterations run: %d (mean change: %0.4f).", MAX(ct, 0), (ct > 0) ? diff / ((double) dimx * dimy * dimz) : 0.0);
         wr_log("Pore3D - Bilateral filter applied successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
     }
 
     // Release resources:
     if (tmp_im != NULL) free(tmp_im);
-    if (tmp_im2 != NULL) free(tmp_im2);
+    if (d_lut != NULL) free(d_lut);
+    if (r_lut != NULL) free(r_lut);
+    p3dClampTableFree(cx, a_rad);
+    p3dClampTableFree(cy, a_rad);
+    p3dClampTableFree(cz, a_rad);
 
     // Return success:
     return P3D_SUCCESS;
@@ -300,7 +506,11 @@ MEM_ERROR:
 
     // Release resources:	
     if (tmp_im != NULL) free(tmp_im);
-    if (tmp_im2 != NULL) free(tmp_im2);
+    if (d_lut != NULL) free(d_lut);
+    if (r_lut != NULL) free(r_lut);
+    p3dClampTableFree(cx, a_rad);
+    p3dClampTableFree(cy, a_rad);
+    p3dClampTableFree(cz, a_rad);
 
     // Return error:
     return P3D_MEM_ERROR;
@@ -314,3 +524,518 @@ MEM_ERROR:
     return P3D_AUTH_ERROR;*/
 }
 
+int p3dBilateralFilter3D_16(
+        unsigned short* in_im,
+        unsigned short* out_im,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int size,
+        const double sigma_d,
+        const double sigma_r,
+        const int iter,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    return p3dBilateralFilter3D_16_tol(in_im, out_im, dimx, dimy, dimz, size, sigma_d, sigma_r, iter, 0.0, NULL, wr_log, wr_progress);
+}
+
+int p3dBilateralGridFilter3D_8_tol(
+        unsigned char* in_im,
+        unsigned char* out_im,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const double sigma_d,
+        const double sigma_r,
+        const int iter,
+        const double tol, // IN: mean absolute change below which iterations stop (0: no check)
+        struct IterationInfo* info, // OUT: iterations run and last change (may be NULL)
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    // Temporary volume for iterations:
+    unsigned char* tmp_im = NULL;
+    unsigned char* src_im;
+    unsigned char* dst_im;
+
+    // Bilateral grid: each cell holds the sum of the values splatted into it
+    // and their number (i.e. a homogeneous value):
+    float* grid = NULL;
+    float* cell;
+    int gx, gy, gz, gr;
+    size_t g_size;
+
+    int i, j, k;
+    int x, y, z, r;
+    int ct, v, c, v_min, v_max, pl;
+    double s_d, s_r, fx, fy, fz, fr;
+    double wx, wy, wz, wr, w, sum_f, sum_fi;
+    double tmp;
+
+    // Sum of the absolute changes of an iteration:
+    double diff = 0.0;
+
+
+    // Start tracking computational time:
+    if (wr_log != NULL) {
+        p3dResetStartTime();
+        wr_log("Pore3D - Applying bilateral filter (bilateral grid)...");
+        wr_log("\tDomain sigma: %0.3f.", sigma_d);
+        wr_log("\tRange sigma: %0.3f.", sigma_r);
+        wr_log("\tNumber of iterations: %d.", iter);
+        if (tol > 0.0) wr_log("\tTolerance: %0.3f.", tol);
+    }
+
+    // The grid is sampled every sigma (spatial cells span at least
+    // P3D_GRID_MINCELL voxels, range cells at least one grey level):
+    s_d = MAX(sigma_d, P3D_GRID_MINCELL);
+    s_r = MAX(sigma_r, 1.0);
+
+    // The range axis only spans the values actually present (the output of
+    // each iteration lies within the range of its input, so the size of the
+    // first grid is enough for all of them):
+    v_min = UCHAR_MAX;
+    v_max = 0;
+    for (k = 0; k < dimz; k++)
+        for (j = 0; j < dimy; j++)
+            for (i = 0; i < dimx; i++) {
+                v = in_im[ I(i, j, k, dimx, dimy) ];
+                v_min = MIN(v_min, v);
+                v_max = MAX(v_max, v);
+            }
+
+    gx = (int) ((dimx - 1) / s_d + 0.5) + 1 + 2 * P3D_GRID_PAD;
+    gy = (int) ((dimy - 1) / s_d + 0.5) + 1 + 2 * P3D_GRID_PAD;
+    gz = (int) ((dimz - 1) / s_d + 0.5) + 1 + 2 * P3D_GRID_PAD;
+    gr = (int) ((v_max - v_min) / s_r + 0.5) + 1 + 2 * P3D_GRID_PAD;
+    g_size = (size_t) gx * gy * gz * gr * 2;
+
+    // The grid pays off only if its cells span several voxels and they are
+    // fewer than the voxels of the volume. Otherwise the lookup-table filter
+    // is applied with a kernel of P3D_GRID_LUT_RAD * sigma_d:
+    if ((sigma_d < P3D_GRID_MINCELL) || (((double) gx * gy * gz * gr) > ((double) dimx * dimy * dimz))) {
+        if (wr_log != NULL) {
+            wr_log("\tBilateral grid not convenient: lookup-table filter used.");
+        }
+        return p3dBilateralFilter3D_8_tol(in_im, out_im, dimx, dimy, dimz, 2 * (int) ceil(P3D_GRID_LUT_RAD * sigma_d) + 1,
+                sigma_d, sigma_r, iter, tol, info, wr_log, wr_progress);
+    }
+
+    // Try to allocate memory:
+    if (iter > 1) {
+        P3D_TRY(tmp_im = (unsigned char*) malloc((size_t) dimx * dimy * dimz * sizeof (unsigned char)));
+    }
+    P3D_TRY(grid = (float*) malloc(g_size * sizeof (float)));
+
+    if (iter < 1)
+        memcpy(out_im, in_im, (size_t) dimx * dimy * dimz * sizeof (unsigned char));
+
+    // Iterations alternate between OUT_IM and TMP_IM so that the last one
+    // writes OUT_IM (if all of them are run):
+    src_im = in_im;
+    for (ct = 0; ct < iter; ct++) {
+        dst_im = (((iter - 1 - ct) % 2) == 0) ? out_im : tmp_im;
+        diff = 0.0;
+
+        // Range of the values of this iteration:
+        v_min = UCHAR_MAX;
+        v_max = 0;
+        for (k = 0; k < dimz; k++)
+            for (j = 0; j < dimy; j++)
+                for (i = 0; i < dimx; i++) {
+                    v = src_im[ I(i, j, k, dimx, dimy) ];
+                    v_min = MIN(v_min, v);
+                    v_max = MAX(v_max, v);
+                }
+        gr = (int) ((v_max - v_min) / s_r + 0.5) + 1 + 2 * P3D_GRID_PAD;
+
+        // Splat each voxel into its nearest cell. Each thread fills one plane
+        // of the grid, so no two threads write the same cell:
+        memset(grid, 0, (size_t) gx * gy * gz * gr * 2 * sizeof (float));
+
+#pragma omp parallel for private(i, j, k, x, y, r, v, cell)
+        for (pl = 0; pl < gz; pl++)
+            for (k = 0; k < dimz; k++) {
+                if (((int) (k / s_d + 0.5) + P3D_GRID_PAD) != pl)
+                    continue;
+
+                for (j = 0; j < dimy; j++)
+                    for (i = 0; i < dimx; i++) {
+                        v = src_im[ I(i, j, k, dimx, dimy) ];
+                        x = (int) (i / s_d + 0.5) + P3D_GRID_PAD;
+                        y = (int) (j / s_d + 0.5) + P3D_GRID_PAD;
+                        r = (int) ((v - v_min) / s_r + 0.5) + P3D_GRID_PAD;
+
+                        cell = grid + ((I(x, y, pl, gx, gy)) * gr + r) * 2;
+                        cell[0] += (float) v;
+                        cell[1] += 1.0f;
+                    }
+            }
+
+        // Blur the grid along range, x, y and z:
+        _p3dBilateralGridBlur(grid, gr, 2, (size_t) gx * gy * gz);
+        _p3dBilateralGridBlur(grid, gx, (size_t) gr * 2, (size_t) gy * gz);
+        _p3dBilateralGridBlur(grid, gy, (size_t) gx * gr * 2, gz);
+        _p3dBilateralGridBlur(grid, gz, (size_t) gx * gy * gr * 2, 1);
+
+        // Slice the grid at the position of each voxel (quadrilinear
+        // interpolation) and normalize:
+#pragma omp parallel for reduction(+ : diff) private(i, j, x, y, z, r, v, c, fx, fy, fz, fr, wx, wy, wz, wr, w, sum_f, sum_fi, cell, tmp)
+        for (k = 0; k < dimz; k++)
+            for (j = 0; j < dimy; j++)
+                for (i = 0; i < dimx; i++) {
+                    v = src_im[ I(i, j, k, dimx, dimy) ];
+
+                    fx = i / s_d + P3D_GRID_PAD;
+                    fy = j / s_d + P3D_GRID_PAD;
+                    fz = k / s_d + P3D_GRID_PAD;
+                    fr = (v - v_min) / s_r + P3D_GRID_PAD;
+
+                    sum_f = 0.0;
+                    sum_fi = 0.0;
+
+                    for (z = (int) fz; z <= ((int) fz + 1); z++)
+                        for (y = (int) fy; y <= ((int) fy + 1); y++)
+                            for (x = (int) fx; x <= ((int) fx + 1); x++)
+                                for (r = (int) fr; r <= ((int) fr + 1); r++) {
+                                    wx = 1.0 - fabs(fx - x);
+                                    wy = 1.0 - fabs(fy - y);
+                                    wz = 1.0 - fabs(fz - z);
+                                    wr = 1.0 - fabs(fr - r);
+                                    w = wx * wy * wz * wr;
+
+                                    cell = grid + ((I(x, y, z, gx, gy)) * gr + r) * 2;
+                                    sum_fi += w * cell[0];
+                                    sum_f += w * cell[1];
+                                }
+
+                    // Set out voxel (within the range of the input, as
+                    // rounding could otherwise widen it) and accumulate its
+                    // change:
+                    tmp = (sum_f > 0.0) ? sum_fi / sum_f : v;
+                    if (tmp < v_min)
+                        c = v_min;
+                    else if (tmp > v_max)
+                        c = v_max;
+                    else
+                        c = (int) tmp;
+                    dst_im[ I(i, j, k, dimx, dimy) ] = (unsigned char) c;
+                    diff += abs(c - v);
+                }
+
+        // Update any progress counter:
+        if (wr_progress != NULL) wr_progress((int) ((double) (ct + 1) / iter * 100 + 0.5));
+
+        // Prepare for next iteration:
+        src_im = dst_im;
+
+        // Stop when the mean change drops below the tolerance:
+        if ((tol > 0.0) && ((diff / ((double) dimx * dimy * dimz)) <= tol)) {
+            ct++;
+            break;
+        }
+    }
+
+    // An early stop may leave the result in TMP_IM:
+    if ((ct > 0) && (src_im != out_im))
+        memcpy(out_im, src_im, (size_t) dimx * dimy * dimz * sizeof (unsigned char));
+
+    if (info != NULL) {
+        info->iterations = MAX(ct, 0);
+        info->change = (ct > 0) ? diff / ((double) dimx * dimy * dimz) : 0.0;
+    }
+
+
+    // Print elapsed time (if required):
+    if (wr_log != NULL) {
+        wr_log("\tIterations run: %d (mean change: %0.4f).", MAX(ct, 0), (ct > 0) ? diff / ((double) dimx * dimy * dimz) : 0.0);
+        wr_log("Pore3D - Bilateral filter applied successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
+    }
+
+    // Release resources:
+    if (tmp_im != NULL) free(tmp_im);
+    if (grid != NULL) free(grid);
+
+    // Return success:
+    return P3D_SUCCESS;
+
+
+MEM_ERROR:
+
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Not enough (contiguous) memory. Program will exit.");
+    }
+
+    // Release resources:
+    if (tmp_im != NULL) free(tmp_im);
+    if (grid != NULL) free(grid);
+
+    // Return error:
+    return P3D_MEM_ERROR;
+}
+
+int p3dBilateralGridFilter3D_8(
+        unsigned char* in_im,
+        unsigned char* out_im,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const double sigma_d,
+        const double sigma_r,
+        const int iter,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    return p3dBilateralGridFilter3D_8_tol(in_im, out_im, dimx, dimy, dimz, sigma_d, sigma_r, iter, 0.0, NULL, wr_log, wr_progress);
+}
+
+int p3dBilateralGridFilter3D_16_tol(
+        unsigned short* in_im,
+        unsigned short* out_im,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const double sigma_d,
+        const double sigma_r,
+        const int iter,
+        const double tol, // IN: mean absolute change below which iterations stop (0: no check)
+        struct IterationInfo* info, // OUT: iterations run and last change (may be NULL)
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    // Temporary volume for iterations:
+    unsigned short* tmp_im = NULL;
+    unsigned short* src_im;
+    unsigned short* dst_im;
+
+    // Bilateral grid: each cell holds the sum of the values splatted into it
+    // and their number (i.e. a homogeneous value):
+    float* grid = NULL;
+    float* cell;
+    int gx, gy, gz, gr;
+    size_t g_size;
+
+    int i, j, k;
+    int x, y, z, r;
+    int ct, v, c, v_min, v_max, pl;
+    double s_d, s_r, fx, fy, fz, fr;
+    double wx, wy, wz, wr, w, sum_f, sum_fi;
+    double tmp;
+
+    // Sum of the absolute changes of an iteration:
+    double diff = 0.0;
+
+
+    // Start tracking computational time:
+    if (wr_log != NULL) {
+        p3dResetStartTime();
+        wr_log("Pore3D - Applying bilateral filter (bilateral grid)...");
+        wr_log("\tDomain sigma: %0.3f.", sigma_d);
+        wr_log("\tRange sigma: %0.3f.", sigma_r);
+        wr_log("\tNumber of iterations: %d.", iter);
+        if (tol > 0.0) wr_log("\tTolerance: %0.3f.", tol);
+    }
+
+    // The grid is sampled every sigma (spatial cells span at least
+    // P3D_GRID_MINCELL voxels, range cells at least one grey level):
+    s_d = MAX(sigma_d, P3D_GRID_MINCELL);
+    s_r = MAX(sigma_r, 1.0);
+
+    // The range axis only spans the values actually present (the output of
+    // each iteration lies within the range of its input, so the size of the
+    // first grid is enough for all of them):
+    v_min = USHRT_MAX;
+    v_max = 0;
+    for (k = 0; k < dimz; k++)
+        for (j = 0; j < dimy; j++)
+            for (i = 0; i < dimx; i++) {
+                v = in_im[ I(i, j, k, dimx, dimy) ];
+                v_min = MIN(v_min, v);
+                v_max = MAX(v_max, v);
+            }
+
+    gx = (int) ((dimx - 1) / s_d + 0.5) + 1 + 2 * P3D_GRID_PAD;
+    gy = (int) ((dimy - 1) / s_d + 0.5) + 1 + 2 * P3D_GRID_PAD;
+    gz = (int) ((dimz - 1) / s_d + 0.5) + 1 + 2 * P3D_GRID_PAD;
+    gr = (int) ((v_max - v_min) / s_r + 0.5) + 1 + 2 * P3D_GRID_PAD;
+    g_size = (size_t) gx * gy * gz * gr * 2;
+
+    // The grid pays off only if its cells span several voxels and they are
+    // fewer than the voxels of the volume. Otherwise the lookup-table filter
+    // is applied with a kernel of P3D_GRID_LUT_RAD * sigma_d:
+    if ((sigma_d < P3D_GRID_MINCELL) || (((double) gx * gy * gz * gr) > ((double) dimx * dimy * dimz))) {
+        if (wr_log != NULL) {
+            wr_log("\tBilateral grid not convenient: lookup-table filter used.");
+        }
+        return p3dBilateralFilter3D_16_tol(in_im, out_im, dimx, dimy, dimz, 2 * (int) ceil(P3D_GRID_LUT_RAD * sigma_d) + 1,
+                sigma_d, sigma_r, iter, tol, info, wr_log, wr_progress);
+    }
+
+    // Try to allocate memory:
+    if (iter > 1) {
+        P3D_TRY(tmp_im = (unsigned short*) malloc((size_t) dimx * dimy * dimz * sizeof (unsigned short)));
+    }
+    P3D_TRY(grid = (float*) malloc(g_size * sizeof (float)));
+
+    if (iter < 1)
+        memcpy(out_im, in_im, (size_t) dimx * dimy * dimz * sizeof (unsigned short));
+
+    // Iterations alternate between OUT_IM and TMP_IM so that the last one
+    // writes OUT_IM (if all of them are run):
+    src_im = in_im;
+    for (ct = 0; ct < iter; ct++) {
+        dst_im = (((iter - 1 - ct) % 2) == 0) ? out_im : tmp_im;
+        diff = 0.0;
+
+        // Range of the values of this iteration:
+        v_min = USHRT_MAX;
+        v_max = 0;
+        for (k = 0; k < dimz; k++)
+            for (j = 0; j < dimy; j++)
+                for (i = 0; i < dimx; i++) {
+                    v = src_im[ I(i, j, k, dimx, dimy) ];
+                    v_min = MIN(v_min, v);
+                    v_max = MAX(v_max, v);
+                }
+        gr = (int) ((v_max - v_min) / s_r + 0.5) + 1 + 2 * P3D_GRID_PAD;
+
+        // Splat each voxel into its nearest cell. Each thread fills one plane
+        // of the grid, so no two threads write the same cell:
+        memset(grid, 0, (size_t) gx * gy * gz * gr * 2 * sizeof (float));
+
+#pragma omp parallel for private(i, j, k, x, y, r, v, cell)
+        for (pl = 0; pl < gz; pl++)
+            for (k = 0; k < dimz; k++) {
+                if (((int) (k / s_d + 0.5) + P3D_GRID_PAD) != pl)
+                    continue;
+
+                for (j = 0; j < dimy; j++)
+                    for (i = 0; i < dimx; i++) {
+                        v = src_im[ I(i, j, k, dimx, dimy) ];
+                        x = (int) (i / s_d + 0.5) + P3D_GRID_PAD;
+                        y = (int) (j / s_d + 0.5) + P3D_GRID_PAD;
+                        r = (int) ((v - v_min) / s_r + 0.5) + P3D_GRID_PAD;
+
+                        cell = grid + ((I(x, y, pl, gx, gy)) * gr + r) * 2;
+                        cell[0] += (float) v;
+                        cell[1] += 1.0f;
+                    }
+            }
+
+        // Blur the grid along range, x, y and z:
+        _p3dBilateralGridBlur(grid, gr, 2, (size_t) gx * gy * gz);
+        _p3dBilateralGridBlur(grid, gx, (size_t) gr * 2, (size_t) gy * gz);
+        _p3dBilateralGridBlur(grid, gy, (size_t) gx * gr * 2, gz);
+        _p3dBilateralGridBlur(grid, gz, (size_t) gx * gy * gr * 2, 1);
+
+        // Slice the grid at the position of each voxel (quadrilinear
+        // interpolation) and normalize:
+#pragma omp parallel for reduction(+ : diff) private(i, j, x, y, z, r, v, c, fx, fy, fz, fr, wx, wy, wz, wr, w, sum_f, sum_fi, cell, tmp)
+        for (k = 0; k < dimz; k++)
+            for (j = 0; j < dimy; j++)
+                for (i = 0; i < dimx; i++) {
+                    v = src_im[ I(i, j, k, dimx, dimy) ];
+
+                    fx = i / s_d + P3D_GRID_PAD;
+                    fy = j / s_d + P3D_GRID_PAD;
+                    fz = k / s_d + P3D_GRID_PAD;
+                    fr = (v - v_min) / s_r + P3D_GRID_PAD;
+
+                    sum_f = 0.0;
+                    sum_fi = 0.0;
+
+                    for (z = (int) fz; z <= ((int) fz + 1); z++)
+                        for (y = (int) fy; y <= ((int) fy + 1); y++)
+                            for (x = (int) fx; x <= ((int) fx + 1); x++)
+                                for (r = (int) fr; r <= ((int) fr + 1); r++) {
+                                    wx = 1.0 - fabs(fx - x);
+                                    wy = 1.0 - fabs(fy - y);
+                                    wz = 1.0 - fabs(fz - z);
+                                    wr = 1.0 - fabs(fr - r);
+                                    w = wx * wy * wz * wr;
+
+                                    cell = grid + ((I(x, y, z, gx, gy)) * gr + r) * 2;
+                                    sum_fi += w * cell[0];
+                                    sum_f += w * cell[1];
+                                }
+
+                    // Set out voxel (within the range of the input, as
+                    // rounding could otherwise widen it) and accumulate its
+                    // change:
+                    tmp = (sum_f > 0.0) ? sum_fi / sum_f : v;
+                    if (tmp < v_min)
+                        c = v_min;
+                    else if (tmp > v_max)
+                        c = v_max;
+                    else
+                        c = (int) tmp;
+                    dst_im[ I(i, j, k, dimx, dimy) ] = (unsigned short) c;
+                    diff += abs(c - v);
+                }
+
+        // Update any progress counter:
+        if (wr_progress != NULL) wr_progress((int) ((double) (ct + 1) / iter * 100 + 0.5));
+
+        // Prepare for next iteration:
+        src_im = dst_im;
+
+        // Stop when the mean change drops below the tolerance:
+        if ((tol > 0.0) && ((diff / ((double) dimx * dimy * dimz)) <= tol)) {
+            ct++;
+            break;
+        }
+    }
+
+    // An early stop may leave the result in TMP_IM:
+    if ((ct > 0) && (src_im != out_im))
+        memcpy(out_im, src_im, (size_t) dimx * dimy * dimz * sizeof (unsigned short));
+
+    if (info != NULL) {
+        info->iterations = MAX(ct, 0);
+        info->change = (ct > 0) ? diff / ((double) dimx * dimy * dimz) : 0.0;
+    }
+
+
+    // Print elapsed time (if required):
+    if (wr_log != NULL) {
+        wr_log("\tIterations run: %d (mean change: %0.4f).", MAX(ct, 0), (ct > 0) ? diff / ((double) dimx * dimy * dimz) : 0.0);
+        wr_log("Pore3D - Bilateral filter applied successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
+    }
+
+    // Release resources:
+    if (tmp_im != NULL) free(tmp_im);
+    if (grid != NULL) free(grid);
+
+    // Return success:
+    return P3D_SUCCESS;
+
+
+MEM_ERROR:
+
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Not enough (contiguous) memory. Program will exit.");
+    }
+
+    // Release resources:
+    if (tmp_im != NULL) free(tmp_im);
+    if (grid != NULL) free(grid);
+
+    // Return error:
+    return P3D_MEM_ERROR;
+}
+
+int p3dBilateralGridFilter3D_16(
+        unsigned short* in_im,
+        unsigned short* out_im,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const double sigma_d,
+        const double sigma_r,
+        const int iter,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    return p3dBilateralGridFilter3D_16_tol(in_im, out_im, dimx, dimy, dimz, sigma_d, sigma_r, iter, 0.0, NULL, wr_log, wr_progress);
+}
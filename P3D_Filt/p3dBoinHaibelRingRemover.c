@@ -28,7 +28,6 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
-#include <limits.h>
 #include <omp.h>
 
 #include "p3dFilt.h"
@@ -66,309 +65,187 @@ double _p3dBoinHaibelRingRemover_kth_smallest(double* a, int n, int k) {
 }
 
 
-// This procedure removes ring artifacts from CT images.
+// This procedure removes ring artifacts from CT images. Both the 8-bit and
+// the 16-bit versions (BYTES per pixel) are implemented here. Since the
+// correction only depends on the radius, the polar image is never stored:
+// the radial profile is accumulated while scanning the cartesian image and
+// the gain is applied back to the cartesian pixels through the inverse map.
 
-int p3dBoinHaibelRingRemover2D_8(
-        unsigned char* in_im,
-        unsigned char* out_im,
+static int _p3dBoinHaibelRingRemover2D(
+        void* in_im,
+        void* out_im,
         const int dimx,
         const int dimy,
         const int centerX,
         const int centerY,
-        const int winsize, // IN: width of the moving average
+        const int bytes,
+        const int winsize, // IN: width of the moving median
         const int iterations, // IN: filter can be re-iterated
         const double precision,
+        struct PolarPlan* plan, // IN: resampling plan (if NULL it is created)
         int (*wr_log)(const char*, ...)
         ) {
-    int i, j; // generic counters
-    int k, tmp_k;
-    int sum;
+    int j, k, tmp_k; // generic counters
 
-    double tmp_val;
-
-    // Polar images:
-    unsigned char* p_in_im; // no need for malloc
-    unsigned char* c_out_im; // no need for malloc
+    // Plan owned by this call (if any):
+    struct PolarPlan* tmp_plan = NULL;
 
     int p_dim, ct, it_ct;
 
-    // Artifacts vectors:
-    double* glob_art;
-    double* v;
+    // Radial profile and artifacts correction vectors:
+    double* profile = NULL;
+    double* loc_art = NULL;
+    double* glob_art = NULL;
 
-    /*char auth_code;
-
-    //
-    // Authenticate:
-    //
-    auth_code = authenticate("p3dBoinHaibelRingRemover2D_8");
-    if (auth_code == '0') goto AUTH_ERROR;*/
+    // One window (of WINSIZE elements) for each thread:
+    double* windows = NULL;
+    double* v;
 
-    // STEP2: Transform in polar coordinates. Remember that memory allocation
-    // for output images is performed within the procedure.
+    // STEP2: Radial profile, i.e. mean of the rows of the polar image (the
+    // plan is created for this geometry if not provided by the caller):
+    if (plan == NULL) {
+        P3D_TRY(p3dPolarPlanCreate(&tmp_plan, dimx, dimy, centerX, centerY, precision));
+        plan = tmp_plan;
+    }
+    p_dim = plan->polarX;
 
-    p3dCartesian2polar_8(in_im, &p_in_im, dimx, dimy, centerX, centerY, precision, &p_dim);
+    P3D_TRY(profile = (double*) malloc(p_dim * sizeof (double)));
+    P3D_TRY(_p3dPolarPlanProfile(plan, in_im, bytes, profile));
 
     // STEP3: Artifact template selection.
 
     // Allocate dynamic memory:
+    P3D_TRY(loc_art = (double*) malloc(p_dim * sizeof (double)));
+    P3D_TRY(windows = (double*) malloc((size_t) omp_get_max_threads() * MAX(winsize, 1) * sizeof (double)));
 
     // Now that we know the dimensions of polar image we can allocate
     // the global artifacts correction vector:
-    glob_art = (double*) calloc(p_dim, sizeof (double));
+    P3D_TRY(glob_art = (double*) malloc(p_dim * sizeof (double)));
 
-    // Allocate memory for the column:
-    // v = (double*) malloc(row_ct * sizeof (double));
+    for (j = 0; j < p_dim; j++)
+        glob_art[j] = 1.0;
 
     for (it_ct = 0; it_ct < iterations; it_ct++) {
-        // Compute median for each column and store the value in the
-        // artifact vector:
-#pragma omp parallel for private(k, sum)
-        for (j = 0; j < p_dim; j++) {
-            // Fill the column array:
-            sum = 0;
-
-            for (k = 0; k < p_dim; k++) {
-                sum = sum + p_in_im[ I2(j, k, p_dim) ];
-            }
-
-            // Put the sum in artifact vector:
-            glob_art[j] = sum;
-        }
-
-        // Free memory for the column:
-        // Cycle for each element in line to compute moving average:
+        // Cycle for each element of the profile to compute the ratio between
+        // its moving median and the element itself:
 #pragma omp parallel for private(v, ct, k, tmp_k)
         for (j = 0; j < p_dim; j++) {
-            /*sum = 0;
-
-            // Moving average:
-            for (k = ( j - (win_size / 2)); k < ( j + (win_size / 2)); k++)
-            {
-                    tmp_k = k;
-
-                    // Replicate padding:
-                    if (tmp_k < 0) tmp_k = 0;
-                    if (tmp_k > (p_dim - 1)) tmp_k = p_dim - 1;
-
-                    sum = sum + glob_art[ tmp_k ];
-            }
-
-            // Moving average:
-            glob_art[j] = (sum / win_size) / (glob_art[j] + EPS);*/
-
-            // Allocate memory for the column:
-            v = (double*) malloc(winsize * sizeof (double));
+            v = windows + (size_t) omp_get_thread_num() * MAX(winsize, 1);
             ct = 0;
 
-            for (k = (j - (winsize / 2)); k < (j + (winsize / 2)); k++) {
+            for (k = (j - (winsize / 2)); k < (j - (winsize / 2) + winsize); k++) {
                 tmp_k = k;
 
                 // Replicate padding:
                 if (tmp_k < 0) tmp_k = 0;
                 if (tmp_k > (p_dim - 1)) tmp_k = p_dim - 1;
 
-                v[ct++] = glob_art[ tmp_k ];
+                v[ct++] = profile[ tmp_k ];
             }
 
-            glob_art[j] = (P3DBOINHAIBELRINGREMOVER_MEDIAN(v, winsize) / (glob_art[j] + EPS));
-
-            // Free memory for the column:
-            free(v);
+            loc_art[j] = (ct > 0) ? (P3DBOINHAIBELRINGREMOVER_MEDIAN(v, ct) / (profile[j] + EPS)) : 1.0;
         }
 
-
-        // The artifact template vector is multiplied for each
-        // row of the polar image P:
-#pragma omp parallel for private(i, tmp_val)
-        for (j = 0; j < p_dim; j++)
-            for (i = 0; i < p_dim; i++) {
-                // Take care of intensity bounds:
-                tmp_val = p_in_im[ I2(i, j, p_dim) ] * glob_art[i];
-
-                if (tmp_val < 0.0) tmp_val = 0.0;
-                if (tmp_val > UCHAR_MAX) tmp_val = UCHAR_MAX;
-
-                p_in_im[ I2(i, j, p_dim) ] = (unsigned char) tmp_val;
-            }
-
-
+        // The correction multiplies each row of the polar image, i.e. the
+        // profile of the next iteration, and it accumulates in the global
+        // vector:
+        for (j = 0; j < p_dim; j++) {
+            profile[j] = profile[j] * loc_art[j];
+            glob_art[j] = glob_art[j] * loc_art[j];
+        }
     }
 
-    //p3dWriteRaw8 ( p_in_im, "C:\\p_out_im.raw", p_dim, p_dim, 1, printf );
-
-    // Return in cartesian coordinates:
-    p3dPolar2cartesian_8(p_in_im, &c_out_im, p_dim, centerX, centerY, dimx, dimy);
-
-    // Copy C_OUT_IM to the output of the procedure:
-    memcpy(out_im, c_out_im, dimx * dimy * sizeof (unsigned char));
+    // Apply the correction in cartesian coordinates (directly into the output):
+    _p3dPolarPlanApplyProfile(plan, in_im, out_im, bytes, glob_art);
 
     // Free memory:
+    free(profile);
+    free(loc_art);
     free(glob_art);
+    free(windows);
 
-    free(p_in_im);
-    free(c_out_im);
+    p3dPolarPlanFree(tmp_plan);
 
     return P3D_SUCCESS;
-    
-   /* AUTH_ERROR:
+
+MEM_ERROR:
 
     if (wr_log != NULL) {
-        wr_log("Pore3D - Authentication error: %s. Program will exit.", auth_code);
+        wr_log("Pore3D - Not enough (contiguous) memory. Program will exit.");
     }
 
-    return P3D_AUTH_ERROR;*/
+    // Release resources:
+    if (profile != NULL) free(profile);
+    if (loc_art != NULL) free(loc_art);
+    if (glob_art != NULL) free(glob_art);
+    if (windows != NULL) free(windows);
+    p3dPolarPlanFree(tmp_plan);
+
+    return P3D_MEM_ERROR;
 }
 
-int p3dBoinHaibelRingRemover2D_16(
+int p3dBoinHaibelRingRemover2D_8_plan(
+        unsigned char* in_im,
+        unsigned char* out_im,
+        const int dimx,
+        const int dimy,
+        const int centerX,
+        const int centerY,
+        const int winsize, // IN: width of the moving median
+        const int iterations, // IN: filter can be re-iterated
+        const double precision,
+        struct PolarPlan* plan, // IN: resampling plan (if NULL it is created)
+        int (*wr_log)(const char*, ...)
+        ) {
+    return _p3dBoinHaibelRingRemover2D(in_im, out_im, dimx, dimy, centerX, centerY, 1,
+            winsize, iterations, precision, plan, wr_log);
+}
+
+int p3dBoinHaibelRingRemover2D_16_plan(
         unsigned short* in_im,
         unsigned short* out_im,
         const int dimx,
         const int dimy,
         const int centerX,
         const int centerY,
-        const int winsize, // IN: width of the moving average
+        const int winsize, // IN: width of the moving median
         const int iterations, // IN: filter can be re-iterated
         const double precision,
+        struct PolarPlan* plan, // IN: resampling plan (if NULL it is created)
         int (*wr_log)(const char*, ...)
         ) {
-    int i, j; // generic counters
-    int k, tmp_k;
-    int sum;
-
-    double tmp_val;
-
-    // Polar images:
-    unsigned short* p_in_im; // no need for malloc
-    unsigned short* c_out_im; // no need for malloc
-
-    int p_dim, ct, it_ct;
-
-    // Artifacts vectors:
-    double* glob_art;
-    double* v;
-
-   /* char auth_code;
-
-    //
-    // Authenticate:
-    //
-    auth_code = authenticate("p3dBoinHaibelRingRemover2D_16");
-    if (auth_code == '0') goto AUTH_ERROR;*/
-
-
-    // STEP2: Transform in polar coordinates. Remember that memory allocation
-    // for output images is performed within the procedure.
-
-    p3dCartesian2polar_16(in_im, &p_in_im, dimx, dimy, centerX, centerY, precision, &p_dim);
-
-    // STEP3: Artifact template selection.
-
-    // Allocate dynamic memory:
-
-    // Now that we know the dimensions of polar image we can allocate
-    // the global artifacts correction vector:
-    glob_art = (double*) calloc(p_dim, sizeof (double));
-
-    // Allocate memory for the column:
-    // v = (double*) malloc(row_ct * sizeof (double));
-
-    // Compute median for each column and store the value in the
-    // artifact vector:
-
-        for (it_ct = 0; it_ct < iterations; it_ct++) {
-#pragma omp parallel for private(k, sum)
-    for (j = 0; j < p_dim; j++) {
-        // Fill the column array:
-        sum = 0;
-
-        for (k = 0; k < p_dim; k++) {
-            sum = sum + p_in_im[ I2(j, k, p_dim) ];
-        }
-
-        // Put the sum in artifact vector:
-        glob_art[j] = sum;
-    }
-
-    // Free memory for the column:
-    // Cycle for each element in line to compute moving average:
-#pragma omp parallel for private(v, ct, k, tmp_k)
-    for (j = 0; j < p_dim; j++) {
-        /*sum = 0;
-
-        // Moving average:
-        for (k = ( j - (win_size / 2)); k < ( j + (win_size / 2)); k++)
-        {
-                tmp_k = k;
-
-                // Replicate padding:
-                if (tmp_k < 0) tmp_k = 0;
-                if (tmp_k > (p_dim - 1)) tmp_k = p_dim - 1;
-
-                sum = sum + glob_art[ tmp_k ];
-        }
-
-        // Moving average:
-        glob_art[j] = (sum / win_size) / (glob_art[j] + EPS);*/
-
-        // Allocate memory for the column:
-        v = (double*) malloc(winsize * sizeof (double));
-        ct = 0;
-
-        for (k = (j - (winsize / 2)); k < (j + (winsize / 2)); k++) {
-            tmp_k = k;
-
-            // Replicate padding:
-            if (tmp_k < 0) tmp_k = 0;
-            if (tmp_k > (p_dim - 1)) tmp_k = p_dim - 1;
-
-            v[ct++] = glob_art[ tmp_k ];
-        }
-
-        glob_art[j] = (P3DBOINHAIBELRINGREMOVER_MEDIAN(v, winsize) / (glob_art[j] + EPS));
-
-        // Free memory for the column:
-        free(v);
-    }
-
-
-    // The artifact template vector is multiplied for each
-    // row of the polar image P:
-#pragma omp parallel for private(i, tmp_val)
-    for (j = 0; j < p_dim; j++)
-        for (i = 0; i < p_dim; i++) {
-            // Take care of intensity bounds:
-            tmp_val = p_in_im[ I2(i, j, p_dim) ] * glob_art[i];
-
-            if (tmp_val < 0.0) tmp_val = 0.0;
-            if (tmp_val > USHRT_MAX) tmp_val = USHRT_MAX;
-
-            p_in_im[ I2(i, j, p_dim) ] = (unsigned short) tmp_val;
-        }
-
-        }
-
-    //p3dWriteRaw8 ( p_in_im, "C:\\p_out_im.raw", p_dim, p_dim, 1, printf );
-
-    // Return in cartesian coordinates:
-    p3dPolar2cartesian_16(p_in_im, &c_out_im, p_dim, centerX, centerY, dimx, dimy);
-
-    // Copy C_OUT_IM to the output of the procedure:
-    memcpy(out_im, c_out_im, dimx * dimy * sizeof (unsigned short));
-
-    // Free memory:
-    free(glob_art);
-
-    free(p_in_im);
-    free(c_out_im);
-
-    return P3D_SUCCESS;
-    
-/*AUTH_ERROR:
+    return _p3dBoinHaibelRingRemover2D(in_im, out_im, dimx, dimy, centerX, centerY, 2,
+            winsize, iterations, precision, plan, wr_log);
+}
 
-    if (wr_log != NULL) {
-        wr_log("Pore3D - Authentication error: %s. Program will exit.", auth_code);
-    }
+int p3dBoinHaibelRingRemover2D_8(
+        unsigned char* in_im,
+        unsigned char* out_im,
+        const int dimx,
+        const int dimy,
+        const int centerX,
+        const int centerY,
+        const int winsize,
+        const int iterations,
+        const double precision,
+        int (*wr_log)(const char*, ...)
+        ) {
+    return p3dBoinHaibelRingRemover2D_8_plan(in_im, out_im, dimx, dimy, centerX, centerY,
+            winsize, iterations, precision, NULL, wr_log);
+}
 
-    return P3D_AUTH_ERROR;*/
-}
\ No newline at end of file
+int p3dBoinHaibelRingRemover2D_16(
+        unsigned short* in_im,
+        unsigned short* out_im,
+        const int dimx,
+        const int dimy,
+        const int centerX,
+        const int centerY,
+        const int winsize,
+        const int iterations,
+        const double precision,
+        int (*wr_log)(const char*, ...)
+        ) {
+    return p3dBoinHaibelRingRemover2D_16_plan(in_im, out_im, dimx, dimy, centerX, centerY,
+            winsize, iterations, precision, NULL, wr_log);
+}
@@ -52,6 +52,20 @@ extern "C" {
 #define CONN18  712
 #define CONN26  713
 
+    // Access hints for memory-mapped volumes:
+#define P3D_ACCESS_NORMAL       811
+#define P3D_ACCESS_SEQUENTIAL   812
+#define P3D_ACCESS_RANDOM       813
+
+    // Reduction modes for multi-resolution pyramids:
+#define P3D_PYRAMID_MEAN        821
+#define P3D_PYRAMID_MAJORITY    822
+#define P3D_PYRAMID_OR          823
+
+    // Slice formats for slice stacks:
+#define P3D_SLICE_RAW           831
+#define P3D_SLICE_TIFF          832
+
 #endif
 
     /*
@@ -61,8 +75,8 @@ extern "C" {
 #ifndef P3D_MACROS
 #define P3D_MACROS
 
-#define I(i,j,k,N,M)    ( (j)*(N) + (i) + (k)*(N)*(M) )
-#define I2(i,j,N)       ( (j)*(N) + (i) )
+#define I(i,j,k,N,M)    ( (size_t)(j)*(N) + (i) + (size_t)(k)*(N)*(M) )
+#define I2(i,j,N)       ( (size_t)(j)*(N) + (i) )
 
     
 #define MIN(x,y)        (((x) < (y))?(x):(y))
@@ -73,6 +87,21 @@ extern "C" {
 #define ELEM_SWAP(a,b) { register double t=(a);(a)=(b);(b)=t; }
 #endif
 
+// Strided sub-volumes (struct VolumeView):
+#include "../P3D_Common/p3dVolumeView.h"
+
+#ifndef P3D_ITERATION_DEFINED
+#define P3D_ITERATION_DEFINED
+
+    // Outcome of the iterative filters (*_tol variants), which stop as soon as
+    // the mean absolute change of an iteration (in grey levels) is not
+    // greater than the given tolerance:
+    struct IterationInfo {
+        int iterations;             // Iterations actually run
+        double change;              // Mean absolute change of the last one
+    };
+#endif
+
     // Input - output:
     int p3dReadRaw8(char*, unsigned char*, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
     int p3dReadRaw16(char*, unsigned short*, const int, const int, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
@@ -81,6 +110,53 @@ extern "C" {
     int p3dWriteRaw16(unsigned short*, char*, const int, const int, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
 	int p3dWriteRaw32(unsigned int*, char*, const int, const int, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
 
+    int p3dMapRaw8(char*, unsigned char**, const int, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dMapRaw16(char*, unsigned short**, const int, const int, const int, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dUnmapRaw8(unsigned char*, const int, const int, const int);
+    int p3dUnmapRaw16(unsigned short*, const int, const int, const int);
+
+    struct SlabReader;
+    struct SlabWriter;
+
+    int p3dSlabReaderOpen(char*, struct SlabReader**, const int, const int, const int, const int, const int, const int, const int, const int, int (*wr_log)(const char*, ...));
+    int p3dSlabReaderNext(struct SlabReader*, void**, int*, int*, int*, int*);
+    int p3dSlabReaderClose(struct SlabReader*);
+    int p3dSlabWriterOpen(char*, struct SlabWriter**, const int, const int, const int, const int, const int, const int, int (*wr_log)(const char*, ...));
+    int p3dSlabWriterWrite(struct SlabWriter*, void*, const int);
+    int p3dSlabWriterClose(struct SlabWriter*);
+
+    struct AsyncWriter;
+
+    int p3dAsyncWriterOpen(char*, struct AsyncWriter**, const int, const int, const int, const int, const int, const int, const int, int (*wr_log)(const char*, ...));
+    int p3dAsyncWriterSubmit(struct AsyncWriter*, void*, const int);
+    int p3dAsyncWriterTest(struct AsyncWriter*);
+    int p3dAsyncWriterWait(struct AsyncWriter*);
+    int p3dAsyncWriteRaw8(unsigned char*, char*, const int, const int, const int, const int, struct AsyncWriter**, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dAsyncWriteRaw16(unsigned short*, char*, const int, const int, const int, const int, const int, const int, struct AsyncWriter**, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dAsyncWriteRaw32(unsigned int*, char*, const int, const int, const int, const int, const int, const int, struct AsyncWriter**, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+
+    int p3dWriteBrick8(unsigned char*, char*, const int, const int, const int, const double, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dWriteBrick16(unsigned short*, char*, const int, const int, const int, const double, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dReadBrickInfo(char*, int*, int*, int*, int*, double*);
+    int p3dReadBrick8(char*, unsigned char*, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dReadBrick16(char*, unsigned short*, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dReadBrickROI8(char*, unsigned char*, const int, const int, const int, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dReadBrickROI16(char*, unsigned short*, const int, const int, const int, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+
+    void p3dPyramidLevelDims(const int, const int, const int, const int, int*, int*, int*);
+    int p3dDownsample3D_8(unsigned char*, unsigned char*, const int, const int, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dDownsample3D_16(unsigned short*, unsigned short*, const int, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dWritePyramid8(unsigned char*, char*, const int, const int, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dWritePyramid16(unsigned short*, char*, const int, const int, const int, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dReadRawLevel8(char*, unsigned char*, const int, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dReadRawLevel16(char*, unsigned short*, const int, const int, const int, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+
+    int p3dReadSliceStackInfo(char*, int*, int*, int*, int*);
+    int p3dReadSliceStack8(char*, unsigned char*, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dReadSliceStack16(char*, unsigned short*, const int, const int, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dWriteSliceStack8(unsigned char*, char*, char*, const int, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dWriteSliceStack16(unsigned short*, char*, char*, const int, const int, const int, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+
 
     // Utils:
     int p3dCrop2D_8(unsigned char*, unsigned char*, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
@@ -107,26 +183,53 @@ extern "C" {
     
     // Basic Filters:
     int p3dAnisotropicDiffusionFilter3D_8(unsigned char*, unsigned char*, const int, const int, const int, const int, const double, const double, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dAnisotropicDiffusionFilter3D_8_tol(unsigned char*, unsigned char*, const int, const int, const int, const int, const double, const double, const int, const double, struct IterationInfo*, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
     int p3dAnisotropicDiffusionFilter3D_16(unsigned short*, unsigned short*, const int, const int, const int, const int, const double, const double, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dAnisotropicDiffusionFilter3D_16_tol(unsigned short*, unsigned short*, const int, const int, const int, const int, const double, const double, const int, const double, struct IterationInfo*, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dAnisotropicDiffusionFilter3D_16_stream(char*, char*, const int, const int, const int, const int, const double, const double, const int, const int, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
 
     int p3dBilateralFilter3D_8(unsigned char*, unsigned char*, const int, const int, const int, const int, const double, const double, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dBilateralFilter3D_8_tol(unsigned char*, unsigned char*, const int, const int, const int, const int, const double, const double, const int, const double, struct IterationInfo*, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
     int p3dBilateralFilter3D_16(unsigned short*, unsigned short*, const int, const int, const int, const int, const double, const double, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dBilateralFilter3D_16_tol(unsigned short*, unsigned short*, const int, const int, const int, const int, const double, const double, const int, const double, struct IterationInfo*, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dBilateralGridFilter3D_8(unsigned char*, unsigned char*, const int, const int, const int, const double, const double, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dBilateralGridFilter3D_8_tol(unsigned char*, unsigned char*, const int, const int, const int, const double, const double, const int, const double, struct IterationInfo*, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dBilateralGridFilter3D_16(unsigned short*, unsigned short*, const int, const int, const int, const double, const double, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dBilateralGridFilter3D_16_tol(unsigned short*, unsigned short*, const int, const int, const int, const double, const double, const int, const double, struct IterationInfo*, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
 
     int p3dGaussianFilter3D_8(unsigned char*, unsigned char*, const int, const int, const int, const int, const double, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
     int p3dGaussianFilter3D_16(unsigned short*, unsigned short*, const int, const int, const int, const int, const double, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dGaussianFilter3D_8_view(struct VolumeView*, struct VolumeView*, const int, const double, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dGaussianFilter3D_16_view(struct VolumeView*, struct VolumeView*, const int, const double, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dGaussianFilter3D_8_iir(unsigned char*, unsigned char*, const int, const int, const int, const int, const double, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dGaussianFilter3D_16_iir(unsigned short*, unsigned short*, const int, const int, const int, const int, const double, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dGaussianFilter3D_16_stream(char*, char*, const int, const int, const int, const int, const double, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
 
     int p3dMeanFilter2D_8(unsigned char*, unsigned char*, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
     int p3dMeanFilter2D_16(unsigned short*, unsigned short*, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
     int p3dMeanFilter3D_8(unsigned char*, unsigned char*, const int, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
     int p3dMeanFilter3D_16(unsigned short*, unsigned short*, const int, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dMeanFilter3D_8_view(struct VolumeView*, struct VolumeView*, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dMeanFilter3D_16_view(struct VolumeView*, struct VolumeView*, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dMeanFilter3D_8_stream(char*, char*, const int, const int, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
 
     int p3dMedianFilter2D_8(unsigned char*, unsigned char*, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
     int p3dMedianFilter2D_16(unsigned short*, unsigned short*, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
     int p3dMedianFilter3D_8(unsigned char*, unsigned char*, const int, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
     int p3dMedianFilter3D_16(unsigned short*, unsigned short*, const int, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dMedianFilter3D_8_view(struct VolumeView*, struct VolumeView*, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dMedianFilter3D_16_view(struct VolumeView*, struct VolumeView*, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dMedianFilter3D_8_stream(char*, char*, const int, const int, const int, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+
+    struct PolarPlan;
+
+    int p3dPolarPlanCreate(struct PolarPlan**, const int, const int, const double, const double, const double);
+    void p3dPolarPlanFree(struct PolarPlan*);
 
     int p3dBoinHaibelRingRemover2D_8(unsigned char*, unsigned char*, const int, const int, const int, const int, const int, const int, const double, int (*wr_log)(const char*, ...));
     int p3dBoinHaibelRingRemover2D_16(unsigned short*, unsigned short*, const int, const int, const int, const int, const int, const int, const double, int (*wr_log)(const char*, ...));
+    int p3dBoinHaibelRingRemover2D_8_plan(unsigned char*, unsigned char*, const int, const int, const int, const int, const int, const int, const double, struct PolarPlan*, int (*wr_log)(const char*, ...));
+    int p3dBoinHaibelRingRemover2D_16_plan(unsigned short*, unsigned short*, const int, const int, const int, const int, const int, const int, const double, struct PolarPlan*, int (*wr_log)(const char*, ...));
 
     int p3dMunchEtAlRingRemover2D_8(unsigned char*, unsigned char*, const int, const int, const double, const double, const int, const double, const int, const double, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...), int);
     int p3dMunchEtAlRingRemover2D_16(unsigned short*, unsigned short*, const int, const int, const double, const double, const int, const double, const int, const double, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...), int);
@@ -136,6 +239,8 @@ extern "C" {
     
     int p3dSijbersPostnovRingRemover2D_8(unsigned char*, unsigned char*, const int, const int, const double, const double, const int, const double, const int, const double, unsigned char*, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
     int p3dSijbersPostnovRingRemover2D_16(unsigned short*, unsigned short*, const int, const int, const double, const double, const int, const double, const int, const double, const int, unsigned char*, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dSijbersPostnovRingRemover2D_8_plan(unsigned char*, unsigned char*, const int, const int, const double, const double, const int, const double, const int, const double, unsigned char*, struct PolarPlan*, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
+    int p3dSijbersPostnovRingRemover2D_16_plan(unsigned short*, unsigned short*, const int, const int, const double, const double, const int, const double, const int, const double, const int, unsigned char*, struct PolarPlan*, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
     
     int p3dSijbersPostnovRingRemover2D_8_batch(char*, char*, const int, const int, const double, const double, const int, const double, const int, const double, char*, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...), int );
     int p3dSijbersPostnovRingRemover2D_16_batch(char*, char*, const int, const int, const double, const double, const int, const double, const int,  const double, const int, char*, const int, const int, int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...), int );
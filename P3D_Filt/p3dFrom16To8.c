@@ -48,7 +48,7 @@ int p3dFrom16To8(
     double new_min = 0.0;
     double new_max = UCHAR_MAX * 1.0;
     double tmpval;
-    int i;
+    long long i;
 
     // Start tracking computational time:
     if (wr_log != NULL) {
@@ -58,7 +58,7 @@ int p3dFrom16To8(
     }
 
 #pragma omp parallel for private (tmpval)
-    for (i = 0; i < (dimx * dimy * dimz); i++) {
+    for (i = 0; i < ((long long) dimx * dimy * dimz); i++) {
         tmpval = (in_im[i] - min) / ((max - min) * 1.0)*(new_max - new_min);
         if (tmpval > new_max) tmpval = new_max;
         if (tmpval < new_min) tmpval = new_min;
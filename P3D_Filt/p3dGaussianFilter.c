@@ -22,7 +22,7 @@
 
 //
 // Author: Francesco Brun
-// Last modified: Sept, 28th 2016
+// Last modified: October, 16th 2026
 //
 
 #include <stdlib.h>
@@ -30,32 +30,46 @@
 #include <stdio.h>
 #include <omp.h>
 #include <limits.h>
+#include <math.h>
 
 #include "p3dFilt.h"
 #include "p3dTime.h"
-
-int p3dGaussianFilter3D_8(
-        unsigned char* in_im,
-        unsigned char* out_im,
-        const int dimx,
-        const int dimy,
-        const int dimz,
+#include "p3dSlabIO.h"
+
+#include "Common/p3dGaussianEngine.h"
+
+// Parameters of the filter applied to each slab by the streaming variant:
+struct GaussianParams {
+    int size;
+    double sigma;
+};
+
+// Filters IN_VIEW into OUT_VIEW with the truncated gaussian kernel or, if
+// FLAGIIR is P3D_TRUE, with its recursive approximation (see
+// Common/p3dGaussianEngine.h). The view is converted to a float working volume
+// because the engine filters each direction in place:
+static int _p3dGaussianFilter3D_8(
+        struct VolumeView* in_view, // IN: input view
+        struct VolumeView* out_view, // OUT: output view (same dimensions)
         const int size,
         const double sigma,
+        const int flagIIR,
         int (*wr_log)(const char*, ...),
         int (*wr_progress)(const int, ...)
         ) {
-    // Padded input and related dims:
+    // Input and output are addressed through origin and strides of their views:
+    unsigned char* in_im = (unsigned char*) in_view->base + IV(0, 0, 0, in_view);
+    unsigned char* out_im = (unsigned char*) out_view->base + IV(0, 0, 0, out_view);
+    const size_t in_sy = in_view->stridey, in_sz = in_view->stridez;
+    const size_t out_sy = out_view->stridey, out_sz = out_view->stridez;
+    const int dimx = in_view->dimx, dimy = in_view->dimy, dimz = in_view->dimz;
+
+    // Working volume (filtered in place by the separable gaussian engine):
     float* tmp_im = NULL;
-    float* kernel = NULL;
-
 
-    int a_dimx, a_dimy, a_dimz;
     int i, j, k;
-    int x, y, z;
-    int ct, a_rad, a_size;
-    double d;
-    double f, w, sum, sum_w;
+    int a_rad;
+    float val;
     
     /*char auth_code;
 
@@ -66,12 +80,22 @@ int p3dGaussianFilter3D_8(
     if (auth_code == '0') goto AUTH_ERROR;*/
 
 
+    // Output view must have the dimensions of the input view:
+    if (p3dVolumeViewSameDims(in_view, out_view) == P3D_FALSE) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - Error: output view should have the same dimensions of the input view.");
+        }
+        return P3D_IO_ERROR;
+    }
+
     // Start tracking computational time:
     if (wr_log != NULL) {
         p3dResetStartTime();
         wr_log("Pore3D - Applying gaussian filter...");
         wr_log("\tKernel size: %d.", size);
         wr_log("\tSigma: %0.3f.", sigma);
+        if (flagIIR == P3D_TRUE)
+            wr_log("\tRecursive approximation enabled.");
     }
 
     // Set kernel size and variance:
@@ -79,96 +103,33 @@ int p3dGaussianFilter3D_8(
         a_rad = 1;
     else
         a_rad = ceil(size / 2);
-    a_size = 2 * a_rad + 1;
-
-    d = (2.0 * sigma * sigma);
-
 
-    // Compute dimensions of padded volume:
-    a_dimx = dimx + a_rad * 2;
-    a_dimy = dimy + a_rad * 2;
-    a_dimz = dimz + a_rad * 2;
 
+    // Initialize input (replicate borders are handled by the engine):
+    P3D_TRY(tmp_im = (float*) malloc((size_t) dimx * dimy * dimz * sizeof (float)));
 
-    // Initialize input:
-    tmp_im = (float*) malloc(a_dimx * a_dimy * a_dimz * sizeof (float));
-    kernel = (float*) malloc(a_size * sizeof (float));
+#pragma omp parallel for private(i, j)
+    for (k = 0; k < dimz; k++)
+        for (j = 0; j < dimy; j++)
+            for (i = 0; i < dimx; i++)
+                tmp_im[ I(i, j, k, dimx, dimy) ] = (float) in_im[ IS(i, j, k, in_sy, in_sz) ];
 
-    _p3dReplicatePadding3D_uchar2float(in_im, tmp_im, dimx, dimy, dimz, a_rad);
-
-    ct = 0;
-    sum_w = 0.0;
-
-    // Create gausssian kernel:
-    for (x = (-a_rad); x <= a_rad; x++) {
-       
-       f = (x)*(x) / d;
-       kernel[ct] = exp(-f);
-       sum_w = sum_w + kernel[ct++];
-    }
-    ct = 0;
-    // Normalize kernel
-    for (x = (-a_rad); x <= a_rad; x++) 
-        kernel[ct] = kernel[ct++]/sum_w;
-
-    // X-direction scanning
-#pragma omp parallel for private(i, j, x, sum, ct)
-    for (k = a_rad; k < (a_dimz - a_rad); k++)
-        for (j = a_rad; j < (a_dimy - a_rad); j++)
-            for (i = a_rad; i < (a_dimx - a_rad); i++) {
-                sum = 0.0;
-                ct = 0;
-
-                // Process kernel:
-                for (x = (i - a_rad); x <= (i + a_rad); x++) {
-                    // Gausssian kernel:                       
-                    sum = sum + kernel[ct++] * tmp_im[ I(x, j, k, a_dimx, a_dimy) ];
-                }
-
-                // Set out voxel with the mean of the sorted temporary array:                
-                tmp_im[ I(i, j, k, a_dimx, a_dimy) ] = sum;
-            }
+    // Separable smoothing along x, y and z:
+    P3D_TRY(p3dGaussianSmooth3D_float(tmp_im, dimx, dimy, dimz, sigma, a_rad, flagIIR));
 
-    // Y-direction scanning
-#pragma omp parallel for private(i, j, y, sum, ct)
-    for (k = a_rad; k < (a_dimz - a_rad); k++)
-        for (j = a_rad; j < (a_dimy - a_rad); j++)
-            for (i = a_rad; i < (a_dimx - a_rad); i++) {
-                sum = 0.0;
-                ct = 0;
-
-                // Process kernel:
-                for (y = (j - a_rad); y <= (j + a_rad); y++) {
-                    // Gausssian kernel:
-                    sum = sum + kernel[ct++] * tmp_im[ I(i, y, k, a_dimx, a_dimy) ];
-                }
-
-                // Set out voxel with the mean of the sorted temporary array:             
-                tmp_im[ I(i, j, k, a_dimx, a_dimy) ] = sum;
-            }
+    // Set out voxels (saturated to the output range):
+#pragma omp parallel for private(i, j, val)
+    for (k = 0; k < dimz; k++)
+        for (j = 0; j < dimy; j++)
+            for (i = 0; i < dimx; i++) {
+                val = tmp_im[ I(i, j, k, dimx, dimy) ];
 
-    // Z-direction scanning
-#pragma omp parallel for private(i, j, z, sum, ct)
-    for (k = a_rad; k < (a_dimz - a_rad); k++)
-        for (j = a_rad; j < (a_dimy - a_rad); j++)
-            for (i = a_rad; i < (a_dimx - a_rad); i++) {
-                sum = 0.0;
-                ct = 0;
-
-                // Process kernel:
-                for (z = (k - a_rad); z <= (k + a_rad); z++) {
-                    // Gausssian kernel:
-                    sum = sum + kernel[ct++] * tmp_im[ I(i, j, z, a_dimx, a_dimy) ];
-                }
-
-                // Set out voxel with the mean of the sorted temporary array: 
-                if (sum < 0)
-                    out_im[ I(i - a_rad, j - a_rad, k - a_rad, dimx, dimy) ] = 0;
-                else if (sum > UCHAR_MAX)
-                    out_im[ I(i - a_rad, j - a_rad, k - a_rad, dimx, dimy) ] = UCHAR_MAX;
+                if (val < 0)
+                    out_im[ IS(i, j, k, out_sy, out_sz) ] = 0;
+                else if (val > UCHAR_MAX)
+                    out_im[ IS(i, j, k, out_sy, out_sz) ] = UCHAR_MAX;
                 else
-                    out_im[ I(i - a_rad, j - a_rad, k - a_rad, dimx, dimy) ] = (unsigned char) sum;
-
+                    out_im[ IS(i, j, k, out_sy, out_sz) ] = (unsigned char) val;
             }
 
     // Print elapsed time (if required):
@@ -178,7 +139,6 @@ int p3dGaussianFilter3D_8(
 
     // Release resources:
     if (tmp_im != NULL) free(tmp_im);
-    if (kernel != NULL) free(kernel);
 
     // Return success:
     return P3D_SUCCESS;
@@ -192,7 +152,6 @@ MEM_ERROR:
 
     // Release resources:
     if (tmp_im != NULL) free(tmp_im);
-    if (kernel != NULL) free(kernel);
 
     // Return error:
     return P3D_MEM_ERROR;
@@ -207,9 +166,20 @@ MEM_ERROR:
 
 }
 
-int p3dGaussianFilter3D_16(
-        unsigned short* in_im,
-        unsigned short* out_im,
+int p3dGaussianFilter3D_8_view(
+        struct VolumeView* in_view, // IN: input view
+        struct VolumeView* out_view, // OUT: output view (same dimensions)
+        const int size,
+        const double sigma,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    return _p3dGaussianFilter3D_8(in_view, out_view, size, sigma, P3D_FALSE, wr_log, wr_progress);
+}
+
+int p3dGaussianFilter3D_8(
+        unsigned char* in_im,
+        unsigned char* out_im,
         const int dimx,
         const int dimy,
         const int dimz,
@@ -218,17 +188,66 @@ int p3dGaussianFilter3D_16(
         int (*wr_log)(const char*, ...),
         int (*wr_progress)(const int, ...)
         ) {
-    // Padded input and related dims:
-    float* tmp_im = NULL;
-    float* kernel = NULL;
+    struct VolumeView in_view, out_view;
 
+    // Whole volumes are processed as views of themselves:
+    p3dVolumeView(&in_view, in_im, dimx, dimy, dimz, 0, 0, 0, dimx, dimy, dimz);
+    p3dVolumeView(&out_view, out_im, dimx, dimy, dimz, 0, 0, 0, dimx, dimy, dimz);
+
+    return _p3dGaussianFilter3D_8(&in_view, &out_view, size, sigma, P3D_FALSE, wr_log, wr_progress);
+}
+
+// Recursive (Young-van Vliet) variant, whose cost does not depend on sigma. It
+// approximates the whole gaussian instead of the kernel truncated to SIZE, so
+// its output differs from the one of p3dGaussianFilter3D_8: on noisy 16-bit
+// volumes by about 1% of the range at most and 0.1% on average for sigma = 2,
+// less for larger sigma (see test/p3dGaussianFilterTest.c). It falls back to
+// the truncated kernel when sigma < 2 or SIZE does not cover 3 sigma:
+int p3dGaussianFilter3D_8_iir(
+        unsigned char* in_im,
+        unsigned char* out_im,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int size,
+        const double sigma,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    struct VolumeView in_view, out_view;
+
+    p3dVolumeView(&in_view, in_im, dimx, dimy, dimz, 0, 0, 0, dimx, dimy, dimz);
+    p3dVolumeView(&out_view, out_im, dimx, dimy, dimz, 0, 0, 0, dimx, dimy, dimz);
+
+    return _p3dGaussianFilter3D_8(&in_view, &out_view, size, sigma, P3D_TRUE, wr_log, wr_progress);
+}
+
+// Filters IN_VIEW into OUT_VIEW with the truncated gaussian kernel or, if
+// FLAGIIR is P3D_TRUE, with its recursive approximation (see
+// Common/p3dGaussianEngine.h). The view is converted to a float working volume
+// because the engine filters each direction in place:
+static int _p3dGaussianFilter3D_16(
+        struct VolumeView* in_view, // IN: input view
+        struct VolumeView* out_view, // OUT: output view (same dimensions)
+        const int size,
+        const double sigma,
+        const int flagIIR,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    // Input and output are addressed through origin and strides of their views:
+    unsigned short* in_im = (unsigned short*) in_view->base + IV(0, 0, 0, in_view);
+    unsigned short* out_im = (unsigned short*) out_view->base + IV(0, 0, 0, out_view);
+    const size_t in_sy = in_view->stridey, in_sz = in_view->stridez;
+    const size_t out_sy = out_view->stridey, out_sz = out_view->stridez;
+    const int dimx = in_view->dimx, dimy = in_view->dimy, dimz = in_view->dimz;
+
+    // Working volume (filtered in place by the separable gaussian engine):
+    float* tmp_im = NULL;
 
-    int a_dimx, a_dimy, a_dimz;
     int i, j, k;
-    int x, y, z;
-    int ct, a_rad, a_size;
-    double d;
-    double f, w, sum, sum_w;
+    int a_rad;
+    float val;
     
     /*char auth_code;
 
@@ -239,12 +258,22 @@ int p3dGaussianFilter3D_16(
     if (auth_code == '0') goto AUTH_ERROR;*/
 
 
+    // Output view must have the dimensions of the input view:
+    if (p3dVolumeViewSameDims(in_view, out_view) == P3D_FALSE) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - Error: output view should have the same dimensions of the input view.");
+        }
+        return P3D_IO_ERROR;
+    }
+
     // Start tracking computational time:
     if (wr_log != NULL) {
         p3dResetStartTime();
         wr_log("Pore3D - Applying gaussian filter...");
         wr_log("\tKernel size: %d.", size);
         wr_log("\tSigma: %0.3f.", sigma);
+        if (flagIIR == P3D_TRUE)
+            wr_log("\tRecursive approximation enabled.");
     }
 
     // Set kernel size and variance:
@@ -252,95 +281,33 @@ int p3dGaussianFilter3D_16(
         a_rad = 1;
     else
         a_rad = ceil(size / 2);
-    a_size = 2 * a_rad + 1;
-
-    d = (2.0 * sigma * sigma);
-
-
-    // Compute dimensions of padded volume:
-    a_dimx = dimx + a_rad * 2;
-    a_dimy = dimy + a_rad * 2;
-    a_dimz = dimz + a_rad * 2;
 
 
-    // Initialize input:
-    tmp_im = (float*) malloc(a_dimx * a_dimy * a_dimz * sizeof (float));
-    kernel = (float*) malloc(a_size * sizeof (float));
+    // Initialize input (replicate borders are handled by the engine):
+    P3D_TRY(tmp_im = (float*) malloc((size_t) dimx * dimy * dimz * sizeof (float)));
 
-    _p3dReplicatePadding3D_ushort2float(in_im, tmp_im, dimx, dimy, dimz, a_rad);
+#pragma omp parallel for private(i, j)
+    for (k = 0; k < dimz; k++)
+        for (j = 0; j < dimy; j++)
+            for (i = 0; i < dimx; i++)
+                tmp_im[ I(i, j, k, dimx, dimy) ] = (float) in_im[ IS(i, j, k, in_sy, in_sz) ];
 
-    ct = 0;
-    sum_w = 0.0;
+    // Separable smoothing along x, y and z:
+    P3D_TRY(p3dGaussianSmooth3D_float(tmp_im, dimx, dimy, dimz, sigma, a_rad, flagIIR));
 
-    // Create gausssian kernel:
-    for (x = (-a_rad); x <= a_rad; x++) {
-       
-       f = (x)*(x) / d;
-       kernel[ct] = exp(-f);
-       sum_w = sum_w + kernel[ct++];
-    }
-    ct = 0;
-    // Normalize kernel
-    for (x = (-a_rad); x <= a_rad; x++) 
-        kernel[ct] = kernel[ct++]/sum_w;
-
-    // X-direction scanning
-#pragma omp parallel for private(i, j, x, sum, ct)
-    for (k = a_rad; k < (a_dimz - a_rad); k++)
-        for (j = a_rad; j < (a_dimy - a_rad); j++)
-            for (i = a_rad; i < (a_dimx - a_rad); i++) {
-                sum = 0.0;
-                ct = 0;
-
-                // Process kernel:
-                for (x = (i - a_rad); x <= (i + a_rad); x++) {
-                    // Gausssian kernel:                       
-                    sum = sum + kernel[ct++] * tmp_im[ I(x, j, k, a_dimx, a_dimy) ];
-                }
-
-                // Set out voxel with the mean of the sorted temporary array:                
-                tmp_im[ I(i, j, k, a_dimx, a_dimy) ] = sum;
-            }
-
-    // Y-direction scanning
-#pragma omp parallel for private(i, j, y, sum, ct)
-    for (k = a_rad; k < (a_dimz - a_rad); k++)
-        for (j = a_rad; j < (a_dimy - a_rad); j++)
-            for (i = a_rad; i < (a_dimx - a_rad); i++) {
-                sum = 0.0;
-                ct = 0;
-
-                // Process kernel:
-                for (y = (j - a_rad); y <= (j + a_rad); y++) {
-                    // Gausssian kernel:
-                    sum = sum + kernel[ct++] * tmp_im[ I(i, y, k, a_dimx, a_dimy) ];
-                }
-
-                // Set out voxel with the mean of the sorted temporary array:             
-                tmp_im[ I(i, j, k, a_dimx, a_dimy) ] = sum;
-            }
+    // Set out voxels (saturated to the output range):
+#pragma omp parallel for private(i, j, val)
+    for (k = 0; k < dimz; k++)
+        for (j = 0; j < dimy; j++)
+            for (i = 0; i < dimx; i++) {
+                val = tmp_im[ I(i, j, k, dimx, dimy) ];
 
-    // Z-direction scanning
-#pragma omp parallel for private(i, j, z, sum, ct)
-    for (k = a_rad; k < (a_dimz - a_rad); k++)
-        for (j = a_rad; j < (a_dimy - a_rad); j++)
-            for (i = a_rad; i < (a_dimx - a_rad); i++) {
-                sum = 0.0;
-                ct = 0;
-
-                // Process kernel:
-                for (z = (k - a_rad); z <= (k + a_rad); z++) {
-                    // Gausssian kernel:
-                    sum = sum + kernel[ct++] * tmp_im[ I(i, j, z, a_dimx, a_dimy) ];
-                }
-
-                // Set out voxel with the mean of the sorted temporary array:               
-                if (sum < 0)
-                    out_im[ I(i - a_rad, j - a_rad, k - a_rad, dimx, dimy) ] = 0;
-                else if (sum > USHRT_MAX)
-                    out_im[ I(i - a_rad, j - a_rad, k - a_rad, dimx, dimy) ] = USHRT_MAX;
+                if (val < 0)
+                    out_im[ IS(i, j, k, out_sy, out_sz) ] = 0;
+                else if (val > USHRT_MAX)
+                    out_im[ IS(i, j, k, out_sy, out_sz) ] = USHRT_MAX;
                 else
-                    out_im[ I(i - a_rad, j - a_rad, k - a_rad, dimx, dimy) ] = (unsigned short) sum;
+                    out_im[ IS(i, j, k, out_sy, out_sz) ] = (unsigned short) val;
             }
 
     // Print elapsed time (if required):
@@ -350,7 +317,6 @@ int p3dGaussianFilter3D_16(
 
     // Release resources:
     if (tmp_im != NULL) free(tmp_im);
-    if (kernel != NULL) free(kernel);
 
     // Return success:
     return P3D_SUCCESS;
@@ -364,7 +330,6 @@ MEM_ERROR:
 
     // Release resources:
     if (tmp_im != NULL) free(tmp_im);
-    if (kernel != NULL) free(kernel);
 
     // Return error:
     return P3D_MEM_ERROR;
@@ -378,3 +343,106 @@ MEM_ERROR:
     return P3D_AUTH_ERROR;*/
 
 }
+
+int p3dGaussianFilter3D_16_view(
+        struct VolumeView* in_view, // IN: input view
+        struct VolumeView* out_view, // OUT: output view (same dimensions)
+        const int size,
+        const double sigma,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    return _p3dGaussianFilter3D_16(in_view, out_view, size, sigma, P3D_FALSE, wr_log, wr_progress);
+}
+
+int p3dGaussianFilter3D_16(
+        unsigned short* in_im,
+        unsigned short* out_im,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int size,
+        const double sigma,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    struct VolumeView in_view, out_view;
+
+    // Whole volumes are processed as views of themselves:
+    p3dVolumeView(&in_view, in_im, dimx, dimy, dimz, 0, 0, 0, dimx, dimy, dimz);
+    p3dVolumeView(&out_view, out_im, dimx, dimy, dimz, 0, 0, 0, dimx, dimy, dimz);
+
+    return _p3dGaussianFilter3D_16(&in_view, &out_view, size, sigma, P3D_FALSE, wr_log, wr_progress);
+}
+
+// Recursive (Young-van Vliet) variant, whose cost does not depend on sigma. It
+// approximates the whole gaussian instead of the kernel truncated to SIZE, so
+// its output differs from the one of p3dGaussianFilter3D_16: on noisy 16-bit
+// volumes by about 1% of the range at most and 0.1% on average for sigma = 2,
+// less for larger sigma (see test/p3dGaussianFilterTest.c). It falls back to
+// the truncated kernel when sigma < 2 or SIZE does not cover 3 sigma:
+int p3dGaussianFilter3D_16_iir(
+        unsigned short* in_im,
+        unsigned short* out_im,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int size,
+        const double sigma,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    struct VolumeView in_view, out_view;
+
+    p3dVolumeView(&in_view, in_im, dimx, dimy, dimz, 0, 0, 0, dimx, dimy, dimz);
+    p3dVolumeView(&out_view, out_im, dimx, dimy, dimz, 0, 0, 0, dimx, dimy, dimz);
+
+    return _p3dGaussianFilter3D_16(&in_view, &out_view, size, sigma, P3D_TRUE, wr_log, wr_progress);
+}
+
+int _p3dGaussianFilter3D_16_slab(void* in_im, void* out_im, const int dimx, const int dimy, const int dimz, void* params) {
+    struct GaussianParams* p = (struct GaussianParams*) params;
+
+    return p3dGaussianFilter3D_16((unsigned short*) in_im, (unsigned short*) out_im, dimx, dimy, dimz, p->size, p->sigma, NULL, NULL);
+}
+
+int p3dGaussianFilter3D_16_stream(
+        char* in_filename,
+        char* out_filename,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int size,
+        const double sigma,
+        const int flagLittle,
+        const int flagSigned,
+        const int slab, // IN: number of slices filtered at once
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    struct GaussianParams params;
+    int err;
+
+    // Start tracking computational time:
+    if (wr_log != NULL) {
+        p3dResetStartTime();
+        wr_log("Pore3D - Applying gaussian filter (streaming)...");
+        wr_log("\tKernel size: %d.", size);
+        wr_log("\tSigma: %0.3f.", sigma);
+        wr_log("\tSlab size: %d.", slab);
+    }
+
+    params.size = size;
+    params.sigma = sigma;
+
+    // Process file by slabs having a halo as thick as the kernel radius:
+    err = _p3dSlabFilter(in_filename, out_filename, dimx, dimy, dimz, 2, flagLittle, flagSigned, slab, (size < 1) ? 1 : size / 2,
+            _p3dGaussianFilter3D_16_slab, (void*) &params, wr_log, wr_progress);
+
+    // Print elapsed time (if required):
+    if ((wr_log != NULL) && (err == P3D_SUCCESS)) {
+        wr_log("Pore3D - Gaussian filter applied successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
+    }
+
+    return err;
+}
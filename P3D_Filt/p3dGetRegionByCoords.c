@@ -369,16 +369,16 @@ int p3dGetRegionByCoords3D (
     a_dimz = dimz + a_rad*2;
  
     // Initialize input:
-    tmp_in_rev = (unsigned char*) malloc( a_dimx*a_dimy*a_dimz*sizeof(unsigned char) );
+    tmp_in_rev = (unsigned char*) malloc( (size_t) a_dimx*a_dimy*a_dimz*sizeof(unsigned char) );
     if ( tmp_in_rev == NULL ) goto MEM_ERROR;
  
     p3dZeroPadding3D_8 ( in_rev, tmp_in_rev, dimx, dimy, dimz, a_rad, NULL, NULL );
  
     // Initialize output volume with a copy of input volume:
-    tmp_out_rev = (unsigned char*) malloc( a_dimx*a_dimy*a_dimz*sizeof(unsigned char) );
+    tmp_out_rev = (unsigned char*) malloc( (size_t) a_dimx*a_dimy*a_dimz*sizeof(unsigned char) );
     if ( tmp_out_rev == NULL ) goto MEM_ERROR;
  
-    memcpy(tmp_out_rev,tmp_in_rev,a_dimx*a_dimy*a_dimz*sizeof(unsigned char));
+    memcpy(tmp_out_rev,tmp_in_rev,(size_t) a_dimx*a_dimy*a_dimz*sizeof(unsigned char));
  
  
     // Initialize variables:
@@ -78,7 +78,7 @@ int p3dHuangYagerThresholding_8(
     int i, t, tbest = -1, u0, u1;
     int start, end;
 
-    int ct;
+    long long ct;
 
     /*char auth_code;
 
@@ -105,7 +105,7 @@ int p3dHuangYagerThresholding_8(
     F = (double *) malloc(sizeof (double) *(UCHAR_MAX + 1));
 
     /* Compute image histogram: */
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         hist[in_im[ ct ]] = hist[in_im[ ct ]] + 1.0;
 
 
@@ -135,7 +135,7 @@ int p3dHuangYagerThresholding_8(
         u1 = (int) (Wbar[t] / Sbar[t] + 0.5);
 
         /* Fuzziness measure */
-        F[t] = _p3dHuangYagerThresholding_yager(u0, u1, t) / (dimx * dimy * dimz);
+        F[t] = _p3dHuangYagerThresholding_yager(u0, u1, t) / ((double) dimx * dimy * dimz);
 
         /* Keep the minimum fuzziness */
         if (F[t] > maxv)
@@ -167,7 +167,7 @@ int p3dHuangYagerThresholding_8(
 
 
 #pragma omp parallel for
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         out_im[ ct ] = (in_im[ ct ] > (*thresh)) ? OBJECT : BACKGROUND;
 
     // Free memory:
@@ -231,7 +231,7 @@ int p3dHuangYagerThresholding_16(
     int i, t, tbest = -1, u0, u1;
     int start, end;
 
-    int ct;
+    long long ct;
 
     /*char auth_code;
 
@@ -257,7 +257,7 @@ int p3dHuangYagerThresholding_16(
     F = (double *) malloc(sizeof (double) *(USHRT_MAX + 1));
 
     /* Compute image histogram: */
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         hist[in_im[ ct ]] = hist[in_im[ ct ]] + 1.0;
 
 
@@ -287,7 +287,7 @@ int p3dHuangYagerThresholding_16(
         u1 = (int) (Wbar[t] / Sbar[t] + 0.5);
 
         /* Fuzziness measure */
-        F[t] = _p3dHuangYagerThresholding_yager(u0, u1, t) / (dimx * dimy * dimz);
+        F[t] = _p3dHuangYagerThresholding_yager(u0, u1, t) / ((double) dimx * dimy * dimz);
 
         /* Keep the minimum fuzziness */
         if (F[t] > maxv)
@@ -319,7 +319,7 @@ int p3dHuangYagerThresholding_16(
 
 
 #pragma omp parallel for
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         out_im[ ct ] = (in_im[ ct ] > (*thresh)) ? OBJECT : BACKGROUND;
 
     // Free memory:
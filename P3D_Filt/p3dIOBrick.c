@@ -0,0 +1,905 @@
+/***************************************************************************/
+/* (C) 2016 Elettra - Sincrotrone Trieste S.C.p.A.. All rights reserved.   */
+/*                                                                         */
+/*                                                                         */
+/* This file is part of Pore3D, a software library for quantitative        */
+/* analysis of 3D (volume) images.                                         */
+/*                                                                         */
+/* Pore3D is free software: you can redistribute it and/or modify it       */
+/* under the terms of the GNU General Public License as published by the   */
+/* Free Software Foundation, either version 3 of the License, or (at your  */
+/* option) any later version.                                              */
+/*                                                                         */
+/* Pore3D is distributed in the hope that it will be useful, but WITHOUT   */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or   */
+/* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License    */
+/* for more details.                                                       */
+/*                                                                         */
+/* You should have received a copy of the GNU General Public License       */
+/* along with Pore3D. If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                         */
+/***************************************************************************/
+
+//
+// Author: Francesco Brun
+// Last modified: October, 16th 2026
+//
+
+// Bricked volume format. The volume is split into cubic bricks of BRICK^3
+// voxels (smaller at the borders) each compressed independently, so that a
+// region of interest can be read by decoding only the bricks it intersects.
+//
+// File layout (host byte order):
+//
+//   char      magic[4]              "P3DB"
+//   int       version               1
+//   int       dimx, dimy, dimz
+//   int       bytes                 1 (8-bit) or 2 (16-bit)
+//   int       brick                 brick side
+//   double    voxelsize
+//   long long offset[nbricks + 1]   absolute offsets of bricks in the file
+//   ...       bricks                (brick b spans offset[b] to offset[b+1])
+//
+// Bricks are ordered with x fastest, then y, then z. The first byte of each
+// brick identifies the codec: delta+RLE for 8-bit data (binary masks reduce
+// to a handful of runs), bit-plane shuffle+LZ77 for 16-bit data (the most
+// significant bit-planes of CT data are almost constant). Bricks that do not
+// compress are stored uncompressed.
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <omp.h>
+
+#include "p3dFilt.h"
+#include "p3dTime.h"
+
+#ifdef _WINDOWS
+	#define _p3dFseek	_fseeki64
+	#define _p3dFtell	_ftelli64
+#else
+	#define _p3dFseek	fseeko
+	#define _p3dFtell	ftello
+#endif
+
+#define P3D_BRICK_VERSION		1
+#define P3D_BRICK_DEFAULT		64
+#define P3D_BRICK_MAX			512
+#define P3D_BRICK_HEADER_SIZE	(4 + 6 * sizeof (int) + sizeof (double))
+
+// Brick codecs:
+#define P3D_BRICK_CODEC_RAW		0
+#define P3D_BRICK_CODEC_RLE		1	// delta + run-length (8-bit)
+#define P3D_BRICK_CODEC_LZ		2	// bit-plane shuffle + LZ77 (16-bit)
+
+// LZ77 parameters:
+#define P3D_LZ_MINMATCH		4
+#define P3D_LZ_HASHBITS		12
+#define P3D_LZ_MAXOFFSET	65535
+
+struct BrickHeader {
+    int dimx, dimy, dimz;
+    int bytes;
+    int brick;
+    double voxelsize;
+    int nbx, nby, nbz;
+    long long* offset;
+};
+
+
+/* ------------------------------------------------------------------------ */
+/*  Codecs                                                                  */
+/* ------------------------------------------------------------------------ */
+
+// Upper bound of the encoded size of N bytes (any codec, codec byte included):
+size_t _p3dBrickBound(const size_t n) {
+    return n + n / 128 + 32;
+}
+
+// PackBits-like run-length encoding: a control byte C < 128 is followed by
+// C + 1 literals, a control byte C >= 128 is followed by a byte repeated
+// C - 126 times.
+size_t _p3dRLEEncode(const unsigned char* src, const size_t n, unsigned char* dst) {
+    size_t i = 0, j, o = 0, run;
+
+    while (i < n) {
+        run = 1;
+        while (((i + run) < n) && (run < 129) && (src[i + run] == src[i])) run++;
+
+        if (run >= 2) {
+            dst[o++] = (unsigned char) (run + 126);
+            dst[o++] = src[i];
+            i += run;
+        } else {
+            // Literals up to the beginning of the next run of at least 3 bytes
+            // (shorter runs would not save anything):
+            j = i + 1;
+            while ((j < n) && ((j - i) < 128) && !(((j + 2) < n) && (src[j + 1] == src[j]) && (src[j + 2] == src[j]))) j++;
+
+            dst[o++] = (unsigned char) (j - i - 1);
+            memcpy(dst + o, src + i, j - i);
+            o += j - i;
+            i = j;
+        }
+    }
+
+    return o;
+}
+
+int _p3dRLEDecode(const unsigned char* src, const size_t len, unsigned char* dst, const size_t n) {
+    size_t i = 0, o = 0, run;
+    unsigned char c;
+
+    while ((o < n) && (i < len)) {
+        c = src[i++];
+        if (c < 128) {
+            run = (size_t) c + 1;
+            if (((o + run) > n) || ((i + run) > len)) return P3D_IO_ERROR;
+            memcpy(dst + o, src + i, run);
+            i += run;
+        } else {
+            run = (size_t) c - 126;
+            if (((o + run) > n) || (i >= len)) return P3D_IO_ERROR;
+            memset(dst + o, src[i++], run);
+        }
+        o += run;
+    }
+
+    return (o == n) ? P3D_SUCCESS : P3D_IO_ERROR;
+}
+
+static void _p3dLZPutLength(unsigned char* dst, size_t* o, size_t len) {
+    while (len >= 255) {
+        dst[(*o)++] = 255;
+        len -= 255;
+    }
+    dst[(*o)++] = (unsigned char) len;
+}
+
+static unsigned int _p3dLZRead32(const unsigned char* p) {
+    unsigned int v;
+
+    memcpy(&v, p, sizeof (unsigned int));
+    return v;
+}
+
+// Byte-oriented LZ77 (LZ4-like sequences): a token holds the number of
+// literals (high nibble) and the match length minus P3D_LZ_MINMATCH (low
+// nibble), both extended with 255-terminated bytes when equal to 15. Literals
+// follow, then a 16-bit little endian offset. The last sequence has no match.
+size_t _p3dLZEncode(const unsigned char* src, const size_t n, unsigned char* dst) {
+    int table[1 << P3D_LZ_HASHBITS];
+    size_t ip = 0, anchor = 0, o = 0, lit, len, ref;
+    unsigned int seq, h;
+    int prev;
+    unsigned char* token;
+
+    for (h = 0; h < (1 << P3D_LZ_HASHBITS); h++)
+        table[h] = -1;
+
+    while ((ip + P3D_LZ_MINMATCH) <= n) {
+        seq = _p3dLZRead32(src + ip);
+        h = (seq * 2654435761U) >> (32 - P3D_LZ_HASHBITS);
+        prev = table[h];
+        ref = (size_t) prev;
+        table[h] = (int) ip;
+
+        if ((prev >= 0) && ((ip - ref) <= P3D_LZ_MAXOFFSET) && (_p3dLZRead32(src + ref) == seq)) {
+            // Extend match:
+            len = P3D_LZ_MINMATCH;
+            while (((ip + len) < n) && (src[ref + len] == src[ip + len])) len++;
+
+            // Emit sequence:
+            lit = ip - anchor;
+            token = dst + o++;
+            *token = (unsigned char) (((lit < 15) ? lit : 15) << 4);
+            if (lit >= 15) _p3dLZPutLength(dst, &o, lit - 15);
+            memcpy(dst + o, src + anchor, lit);
+            o += lit;
+
+            dst[o++] = (unsigned char) ((ip - ref) & 0xFF);
+            dst[o++] = (unsigned char) ((ip - ref) >> 8);
+
+            *token |= (unsigned char) (((len - P3D_LZ_MINMATCH) < 15) ? (len - P3D_LZ_MINMATCH) : 15);
+            if ((len - P3D_LZ_MINMATCH) >= 15) _p3dLZPutLength(dst, &o, len - P3D_LZ_MINMATCH - 15);
+
+            ip += len;
+            anchor = ip;
+        } else {
+            ip++;
+        }
+    }
+
+    // Last literals:
+    lit = n - anchor;
+    dst[o++] = (unsigned char) (((lit < 15) ? lit : 15) << 4);
+    if (lit >= 15) _p3dLZPutLength(dst, &o, lit - 15);
+    memcpy(dst + o, src + anchor, lit);
+    o += lit;
+
+    return o;
+}
+
+int _p3dLZDecode(const unsigned char* src, const size_t len, unsigned char* dst, const size_t n) {
+    size_t i = 0, o = 0, lit, mlen, off, ct;
+    unsigned char token, b;
+
+    while (i < len) {
+        token = src[i++];
+
+        // Literals:
+        lit = token >> 4;
+        if (lit == 15) {
+            do {
+                if (i >= len) return P3D_IO_ERROR;
+                b = src[i++];
+                lit += b;
+            } while (b == 255);
+        }
+        if (((i + lit) > len) || ((o + lit) > n)) return P3D_IO_ERROR;
+        memcpy(dst + o, src + i, lit);
+        i += lit;
+        o += lit;
+
+        if (o == n) break;
+
+        // Match:
+        if ((i + 2) > len) return P3D_IO_ERROR;
+        off = (size_t) src[i] | ((size_t) src[i + 1] << 8);
+        i += 2;
+
+        mlen = token & 15;
+        if (mlen == 15) {
+            do {
+                if (i >= len) return P3D_IO_ERROR;
+                b = src[i++];
+                mlen += b;
+            } while (b == 255);
+        }
+        mlen += P3D_LZ_MINMATCH;
+
+        if ((off == 0) || (off > o) || ((o + mlen) > n)) return P3D_IO_ERROR;
+
+        // Byte by byte since source and destination may overlap:
+        for (ct = 0; ct < mlen; ct++, o++)
+            dst[o] = dst[o - off];
+    }
+
+    return (o == n) ? P3D_SUCCESS : P3D_IO_ERROR;
+}
+
+// Bit-plane shuffle of N 16-bit values: plane b (b = 0..15) collects bit b of
+// groups of 8 consecutive values. Values exceeding a multiple of 8 are
+// appended unchanged.
+void _p3dBitShuffle16(const unsigned short* src, const size_t n, unsigned char* dst) {
+    const size_t ng = n / 8;
+    size_t g;
+    int b, j;
+    unsigned char v;
+
+    for (b = 0; b < 16; b++) {
+        for (g = 0; g < ng; g++) {
+            v = 0;
+            for (j = 0; j < 8; j++)
+                v |= (unsigned char) (((src[g * 8 + j] >> b) & 1) << j);
+            dst[b * ng + g] = v;
+        }
+    }
+    memcpy(dst + 16 * ng, src + 8 * ng, (n - 8 * ng) * sizeof (unsigned short));
+}
+
+void _p3dBitUnshuffle16(const unsigned char* src, const size_t n, unsigned short* dst) {
+    const size_t ng = n / 8;
+    size_t g;
+    int b, j;
+    unsigned char v;
+
+    memset(dst, 0, 8 * ng * sizeof (unsigned short));
+    for (b = 0; b < 16; b++) {
+        for (g = 0; g < ng; g++) {
+            v = src[b * ng + g];
+            for (j = 0; j < 8; j++)
+                dst[g * 8 + j] |= (unsigned short) (((v >> j) & 1) << b);
+        }
+    }
+    memcpy(dst + 8 * ng, src + 16 * ng, (n - 8 * ng) * sizeof (unsigned short));
+}
+
+// Encodes N voxels (of BYTES bytes) of SRC into DST (at least _p3dBrickBound
+// bytes). TMP is a scratch buffer of N*BYTES bytes. Returns the encoded size.
+size_t _p3dBrickEncode(const unsigned char* src, const size_t n, const int bytes, unsigned char* dst, unsigned char* tmp) {
+    const size_t raw = n * bytes;
+    size_t len, ct;
+
+    if (bytes == 1) {
+        // Delta with the previous voxel (mod 256) then RLE:
+        tmp[0] = src[0];
+        for (ct = 1; ct < n; ct++)
+            tmp[ct] = (unsigned char) (src[ct] - src[ct - 1]);
+        dst[0] = P3D_BRICK_CODEC_RLE;
+        len = _p3dRLEEncode(tmp, n, dst + 1);
+    } else {
+        _p3dBitShuffle16((const unsigned short*) src, n, tmp);
+        dst[0] = P3D_BRICK_CODEC_LZ;
+        len = _p3dLZEncode(tmp, raw, dst + 1);
+    }
+
+    // Fallback to uncompressed data:
+    if (len >= raw) {
+        dst[0] = P3D_BRICK_CODEC_RAW;
+        memcpy(dst + 1, src, raw);
+        len = raw;
+    }
+
+    return len + 1;
+}
+
+int _p3dBrickDecode(const unsigned char* src, const size_t len, const size_t n, const int bytes, unsigned char* dst, unsigned char* tmp) {
+    size_t ct;
+
+    if (len < 1) return P3D_IO_ERROR;
+
+    switch (src[0]) {
+        case P3D_BRICK_CODEC_RAW:
+            if ((len - 1) != (n * bytes)) return P3D_IO_ERROR;
+            memcpy(dst, src + 1, n * bytes);
+            return P3D_SUCCESS;
+
+        case P3D_BRICK_CODEC_RLE:
+            if (bytes != 1) return P3D_IO_ERROR;
+            if (_p3dRLEDecode(src + 1, len - 1, dst, n) != P3D_SUCCESS) return P3D_IO_ERROR;
+            for (ct = 1; ct < n; ct++)
+                dst[ct] = (unsigned char) (dst[ct] + dst[ct - 1]);
+            return P3D_SUCCESS;
+
+        case P3D_BRICK_CODEC_LZ:
+            if (bytes != 2) return P3D_IO_ERROR;
+            if (_p3dLZDecode(src + 1, len - 1, tmp, n * bytes) != P3D_SUCCESS) return P3D_IO_ERROR;
+            _p3dBitUnshuffle16(tmp, n, (unsigned short*) dst);
+            return P3D_SUCCESS;
+    }
+
+    return P3D_IO_ERROR;
+}
+
+
+/* ------------------------------------------------------------------------ */
+/*  Header                                                                  */
+/* ------------------------------------------------------------------------ */
+
+// Reads the header and the brick offset table. Since offsets are used to
+// size and place the reads, they are checked against the file length and
+// against the largest encoded size of each brick:
+int _p3dReadBrickHeader(FILE* fvol, struct BrickHeader* h) {
+    char magic[4];
+    int version;
+    long long nbricks, b, len, flen;
+    int bx, by, bz;
+    size_t n;
+
+    h->offset = NULL;
+
+    if (fread(magic, sizeof (char), 4, fvol) < 4) return P3D_IO_ERROR;
+    if (strncmp(magic, "P3DB", 4) != 0) return P3D_IO_ERROR;
+    if (fread(&version, sizeof (int), 1, fvol) < 1) return P3D_IO_ERROR;
+    if (version != P3D_BRICK_VERSION) return P3D_IO_ERROR;
+    if (fread(&(h->dimx), sizeof (int), 1, fvol) < 1) return P3D_IO_ERROR;
+    if (fread(&(h->dimy), sizeof (int), 1, fvol) < 1) return P3D_IO_ERROR;
+    if (fread(&(h->dimz), sizeof (int), 1, fvol) < 1) return P3D_IO_ERROR;
+    if (fread(&(h->bytes), sizeof (int), 1, fvol) < 1) return P3D_IO_ERROR;
+    if (fread(&(h->brick), sizeof (int), 1, fvol) < 1) return P3D_IO_ERROR;
+    if (fread(&(h->voxelsize), sizeof (double), 1, fvol) < 1) return P3D_IO_ERROR;
+
+    if ((h->dimx < 1) || (h->dimy < 1) || (h->dimz < 1) || (h->brick < 1) ||
+            (h->brick > P3D_BRICK_MAX) || ((h->bytes != 1) && (h->bytes != 2)))
+        return P3D_IO_ERROR;
+
+    h->nbx = (h->dimx + h->brick - 1) / h->brick;
+    h->nby = (h->dimy + h->brick - 1) / h->brick;
+    h->nbz = (h->dimz + h->brick - 1) / h->brick;
+    nbricks = (long long) h->nbx * h->nby * h->nbz;
+
+    // File length (the offset table must fit in the file):
+    if (_p3dFseek(fvol, 0, SEEK_END) != 0) return P3D_IO_ERROR;
+    flen = (long long) _p3dFtell(fvol);
+    if ((flen < ((long long) P3D_BRICK_HEADER_SIZE + (nbricks + 1) * (long long) sizeof (long long))) ||
+            (_p3dFseek(fvol, (long long) P3D_BRICK_HEADER_SIZE, SEEK_SET) != 0))
+        return P3D_IO_ERROR;
+
+    // Brick offset table:
+    h->offset = (long long*) malloc((size_t) (nbricks + 1) * sizeof (long long));
+    if (h->offset == NULL) return P3D_IO_ERROR;
+    if (fread(h->offset, sizeof (long long), (size_t) (nbricks + 1), fvol) < ((size_t) (nbricks + 1)))
+        goto IO_ERROR;
+
+    // Bricks follow the offset table and the last one ends within the file:
+    if (h->offset[0] != ((long long) P3D_BRICK_HEADER_SIZE + (nbricks + 1) * (long long) sizeof (long long)))
+        goto IO_ERROR;
+    if (h->offset[nbricks] > flen) goto IO_ERROR;
+
+    for (b = 0; b < nbricks; b++) {
+        bx = (int) (b % h->nbx);
+        by = (int) ((b / h->nbx) % h->nby);
+        bz = (int) (b / ((long long) h->nbx * h->nby));
+        n = (size_t) MIN(h->brick, h->dimx - bx * h->brick) * MIN(h->brick, h->dimy - by * h->brick) *
+                MIN(h->brick, h->dimz - bz * h->brick);
+
+        len = h->offset[b + 1] - h->offset[b];
+        if ((len < 1) || (len > (long long) _p3dBrickBound(n * h->bytes))) goto IO_ERROR;
+    }
+
+    return P3D_SUCCESS;
+
+IO_ERROR:
+
+    free(h->offset);
+    h->offset = NULL;
+
+    return P3D_IO_ERROR;
+}
+
+
+/* ------------------------------------------------------------------------ */
+/*  Write                                                                   */
+/* ------------------------------------------------------------------------ */
+
+int _p3dWriteBrick(
+        unsigned char* in_im,
+        char* filename,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int bytes,
+        const double voxelsize,
+        const int brick,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    FILE* fvol;
+    long long* offset = NULL;
+    unsigned char** enc = NULL;
+    size_t* enc_len = NULL;
+    unsigned char *b_im, *b_tmp;
+    const int version = P3D_BRICK_VERSION;
+    int a_brick, nbx, nby, nbz, nb_layer;
+    int b, bx, by, bz, wx, wy, wz, y, z;
+    int err = P3D_FALSE;
+    long long nbricks, pos;
+    size_t n;
+
+    // Brick side (a brick must fit in memory and in 32-bit LZ positions):
+    a_brick = (brick < 8) ? P3D_BRICK_DEFAULT : MIN(brick, P3D_BRICK_MAX);
+
+    nbx = (dimx + a_brick - 1) / a_brick;
+    nby = (dimy + a_brick - 1) / a_brick;
+    nbz = (dimz + a_brick - 1) / a_brick;
+    nb_layer = nbx * nby;
+    nbricks = (long long) nb_layer * nbz;
+
+    P3D_TRY(offset = (long long*) calloc((size_t) (nbricks + 1), sizeof (long long)));
+    P3D_TRY(enc = (unsigned char**) calloc(nb_layer, sizeof (unsigned char*)));
+    P3D_TRY(enc_len = (size_t*) calloc(nb_layer, sizeof (size_t)));
+
+    /* Get a handler for the output file */
+    if ((fvol = fopen(filename, "wb")) == NULL) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - IO error: cannot open output file %s. Program will exit.", filename);
+        }
+        free(offset);
+        free(enc);
+        free(enc_len);
+
+        return P3D_IO_ERROR;
+    }
+
+    // Header and room for the offset table:
+    fwrite("P3DB", sizeof (char), 4, fvol);
+    fwrite(&version, sizeof (int), 1, fvol);
+    fwrite(&dimx, sizeof (int), 1, fvol);
+    fwrite(&dimy, sizeof (int), 1, fvol);
+    fwrite(&dimz, sizeof (int), 1, fvol);
+    fwrite(&bytes, sizeof (int), 1, fvol);
+    fwrite(&a_brick, sizeof (int), 1, fvol);
+    fwrite(&voxelsize, sizeof (double), 1, fvol);
+    fwrite(offset, sizeof (long long), (size_t) (nbricks + 1), fvol);
+
+    pos = (long long) P3D_BRICK_HEADER_SIZE + (nbricks + 1) * (long long) sizeof (long long);
+
+    // Encode a layer of bricks in parallel and then write it:
+    for (bz = 0; bz < nbz; bz++) {
+
+#pragma omp parallel for private(bx, by, wx, wy, wz, y, z, n, b_im, b_tmp)
+        for (b = 0; b < nb_layer; b++) {
+            bx = b % nbx;
+            by = b / nbx;
+            wx = MIN(a_brick, dimx - bx * a_brick);
+            wy = MIN(a_brick, dimy - by * a_brick);
+            wz = MIN(a_brick, dimz - bz * a_brick);
+            n = (size_t) wx * wy * wz;
+
+            b_im = (unsigned char*) malloc(n * bytes);
+            b_tmp = (unsigned char*) malloc(n * bytes);
+            enc[b] = (unsigned char*) malloc(_p3dBrickBound(n * bytes));
+
+            if ((b_im == NULL) || (b_tmp == NULL) || (enc[b] == NULL)) {
+                err = P3D_TRUE;
+            } else {
+                // Gather brick voxels (x fastest):
+                for (z = 0; z < wz; z++)
+                    for (y = 0; y < wy; y++)
+                        memcpy(b_im + ((size_t) z * wy + y) * wx * bytes,
+                            in_im + I(bx * a_brick, by * a_brick + y, bz * a_brick + z, dimx, dimy) * bytes,
+                            (size_t) wx * bytes);
+
+                enc_len[b] = _p3dBrickEncode(b_im, n, bytes, enc[b], b_tmp);
+            }
+
+            if (b_im != NULL) free(b_im);
+            if (b_tmp != NULL) free(b_tmp);
+        }
+
+        for (b = 0; b < nb_layer; b++) {
+            if ((err == P3D_FALSE) && (fwrite(enc[b], sizeof (unsigned char), enc_len[b], fvol) < enc_len[b]))
+                err = P3D_TRUE;
+            offset[(long long) bz * nb_layer + b] = pos;
+            pos += (long long) enc_len[b];
+            if (enc[b] != NULL) free(enc[b]);
+            enc[b] = NULL;
+        }
+
+        if (err == P3D_TRUE) break;
+
+        // Update any progress bar:
+        if (wr_progress != NULL) wr_progress((int) ((double) (bz + 1) / nbz * 100 + 0.5));
+    }
+    offset[nbricks] = pos;
+
+    // Fill the offset table:
+    if ((err == P3D_FALSE) && (_p3dFseek(fvol, (long long) P3D_BRICK_HEADER_SIZE, SEEK_SET) == 0)) {
+        if (fwrite(offset, sizeof (long long), (size_t) (nbricks + 1), fvol) < ((size_t) (nbricks + 1)))
+            err = P3D_TRUE;
+    } else {
+        err = P3D_TRUE;
+    }
+
+    if (fclose(fvol) != 0) err = P3D_TRUE;
+
+    // Release resources:
+    free(offset);
+    free(enc);
+    free(enc_len);
+
+    if (err == P3D_TRUE) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - IO error: error on writing file %s. Program will exit.", filename);
+        }
+
+        return P3D_IO_ERROR;
+    }
+
+    return P3D_SUCCESS;
+
+MEM_ERROR:
+
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Not enough (contiguous) memory. Program will exit.");
+    }
+
+    // Release resources:
+    if (offset != NULL) free(offset);
+    if (enc != NULL) free(enc);
+    if (enc_len != NULL) free(enc_len);
+
+    return P3D_MEM_ERROR;
+}
+
+
+/* ------------------------------------------------------------------------ */
+/*  Read                                                                    */
+/* ------------------------------------------------------------------------ */
+
+// Reads the region [x0, x0 + rx) x [y0, y0 + ry) x [z0, z0 + rz) into OUT_IM
+// (of size rx * ry * rz) decoding only the bricks intersecting it:
+int _p3dReadBrickROI(
+        char* filename,
+        unsigned char* out_im,
+        const int bytes,
+        const int x0,
+        const int y0,
+        const int z0,
+        const int rx,
+        const int ry,
+        const int rz,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    FILE* fvol;
+    struct BrickHeader h;
+    unsigned char *b_enc, *b_im, *b_tmp;
+    int bx0, by0, bz0, nrx, nry, nrz, nr;
+    int r, bx, by, bz, wx, wy, ox, oy, oz, ex, ey, ez, y, z;
+    int err = P3D_FALSE;
+    int rd;
+    long long b;
+    size_t n, len;
+
+    /* Get a handler for the input file */
+    if ((fvol = fopen(filename, "rb")) == NULL) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - IO error: cannot open input file %s. Program will exit.", filename);
+        }
+
+        return P3D_IO_ERROR;
+    }
+
+    if ((_p3dReadBrickHeader(fvol, &h) != P3D_SUCCESS) || (h.bytes != bytes) ||
+            (x0 < 0) || (y0 < 0) || (z0 < 0) || (rx < 1) || (ry < 1) || (rz < 1) ||
+            ((x0 + rx) > h.dimx) || ((y0 + ry) > h.dimy) || ((z0 + rz) > h.dimz)) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - IO error: invalid bricked file %s or region. Program will exit.", filename);
+        }
+        if (h.offset != NULL) free(h.offset);
+        fclose(fvol);
+
+        return P3D_IO_ERROR;
+    }
+
+    // Range of intersected bricks:
+    bx0 = x0 / h.brick;
+    by0 = y0 / h.brick;
+    bz0 = z0 / h.brick;
+    nrx = (x0 + rx - 1) / h.brick - bx0 + 1;
+    nry = (y0 + ry - 1) / h.brick - by0 + 1;
+    nrz = (z0 + rz - 1) / h.brick - bz0 + 1;
+    nr = nrx * nry * nrz;
+
+#pragma omp parallel for private(bx, by, bz, wx, wy, ox, oy, oz, ex, ey, ez, y, z, b, n, len, b_enc, b_im, b_tmp, rd)
+    for (r = 0; r < nr; r++) {
+        bx = bx0 + r % nrx;
+        by = by0 + (r / nrx) % nry;
+        bz = bz0 + r / (nrx * nry);
+        b = (long long) I(bx, by, bz, h.nbx, h.nby);
+
+        wx = MIN(h.brick, h.dimx - bx * h.brick);
+        wy = MIN(h.brick, h.dimy - by * h.brick);
+        n = (size_t) wx * wy * MIN(h.brick, h.dimz - bz * h.brick);
+        len = (size_t) (h.offset[b + 1] - h.offset[b]);
+
+        b_enc = (unsigned char*) malloc(len);
+        b_im = (unsigned char*) malloc(n * bytes);
+        b_tmp = (unsigned char*) malloc(n * bytes);
+
+        if ((b_enc == NULL) || (b_im == NULL) || (b_tmp == NULL)) {
+            err = P3D_TRUE;
+        } else {
+            // Reads are serialized, decoding is not:
+#pragma omp critical
+            {
+                rd = ((_p3dFseek(fvol, h.offset[b], SEEK_SET) == 0) && (fread(b_enc, sizeof (unsigned char), len, fvol) == len));
+            }
+
+            if (!rd || (_p3dBrickDecode(b_enc, len, n, bytes, b_im, b_tmp) != P3D_SUCCESS)) {
+                err = P3D_TRUE;
+            } else {
+                // Intersection of brick and region (in volume coordinates):
+                ox = MAX(bx * h.brick, x0);
+                oy = MAX(by * h.brick, y0);
+                oz = MAX(bz * h.brick, z0);
+                ex = MIN((bx + 1) * h.brick, x0 + rx);
+                ey = MIN((by + 1) * h.brick, y0 + ry);
+                ez = MIN((bz + 1) * h.brick, z0 + rz);
+
+                for (z = oz; z < ez; z++)
+                    for (y = oy; y < ey; y++)
+                        memcpy(out_im + I(ox - x0, y - y0, z - z0, rx, ry) * bytes,
+                            b_im + I(ox - bx * h.brick, y - by * h.brick, z - bz * h.brick, wx, wy) * bytes,
+                            (size_t) (ex - ox) * bytes);
+            }
+        }
+
+        if (b_enc != NULL) free(b_enc);
+        if (b_im != NULL) free(b_im);
+        if (b_tmp != NULL) free(b_tmp);
+    }
+
+    // Release resources:
+    free(h.offset);
+    fclose(fvol);
+
+    if (err == P3D_TRUE) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - IO error: error on reading file %s. Program will exit.", filename);
+        }
+
+        return P3D_IO_ERROR;
+    }
+
+    // Update any progress bar:
+    if (wr_progress != NULL) wr_progress(100);
+
+    return P3D_SUCCESS;
+}
+
+
+/* ------------------------------------------------------------------------ */
+/*  Public API                                                              */
+/* ------------------------------------------------------------------------ */
+
+int p3dReadBrickInfo(
+        char* filename,
+        int* dimx,
+        int* dimy,
+        int* dimz,
+        int* bytes,
+        double* voxelsize
+        ) {
+    FILE* fvol;
+    struct BrickHeader h;
+
+    if ((fvol = fopen(filename, "rb")) == NULL)
+        return P3D_IO_ERROR;
+
+    if (_p3dReadBrickHeader(fvol, &h) != P3D_SUCCESS) {
+        if (h.offset != NULL) free(h.offset);
+        fclose(fvol);
+
+        return P3D_IO_ERROR;
+    }
+
+    *dimx = h.dimx;
+    *dimy = h.dimy;
+    *dimz = h.dimz;
+    *bytes = h.bytes;
+    *voxelsize = h.voxelsize;
+
+    free(h.offset);
+    fclose(fvol);
+
+    return P3D_SUCCESS;
+}
+
+int p3dWriteBrick8(
+        unsigned char* in_im,
+        char* filename,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const double voxelsize,
+        const int brick,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    int err;
+
+    // Start tracking computational time:
+    if (wr_log != NULL) {
+        p3dResetStartTime();
+        wr_log("Pore3D - Writing 8-bit bricked file %s ...", filename);
+        wr_log("\tBrick size: %d.", (brick < 8) ? P3D_BRICK_DEFAULT : MIN(brick, P3D_BRICK_MAX));
+    }
+
+    err = _p3dWriteBrick(in_im, filename, dimx, dimy, dimz, 1, voxelsize, brick, wr_log, wr_progress);
+
+    // Print elapsed time (if required):
+    if ((wr_log != NULL) && (err == P3D_SUCCESS)) {
+        wr_log("Pore3D - Bricked file written successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
+    }
+
+    return err;
+}
+
+int p3dWriteBrick16(
+        unsigned short* in_im,
+        char* filename,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const double voxelsize,
+        const int brick,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    int err;
+
+    // Start tracking computational time:
+    if (wr_log != NULL) {
+        p3dResetStartTime();
+        wr_log("Pore3D - Writing 16-bit bricked file %s ...", filename);
+        wr_log("\tBrick size: %d.", (brick < 8) ? P3D_BRICK_DEFAULT : MIN(brick, P3D_BRICK_MAX));
+    }
+
+    err = _p3dWriteBrick((unsigned char*) in_im, filename, dimx, dimy, dimz, 2, voxelsize, brick, wr_log, wr_progress);
+
+    // Print elapsed time (if required):
+    if ((wr_log != NULL) && (err == P3D_SUCCESS)) {
+        wr_log("Pore3D - Bricked file written successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
+    }
+
+    return err;
+}
+
+int p3dReadBrickROI8(
+        char* filename,
+        unsigned char* out_im,
+        const int x0,
+        const int y0,
+        const int z0,
+        const int rx,
+        const int ry,
+        const int rz,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    int err;
+
+    // Start tracking computational time:
+    if (wr_log != NULL) {
+        p3dResetStartTime();
+        wr_log("Pore3D - Reading bricked file %s ...", filename);
+        wr_log("\tRegion: [%d,%d,%d] - [%d,%d,%d].", x0, y0, z0, x0 + rx - 1, y0 + ry - 1, z0 + rz - 1);
+    }
+
+    err = _p3dReadBrickROI(filename, out_im, 1, x0, y0, z0, rx, ry, rz, wr_log, wr_progress);
+
+    // Print elapsed time (if required):
+    if ((wr_log != NULL) && (err == P3D_SUCCESS)) {
+        wr_log("Pore3D - Bricked file read successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
+    }
+
+    return err;
+}
+
+int p3dReadBrickROI16(
+        char* filename,
+        unsigned short* out_im,
+        const int x0,
+        const int y0,
+        const int z0,
+        const int rx,
+        const int ry,
+        const int rz,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    int err;
+
+    // Start tracking computational time:
+    if (wr_log != NULL) {
+        p3dResetStartTime();
+        wr_log("Pore3D - Reading bricked file %s ...", filename);
+        wr_log("\tRegion: [%d,%d,%d] - [%d,%d,%d].", x0, y0, z0, x0 + rx - 1, y0 + ry - 1, z0 + rz - 1);
+    }
+
+    err = _p3dReadBrickROI(filename, (unsigned char*) out_im, 2, x0, y0, z0, rx, ry, rz, wr_log, wr_progress);
+
+    // Print elapsed time (if required):
+    if ((wr_log != NULL) && (err == P3D_SUCCESS)) {
+        wr_log("Pore3D - Bricked file read successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
+    }
+
+    return err;
+}
+
+int p3dReadBrick8(
+        char* filename,
+        unsigned char* out_im,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    return p3dReadBrickROI8(filename, out_im, 0, 0, 0, dimx, dimy, dimz, wr_log, wr_progress);
+}
+
+int p3dReadBrick16(
+        char* filename,
+        unsigned short* out_im,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    return p3dReadBrickROI16(filename, out_im, 0, 0, 0, dimx, dimy, dimz, wr_log, wr_progress);
+}
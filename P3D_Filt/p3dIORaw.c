@@ -22,7 +22,7 @@
 
 //
 // Author: Francesco Brun
-// Last modified: Sept, 28th 2016
+// Last modified: October, 16th 2026
 //
 
 #include <stdlib.h>
@@ -33,6 +33,8 @@
 #include "p3dFilt.h"
 #include "p3dTime.h"
 
+#include "Common/p3dEndianSwap.h"
+
 short _EndianSwapSignedShort(short s) {
     unsigned char b1, b2;
 
@@ -98,7 +100,7 @@ int p3dReadRaw8(
     }
 
     /* Read raw data from file: */
-    if (fread(out_im, sizeof (unsigned char), dimx * dimy * dimz, fvol) < (dimx * dimy * dimz)) {
+    if (fread(out_im, sizeof (unsigned char), (size_t) dimx * dimy * dimz, fvol) < ((size_t) dimx * dimy * dimz)) {
         wr_log("Pore3D - IO error: error on reading file %s. Program will exit.", filename);
 
         return P3D_IO_ERROR;
@@ -159,7 +161,7 @@ int p3dWriteRaw8(
     }
 
     /* Write raw data to file: */
-    if (fwrite(in_im, sizeof (unsigned char), dimx * dimy * dimz, fvol) < (dimx * dimy * dimz)) {
+    if (fwrite(in_im, sizeof (unsigned char), (size_t) dimx * dimy * dimz, fvol) < ((size_t) dimx * dimy * dimz)) {
         wr_log("Pore3D - IO error: error on writing file %s. Program will exit.", filename);
 
         return P3D_IO_ERROR;
@@ -199,9 +201,8 @@ int p3dReadRaw16(
         int (*wr_progress)(const int, ...)
         ) {
     FILE* fvol;
-    short* s_tmp_im = NULL;
-    unsigned short* us_tmp_im = NULL;
-    int ct;
+    const long long n = (long long) dimx * dimy * dimz;
+    long long ct, chunk;
 
     /*char* auth_code;
 
@@ -234,57 +235,23 @@ int p3dReadRaw16(
     }
 
 
-    /* Read data signed/unsigned: */
-    if (flagSigned == P3D_TRUE) {
-        s_tmp_im = (short*) malloc(dimx * dimy * dimz * sizeof (short));
+    /* Read raw data from file in chunks and convert each chunk while it is
+       still in cache (byte swap and signed offset are applied in place): */
+    for (ct = 0; ct < n; ct += chunk) {
+        chunk = ((n - ct) < P3D_RAW_CHUNK) ? (n - ct) : P3D_RAW_CHUNK;
 
-        /* Read raw data from file: */
-        if (fread(s_tmp_im, sizeof (short), dimx * dimy * dimz, fvol) < (dimx * dimy * dimz)) {
+        if (fread(out_im + ct, sizeof (unsigned short), (size_t) chunk, fvol) < ((size_t) chunk)) {
             wr_log("Pore3D - IO error: error on reading file %s. Program will exit.", filename);
+            fclose(fvol);
 
             return P3D_IO_ERROR;
         }
 
-        /* Convert to unsigned: */
-        for (ct = 0; ct < (dimx * dimy * dimz); ct++) {
-            if (flagLittle == P3D_FALSE) {
-                out_im[ct] = (unsigned short) (_EndianSwapSignedShort(s_tmp_im[ct]) + USHRT_MAX / 2);
-            } else {
-                out_im[ct] = (unsigned short) (s_tmp_im[ct] + USHRT_MAX / 2);
-            }
-        }
-
-        /* Free: */
-        free(s_tmp_im);
-    } else {
-        /* Swap endian if necessary: */
-        if (flagLittle == P3D_FALSE) {
-            us_tmp_im = (unsigned short*) malloc(dimx * dimy * dimz * sizeof (unsigned short));
-
-            /* Read raw data from file: */
-            if (fread(us_tmp_im, sizeof (unsigned short), dimx * dimy * dimz, fvol) < (dimx * dimy * dimz)) {
-                wr_log("Pore3D - IO error: error on reading file %s. Program will exit.", filename);
-
-                return P3D_IO_ERROR;
-            }
-
-            for (ct = 0; ct < (dimx * dimy * dimz); ct++) {
-                out_im[ct] = (unsigned short) (_EndianSwapUnsignedShort(us_tmp_im[ct]));
-            }
-
-            /* Free: */
-            free(us_tmp_im);
-        } else {
-            if (fread(out_im, sizeof (unsigned short), dimx * dimy * dimz, fvol) < (dimx * dimy * dimz)) {
-                wr_log("Pore3D - IO error: error on reading file %s. Program will exit.", filename);
-
-                return P3D_IO_ERROR;
-            }
+        if ((flagLittle == P3D_FALSE) || (flagSigned == P3D_TRUE)) {
+            p3dRawDecode16(out_im + ct, out_im + ct, (size_t) chunk, (flagLittle == P3D_FALSE), (flagSigned == P3D_TRUE));
         }
     }
 
-
-
     /* Close file handler: */
     fclose(fvol);
 
@@ -319,9 +286,9 @@ int p3dWriteRaw16(
         int (*wr_progress)(const int, ...)
         ) {
     FILE* fvol;
-    short* s_tmp_im = NULL;
-    unsigned short* us_tmp_im = NULL;
-    int ct;
+    unsigned short* tmp_im = NULL;
+    const long long n = (long long) dimx * dimy * dimz;
+    long long ct, chunk;
 
     // Start tracking computational time:
     if (wr_log != NULL) {
@@ -345,48 +312,33 @@ int p3dWriteRaw16(
         return P3D_IO_ERROR;
     }
 
-    /* Read data signed/unsigned: */
-    if (flagSigned == P3D_TRUE) {
-        s_tmp_im = (short*) malloc(dimx * dimy * dimz * sizeof (short));
-
-        /* Convert to signed: */
-        for (ct = 0; ct < (dimx * dimy * dimz); ct++) {
-            if (flagLittle == P3D_FALSE) {
-                s_tmp_im[ct] = _EndianSwapSignedShort((short) (in_im[ct] - USHRT_MAX / 2));
-            } else {
-                s_tmp_im[ct] = (short) (in_im[ct] - USHRT_MAX / 2);
-            }
-        }
-
-        /* Write raw data to file: */
-        //fwrite(s_tmp_im, sizeof (short), dimx*dimy, fvol);
-        if (fwrite(s_tmp_im, sizeof (short), dimx * dimy * dimz, fvol) < (dimx * dimy * dimz)) {
-            wr_log("Pore3D - IO error: error on writing file %s. Program will exit.", filename);
-
-            return P3D_IO_ERROR;
-        }
+    /* Write data: conversion (signed offset and byte swap) is performed on
+       a cache-sized buffer which is written and then reused: */
+    if ((flagLittle == P3D_FALSE) || (flagSigned == P3D_TRUE)) {
+        P3D_TRY(tmp_im = (unsigned short*) malloc(P3D_RAW_CHUNK * sizeof (unsigned short)));
 
-        /* Free: */
-        free(s_tmp_im);
-    } else {
-        /* Swap endian if necessary: */
-        if (flagLittle == P3D_FALSE) {
-            us_tmp_im = (unsigned short*) malloc(dimx * dimy * dimz * sizeof (unsigned short));
+        for (ct = 0; ct < n; ct += chunk) {
+            chunk = ((n - ct) < P3D_RAW_CHUNK) ? (n - ct) : P3D_RAW_CHUNK;
 
-            for (ct = 0; ct < (dimx * dimy * dimz); ct++) {
-                us_tmp_im[ct] = _EndianSwapUnsignedShort(in_im[ct]);
-            }
+            p3dRawEncode16(tmp_im, in_im + ct, (size_t) chunk, (flagLittle == P3D_FALSE), (flagSigned == P3D_TRUE));
 
-            //fwrite(us_tmp_im, sizeof (unsigned short), dimx*dimy, fvol);
-            if (fwrite(us_tmp_im, sizeof (unsigned short), dimx * dimy * dimz, fvol) < (dimx * dimy * dimz)) {
+            if (fwrite(tmp_im, sizeof (unsigned short), (size_t) chunk, fvol) < ((size_t) chunk)) {
                 wr_log("Pore3D - IO error: error on writing file %s. Program will exit.", filename);
+                free(tmp_im);
+                fclose(fvol);
 
                 return P3D_IO_ERROR;
             }
+        }
+
+        /* Free: */
+        free(tmp_im);
+    } else {
+        if (fwrite(in_im, sizeof (unsigned short), (size_t) n, fvol) < ((size_t) n)) {
+            wr_log("Pore3D - IO error: error on writing file %s. Program will exit.", filename);
+            fclose(fvol);
 
-            free(us_tmp_im);
-        } else {
-            fwrite(in_im, sizeof (unsigned short), dimx * dimy * dimz, fvol);
+            return P3D_IO_ERROR;
         }
     }
 
@@ -399,6 +351,17 @@ int p3dWriteRaw16(
     }
 
     return P3D_SUCCESS;
+
+MEM_ERROR:
+
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Not enough (contiguous) memory. Program will exit.");
+    }
+
+    // Release resources:
+    fclose(fvol);
+
+    return P3D_MEM_ERROR;
 }
 
 int p3dWriteRaw32(
@@ -413,9 +376,9 @@ int p3dWriteRaw32(
         int (*wr_progress)(const int, ...)
         ) {
     FILE* fvol;
-    int* s_tmp_im = NULL;
-    unsigned int* us_tmp_im = NULL;
-    int ct;
+    unsigned int* tmp_im = NULL;
+    const long long n = (long long) dimx * dimy * dimz;
+    long long ct, chunk;
 
     // Start tracking computational time:
     if (wr_log != NULL) {
@@ -439,48 +402,33 @@ int p3dWriteRaw32(
         return P3D_IO_ERROR;
     }
 
-    /* Read data signed/unsigned: */
-    if (flagSigned == P3D_TRUE) {
-        s_tmp_im = (int*) malloc(dimx * dimy * dimz * sizeof (int));
+    /* Write data: conversion (signed offset and byte swap) is performed on
+       a cache-sized buffer which is written and then reused: */
+    if ((flagLittle == P3D_FALSE) || (flagSigned == P3D_TRUE)) {
+        P3D_TRY(tmp_im = (unsigned int*) malloc(P3D_RAW_CHUNK * sizeof (unsigned int)));
 
-        /* Convert to signed: */
-        for (ct = 0; ct < (dimx * dimy * dimz); ct++) {
-            if (flagLittle == P3D_FALSE) {
-                s_tmp_im[ct] = _EndianSwapInt((int) (in_im[ct] - UINT_MAX / 2));
-            } else {
-                s_tmp_im[ct] = (int) (in_im[ct] - UINT_MAX / 2);
-            }
-        }
-
-        /* Write raw data to file: */
-        //fwrite(s_tmp_im, sizeof (short), dimx*dimy, fvol);
-        if (fwrite(s_tmp_im, sizeof (int), dimx * dimy * dimz, fvol) < (dimx * dimy * dimz)) {
-            wr_log("Pore3D - IO error: error on writing file %s. Program will exit.", filename);
+        for (ct = 0; ct < n; ct += chunk) {
+            chunk = ((n - ct) < P3D_RAW_CHUNK) ? (n - ct) : P3D_RAW_CHUNK;
 
-            return P3D_IO_ERROR;
-        }
+            p3dRawEncode32(tmp_im, in_im + ct, (size_t) chunk, (flagLittle == P3D_FALSE), (flagSigned == P3D_TRUE));
 
-        /* Free: */
-        free(s_tmp_im);
-    } else {
-        /* Swap endian if necessary: */
-        if (flagLittle == P3D_FALSE) {
-            us_tmp_im = (unsigned int*) malloc(dimx * dimy * dimz * sizeof (unsigned int));
-
-            for (ct = 0; ct < (dimx * dimy * dimz); ct++) {
-                us_tmp_im[ct] = _EndianSwapUnsignedInt(in_im[ct]);
-            }
-
-            //fwrite(us_tmp_im, sizeof (unsigned short), dimx*dimy, fvol);
-            if (fwrite(us_tmp_im, sizeof (unsigned int), dimx * dimy * dimz, fvol) < (dimx * dimy * dimz)) {
+            if (fwrite(tmp_im, sizeof (unsigned int), (size_t) chunk, fvol) < ((size_t) chunk)) {
                 wr_log("Pore3D - IO error: error on writing file %s. Program will exit.", filename);
+                free(tmp_im);
+                fclose(fvol);
 
                 return P3D_IO_ERROR;
             }
+        }
+
+        /* Free: */
+        free(tmp_im);
+    } else {
+        if (fwrite(in_im, sizeof (unsigned int), (size_t) n, fvol) < ((size_t) n)) {
+            wr_log("Pore3D - IO error: error on writing file %s. Program will exit.", filename);
+            fclose(fvol);
 
-            free(us_tmp_im);
-        } else {
-            fwrite(in_im, sizeof (unsigned int), dimx * dimy * dimz, fvol);
+            return P3D_IO_ERROR;
         }
     }
 
@@ -493,4 +441,15 @@ int p3dWriteRaw32(
     }
 
     return P3D_SUCCESS;
+
+MEM_ERROR:
+
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Not enough (contiguous) memory. Program will exit.");
+    }
+
+    // Release resources:
+    fclose(fvol);
+
+    return P3D_MEM_ERROR;
 }
@@ -0,0 +1,909 @@
+/***************************************************************************/
+/* (C) 2016 Elettra - Sincrotrone Trieste S.C.p.A.. All rights reserved.   */
+/*                                                                         */
+/*                                                                         */
+/* This file is part of Pore3D, a software library for quantitative        */
+/* analysis of 3D (volume) images.                                         */
+/*                                                                         */
+/* Pore3D is free software: you can redistribute it and/or modify it       */
+/* under the terms of the GNU General Public License as published by the   */
+/* Free Software Foundation, either version 3 of the License, or (at your  */
+/* option) any later version.                                              */
+/*                                                                         */
+/* Pore3D is distributed in the hope that it will be useful, but WITHOUT   */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or   */
+/* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License    */
+/* for more details.                                                       */
+/*                                                                         */
+/* You should have received a copy of the GNU General Public License       */
+/* along with Pore3D. If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                         */
+/***************************************************************************/
+
+//
+// Author: Francesco Brun
+// Last modified: October, 16th 2026
+//
+
+// Slice stacks: volumes stored as a directory of 2D slices (one file per z,
+// as produced by reconstruction software). Supported slice formats are RAW
+// and baseline grayscale TIFF (8 or 16 bit, uncompressed or PackBits, stored
+// in strips). Slices are sorted by file name and they are read (or written)
+// concurrently, each thread decoding its slices directly into the volume
+// buffer: only strip-sized buffers are needed for compressed TIFFs.
+//
+// The slice format is detected from the file content (TIFF magic number),
+// RAW slices are decoded according to flagLittle and flagSigned as in
+// p3dReadRaw16. Signed 16-bit TIFFs are converted to unsigned by adding
+// USHRT_MAX/2, as signed RAW files are.
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <omp.h>
+
+#ifdef _WINDOWS
+	#include <windows.h>
+#else
+	#include <dirent.h>
+#endif
+
+#include "p3dFilt.h"
+#include "p3dTime.h"
+
+#include "p3dIOStack.h"
+
+#include "Common/p3dEndianSwap.h"
+
+#ifdef _WINDOWS
+	#define _p3dFseek	_fseeki64
+	#define P3D_PATH_SEP	"\\"
+#else
+	#define _p3dFseek	fseeko
+	#define P3D_PATH_SEP	"/"
+#endif
+
+// TIFF tags and constants (baseline only):
+#define TIFF_IMAGEWIDTH         256
+#define TIFF_IMAGELENGTH        257
+#define TIFF_BITSPERSAMPLE      258
+#define TIFF_COMPRESSION        259
+#define TIFF_PHOTOMETRIC        262
+#define TIFF_STRIPOFFSETS       273
+#define TIFF_SAMPLESPERPIXEL    277
+#define TIFF_ROWSPERSTRIP       278
+#define TIFF_STRIPBYTECOUNTS    279
+#define TIFF_PLANARCONFIG       284
+#define TIFF_TILEWIDTH          322
+#define TIFF_SAMPLEFORMAT       339
+
+#define TIFF_SHORT              3
+#define TIFF_LONG               4
+
+#define TIFF_COMPRESSION_NONE       1
+#define TIFF_COMPRESSION_PACKBITS   32773
+
+struct TiffInfo {
+    int big; // P3D_TRUE for "MM" files
+    int width, height, bits, samples, compression, signedness, tiled;
+    int rowsperstrip, nstrips;
+    long long* offsets;
+    long long* bytecounts;
+};
+
+/* ---------------------------------------------------------------------------
+   Directory listing:
+   ------------------------------------------------------------------------ */
+
+static int _p3dStrCmp(const void* a, const void* b) {
+    return strcmp(*((char**) a), *((char**) b));
+}
+
+static int _p3dIsSliceFile(const char* name) {
+    const char* ext = strrchr(name, '.');
+    char lext[8];
+    int i;
+
+    if ((ext == NULL) || (strlen(ext) > 5))
+        return P3D_FALSE;
+
+    for (i = 0; ext[i] != '\0'; i++)
+        lext[i] = (char) tolower((unsigned char) ext[i]);
+    lext[i] = '\0';
+
+    return ((strcmp(lext, ".tif") == 0) || (strcmp(lext, ".tiff") == 0) || (strcmp(lext, ".raw") == 0)) ? P3D_TRUE : P3D_FALSE;
+}
+
+static int _p3dAddName(char*** names, int* n, int* cap, const char* dirname, const char* name) {
+    char** tmp;
+
+    if ((*n) == (*cap)) {
+        (*cap) = ((*cap) == 0) ? 1024 : 2 * (*cap);
+        tmp = (char**) realloc(*names, (*cap) * sizeof (char*));
+        if (tmp == NULL)
+            return P3D_FALSE;
+        (*names) = tmp;
+    }
+
+    (*names)[*n] = (char*) malloc((strlen(dirname) + strlen(name) + 2) * sizeof (char));
+    if ((*names)[*n] == NULL)
+        return P3D_FALSE;
+    sprintf((*names)[*n], "%s" P3D_PATH_SEP "%s", dirname, name);
+    (*n)++;
+
+    return P3D_TRUE;
+}
+
+void _p3dFreeSlices(char** names, const int n) {
+    int i;
+
+    if (names == NULL)
+        return;
+    for (i = 0; i < n; i++)
+        if (names[i] != NULL) free(names[i]);
+    free(names);
+}
+
+// Returns in NAMES the sorted full paths of the slice files in DIRNAME and
+// their number, or -1 if the directory cannot be read (0 files is a valid
+// result). NAMES has to be released with _p3dFreeSlices.
+int _p3dListSlices(char* dirname, char*** names) {
+    int n = 0, cap = 0, ok = P3D_TRUE;
+
+#ifdef _WINDOWS
+    WIN32_FIND_DATAA fd;
+    HANDLE h;
+    char* pattern;
+
+    (*names) = NULL;
+    pattern = (char*) malloc((strlen(dirname) + 3) * sizeof (char));
+    if (pattern == NULL)
+        return -1;
+    sprintf(pattern, "%s\\*", dirname);
+    h = FindFirstFileA(pattern, &fd);
+    free(pattern);
+    if (h == INVALID_HANDLE_VALUE)
+        return -1;
+    do {
+        if (((fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0) && (_p3dIsSliceFile(fd.cFileName) == P3D_TRUE))
+            ok = _p3dAddName(names, &n, &cap, dirname, fd.cFileName);
+    } while ((ok == P3D_TRUE) && (FindNextFileA(h, &fd) != 0));
+    FindClose(h);
+#else
+    DIR* dir;
+    struct dirent* ent;
+
+    (*names) = NULL;
+    if ((dir = opendir(dirname)) == NULL)
+        return -1;
+    while ((ok == P3D_TRUE) && ((ent = readdir(dir)) != NULL)) {
+        if (_p3dIsSliceFile(ent->d_name) == P3D_TRUE)
+            ok = _p3dAddName(names, &n, &cap, dirname, ent->d_name);
+    }
+    closedir(dir);
+#endif
+
+    if (ok == P3D_FALSE) {
+        _p3dFreeSlices(*names, n);
+        (*names) = NULL;
+        return -1;
+    }
+
+    if (n > 0)
+        qsort(*names, n, sizeof (char*), _p3dStrCmp);
+
+    return n;
+}
+
+/* ---------------------------------------------------------------------------
+   TIFF decoding:
+   ------------------------------------------------------------------------ */
+
+static unsigned int _p3dTiffGet16(const unsigned char* p, const int big) {
+    return (big == P3D_TRUE) ? ((p[0] << 8) | p[1]) : (p[0] | (p[1] << 8));
+}
+
+static unsigned int _p3dTiffGet32(const unsigned char* p, const int big) {
+    return (big == P3D_TRUE) ?
+            (((unsigned int) p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3]) :
+            (p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int) p[3] << 24));
+}
+
+// Reads COUNT SHORT or LONG values of an IFD entry:
+static int _p3dTiffGetArray(FILE* f, const unsigned char* entry, const int big, long long* values, const int count) {
+    const int type = _p3dTiffGet16(entry + 2, big);
+    const int size = (type == TIFF_SHORT) ? 2 : 4;
+    unsigned char* buf;
+    const unsigned char* p;
+    int i;
+
+    if (((type != TIFF_SHORT) && (type != TIFF_LONG)) || (count <= 0))
+        return P3D_IO_ERROR;
+
+    if (((size_t) count * size) <= 4) {
+        p = entry + 8;
+        buf = NULL;
+    } else {
+        buf = (unsigned char*) malloc((size_t) count * size);
+        if (buf == NULL)
+            return P3D_IO_ERROR;
+        if ((_p3dFseek(f, (long long) _p3dTiffGet32(entry + 8, big), SEEK_SET) != 0) ||
+                (fread(buf, size, (size_t) count, f) < ((size_t) count))) {
+            free(buf);
+            return P3D_IO_ERROR;
+        }
+        p = buf;
+    }
+
+    for (i = 0; i < count; i++)
+        values[i] = (size == 2) ? _p3dTiffGet16(p + 2 * i, big) : _p3dTiffGet32(p + 4 * i, big);
+
+    if (buf != NULL) free(buf);
+
+    return P3D_SUCCESS;
+}
+
+static int _p3dTiffGetValue(const unsigned char* entry, const int big) {
+    return (_p3dTiffGet16(entry + 2, big) == TIFF_SHORT) ?
+            (int) _p3dTiffGet16(entry + 8, big) : (int) _p3dTiffGet32(entry + 8, big);
+}
+
+static void _p3dTiffFree(struct TiffInfo* info) {
+    if (info->offsets != NULL) free(info->offsets);
+    if (info->bytecounts != NULL) free(info->bytecounts);
+    info->offsets = NULL;
+    info->bytecounts = NULL;
+}
+
+// Parses the first IFD of a TIFF file. Returns P3D_FALSE if F is not a TIFF,
+// P3D_IO_ERROR if it is malformed and P3D_SUCCESS otherwise.
+static int _p3dTiffParse(FILE* f, struct TiffInfo* info) {
+    unsigned char hdr[8], entry[12], cnt[2];
+    const unsigned char* e = entry;
+    int i, nentries, tag;
+    int count_off = 0, count_bc = 0;
+    unsigned char entry_off[12], entry_bc[12];
+
+    memset(info, 0, sizeof (struct TiffInfo));
+    info->bits = 1;
+    info->samples = 1;
+    info->compression = TIFF_COMPRESSION_NONE;
+    info->signedness = P3D_FALSE;
+    info->tiled = P3D_FALSE;
+
+    if ((_p3dFseek(f, 0, SEEK_SET) != 0) || (fread(hdr, 1, 8, f) < 8))
+        return P3D_FALSE;
+
+    if ((hdr[0] == 'I') && (hdr[1] == 'I') && (hdr[2] == 42) && (hdr[3] == 0))
+        info->big = P3D_FALSE;
+    else if ((hdr[0] == 'M') && (hdr[1] == 'M') && (hdr[2] == 0) && (hdr[3] == 42))
+        info->big = P3D_TRUE;
+    else
+        return P3D_FALSE;
+
+    if ((_p3dFseek(f, (long long) _p3dTiffGet32(hdr + 4, info->big), SEEK_SET) != 0) || (fread(cnt, 1, 2, f) < 2))
+        return P3D_IO_ERROR;
+    nentries = _p3dTiffGet16(cnt, info->big);
+
+    for (i = 0; i < nentries; i++) {
+        if (fread(entry, 1, 12, f) < 12)
+            return P3D_IO_ERROR;
+        tag = _p3dTiffGet16(e, info->big);
+
+        switch (tag) {
+            case TIFF_IMAGEWIDTH: info->width = _p3dTiffGetValue(e, info->big); break;
+            case TIFF_IMAGELENGTH: info->height = _p3dTiffGetValue(e, info->big); break;
+            case TIFF_BITSPERSAMPLE: info->bits = _p3dTiffGetValue(e, info->big); break;
+            case TIFF_COMPRESSION: info->compression = _p3dTiffGetValue(e, info->big); break;
+            case TIFF_SAMPLESPERPIXEL: info->samples = _p3dTiffGetValue(e, info->big); break;
+            case TIFF_ROWSPERSTRIP: info->rowsperstrip = _p3dTiffGetValue(e, info->big); break;
+            case TIFF_SAMPLEFORMAT: info->signedness = (_p3dTiffGetValue(e, info->big) == 2) ? P3D_TRUE : P3D_FALSE; break;
+            case TIFF_TILEWIDTH: info->tiled = P3D_TRUE; break;
+            case TIFF_STRIPOFFSETS:
+                memcpy(entry_off, entry, 12);
+                count_off = (int) _p3dTiffGet32(e + 4, info->big);
+                break;
+            case TIFF_STRIPBYTECOUNTS:
+                memcpy(entry_bc, entry, 12);
+                count_bc = (int) _p3dTiffGet32(e + 4, info->big);
+                break;
+            default: break;
+        }
+    }
+
+    // There is at most one strip per row (the strip count is read from the
+    // file and it is bounded before any allocation):
+    if ((info->width <= 0) || (info->height <= 0) || (count_off <= 0) || (count_off != count_bc) ||
+            (count_off > info->height))
+        return P3D_IO_ERROR;
+    if ((info->rowsperstrip <= 0) || (info->rowsperstrip > info->height))
+        info->rowsperstrip = info->height;
+
+    info->nstrips = count_off;
+    info->offsets = (long long*) malloc(count_off * sizeof (long long));
+    info->bytecounts = (long long*) malloc(count_bc * sizeof (long long));
+    if ((info->offsets == NULL) || (info->bytecounts == NULL) ||
+            (_p3dTiffGetArray(f, entry_off, info->big, info->offsets, count_off) != P3D_SUCCESS) ||
+            (_p3dTiffGetArray(f, entry_bc, info->big, info->bytecounts, count_bc) != P3D_SUCCESS)) {
+        _p3dTiffFree(info);
+        return P3D_IO_ERROR;
+    }
+
+    return P3D_SUCCESS;
+}
+
+// PackBits decoding. Returns P3D_IO_ERROR if the data are corrupted:
+static int _p3dPackBitsDecode(const unsigned char* src, const long long src_len, unsigned char* dst, const long long dst_len) {
+    long long i = 0, o = 0;
+    int n;
+
+    while ((o < dst_len) && (i < src_len)) {
+        n = (signed char) src[i++];
+        if (n >= 0) {
+            // Literal run of n+1 bytes:
+            if (((i + n + 1) > src_len) || ((o + n + 1) > dst_len))
+                return P3D_IO_ERROR;
+            memcpy(dst + o, src + i, n + 1);
+            i += n + 1;
+            o += n + 1;
+        } else if (n != -128) {
+            // Replicate next byte 1-n times:
+            if ((i >= src_len) || ((o + 1 - n) > dst_len))
+                return P3D_IO_ERROR;
+            memset(dst + o, src[i++], 1 - n);
+            o += 1 - n;
+        }
+    }
+
+    return (o == dst_len) ? P3D_SUCCESS : P3D_IO_ERROR;
+}
+
+// Decodes the TIFF slice in F into DST (DIMX*DIMY voxels of BYTES bytes).
+// BUF/BUF_SIZE is a per-thread scratch buffer for compressed strips.
+static int _p3dReadTiffSlice(FILE* f, unsigned char* dst, const int dimx, const int dimy, const int bytes,
+        unsigned char** buf, long long* buf_size) {
+    struct TiffInfo info;
+    const long long row = (long long) dimx * bytes;
+    long long len;
+    unsigned char* tmp;
+    int s, rows, err = P3D_SUCCESS;
+
+    if (_p3dTiffParse(f, &info) != P3D_SUCCESS)
+        return P3D_IO_ERROR;
+
+    if ((info.width != dimx) || (info.height != dimy) || (info.bits != 8 * bytes) || (info.samples != 1) || (info.tiled == P3D_TRUE) ||
+            ((info.compression != TIFF_COMPRESSION_NONE) && (info.compression != TIFF_COMPRESSION_PACKBITS))) {
+        _p3dTiffFree(&info);
+        return P3D_IO_ERROR;
+    }
+
+    for (s = 0; (s < info.nstrips) && (err == P3D_SUCCESS); s++) {
+        rows = MIN(info.rowsperstrip, dimy - s * info.rowsperstrip);
+        if (rows <= 0)
+            break;
+        len = rows * row;
+
+        if (_p3dFseek(f, info.offsets[s], SEEK_SET) != 0) {
+            err = P3D_IO_ERROR;
+        } else if (info.compression == TIFF_COMPRESSION_NONE) {
+            // Straight into the volume:
+            if (fread(dst + s * info.rowsperstrip * row, 1, (size_t) len, f) < ((size_t) len))
+                err = P3D_IO_ERROR;
+        } else {
+            if (info.bytecounts[s] > (*buf_size)) {
+                tmp = (unsigned char*) realloc(*buf, (size_t) info.bytecounts[s]);
+                if (tmp == NULL) {
+                    err = P3D_IO_ERROR;
+                    break;
+                }
+                (*buf) = tmp;
+                (*buf_size) = info.bytecounts[s];
+            }
+            if ((fread(*buf, 1, (size_t) info.bytecounts[s], f) < ((size_t) info.bytecounts[s])) ||
+                    (_p3dPackBitsDecode(*buf, info.bytecounts[s], dst + s * info.rowsperstrip * row, len) != P3D_SUCCESS))
+                err = P3D_IO_ERROR;
+        }
+    }
+
+    // Host representation (same conversions of RAW files):
+    if ((err == P3D_SUCCESS) && (bytes == 2) && ((info.big == P3D_TRUE) || (info.signedness == P3D_TRUE))) {
+        p3dRawDecode16((unsigned short*) dst, (unsigned short*) dst, (size_t) dimx * dimy,
+                (info.big == P3D_TRUE), (info.signedness == P3D_TRUE));
+    }
+
+    _p3dTiffFree(&info);
+
+    return err;
+}
+
+// Reads slice FILENAME (TIFF or RAW) into DST:
+static int _p3dReadSlice(char* filename, unsigned char* dst, const int dimx, const int dimy, const int bytes,
+        const int flagLittle, const int flagSigned, unsigned char** buf, long long* buf_size) {
+    struct TiffInfo info;
+    FILE* f;
+    const size_t n = (size_t) dimx * dimy;
+    int err;
+
+    if ((f = fopen(filename, "rb")) == NULL)
+        return P3D_IO_ERROR;
+
+    err = _p3dTiffParse(f, &info);
+    _p3dTiffFree(&info);
+
+    if (err == P3D_FALSE) {
+        // Not a TIFF, i.e. RAW slice:
+        err = P3D_SUCCESS;
+        if ((_p3dFseek(f, 0, SEEK_SET) != 0) || (fread(dst, bytes, n, f) < n))
+            err = P3D_IO_ERROR;
+        else if ((bytes == 2) && ((flagLittle == P3D_FALSE) || (flagSigned == P3D_TRUE)))
+            p3dRawDecode16((unsigned short*) dst, (unsigned short*) dst, n, (flagLittle == P3D_FALSE), (flagSigned == P3D_TRUE));
+    } else if (err == P3D_SUCCESS) {
+        err = _p3dReadTiffSlice(f, dst, dimx, dimy, bytes, buf, buf_size);
+    }
+
+    fclose(f);
+
+    return err;
+}
+
+/* ---------------------------------------------------------------------------
+   TIFF encoding (uncompressed, single strip, little endian):
+   ------------------------------------------------------------------------ */
+
+#define TIFF_NENTRIES   11
+#define TIFF_DATAOFFSET 160 /* 8 (header) + 2 + 11*12 + 4 (IFD), rounded up */
+
+static void _p3dTiffPut16(unsigned char* p, const unsigned int v) {
+    p[0] = (unsigned char) (v & 0xFF);
+    p[1] = (unsigned char) ((v >> 8) & 0xFF);
+}
+
+static void _p3dTiffPut32(unsigned char* p, const unsigned int v) {
+    _p3dTiffPut16(p, v & 0xFFFF);
+    _p3dTiffPut16(p + 2, (v >> 16) & 0xFFFF);
+}
+
+static unsigned char* _p3dTiffPutEntry(unsigned char* p, const int tag, const int type, const unsigned int value) {
+    _p3dTiffPut16(p, tag);
+    _p3dTiffPut16(p + 2, type);
+    _p3dTiffPut32(p + 4, 1);
+    _p3dTiffPut32(p + 8, 0);
+    if (type == TIFF_SHORT)
+        _p3dTiffPut16(p + 8, value);
+    else
+        _p3dTiffPut32(p + 8, value);
+
+    return p + 12;
+}
+
+static int _p3dWriteTiffSlice(char* filename, unsigned char* src, const int dimx, const int dimy, const int bytes, const int flagSigned) {
+    unsigned char hdr[TIFF_DATAOFFSET];
+    unsigned char* p = hdr;
+    const size_t n = (size_t) dimx * dimy;
+    FILE* f;
+    int err = P3D_SUCCESS;
+
+    memset(hdr, 0, TIFF_DATAOFFSET);
+    p[0] = 'I';
+    p[1] = 'I';
+    _p3dTiffPut16(p + 2, 42);
+    _p3dTiffPut32(p + 4, 8);
+    p += 8;
+
+    // IFD (entries sorted by tag):
+    _p3dTiffPut16(p, TIFF_NENTRIES);
+    p += 2;
+    p = _p3dTiffPutEntry(p, TIFF_IMAGEWIDTH, TIFF_LONG, dimx);
+    p = _p3dTiffPutEntry(p, TIFF_IMAGELENGTH, TIFF_LONG, dimy);
+    p = _p3dTiffPutEntry(p, TIFF_BITSPERSAMPLE, TIFF_SHORT, 8 * bytes);
+    p = _p3dTiffPutEntry(p, TIFF_COMPRESSION, TIFF_SHORT, TIFF_COMPRESSION_NONE);
+    p = _p3dTiffPutEntry(p, TIFF_PHOTOMETRIC, TIFF_SHORT, 1); // BlackIsZero
+    p = _p3dTiffPutEntry(p, TIFF_STRIPOFFSETS, TIFF_LONG, TIFF_DATAOFFSET);
+    p = _p3dTiffPutEntry(p, TIFF_SAMPLESPERPIXEL, TIFF_SHORT, 1);
+    p = _p3dTiffPutEntry(p, TIFF_ROWSPERSTRIP, TIFF_LONG, dimy);
+    p = _p3dTiffPutEntry(p, TIFF_STRIPBYTECOUNTS, TIFF_LONG, (unsigned int) (n * bytes));
+    p = _p3dTiffPutEntry(p, TIFF_PLANARCONFIG, TIFF_SHORT, 1);
+    p = _p3dTiffPutEntry(p, TIFF_SAMPLEFORMAT, TIFF_SHORT, (flagSigned == P3D_TRUE) ? 2 : 1);
+    _p3dTiffPut32(p, 0); // no next IFD
+
+    if ((f = fopen(filename, "wb")) == NULL)
+        return P3D_IO_ERROR;
+
+    // Header, then slice data straight from the volume:
+    if ((fwrite(hdr, 1, TIFF_DATAOFFSET, f) < TIFF_DATAOFFSET) || (fwrite(src, bytes, n, f) < n))
+        err = P3D_IO_ERROR;
+    if (fclose(f) != 0)
+        err = P3D_IO_ERROR;
+
+    return err;
+}
+
+static int _p3dWriteRawSlice(char* filename, unsigned char* src, const size_t len) {
+    FILE* f;
+    int err = P3D_SUCCESS;
+
+    if ((f = fopen(filename, "wb")) == NULL)
+        return P3D_IO_ERROR;
+    if (fwrite(src, 1, len, f) < len)
+        err = P3D_IO_ERROR;
+    if (fclose(f) != 0)
+        err = P3D_IO_ERROR;
+
+    return err;
+}
+
+/* ---------------------------------------------------------------------------
+   Public functions:
+   ------------------------------------------------------------------------ */
+
+// Returns the number of slices in DIRNAME and, if the first slice is a TIFF,
+// the slice size and the bytes per voxel (0 otherwise, since RAW slices do
+// not carry this information).
+int p3dReadSliceStackInfo(
+        char* dirname,
+        int* dimx,
+        int* dimy,
+        int* dimz,
+        int* bytes
+        ) {
+    struct TiffInfo info;
+    char** names;
+    FILE* f;
+    int n;
+
+    (*dimx) = 0;
+    (*dimy) = 0;
+    (*dimz) = 0;
+    (*bytes) = 0;
+
+    if ((n = _p3dListSlices(dirname, &names)) < 0)
+        return P3D_IO_ERROR;
+
+    (*dimz) = n;
+
+    if ((n > 0) && ((f = fopen(names[0], "rb")) != NULL)) {
+        if (_p3dTiffParse(f, &info) == P3D_SUCCESS) {
+            (*dimx) = info.width;
+            (*dimy) = info.height;
+            (*bytes) = info.bits / 8;
+        }
+        _p3dTiffFree(&info);
+        fclose(f);
+    }
+
+    _p3dFreeSlices(names, n);
+
+    return P3D_SUCCESS;
+}
+
+int p3dReadSliceStack8(
+        char* dirname,
+        unsigned char* out_im,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    char** names = NULL;
+    unsigned char* buf;
+    long long buf_size;
+    int n, k, err = P3D_SUCCESS, bad = -1;
+
+    // Start tracking computational time:
+    if (wr_log != NULL) {
+        p3dResetStartTime();
+        wr_log("Pore3D - Reading 8-bit slice stack %s ...", dirname);
+    }
+
+    if ((n = _p3dListSlices(dirname, &names)) < 0) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - IO error: cannot read directory %s. Program will exit.", dirname);
+        }
+        return P3D_IO_ERROR;
+    }
+    if (n < dimz) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - IO error: directory %s contains %d slices instead of %d. Program will exit.", dirname, n, dimz);
+        }
+        _p3dFreeSlices(names, n);
+
+        return P3D_IO_ERROR;
+    }
+
+    // Each thread decodes whole slices straight into the volume:
+#pragma omp parallel private(buf, buf_size)
+    {
+        buf = NULL;
+        buf_size = 0;
+
+#pragma omp for schedule(dynamic)
+        for (k = 0; k < dimz; k++) {
+            if (_p3dReadSlice(names[k], (unsigned char*) (out_im + (size_t) k * dimx * dimy), dimx, dimy, 1,
+                    P3D_TRUE, P3D_FALSE, &buf, &buf_size) != P3D_SUCCESS) {
+#pragma omp critical
+                {
+                    err = P3D_IO_ERROR;
+                    if ((bad < 0) || (k < bad)) bad = k;
+                }
+            }
+        }
+
+        if (buf != NULL) free(buf);
+    }
+
+    if (err != P3D_SUCCESS) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - IO error: cannot read slice %s (unsupported format or wrong size). Program will exit.", names[bad]);
+        }
+        _p3dFreeSlices(names, n);
+
+        return P3D_IO_ERROR;
+    }
+
+    _p3dFreeSlices(names, n);
+
+    // Print elapsed time (if required):
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Slice stack read successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
+    }
+
+    return P3D_SUCCESS;
+}
+
+int p3dReadSliceStack16(
+        char* dirname,
+        unsigned short* out_im,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int flagLittle,
+        const int flagSigned,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    char** names = NULL;
+    unsigned char* buf;
+    long long buf_size;
+    int n, k, err = P3D_SUCCESS, bad = -1;
+
+    // Start tracking computational time:
+    if (wr_log != NULL) {
+        p3dResetStartTime();
+        wr_log("Pore3D - Reading 16-bit slice stack %s ...", dirname);
+        if (flagSigned == P3D_TRUE)
+            wr_log("\tSigned/Unsigned: Signed.");
+        else
+            wr_log("\tSigned/Unsigned: Unsigned.");
+        if (flagLittle == P3D_TRUE)
+            wr_log("\tLittle/Big Endian: Little (RAW slices only).");
+        else
+            wr_log("\tLittle/Big Endian: Big (RAW slices only).");
+    }
+
+    if ((n = _p3dListSlices(dirname, &names)) < 0) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - IO error: cannot read directory %s. Program will exit.", dirname);
+        }
+        return P3D_IO_ERROR;
+    }
+    if (n < dimz) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - IO error: directory %s contains %d slices instead of %d. Program will exit.", dirname, n, dimz);
+        }
+        _p3dFreeSlices(names, n);
+
+        return P3D_IO_ERROR;
+    }
+
+    // Each thread decodes whole slices straight into the volume:
+#pragma omp parallel private(buf, buf_size)
+    {
+        buf = NULL;
+        buf_size = 0;
+
+#pragma omp for schedule(dynamic)
+        for (k = 0; k < dimz; k++) {
+            if (_p3dReadSlice(names[k], (unsigned char*) (out_im + (size_t) k * dimx * dimy), dimx, dimy, 2,
+                    flagLittle, flagSigned, &buf, &buf_size) != P3D_SUCCESS) {
+#pragma omp critical
+                {
+                    err = P3D_IO_ERROR;
+                    if ((bad < 0) || (k < bad)) bad = k;
+                }
+            }
+        }
+
+        if (buf != NULL) free(buf);
+    }
+
+    if (err != P3D_SUCCESS) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - IO error: cannot read slice %s (unsupported format or wrong size). Program will exit.", names[bad]);
+        }
+        _p3dFreeSlices(names, n);
+
+        return P3D_IO_ERROR;
+    }
+
+    _p3dFreeSlices(names, n);
+
+    // Print elapsed time (if required):
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Slice stack read successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
+    }
+
+    return P3D_SUCCESS;
+}
+
+int p3dWriteSliceStack8(
+        unsigned char* in_im,
+        char* dirname, // IN: existing output directory
+        char* prefix, // IN: slices are named <prefix>_<z>.tif (or .raw)
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int format, // IN: P3D_SLICE_TIFF or P3D_SLICE_RAW
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    char* filename;
+    unsigned char* slice_im;
+    const size_t slice = (size_t) dimx * dimy;
+    int digits, k, err = P3D_SUCCESS, mem_err = P3D_FALSE;
+
+    // Start tracking computational time:
+    if (wr_log != NULL) {
+        p3dResetStartTime();
+        wr_log("Pore3D - Writing 8-bit slice stack %s ...", dirname);
+    }
+
+    // Zero padded slice numbers (at least 4 digits) keep the name ordering:
+    for (digits = 4, k = 10000; k < dimz; k *= 10)
+        digits++;
+
+#pragma omp parallel private(filename, slice_im)
+    {
+        filename = (char*) malloc((strlen(dirname) + strlen(prefix) + digits + 8) * sizeof (char));
+        if (filename == NULL) {
+#pragma omp critical
+            mem_err = P3D_TRUE;
+        }
+
+#pragma omp for schedule(dynamic)
+        for (k = 0; k < dimz; k++) {
+            if ((err == P3D_SUCCESS) && (mem_err == P3D_FALSE)) {
+                sprintf(filename, "%s" P3D_PATH_SEP "%s_%0*d.%s", dirname, prefix, digits, k, (format == P3D_SLICE_RAW) ? "raw" : "tif");
+                slice_im = (unsigned char*) (in_im + (size_t) k * slice);
+
+                if (((format == P3D_SLICE_RAW) ? _p3dWriteRawSlice(filename, slice_im, slice * 1) :
+                        _p3dWriteTiffSlice(filename, slice_im, dimx, dimy, 1, P3D_FALSE)) != P3D_SUCCESS) {
+#pragma omp critical
+                    err = P3D_IO_ERROR;
+                }
+            }
+        }
+
+        if (filename != NULL) free(filename);
+    }
+
+    if (mem_err == P3D_TRUE) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - Not enough (contiguous) memory. Program will exit.");
+        }
+        return P3D_MEM_ERROR;
+    }
+    if (err != P3D_SUCCESS) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - IO error: error on writing slices in %s. Program will exit.", dirname);
+        }
+        return P3D_IO_ERROR;
+    }
+
+    // Print elapsed time (if required):
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Slice stack written successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
+    }
+
+    return P3D_SUCCESS;
+}
+
+int p3dWriteSliceStack16(
+        unsigned short* in_im,
+        char* dirname, // IN: existing output directory
+        char* prefix, // IN: slices are named <prefix>_<z>.tif (or .raw)
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int format, // IN: P3D_SLICE_TIFF or P3D_SLICE_RAW
+        const int flagLittle,
+        const int flagSigned,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    char* filename;
+    unsigned char* slice_im;
+    unsigned short* tmp_im;
+    const size_t slice = (size_t) dimx * dimy;
+    int digits, k, err = P3D_SUCCESS, mem_err = P3D_FALSE;
+
+    // Start tracking computational time:
+    if (wr_log != NULL) {
+        p3dResetStartTime();
+        wr_log("Pore3D - Writing 16-bit slice stack %s ...", dirname);
+        if (flagSigned == P3D_TRUE)
+            wr_log("\tSigned/Unsigned: Signed.");
+        else
+            wr_log("\tSigned/Unsigned: Unsigned.");
+        if (flagLittle == P3D_TRUE)
+            wr_log("\tLittle/Big Endian: Little (RAW slices only).");
+        else
+            wr_log("\tLittle/Big Endian: Big (RAW slices only).");
+    }
+
+    // Zero padded slice numbers (at least 4 digits) keep the name ordering:
+    for (digits = 4, k = 10000; k < dimz; k *= 10)
+        digits++;
+
+#pragma omp parallel private(filename, slice_im, tmp_im)
+    {
+        filename = (char*) malloc((strlen(dirname) + strlen(prefix) + digits + 8) * sizeof (char));
+        tmp_im = NULL;
+        if ((flagSigned == P3D_TRUE) || ((format == P3D_SLICE_RAW) && (flagLittle == P3D_FALSE))) {
+            tmp_im = (unsigned short*) malloc(slice * sizeof (unsigned short));
+            if (tmp_im == NULL) {
+#pragma omp critical
+                mem_err = P3D_TRUE;
+            }
+        }
+        if (filename == NULL) {
+#pragma omp critical
+            mem_err = P3D_TRUE;
+        }
+
+#pragma omp for schedule(dynamic)
+        for (k = 0; k < dimz; k++) {
+            if ((err == P3D_SUCCESS) && (mem_err == P3D_FALSE)) {
+                sprintf(filename, "%s" P3D_PATH_SEP "%s_%0*d.%s", dirname, prefix, digits, k, (format == P3D_SLICE_RAW) ? "raw" : "tif");
+                slice_im = (unsigned char*) (in_im + (size_t) k * slice);
+
+                // Signed offset (and byte swap for RAW slices) on a slice buffer:
+                if (tmp_im != NULL) {
+                    p3dRawEncode16(tmp_im, (unsigned short*) slice_im, slice,
+                            (format == P3D_SLICE_RAW) && (flagLittle == P3D_FALSE), (flagSigned == P3D_TRUE));
+                    slice_im = (unsigned char*) tmp_im;
+                }
+
+                if (((format == P3D_SLICE_RAW) ? _p3dWriteRawSlice(filename, slice_im, slice * 2) :
+                        _p3dWriteTiffSlice(filename, slice_im, dimx, dimy, 2, flagSigned)) != P3D_SUCCESS) {
+#pragma omp critical
+                    err = P3D_IO_ERROR;
+                }
+            }
+        }
+
+        if (filename != NULL) free(filename);
+        if (tmp_im != NULL) free(tmp_im);
+    }
+
+    if (mem_err == P3D_TRUE) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - Not enough (contiguous) memory. Program will exit.");
+        }
+        return P3D_MEM_ERROR;
+    }
+    if (err != P3D_SUCCESS) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - IO error: error on writing slices in %s. Program will exit.", dirname);
+        }
+        return P3D_IO_ERROR;
+    }
+
+    // Print elapsed time (if required):
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Slice stack written successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
+    }
+
+    return P3D_SUCCESS;
+}
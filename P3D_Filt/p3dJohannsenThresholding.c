@@ -63,7 +63,7 @@ int p3dJohannsenThresholding_8(
     double *Pq = NULL;
     int i, t, start, end;
     double Sb, Sw;
-    int ct;
+    long long ct;
 
     /*char auth_code;
 
@@ -87,12 +87,12 @@ int p3dJohannsenThresholding_8(
     Pq = (double *) malloc(sizeof (double) *(UCHAR_MAX + 1));
 
     /* Compute image histogram: */
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         prob[in_im[ ct ]] = prob[in_im[ ct ]] + 1.0;
 
     /* Compute probabilities: */
     for (ct = 0; ct <= UCHAR_MAX; ct++)
-        prob[ct] = prob[ct] / (double) (dimx * dimy * dimz);
+        prob[ct] = prob[ct] / ((double) dimx * dimy * dimz);
 
     /* Compute the factors */
     Pt[0] = prob[0];
@@ -126,7 +126,7 @@ int p3dJohannsenThresholding_8(
 
 
 #pragma omp parallel for
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         out_im[ ct ] = (in_im[ ct ] > (*thresh)) ? OBJECT : BACKGROUND;
 
 
@@ -187,7 +187,7 @@ int p3dJohannsenThresholding_16(
     double *Pq = NULL;
     int i, t, start, end;
     double Sb, Sw;
-    int ct;
+    long long ct;
 
     /*char auth_code;
 
@@ -211,12 +211,12 @@ int p3dJohannsenThresholding_16(
     Pq = (double *) malloc(sizeof (double) *(USHRT_MAX + 1));
 
     /* Compute image histogram: */
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         prob[in_im[ ct ]] = prob[in_im[ ct ]] + 1.0;
 
     /* Compute probabilities: */
     for (ct = 0; ct <= USHRT_MAX; ct++)
-        prob[ct] = prob[ct] / (double) (dimx * dimy * dimz);
+        prob[ct] = prob[ct] / ((double) dimx * dimy * dimz);
 
     /* Compute the factors */
     Pt[0] = prob[0];
@@ -250,7 +250,7 @@ int p3dJohannsenThresholding_16(
 
 
 #pragma omp parallel for
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         out_im[ ct ] = (in_im[ ct ] > (*thresh)) ? OBJECT : BACKGROUND;
 
 
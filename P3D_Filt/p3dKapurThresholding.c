@@ -59,7 +59,8 @@ int p3dKapurThresholding_8(
     double tt, tb, to, t2;
     long N, no, nb;
 
-    int i, j, ct, t;
+    int i, j, t;
+    long long ct;
 
     /*char auth_code;
 
@@ -82,12 +83,12 @@ int p3dKapurThresholding_8(
     prob = (double*) calloc((UCHAR_MAX + 1), sizeof (double));
 
     /* Compute image histogram: */
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         prob[in_im[ ct ]] = prob[in_im[ ct ]] + 1.0;
 
     /* Compute probabilities: */
     for (ct = 0; ct <= UCHAR_MAX; ct++)
-        prob[ct] = prob[ct] / (double) (dimx * dimy * dimz);
+        prob[ct] = prob[ct] / ((double) dimx * dimy * dimz);
 
     /* Compute the factors */
     Pt[0] = prob[0];
@@ -115,7 +116,7 @@ int p3dKapurThresholding_8(
 
 
 #pragma omp parallel for
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         out_im[ ct ] = (in_im[ ct ] > (*thresh)) ? OBJECT : BACKGROUND;
 
     // Free memory:
@@ -174,7 +175,8 @@ int p3dKapurThresholding_16(
     double tt, tb, to, t2;
     long N, no, nb;
 
-    int i, j, ct, t;
+    int i, j, t;
+    long long ct;
 
     /*char auth_code;
 
@@ -197,12 +199,12 @@ int p3dKapurThresholding_16(
     prob = (double*) calloc((USHRT_MAX + 1), sizeof (double));
 
     /* Compute image histogram: */
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         prob[in_im[ ct ]] = prob[in_im[ ct ]] + 1.0;
 
     /* Compute probabilities: */
     for (ct = 0; ct <= USHRT_MAX; ct++)
-        prob[ct] = prob[ct] / (double) (dimx * dimy * dimz);
+        prob[ct] = prob[ct] / ((double) dimx * dimy * dimz);
 
     /* Compute the factors */
     Pt[0] = prob[0];
@@ -230,7 +232,7 @@ int p3dKapurThresholding_16(
 
 
 #pragma omp parallel for
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         out_im[ ct ] = (in_im[ ct ] > (*thresh)) ? OBJECT : BACKGROUND;
 
     // Free memory:
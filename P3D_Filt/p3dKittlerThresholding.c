@@ -159,7 +159,8 @@ int p3dKittlerThresholding_8(
 
     double* prob;
     double* F;
-    int i, ct;    
+    int i;
+    long long ct;
     int tbest = 0;
 
     /*char auth_code;
@@ -181,7 +182,7 @@ int p3dKittlerThresholding_8(
     P3D_TRY(F = (double*) calloc((UCHAR_MAX + 1), sizeof (double)));
     
     /* Compute image histogram: */
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         prob[in_im[ ct ]] = prob[in_im[ ct ]] + 1.0;
 
 
@@ -197,7 +198,7 @@ int p3dKittlerThresholding_8(
 
     /* Threshold image: */
     //#pragma omp parallel for
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         out_im[ ct ] = (in_im[ ct ] > (*thresh)) ? OBJECT : BACKGROUND;
     
     // Print elapsed time (if required):
@@ -251,7 +252,8 @@ int p3dKittlerThresholding_16(
 
     double* prob;
     double* F;
-    int i, ct;
+    int i;
+    long long ct;
     int tbest = 0;
 
     /*char auth_code;
@@ -274,7 +276,7 @@ int p3dKittlerThresholding_16(
     P3D_TRY(F = (double*) calloc((USHRT_MAX + 1), sizeof (double)));
 
     /* Compute image histogram: */
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         prob[in_im[ ct ]] = prob[in_im[ ct ]] + 1.0;
 
 
@@ -289,7 +291,7 @@ int p3dKittlerThresholding_16(
 
     /* Threshold image: */
     //#pragma omp parallel for
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         out_im[ ct ] = (in_im[ ct ] > (*thresh)) ? OBJECT : BACKGROUND;
 
     // Print elapsed time (if required):
@@ -0,0 +1,272 @@
+/***************************************************************************/
+/* (C) 2016 Elettra - Sincrotrone Trieste S.C.p.A.. All rights reserved.   */
+/*                                                                         */
+/*                                                                         */
+/* This file is part of Pore3D, a software library for quantitative        */
+/* analysis of 3D (volume) images.                                         */
+/*                                                                         */
+/* Pore3D is free software: you can redistribute it and/or modify it       */
+/* under the terms of the GNU General Public License as published by the   */
+/* Free Software Foundation, either version 3 of the License, or (at your  */
+/* option) any later version.                                              */
+/*                                                                         */
+/* Pore3D is distributed in the hope that it will be useful, but WITHOUT   */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or   */
+/* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License    */
+/* for more details.                                                       */
+/*                                                                         */
+/* You should have received a copy of the GNU General Public License       */
+/* along with Pore3D. If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                         */
+/***************************************************************************/
+
+//
+// Author: Francesco Brun
+// Last modified: October, 16th 2026
+//
+
+// Memory-mapped access to RAW volumes. The returned pointer can be passed
+// to any p3d* function expecting an input volume: no copy is performed for
+// 8-bit data and for native-endian unsigned 16-bit data. Signed or
+// byte-swapped 16-bit data are mapped copy-on-write and converted in
+// place, so only the touched pages are privately duplicated. Volumes must
+// be released with the matching p3dUnmapRaw* call (not with free).
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <omp.h>
+#include <limits.h>
+
+#ifdef _WINDOWS
+	#include <windows.h>
+#else
+	#include <sys/types.h>
+	#include <sys/stat.h>
+	#include <sys/mman.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+#include "p3dFilt.h"
+#include "p3dTime.h"
+
+#include "Common/p3dEndianSwap.h"
+
+int _p3dIsLittleEndianHost() {
+    const unsigned short test = 1;
+
+    return (*((const unsigned char*) &test) == 1) ? P3D_TRUE : P3D_FALSE;
+}
+
+// Maps LENGTH bytes of FILENAME. If WRITABLE is P3D_TRUE the mapping is
+// private (copy-on-write), otherwise it is shared and read-only. Returns
+// NULL on failure.
+
+void* _p3dMapFile(
+        char* filename,
+        const size_t length,
+        const int writable,
+        const int access_hint
+        ) {
+    void* addr = NULL;
+
+#ifdef _WINDOWS
+    HANDLE hfile, hmap;
+    LARGE_INTEGER fsize;
+    DWORD flags = FILE_ATTRIBUTE_NORMAL;
+
+    if (access_hint == P3D_ACCESS_SEQUENTIAL)
+        flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+    else if (access_hint == P3D_ACCESS_RANDOM)
+        flags |= FILE_FLAG_RANDOM_ACCESS;
+
+    hfile = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, flags, NULL);
+    if (hfile == INVALID_HANDLE_VALUE)
+        return NULL;
+
+    if ((GetFileSizeEx(hfile, &fsize) == 0) || ((unsigned long long) fsize.QuadPart < (unsigned long long) length)) {
+        CloseHandle(hfile);
+        return NULL;
+    }
+
+    hmap = CreateFileMappingA(hfile, NULL, (writable == P3D_TRUE) ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+    if (hmap == NULL) {
+        CloseHandle(hfile);
+        return NULL;
+    }
+
+    addr = MapViewOfFile(hmap, (writable == P3D_TRUE) ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, length);
+
+    // The view keeps a reference to the mapping object and to the file:
+    CloseHandle(hmap);
+    CloseHandle(hfile);
+#else
+    int fd;
+    struct stat st;
+
+    if ((fd = open(filename, O_RDONLY)) < 0)
+        return NULL;
+
+    if ((fstat(fd, &st) != 0) || ((unsigned long long) st.st_size < (unsigned long long) length)) {
+        close(fd);
+        return NULL;
+    }
+
+    if (writable == P3D_TRUE)
+        addr = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    else
+        addr = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+
+    // The mapping keeps a reference to the file:
+    close(fd);
+
+    if (addr == MAP_FAILED)
+        return NULL;
+
+    if (access_hint == P3D_ACCESS_SEQUENTIAL)
+        madvise(addr, length, MADV_SEQUENTIAL);
+    else if (access_hint == P3D_ACCESS_RANDOM)
+        madvise(addr, length, MADV_RANDOM);
+#endif
+
+    return addr;
+}
+
+void _p3dUnmapFile(void* addr, const size_t length) {
+#ifdef _WINDOWS
+    UnmapViewOfFile(addr);
+#else
+    munmap(addr, length);
+#endif
+}
+
+int p3dMapRaw8(
+        char* filename,
+        unsigned char** out_im,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int access_hint,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    const size_t length = (size_t) dimx * dimy * dimz * sizeof (unsigned char);
+
+    // Start tracking computational time:
+    if (wr_log != NULL) {
+        p3dResetStartTime();
+        wr_log("Pore3D - Mapping RAW file %s ...", filename);
+    }
+
+    // Map the file read-only:
+    (*out_im) = (unsigned char*) _p3dMapFile(filename, length, P3D_FALSE, access_hint);
+
+    if ((*out_im) == NULL) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - IO error: cannot map input file %s. Program will exit.", filename);
+        }
+
+        return P3D_IO_ERROR;
+    }
+
+    // Print elapsed time (if required):
+    if (wr_log != NULL) {
+        wr_log("Pore3D - RAW file mapped successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
+    }
+
+    // Return OK:
+    return P3D_SUCCESS;
+}
+
+int p3dMapRaw16(
+        char* filename,
+        unsigned short** out_im,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int flagLittle,
+        const int flagSigned,
+        const int access_hint,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    const long long nvoxels = (long long) dimx * dimy * dimz;
+    const size_t length = (size_t) nvoxels * sizeof (unsigned short);
+    unsigned short* im;
+    int swap, convert;
+    long long ct;
+
+    // Start tracking computational time:
+    if (wr_log != NULL) {
+        p3dResetStartTime();
+        wr_log("Pore3D - Mapping RAW file %s ...", filename);
+        if (flagSigned == P3D_TRUE)
+            wr_log("\tSigned/Unsigned: Signed.");
+        else
+            wr_log("\tSigned/Unsigned: Unsigned.");
+        if (flagLittle == P3D_TRUE)
+            wr_log("\tLittle/Big Endian: Little.");
+        else
+            wr_log("\tLittle/Big Endian: Big.");
+    }
+
+    // Data need to be touched only if byte order differs from the host one
+    // or if signed values have to be shifted:
+    swap = (((flagLittle == P3D_FALSE) ? P3D_FALSE : P3D_TRUE) != _p3dIsLittleEndianHost());
+    convert = (swap || (flagSigned == P3D_TRUE)) ? P3D_TRUE : P3D_FALSE;
+
+    // Map the file (copy-on-write only if conversion is needed):
+    im = (unsigned short*) _p3dMapFile(filename, length, convert, access_hint);
+
+    if (im == NULL) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - IO error: cannot map input file %s. Program will exit.", filename);
+        }
+        (*out_im) = NULL;
+
+        return P3D_IO_ERROR;
+    }
+
+    // Convert in place (same rules of p3dReadRaw16):
+    if (convert == P3D_TRUE) {
+#pragma omp parallel for
+        for (ct = 0; ct < nvoxels; ct += P3D_RAW_CHUNK) {
+            p3dRawDecode16(im + ct, im + ct, (size_t) (((nvoxels - ct) < P3D_RAW_CHUNK) ? (nvoxels - ct) : P3D_RAW_CHUNK),
+                    swap, (flagSigned == P3D_TRUE));
+        }
+    }
+
+    (*out_im) = im;
+
+    // Print elapsed time (if required):
+    if (wr_log != NULL) {
+        wr_log("Pore3D - RAW file mapped successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
+    }
+
+    // Return OK:
+    return P3D_SUCCESS;
+}
+
+int p3dUnmapRaw8(
+        unsigned char* in_im,
+        const int dimx,
+        const int dimy,
+        const int dimz
+        ) {
+    if (in_im != NULL)
+        _p3dUnmapFile(in_im, (size_t) dimx * dimy * dimz * sizeof (unsigned char));
+
+    return P3D_SUCCESS;
+}
+
+int p3dUnmapRaw16(
+        unsigned short* in_im,
+        const int dimx,
+        const int dimy,
+        const int dimz
+        ) {
+    if (in_im != NULL)
+        _p3dUnmapFile(in_im, (size_t) dimx * dimy * dimz * sizeof (unsigned short));
+
+    return P3D_SUCCESS;
+}
@@ -22,7 +22,7 @@
 
 //
 // Author: Francesco Brun
-// Last modified: Sept, 28th 2016
+// Last modified: October, 16th 2026
 //
 
 #include <stdlib.h>
@@ -32,6 +32,20 @@
 
 #include "p3dFilt.h"
 #include "p3dTime.h"
+#include "p3dSlabIO.h"
+
+#include "Common/p3dClampIndex.h"
+
+// Mean filters are separable box filters computed with running sums along 
+// each direction, so that the cost per voxel does not depend on kernel size.
+// Sums are exact: 8-bit images are accumulated in unsigned integers and 
+// 16-bit images in doubles (an unsigned int would overflow for size > 40).
+// In 3D the volume is split into slabs of planes (one for each thread) and
+// the sum along z keeps a ring of the 2 * rad + 1 planes within the kernel,
+// already summed along x and y: no volume-sized buffer is needed.
+
+// Width of the column strips scanned by each thread in the 2D y pass:
+#define P3D_MEAN_STRIP 256
 
 
 int p3dMeanFilter2D_8(
@@ -43,17 +57,24 @@ int p3dMeanFilter2D_8(
         int (*wr_log)(const char*, ...),
         int (*wr_progress)(const int, ...)
         ) {
-    // Padded input and related dims:
-    unsigned char* tmp_im;
-
-    int a_dimx, a_dimy;
-    int i, j;
-    int x, y;
+    // Clamped coordinates for the boundary region:
+    int* cx = NULL;
+    int* cy = NULL;
+
+    // Running sums along x (whole image) and along y (one entry per column):
+    unsigned int* sum_im = NULL;
+    unsigned int* acc = NULL;
+    unsigned int sum;
+
+    unsigned char* row;
+    unsigned int* row_add;
+    unsigned int* row_del;
+    int i, j, b;
+    int x0, x1;
     int pr;
 
-    // Variables for computing gaussian kernel:
     int a_rad;
-    double sum;
+    double n;
 
 
     // Start tracking computational time:
@@ -66,38 +87,73 @@ int p3dMeanFilter2D_8(
 
     // Init variables:
     a_rad = size / 2; // integer division   
+    n = (double) size * size;
 
-    // Compute dimensions of padded REV:
-    a_dimx = dimx + a_rad * 2;
-    a_dimy = dimy + a_rad * 2;
+    // Replicate padding is performed virtually by clamping coordinates:
+    P3D_TRY(cx = p3dClampTable(dimx, a_rad));
+    P3D_TRY(cy = p3dClampTable(dimy, a_rad));
 
-    // Initialize input:
-    P3D_TRY(tmp_im = (unsigned char*) malloc(a_dimx * a_dimy * sizeof (unsigned char)));
-    P3D_TRY(p3dReplicatePadding2D_8(in_im, tmp_im, dimx, dimy, a_rad, NULL, NULL));
+    P3D_TRY(sum_im = (unsigned int*) malloc((size_t) dimx * dimy * sizeof (unsigned int)));
+    P3D_TRY(acc = (unsigned int*) malloc(dimx * sizeof (unsigned int)));
 
     pr = 0;
 
-    // Volume scanning:
-#pragma omp parallel for private(i, x, y, sum) reduction( + : pr)
-    for (j = a_rad; j < (a_dimy - a_rad); j++) {
-        for (i = a_rad; i < (a_dimx - a_rad); i++) {
-            sum = 0;
-            // Fill temporary array:
-            for (y = (j - a_rad); y <= (j + a_rad); y++)
-                for (x = (i - a_rad); x <= (i + a_rad); x++)
-                    sum += (double) tmp_im[ I2(x, y, a_dimx) ];
+    // Running sum along x: the first window of each row is summed, the 
+    // following ones are obtained by adding the entering sample and removing
+    // the leaving one:
+#pragma omp parallel for private(i, sum, row) reduction( + : pr)
+    for (j = 0; j < dimy; j++) {
+        row = in_im + I2(0, j, dimx);
+
+        sum = 0;
+        for (i = -a_rad; i <= a_rad; i++)
+            sum += row[ cx[i] ];
+        sum_im[ I2(0, j, dimx) ] = sum;
+
+        for (i = 1; i < dimx; i++) {
+            sum += (unsigned int) row[ cx[i + a_rad] ] - row[ cx[i - a_rad - 1] ];
+            sum_im[ I2(i, j, dimx) ] = sum;
+        }
 
-            // Set out voxel with the mean of the sorted temporary array:
-            out_im[ I2(i - a_rad, j - a_rad, dimx) ] = (unsigned char) (sum / (size * size) + 0.5);
+        // Increase progress counter:
+        pr++;
+    }
 
-            // Increase progress counter:
-            pr++;
+    // Update any progress bar:
+    if (wr_progress != NULL) wr_progress((int) ((double) (pr) / (2 * dimy)*100 + 0.5));
+
+    // Running sum along y, performed on whole rows at once. Each thread 
+    // scans a strip of columns:
+#pragma omp parallel for private(i, j, x0, x1, row_add, row_del)
+    for (b = 0; b < ((dimx + P3D_MEAN_STRIP - 1) / P3D_MEAN_STRIP); b++) {
+        x0 = b * P3D_MEAN_STRIP;
+        x1 = ((x0 + P3D_MEAN_STRIP) < dimx) ? (x0 + P3D_MEAN_STRIP) : dimx;
+
+        for (i = x0; i < x1; i++)
+            acc[i] = 0;
+        for (j = -a_rad; j <= a_rad; j++) {
+            row_add = sum_im + I2(0, cy[j], dimx);
+            for (i = x0; i < x1; i++)
+                acc[i] += row_add[i];
         }
 
-        // Update any progress bar:
-        if (wr_progress != NULL) wr_progress((int) ((double) (pr) / (dimx * dimy)*100 + 0.5));
+        for (j = 0; j < dimy; j++) {
+            if (j > 0) {
+                row_add = sum_im + I2(0, cy[j + a_rad], dimx);
+                row_del = sum_im + I2(0, cy[j - a_rad - 1], dimx);
+                for (i = x0; i < x1; i++)
+                    acc[i] += row_add[i] - row_del[i];
+            }
+
+            // Set out pixel with the mean of the window:
+            for (i = x0; i < x1; i++)
+                out_im[ I2(i, j, dimx) ] = (unsigned char) (acc[i] / n + 0.5);
+        }
     }
 
+    // Update any progress bar:
+    if (wr_progress != NULL) wr_progress(100);
+
 
     // Print elapsed time (if required):
     if (wr_log != NULL) {
@@ -105,7 +161,10 @@ int p3dMeanFilter2D_8(
     }
 
     // Release resources:
-    if (tmp_im != NULL) free(tmp_im);
+    p3dClampTableFree(cx, a_rad);
+    p3dClampTableFree(cy, a_rad);
+    if (sum_im != NULL) free(sum_im);
+    if (acc != NULL) free(acc);
 
     // Return success:
     return P3D_SUCCESS;
@@ -118,7 +177,10 @@ MEM_ERROR:
     }
 
     // Release resources:	
-    if (tmp_im != NULL) free(tmp_im);
+    p3dClampTableFree(cx, a_rad);
+    p3dClampTableFree(cy, a_rad);
+    if (sum_im != NULL) free(sum_im);
+    if (acc != NULL) free(acc);
 
     // Return error:
     return P3D_MEM_ERROR;
@@ -133,17 +195,24 @@ int p3dMeanFilter2D_16(
         int (*wr_log)(const char*, ...),
         int (*wr_progress)(const int, ...)
         ) {
-    // Padded input and related dims:
-    unsigned short* tmp_im;
+    // Clamped coordinates for the boundary region:
+    int* cx = NULL;
+    int* cy = NULL;
 
-    int a_dimx, a_dimy;
-    int i, j;
-    int x, y;
+    // Running sums along x (whole image) and along y (one entry per column):
+    double* sum_im = NULL;
+    double* acc = NULL;
+    double sum;
+
+    unsigned short* row;
+    double* row_add;
+    double* row_del;
+    int i, j, b;
+    int x0, x1;
     int pr;
 
-    // Variables for computing gaussian kernel:
     int a_rad;
-    double sum;
+    double n;
 
 
     // Start tracking computational time:
@@ -156,38 +225,73 @@ int p3dMeanFilter2D_16(
 
     // Init variables:
     a_rad = size / 2; // integer division   
+    n = (double) size * size;
 
-    // Compute dimensions of padded REV:
-    a_dimx = dimx + a_rad * 2;
-    a_dimy = dimy + a_rad * 2;
+    // Replicate padding is performed virtually by clamping coordinates:
+    P3D_TRY(cx = p3dClampTable(dimx, a_rad));
+    P3D_TRY(cy = p3dClampTable(dimy, a_rad));
 
-    // Initialize input:
-    P3D_TRY(tmp_im = (unsigned short*) malloc(a_dimx * a_dimy * sizeof (unsigned short)));
-    P3D_TRY(p3dReplicatePadding2D_16(in_im, tmp_im, dimx, dimy, a_rad, NULL, NULL));
+    P3D_TRY(sum_im = (double*) malloc((size_t) dimx * dimy * sizeof (double)));
+    P3D_TRY(acc = (double*) malloc(dimx * sizeof (double)));
 
     pr = 0;
 
-    // Volume scanning:
-#pragma omp parallel for private(i, x, y, sum) reduction( + : pr)
-    for (j = a_rad; j < (a_dimy - a_rad); j++) {
-        for (i = a_rad; i < (a_dimx - a_rad); i++) {
-            sum = 0;
-            // Fill temporary array:
-            for (y = (j - a_rad); y <= (j + a_rad); y++)
-                for (x = (i - a_rad); x <= (i + a_rad); x++)
-                    sum += (double) tmp_im[ I2(x, y, a_dimx) ];
+    // Running sum along x: the first window of each row is summed, the 
+    // following ones are obtained by adding the entering sample and removing
+    // the leaving one:
+#pragma omp parallel for private(i, sum, row) reduction( + : pr)
+    for (j = 0; j < dimy; j++) {
+        row = in_im + I2(0, j, dimx);
+
+        sum = 0;
+        for (i = -a_rad; i <= a_rad; i++)
+            sum += row[ cx[i] ];
+        sum_im[ I2(0, j, dimx) ] = sum;
+
+        for (i = 1; i < dimx; i++) {
+            sum += (double) row[ cx[i + a_rad] ] - row[ cx[i - a_rad - 1] ];
+            sum_im[ I2(i, j, dimx) ] = sum;
+        }
 
-            // Set out voxel with the mean of the sorted temporary array:
-            out_im[ I2(i - a_rad, j - a_rad, dimx) ] = (unsigned short) (sum / (size * size) + 0.5);
+        // Increase progress counter:
+        pr++;
+    }
 
-            // Increase progress counter:
-            pr++;
+    // Update any progress bar:
+    if (wr_progress != NULL) wr_progress((int) ((double) (pr) / (2 * dimy)*100 + 0.5));
+
+    // Running sum along y, performed on whole rows at once. Each thread 
+    // scans a strip of columns:
+#pragma omp parallel for private(i, j, x0, x1, row_add, row_del)
+    for (b = 0; b < ((dimx + P3D_MEAN_STRIP - 1) / P3D_MEAN_STRIP); b++) {
+        x0 = b * P3D_MEAN_STRIP;
+        x1 = ((x0 + P3D_MEAN_STRIP) < dimx) ? (x0 + P3D_MEAN_STRIP) : dimx;
+
+        for (i = x0; i < x1; i++)
+            acc[i] = 0;
+        for (j = -a_rad; j <= a_rad; j++) {
+            row_add = sum_im + I2(0, cy[j], dimx);
+            for (i = x0; i < x1; i++)
+                acc[i] += row_add[i];
         }
 
-        // Update any progress bar:
-        if (wr_progress != NULL) wr_progress((int) ((double) (pr) / (dimx * dimy)*100 + 0.5));
+        for (j = 0; j < dimy; j++) {
+            if (j > 0) {
+                row_add = sum_im + I2(0, cy[j + a_rad], dimx);
+                row_del = sum_im + I2(0, cy[j - a_rad - 1], dimx);
+                for (i = x0; i < x1; i++)
+                    acc[i] += row_add[i] - row_del[i];
+            }
+
+            // Set out pixel with the mean of the window:
+            for (i = x0; i < x1; i++)
+                out_im[ I2(i, j, dimx) ] = (unsigned short) (acc[i] / n + 0.5);
+        }
     }
 
+    // Update any progress bar:
+    if (wr_progress != NULL) wr_progress(100);
+
 
     // Print elapsed time (if required):
     if (wr_log != NULL) {
@@ -195,7 +299,10 @@ int p3dMeanFilter2D_16(
     }
 
     // Release resources:
-    if (tmp_im != NULL) free(tmp_im);
+    p3dClampTableFree(cx, a_rad);
+    p3dClampTableFree(cy, a_rad);
+    if (sum_im != NULL) free(sum_im);
+    if (acc != NULL) free(acc);
 
     // Return success:
     return P3D_SUCCESS;
@@ -208,34 +315,114 @@ MEM_ERROR:
     }
 
     // Release resources:	
-    if (tmp_im != NULL) free(tmp_im);
+    p3dClampTableFree(cx, a_rad);
+    p3dClampTableFree(cy, a_rad);
+    if (sum_im != NULL) free(sum_im);
+    if (acc != NULL) free(acc);
 
     // Return error:
     return P3D_MEM_ERROR;
 }
 
-int p3dMeanFilter3D_8(
+// Sums along x and y of the plane K (through clamped coordinates), the
+// sums along x being computed in TMP:
+static void _p3dMeanFilterPlane_8(
         unsigned char* in_im,
-        unsigned char* out_im,
+        const size_t in_sy,
+        const size_t in_sz,
+        const int k,
         const int dimx,
         const int dimy,
-        const int dimz,
+        const int a_rad,
+        const int* cx,
+        const int* cy,
+        unsigned int* tmp,
+        unsigned int* out
+        ) {
+    unsigned char* row;
+    unsigned int* row_add;
+    unsigned int* row_del;
+    unsigned int sum;
+    int i, j;
+
+    for (j = 0; j < dimy; j++) {
+        row = in_im + IS(0, j, k, in_sy, in_sz);
+
+        sum = 0;
+        for (i = -a_rad; i <= a_rad; i++)
+            sum += row[ cx[i] ];
+        tmp[ I2(0, j, dimx) ] = sum;
+
+        for (i = 1; i < dimx; i++) {
+            sum += (unsigned int) row[ cx[i + a_rad] ] - row[ cx[i - a_rad - 1] ];
+            tmp[ I2(i, j, dimx) ] = sum;
+        }
+    }
+
+    // Along y whole rows are summed at once:
+    for (i = 0; i < dimx; i++)
+        out[i] = 0;
+    for (j = -a_rad; j <= a_rad; j++) {
+        row_add = tmp + I2(0, cy[j], dimx);
+        for (i = 0; i < dimx; i++)
+            out[i] += row_add[i];
+    }
+
+    for (j = 1; j < dimy; j++) {
+        row_add = tmp + I2(0, cy[j + a_rad], dimx);
+        row_del = tmp + I2(0, cy[j - a_rad - 1], dimx);
+        for (i = 0; i < dimx; i++)
+            out[i + dimx] = out[i] + row_add[i] - row_del[i];
+        out += dimx;
+    }
+}
+
+int p3dMeanFilter3D_8_view(
+        struct VolumeView* in_view, // IN: input view
+        struct VolumeView* out_view, // OUT: output view (same dimensions)
         const int size,
         int (*wr_log)(const char*, ...),
         int (*wr_progress)(const int, ...)
         ) {
-    // Padded input and related dims:
-    unsigned char* tmp_im;
-
-    int a_dimx, a_dimy, a_dimz;
-    int i, j, k;
-    int x, y, z;
+    // Input and output are addressed through origin and strides of their views:
+    unsigned char* in_im = (unsigned char*) in_view->base + IV(0, 0, 0, in_view);
+    unsigned char* out_im = (unsigned char*) out_view->base + IV(0, 0, 0, out_view);
+    const size_t in_sy = in_view->stridey, in_sz = in_view->stridez;
+    const size_t out_sy = out_view->stridey, out_sz = out_view->stridez;
+    const int dimx = in_view->dimx, dimy = in_view->dimy, dimz = in_view->dimz;
+    const size_t np = (size_t) dimx * dimy;
+
+    // Clamped coordinates for the boundary region:
+    int* cx = NULL;
+    int* cy = NULL;
+    int* cz = NULL;
+
+    // For each slab: ring of the planes summed along x and y that are within
+    // the kernel, running sum along z and scratch plane:
+    unsigned int* ring = NULL;
+    unsigned int* t_ring;
+    unsigned int* t_acc;
+    unsigned int* t_tmp;
+    unsigned int* t_plane;
+
+    unsigned char* row;
+    size_t ct;
+    int i, j, k, z, b;
+    int z0, z1, slot;
+    int nslabs, nplanes;
     int pr;
 
-    // Variables for computing gaussian kernel:
     int a_rad;
-    double sum;
+    double n;
+
 
+    // Output view must have the dimensions of the input view:
+    if (p3dVolumeViewSameDims(in_view, out_view) == P3D_FALSE) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - Error: output view should have the same dimensions of the input view.");
+        }
+        return P3D_IO_ERROR;
+    }
 
     // Start tracking computational time:
     if (wr_log != NULL) {
@@ -247,40 +434,65 @@ int p3dMeanFilter3D_8(
 
     // Init variables:
     a_rad = size / 2; // integer division   
+    n = (double) size * size * size;
+    nplanes = 2 * a_rad + 1;
+    nslabs = MIN(omp_get_max_threads(), dimz);
 
-    // Compute dimensions of padded REV:
-    a_dimx = dimx + a_rad * 2;
-    a_dimy = dimy + a_rad * 2;
-    a_dimz = dimz + a_rad * 2;
+    // Replicate padding is performed virtually by clamping coordinates:
+    P3D_TRY(cx = p3dClampTable(dimx, a_rad));
+    P3D_TRY(cy = p3dClampTable(dimy, a_rad));
+    P3D_TRY(cz = p3dClampTable(dimz, a_rad));
 
-    // Initialize input:
-    P3D_TRY(tmp_im = (unsigned char*) malloc(a_dimx * a_dimy * a_dimz * sizeof (unsigned char)));
-    P3D_TRY(p3dReplicatePadding3D_8(in_im, tmp_im, dimx, dimy, dimz, a_rad, NULL, NULL));
+    P3D_TRY(ring = (unsigned int*) malloc((size_t) nslabs * (nplanes + 2) * np * sizeof (unsigned int)));
 
     pr = 0;
 
-    // Volume scanning:
-#pragma omp parallel for private(i, j, x, y, z, sum) reduction( + : pr)
-    for (k = a_rad; k < (a_dimz - a_rad); k++) {
-        for (j = a_rad; j < (a_dimy - a_rad); j++)
-            for (i = a_rad; i < (a_dimx - a_rad); i++) {
-                sum = 0;
-                // Fill temporary array:
-                for (z = (k - a_rad); z <= (k + a_rad); z++)
-                    for (y = (j - a_rad); y <= (j + a_rad); y++)
-                        for (x = (i - a_rad); x <= (i + a_rad); x++)
-                            sum += (double) tmp_im[ I(x, y, z, a_dimx, a_dimy) ];
-
-                // Set out voxel with the mean of the sorted temporary array:
-                out_im[ I(i - a_rad, j - a_rad, k - a_rad, dimx, dimy) ] = (unsigned char)
-                        (sum / (size * size * size));
-
-                // Increment progress counter:
-                pr++;
+    // Each slab of planes [z0, z1) is scanned along z: the first window is
+    // summed, then the plane leaving the window is subtracted and its slot
+    // of the ring is overwritten with the entering one, which is added:
+#pragma omp parallel for private(i, j, k, z, z0, z1, slot, ct, row, t_ring, t_acc, t_tmp, t_plane) reduction( + : pr)
+    for (b = 0; b < nslabs; b++) {
+        t_ring = ring + (size_t) b * (nplanes + 2) * np;
+        t_acc = t_ring + (size_t) nplanes * np;
+        t_tmp = t_acc + np;
+
+        z0 = (int) ((long long) dimz * b / nslabs);
+        z1 = (int) ((long long) dimz * (b + 1) / nslabs);
+
+        for (ct = 0; ct < np; ct++)
+            t_acc[ct] = 0;
+        for (z = -a_rad; z <= a_rad; z++) {
+            t_plane = t_ring + (size_t) (z + a_rad) * np;
+            _p3dMeanFilterPlane_8(in_im, in_sy, in_sz, cz[z0 + z], dimx, dimy, a_rad, cx, cy, t_tmp, t_plane);
+            for (ct = 0; ct < np; ct++)
+                t_acc[ct] += t_plane[ct];
+        }
+
+        slot = 0;
+        for (k = z0; k < z1; k++) {
+            if (k > z0) {
+                t_plane = t_ring + (size_t) slot * np;
+                for (ct = 0; ct < np; ct++)
+                    t_acc[ct] -= t_plane[ct];
+                _p3dMeanFilterPlane_8(in_im, in_sy, in_sz, cz[k + a_rad], dimx, dimy, a_rad, cx, cy, t_tmp, t_plane);
+                for (ct = 0; ct < np; ct++)
+                    t_acc[ct] += t_plane[ct];
+                slot = (slot + 1) % nplanes;
+            }
+
+            // Set out voxels with the mean of the window:
+            for (j = 0; j < dimy; j++) {
+                row = out_im + IS(0, j, k, out_sy, out_sz);
+                for (i = 0; i < dimx; i++)
+                    row[i] = (unsigned char) (t_acc[ I2(i, j, dimx) ] / n);
             }
 
-        // Update any progress counter:
-        if (wr_progress != NULL) wr_progress((int) ((double) (pr) / (dimx * dimy * dimz)*100 + 0.5));
+            // Increment progress counter:
+            pr++;
+
+            // Update any progress counter:
+            if (wr_progress != NULL) wr_progress((int) ((double) (pr) / ((double) dimz)*100 + 0.5));
+        }
     }
 
 
@@ -290,7 +502,10 @@ int p3dMeanFilter3D_8(
     }
 
     // Release resources:
-    if (tmp_im != NULL) free(tmp_im);
+    p3dClampTableFree(cx, a_rad);
+    p3dClampTableFree(cy, a_rad);
+    p3dClampTableFree(cz, a_rad);
+    if (ring != NULL) free(ring);
 
     // Return success:
     return P3D_SUCCESS;
@@ -303,15 +518,18 @@ MEM_ERROR:
     }
 
     // Release resources:	
-    if (tmp_im != NULL) free(tmp_im);
+    p3dClampTableFree(cx, a_rad);
+    p3dClampTableFree(cy, a_rad);
+    p3dClampTableFree(cz, a_rad);
+    if (ring != NULL) free(ring);
 
     // Return error:
     return P3D_MEM_ERROR;
 }
 
-int p3dMeanFilter3D_16(
-        unsigned short* in_im,
-        unsigned short* out_im,
+int p3dMeanFilter3D_8(
+        unsigned char* in_im,
+        unsigned char* out_im,
         const int dimx,
         const int dimy,
         const int dimz,
@@ -319,18 +537,114 @@ int p3dMeanFilter3D_16(
         int (*wr_log)(const char*, ...),
         int (*wr_progress)(const int, ...)
         ) {
-    // Padded input and related dims:
-    unsigned short* tmp_im;
+    struct VolumeView in_view, out_view;
+
+    // Whole volumes are processed as views of themselves:
+    p3dVolumeView(&in_view, in_im, dimx, dimy, dimz, 0, 0, 0, dimx, dimy, dimz);
+    p3dVolumeView(&out_view, out_im, dimx, dimy, dimz, 0, 0, 0, dimx, dimy, dimz);
+
+    return p3dMeanFilter3D_8_view(&in_view, &out_view, size, wr_log, wr_progress);
+}
+
+// Sums along x and y of the plane K (through clamped coordinates), the
+// sums along x being computed in TMP:
+static void _p3dMeanFilterPlane_16(
+        unsigned short* in_im,
+        const size_t in_sy,
+        const size_t in_sz,
+        const int k,
+        const int dimx,
+        const int dimy,
+        const int a_rad,
+        const int* cx,
+        const int* cy,
+        double* tmp,
+        double* out
+        ) {
+    unsigned short* row;
+    double* row_add;
+    double* row_del;
+    double sum;
+    int i, j;
+
+    for (j = 0; j < dimy; j++) {
+        row = in_im + IS(0, j, k, in_sy, in_sz);
+
+        sum = 0;
+        for (i = -a_rad; i <= a_rad; i++)
+            sum += row[ cx[i] ];
+        tmp[ I2(0, j, dimx) ] = sum;
 
-    int a_dimx, a_dimy, a_dimz;
-    int i, j, k;
-    int x, y, z;
+        for (i = 1; i < dimx; i++) {
+            sum += (double) row[ cx[i + a_rad] ] - row[ cx[i - a_rad - 1] ];
+            tmp[ I2(i, j, dimx) ] = sum;
+        }
+    }
+
+    // Along y whole rows are summed at once:
+    for (i = 0; i < dimx; i++)
+        out[i] = 0;
+    for (j = -a_rad; j <= a_rad; j++) {
+        row_add = tmp + I2(0, cy[j], dimx);
+        for (i = 0; i < dimx; i++)
+            out[i] += row_add[i];
+    }
+
+    for (j = 1; j < dimy; j++) {
+        row_add = tmp + I2(0, cy[j + a_rad], dimx);
+        row_del = tmp + I2(0, cy[j - a_rad - 1], dimx);
+        for (i = 0; i < dimx; i++)
+            out[i + dimx] = out[i] + row_add[i] - row_del[i];
+        out += dimx;
+    }
+}
+
+int p3dMeanFilter3D_16_view(
+        struct VolumeView* in_view, // IN: input view
+        struct VolumeView* out_view, // OUT: output view (same dimensions)
+        const int size,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    // Input and output are addressed through origin and strides of their views:
+    unsigned short* in_im = (unsigned short*) in_view->base + IV(0, 0, 0, in_view);
+    unsigned short* out_im = (unsigned short*) out_view->base + IV(0, 0, 0, out_view);
+    const size_t in_sy = in_view->stridey, in_sz = in_view->stridez;
+    const size_t out_sy = out_view->stridey, out_sz = out_view->stridez;
+    const int dimx = in_view->dimx, dimy = in_view->dimy, dimz = in_view->dimz;
+    const size_t np = (size_t) dimx * dimy;
+
+    // Clamped coordinates for the boundary region:
+    int* cx = NULL;
+    int* cy = NULL;
+    int* cz = NULL;
+
+    // For each slab: ring of the planes summed along x and y that are within
+    // the kernel, running sum along z and scratch plane:
+    double* ring = NULL;
+    double* t_ring;
+    double* t_acc;
+    double* t_tmp;
+    double* t_plane;
+
+    unsigned short* row;
+    size_t ct;
+    int i, j, k, z, b;
+    int z0, z1, slot;
+    int nslabs, nplanes;
     int pr;
 
-    // Variables for computing gaussian kernel:
     int a_rad;
-    double sum;
+    double n;
+
 
+    // Output view must have the dimensions of the input view:
+    if (p3dVolumeViewSameDims(in_view, out_view) == P3D_FALSE) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - Error: output view should have the same dimensions of the input view.");
+        }
+        return P3D_IO_ERROR;
+    }
 
     // Start tracking computational time:
     if (wr_log != NULL) {
@@ -342,40 +656,65 @@ int p3dMeanFilter3D_16(
 
     // Init variables:
     a_rad = size / 2; // integer division   
+    n = (double) size * size * size;
+    nplanes = 2 * a_rad + 1;
+    nslabs = MIN(omp_get_max_threads(), dimz);
 
-    // Compute dimensions of padded REV:
-    a_dimx = dimx + a_rad * 2;
-    a_dimy = dimy + a_rad * 2;
-    a_dimz = dimz + a_rad * 2;
+    // Replicate padding is performed virtually by clamping coordinates:
+    P3D_TRY(cx = p3dClampTable(dimx, a_rad));
+    P3D_TRY(cy = p3dClampTable(dimy, a_rad));
+    P3D_TRY(cz = p3dClampTable(dimz, a_rad));
 
-    // Initialize input:
-    P3D_TRY(tmp_im = (unsigned short*) malloc(a_dimx * a_dimy * a_dimz * sizeof (unsigned short)));
-    P3D_TRY(p3dReplicatePadding3D_16(in_im, tmp_im, dimx, dimy, dimz, a_rad, NULL, NULL));
+    P3D_TRY(ring = (double*) malloc((size_t) nslabs * (nplanes + 2) * np * sizeof (double)));
 
     pr = 0;
 
-    // Volume scanning:
-#pragma omp parallel for private(i, j, x, y, z, sum) reduction( + : pr)
-    for (k = a_rad; k < (a_dimz - a_rad); k++) {
-        for (j = a_rad; j < (a_dimy - a_rad); j++)
-            for (i = a_rad; i < (a_dimx - a_rad); i++) {
-                sum = 0;
-                // Fill temporary array:
-                for (z = (k - a_rad); z <= (k + a_rad); z++)
-                    for (y = (j - a_rad); y <= (j + a_rad); y++)
-                        for (x = (i - a_rad); x <= (i + a_rad); x++)
-                            sum += (double) tmp_im[ I(x, y, z, a_dimx, a_dimy) ];
-
-                // Set out voxel with the mean of the sorted temporary array:
-                out_im[ I(i - a_rad, j - a_rad, k - a_rad, dimx, dimy) ] = (unsigned short)
-                        (sum / (size * size * size));
-
-                // Increment progress counter:
-                pr++;
+    // Each slab of planes [z0, z1) is scanned along z: the first window is
+    // summed, then the plane leaving the window is subtracted and its slot
+    // of the ring is overwritten with the entering one, which is added:
+#pragma omp parallel for private(i, j, k, z, z0, z1, slot, ct, row, t_ring, t_acc, t_tmp, t_plane) reduction( + : pr)
+    for (b = 0; b < nslabs; b++) {
+        t_ring = ring + (size_t) b * (nplanes + 2) * np;
+        t_acc = t_ring + (size_t) nplanes * np;
+        t_tmp = t_acc + np;
+
+        z0 = (int) ((long long) dimz * b / nslabs);
+        z1 = (int) ((long long) dimz * (b + 1) / nslabs);
+
+        for (ct = 0; ct < np; ct++)
+            t_acc[ct] = 0;
+        for (z = -a_rad; z <= a_rad; z++) {
+            t_plane = t_ring + (size_t) (z + a_rad) * np;
+            _p3dMeanFilterPlane_16(in_im, in_sy, in_sz, cz[z0 + z], dimx, dimy, a_rad, cx, cy, t_tmp, t_plane);
+            for (ct = 0; ct < np; ct++)
+                t_acc[ct] += t_plane[ct];
+        }
+
+        slot = 0;
+        for (k = z0; k < z1; k++) {
+            if (k > z0) {
+                t_plane = t_ring + (size_t) slot * np;
+                for (ct = 0; ct < np; ct++)
+                    t_acc[ct] -= t_plane[ct];
+                _p3dMeanFilterPlane_16(in_im, in_sy, in_sz, cz[k + a_rad], dimx, dimy, a_rad, cx, cy, t_tmp, t_plane);
+                for (ct = 0; ct < np; ct++)
+                    t_acc[ct] += t_plane[ct];
+                slot = (slot + 1) % nplanes;
+            }
+
+            // Set out voxels with the mean of the window:
+            for (j = 0; j < dimy; j++) {
+                row = out_im + IS(0, j, k, out_sy, out_sz);
+                for (i = 0; i < dimx; i++)
+                    row[i] = (unsigned short) (t_acc[ I2(i, j, dimx) ] / n);
             }
 
-        // Update any progress counter:
-        if (wr_progress != NULL) wr_progress((int) ((double) (pr) / (dimx * dimy * dimz)*100 + 0.5));
+            // Increment progress counter:
+            pr++;
+
+            // Update any progress counter:
+            if (wr_progress != NULL) wr_progress((int) ((double) (pr) / ((double) dimz)*100 + 0.5));
+        }
     }
 
 
@@ -385,7 +724,10 @@ int p3dMeanFilter3D_16(
     }
 
     // Release resources:
-    if (tmp_im != NULL) free(tmp_im);
+    p3dClampTableFree(cx, a_rad);
+    p3dClampTableFree(cy, a_rad);
+    p3dClampTableFree(cz, a_rad);
+    if (ring != NULL) free(ring);
 
     // Return success:
     return P3D_SUCCESS;
@@ -398,9 +740,69 @@ MEM_ERROR:
     }
 
     // Release resources:	
-    if (tmp_im != NULL) free(tmp_im);
+    p3dClampTableFree(cx, a_rad);
+    p3dClampTableFree(cy, a_rad);
+    p3dClampTableFree(cz, a_rad);
+    if (ring != NULL) free(ring);
 
     // Return error:
     return P3D_MEM_ERROR;
 }
 
+int p3dMeanFilter3D_16(
+        unsigned short* in_im,
+        unsigned short* out_im,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int size,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    struct VolumeView in_view, out_view;
+
+    // Whole volumes are processed as views of themselves:
+    p3dVolumeView(&in_view, in_im, dimx, dimy, dimz, 0, 0, 0, dimx, dimy, dimz);
+    p3dVolumeView(&out_view, out_im, dimx, dimy, dimz, 0, 0, 0, dimx, dimy, dimz);
+
+    return p3dMeanFilter3D_16_view(&in_view, &out_view, size, wr_log, wr_progress);
+}
+
+int _p3dMeanFilter3D_8_slab(void* in_im, void* out_im, const int dimx, const int dimy, const int dimz, void* params) {
+    return p3dMeanFilter3D_8((unsigned char*) in_im, (unsigned char*) out_im, dimx, dimy, dimz, *((int*) params), NULL, NULL);
+}
+
+int p3dMeanFilter3D_8_stream(
+        char* in_filename,
+        char* out_filename,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int size,
+        const int slab, // IN: number of slices filtered at once
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    int a_size = size;
+    int err;
+
+    // Start tracking computational time:
+    if (wr_log != NULL) {
+        p3dResetStartTime();
+        wr_log("Pore3D - Applying mean filter (streaming)...");
+        wr_log("\tKernel size: %d.", size);
+        wr_log("\tSlab size: %d.", slab);
+    }
+
+
+    // Process file by slabs having a halo as thick as the kernel radius:
+    err = _p3dSlabFilter(in_filename, out_filename, dimx, dimy, dimz, 1, P3D_TRUE, P3D_FALSE, slab, size / 2,
+            _p3dMeanFilter3D_8_slab, (void*) &a_size, wr_log, wr_progress);
+
+    // Print elapsed time (if required):
+    if ((wr_log != NULL) && (err == P3D_SUCCESS)) {
+        wr_log("Pore3D - Mean filter applied successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
+    }
+
+    return err;
+}
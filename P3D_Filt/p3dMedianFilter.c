@@ -31,39 +31,89 @@
 #include <limits.h>
 #include <omp.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+	#define P3D_HAVE_SSE2
+	#include <emmintrin.h>
+#endif
+
 #include "p3dFilt.h"
 #include "p3dTime.h"
+#include "p3dSlabIO.h"
 
+#include "Common/p3dClampIndex.h"
 
-// NOTE: Different implementation for the 8 bit case and the
-// 16 bit case. 
-
-#define P3DMEDIAN_FILTER_ELEM_SWAP(a,b) { register unsigned short t=(a);(a)=(b);(b)=t; }
-#define P3DMEDIAN_FILTER_MEDIAN(a,n) _p3dMedianFilter_kth_smallest(a,n,((n)/2))
-
-unsigned short _p3dMedianFilter_kth_smallest(unsigned short* a, int n, int k) {
-    register int i, j, l, m;
-    register unsigned short x;
-
-    l = 0;
-    m = n - 1;
-    while (l < m) {
-        x = a[k];
-        i = l;
-        j = m;
-        do {
-            while (a[i] < x) i++;
-            while (x < a[j]) j--;
-            if (i <= j) {
-                P3DMEDIAN_FILTER_ELEM_SWAP(a[i], a[j]);
-                i++;
-                j--;
-            }
-        } while (i <= j);
-        if (j < k) l = i;
-        if (k < i) m = j;
+
+// NOTE: Both cases keep a "sliding" histogram of the kernel along x. The
+// 16 bit case uses two levels: a fine histogram (one bin per value) and a
+// coarse one (one bin per high byte) so that the median is found scanning
+// at most 256 + 256 bins. The 3D 8 bit case also keeps one histogram per
+// column (x) of the kernel, so that sliding along x adds and removes whole
+// column histograms instead of kernel planes (Perreault and Hebert, IEEE 
+// Trans. Image Process. 16(9), 2007).
+
+// Column histograms of the 3D 8 bit case count SIZE * SIZE voxels in
+// unsigned short bins, hence the maximum kernel size:
+#define P3DMEDIAN_MAXSIZE3D_8	255
+
+#define P3DMEDIAN_HIST16_ADD(h,c,v) { (h)[(v)]++; (c)[(v) >> 8]++; }
+#define P3DMEDIAN_HIST16_DEL(h,c,v) { (h)[(v)]--; (c)[(v) >> 8]--; }
+
+unsigned short _p3dMedianFilter_hist16(unsigned int* hist, unsigned int* chist, const unsigned int half) {
+    unsigned int sum = 0;
+    int ct = 0;
+
+    // Coarse scan of high bytes:
+    while ((sum + chist[ct]) <= half)
+        sum += chist[ct++];
+
+    // Fine scan within the selected high byte:
+    ct = ct << 8;
+    while ((sum + hist[ct]) <= half)
+        sum += hist[ct++];
+
+    return (unsigned short) ct;
+}
+
+// Kernel histogram h += add - del (add or del can be NULL), n multiple of 8:
+void _p3dMedianFilter_slide8(unsigned int* h, const unsigned short* add, const unsigned short* del, const int n) {
+    int b;
+#ifdef P3D_HAVE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    __m128i a, d, lo, hi;
+
+    for (b = 0; b < n; b += 8) {
+        a = (add != NULL) ? _mm_loadu_si128((__m128i*) (add + b)) : zero;
+        d = (del != NULL) ? _mm_loadu_si128((__m128i*) (del + b)) : zero;
+
+        lo = _mm_loadu_si128((__m128i*) (h + b));
+        hi = _mm_loadu_si128((__m128i*) (h + b + 4));
+        lo = _mm_sub_epi32(_mm_add_epi32(lo, _mm_unpacklo_epi16(a, zero)), _mm_unpacklo_epi16(d, zero));
+        hi = _mm_sub_epi32(_mm_add_epi32(hi, _mm_unpackhi_epi16(a, zero)), _mm_unpackhi_epi16(d, zero));
+        _mm_storeu_si128((__m128i*) (h + b), lo);
+        _mm_storeu_si128((__m128i*) (h + b + 4), hi);
     }
-    return a[k];
+#else
+    if (add != NULL)
+        for (b = 0; b < n; b++) h[b] += add[b];
+    if (del != NULL)
+        for (b = 0; b < n; b++) h[b] -= del[b];
+#endif
+}
+
+unsigned char _p3dMedianFilter_hist8(unsigned int* hist, unsigned int* chist, const unsigned int half) {
+    unsigned int sum = 0;
+    int ct = 0;
+
+    // Coarse scan (16 bins of 16 values each):
+    while ((sum + chist[ct]) <= half)
+        sum += chist[ct++];
+
+    // Fine scan within the selected coarse bin:
+    ct = ct << 4;
+    while ((sum + hist[ct]) <= half)
+        sum += hist[ct++];
+
+    return (unsigned char) ct;
 }
 
 int p3dMedianFilter2D_8(
@@ -71,17 +121,17 @@ int p3dMedianFilter2D_8(
         unsigned char* out_im,
         const int dimx,
         const int dimy,
-        const int size,
+        const int size, // IN: kernel size (at most 255)
         int (*wr_log)(const char*, ...),
         int (*wr_progress)(const int, ...)
         ) {
-    // Padded input and related dims:
-    unsigned char* tmp_im;
+    // Clamped coordinates for the boundary region:
+    int* cx = NULL;
+    int* cy = NULL;
 
-    int a_dimx, a_dimy;
     int i, j;
     int x, y;
-    int pr = 0;
+    int pr = 0, inner;
 
     // Variables for computing gaussian kernel:
     int a_rad, ct;
@@ -102,27 +152,25 @@ int p3dMedianFilter2D_8(
     // Init variables:
     a_rad = size / 2; // integer division   
 
-    // Compute dimensions of padded REV:
-    a_dimx = dimx + a_rad * 2;
-    a_dimy = dimy + a_rad * 2;
-
-    // Get the replicate padded input:
-    P3D_TRY(tmp_im = (unsigned char*) malloc(a_dimx * a_dimy * sizeof (unsigned char)));
-    P3D_TRY(p3dReplicatePadding2D_8(in_im, tmp_im, dimx, dimy, a_rad, NULL, NULL));
+    // Replicate padding is performed virtually by clamping coordinates:
+    P3D_TRY(cx = p3dClampTable(dimx, a_rad));
+    P3D_TRY(cy = p3dClampTable(dimy, a_rad));
 
 
 
 
     // Volume scanning:
-#pragma omp parallel for private(i, x, y, ct, sum, hist) reduction( + : pr) 
-    for (j = a_rad; j < (a_dimy - a_rad); j++) {
+#pragma omp parallel for private(i, x, y, ct, sum, hist, inner) reduction( + : pr) 
+    for (j = 0; j < dimy; j++) {
+        inner = (j >= a_rad) && (j < (dimy - a_rad));
+
         // Allocate and initialize to zero kernel histogram:
         hist = (unsigned int*) calloc((UCHAR_MAX + 1), sizeof (unsigned int));
 
         // Compute histogram for first step:
         for (y = (j - a_rad); y <= (j + a_rad); y++)
-            for (x = 0; x <= (2 * a_rad); x++) {
-                hist[tmp_im[ I2(x, y, a_dimx) ]] = hist[tmp_im[ I2(x, y, a_dimx) ]] + 1;
+            for (x = -a_rad; x <= a_rad; x++) {
+                hist[in_im[ I2(cx[x], cy[y], dimx) ]]++;
             }
 
 
@@ -134,18 +182,25 @@ int p3dMedianFilter2D_8(
         }
 
         // Set out voxel with the median:
-        out_im[ I2(0, j - a_rad, dimx) ] = ct;
+        out_im[ I2(0, j, dimx) ] = ct;
 
         // Increment progress counter:
         pr++;
 
 
         // Scan along x dimension:
-        for (i = (a_rad + 1); i < (a_dimx - a_rad); i++) {
+        for (i = 1; i < dimx; i++) {
             // Update "sliding" histogram:
-            for (y = (j - a_rad); y <= (j + a_rad); y++) {
-                hist[tmp_im[ I2(i - a_rad - 1, y, a_dimx) ]]--;
-                hist[tmp_im[ I2(i + a_rad, y, a_dimx) ]]++;
+            if (inner && ((i - a_rad - 1) >= 0) && ((i + a_rad) < dimx)) {
+                for (y = (j - a_rad); y <= (j + a_rad); y++) {
+                    hist[in_im[ I2(i - a_rad - 1, y, dimx) ]]--;
+                    hist[in_im[ I2(i + a_rad, y, dimx) ]]++;
+                }
+            } else {
+                for (y = (j - a_rad); y <= (j + a_rad); y++) {
+                    hist[in_im[ I2(cx[i - a_rad - 1], cy[y], dimx) ]]--;
+                    hist[in_im[ I2(cx[i + a_rad], cy[y], dimx) ]]++;
+                }
             }
 
             // Compute median:
@@ -156,7 +211,7 @@ int p3dMedianFilter2D_8(
             }
 
             // Set out voxel with the median:
-            out_im[ I2(i - a_rad, j - a_rad, dimx) ] = ct;
+            out_im[ I2(i, j, dimx) ] = ct;
 
             // Increment progress counter:
             pr++;
@@ -176,7 +231,8 @@ int p3dMedianFilter2D_8(
     }
 
     // Release resources:
-    if (tmp_im != NULL) free(tmp_im);
+    p3dClampTableFree(cx, a_rad);
+    p3dClampTableFree(cy, a_rad);
 
     // Return success:
     return P3D_SUCCESS;
@@ -189,7 +245,8 @@ MEM_ERROR:
     }
 
     // Release resources:	
-    if (tmp_im != NULL) free(tmp_im);
+    p3dClampTableFree(cx, a_rad);
+    p3dClampTableFree(cy, a_rad);
 
     // Return error:
     return P3D_MEM_ERROR;
@@ -200,22 +257,27 @@ int p3dMedianFilter2D_16(
         unsigned short* out_im,
         const int dimx,
         const int dimy,
-        const int size,
+        const int size, // IN: kernel size (at most 255)
         int (*wr_log)(const char*, ...),
         int (*wr_progress)(const int, ...)
         ) {
-    // Padded input and related dims:
-    unsigned short* tmp_im;
+    // Clamped coordinates for the boundary region:
+    int* cx = NULL;
+    int* cy = NULL;
 
-    int a_dimx, a_dimy;
     int i, j;
     int x, y;
+    int pr = 0, inner;
 
-    // Variables for computing gaussian kernel:
-    int a_rad, ct;
+    // Variables for computing kernel:
+    int a_rad;
+    unsigned int half;
 
-    // Temporary array:
-    unsigned short* a_vtmp;
+    // Fine and coarse histograms (one pair for each thread):
+    unsigned int* hist = NULL;
+    unsigned int* chist = NULL;
+    unsigned int* t_hist;
+    unsigned int* t_chist;
 
 
     // Start tracking computational time:
@@ -227,39 +289,71 @@ int p3dMedianFilter2D_16(
 
     // Init variables:
     a_rad = size / 2; // integer division
+    half = (size * size) / 2;
 
-    // Compute dimensions of padded REV:
-    a_dimx = dimx + a_rad * 2;
-    a_dimy = dimy + a_rad * 2;
-
-    // Get the replicate padded input:
-    tmp_im = (unsigned short*) malloc(a_dimx * a_dimy * sizeof (unsigned short));
-    p3dReplicatePadding2D_8(in_im, tmp_im, dimx, dimy, a_rad, NULL, NULL);
+    // Replicate padding is performed virtually by clamping coordinates:
+    P3D_TRY(cx = p3dClampTable(dimx, a_rad));
+    P3D_TRY(cy = p3dClampTable(dimy, a_rad));
 
-    // Allocate temp array:
-    a_vtmp = (unsigned short*) malloc(size * size * sizeof (unsigned short));
+    P3D_TRY(hist = (unsigned int*) calloc((size_t) omp_get_max_threads() * (USHRT_MAX + 1), sizeof (unsigned int)));
+    P3D_TRY(chist = (unsigned int*) calloc((size_t) omp_get_max_threads() * (UCHAR_MAX + 1), sizeof (unsigned int)));
 
     // Volume scanning:
-#pragma omp parallel for private(i, x, y, ct)
-    for (j = a_rad; j < (a_dimy - a_rad); j++)
-        for (i = a_rad; i < (a_dimx - a_rad); i++) {
-            ct = 0;
-            // Fill temporary array:
-            for (y = (j - a_rad); y <= (j + a_rad); y++)
-                for (x = (i - a_rad); x <= (i + a_rad); x++)
-                    a_vtmp[ct++] = tmp_im[ I2(x, y, a_dimx) ];
-
-            out_im[ I2(i - a_rad, j - a_rad, dimx) ] = P3DMEDIAN_FILTER_MEDIAN(a_vtmp, size * size);
+#pragma omp parallel for private(i, x, y, t_hist, t_chist, inner) reduction( + : pr)
+    for (j = 0; j < dimy; j++) {
+        inner = (j >= a_rad) && (j < (dimy - a_rad));
+
+        t_hist = hist + (size_t) omp_get_thread_num() * (USHRT_MAX + 1);
+        t_chist = chist + (size_t) omp_get_thread_num() * (UCHAR_MAX + 1);
+
+        // Compute histogram for first step:
+        for (y = (j - a_rad); y <= (j + a_rad); y++)
+            for (x = -a_rad; x <= a_rad; x++)
+                P3DMEDIAN_HIST16_ADD(t_hist, t_chist, in_im[ I2(cx[x], cy[y], dimx) ]);
+
+        // Set out voxel with the median:
+        out_im[ I2(0, j, dimx) ] = _p3dMedianFilter_hist16(t_hist, t_chist, half);
+        pr++;
+
+        // Scan along x dimension:
+        for (i = 1; i < dimx; i++) {
+            // Update "sliding" histogram:
+            if (inner && ((i - a_rad - 1) >= 0) && ((i + a_rad) < dimx)) {
+                for (y = (j - a_rad); y <= (j + a_rad); y++) {
+                    P3DMEDIAN_HIST16_DEL(t_hist, t_chist, in_im[ I2(i - a_rad - 1, y, dimx) ]);
+                    P3DMEDIAN_HIST16_ADD(t_hist, t_chist, in_im[ I2(i + a_rad, y, dimx) ]);
+                }
+            } else {
+                for (y = (j - a_rad); y <= (j + a_rad); y++) {
+                    P3DMEDIAN_HIST16_DEL(t_hist, t_chist, in_im[ I2(cx[i - a_rad - 1], cy[y], dimx) ]);
+                    P3DMEDIAN_HIST16_ADD(t_hist, t_chist, in_im[ I2(cx[i + a_rad], cy[y], dimx) ]);
+                }
+            }
+
+            // Set out voxel with the median:
+            out_im[ I2(i, j, dimx) ] = _p3dMedianFilter_hist16(t_hist, t_chist, half);
+            pr++;
         }
 
+        // Empty histograms for next row (only the last kernel is counted):
+        for (y = (j - a_rad); y <= (j + a_rad); y++)
+            for (x = (dimx - 1 - a_rad); x <= (dimx - 1 + a_rad); x++)
+                P3DMEDIAN_HIST16_DEL(t_hist, t_chist, in_im[ I2(cx[x], cy[y], dimx) ]);
+
+        // Update any progress bar:
+        if (wr_progress != NULL) wr_progress((int) ((double) (pr) / (dimx * dimy)*100 + 0.5));
+    }
+
     // Print elapsed time (if required):
     if (wr_log != NULL) {
          wr_log("Pore3D - Median filter applied successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
     }
 
     // Free memory:
-    if (tmp_im != NULL) free(tmp_im);
-    if (a_vtmp != NULL) free(a_vtmp);
+    if (hist != NULL) free(hist);
+    if (chist != NULL) free(chist);
+    p3dClampTableFree(cx, a_rad);
+    p3dClampTableFree(cy, a_rad);
 
     // Return OK:
     return P3D_SUCCESS;
@@ -272,36 +366,54 @@ MEM_ERROR:
     }
 
     // Release resources:
-    if (tmp_im != NULL) free(tmp_im);
+    if (hist != NULL) free(hist);
+    if (chist != NULL) free(chist);
+    p3dClampTableFree(cx, a_rad);
+    p3dClampTableFree(cy, a_rad);
 
     // Return error:
     return P3D_MEM_ERROR;
 }
 
-int p3dMedianFilter3D_8(
-        unsigned char* in_im,
-        unsigned char* out_im,
-        const int dimx,
-        const int dimy,
-        const int dimz,
-        const int size,
+int p3dMedianFilter3D_8_view(
+        struct VolumeView* in_view, // IN: input view
+        struct VolumeView* out_view, // OUT: output view (same dimensions)
+        const int size, // IN: kernel size (at most 255)
         int (*wr_log)(const char*, ...),
         int (*wr_progress)(const int, ...)
         ) {
-    // Padded input and related dims:
-    unsigned char* tmp_im;
+    // Input and output are addressed through origin and strides of their views:
+    unsigned char* in_im = (unsigned char*) in_view->base + IV(0, 0, 0, in_view);
+    unsigned char* out_im = (unsigned char*) out_view->base + IV(0, 0, 0, out_view);
+    const size_t in_sy = in_view->stridey, in_sz = in_view->stridez;
+    const size_t out_sy = out_view->stridey, out_sz = out_view->stridez;
+    const int dimx = in_view->dimx, dimy = in_view->dimy, dimz = in_view->dimz;
+
+    // Clamped coordinates for the boundary region:
+    int* cx = NULL;
+    int* cy = NULL;
+    int* cz = NULL;
 
-    int a_dimx, a_dimy, a_dimz;
     int i, j, k;
     int x, y, z;
     int pr = 0;
 
     // Variables for computing kernel:
-    int a_rad, ct;
-
-    // Temporary array:
-    unsigned int* hist;
-    unsigned int sum;
+    int a_rad;
+    unsigned int half;
+    unsigned char* row_del;
+    unsigned char* row_add;
+
+    // Column histograms (fine and coarse) and kernel histograms, one set
+    // for each thread:
+    unsigned short* col = NULL;
+    unsigned short* ccol = NULL;
+    unsigned int* hist = NULL;
+    unsigned int* chist = NULL;
+    unsigned short* t_col;
+    unsigned short* t_ccol;
+    unsigned int* t_hist;
+    unsigned int* t_chist;
     
     /*char auth_code;
 
@@ -312,6 +424,22 @@ int p3dMedianFilter3D_8(
     if (auth_code == '0') goto AUTH_ERROR;*/
 
 
+    // Output view must have the dimensions of the input view:
+    if (p3dVolumeViewSameDims(in_view, out_view) == P3D_FALSE) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - Error: output view should have the same dimensions of the input view.");
+        }
+        return P3D_IO_ERROR;
+    }
+
+    // Check kernel size:
+    if ((size < 1) || (size > P3DMEDIAN_MAXSIZE3D_8)) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - Error: kernel size should be in the range [1, %d].", P3DMEDIAN_MAXSIZE3D_8);
+        }
+        return P3D_IO_ERROR;
+    }
+
     // Start tracking computational time:
     if (wr_log != NULL) {
         p3dResetStartTime();
@@ -322,77 +450,85 @@ int p3dMedianFilter3D_8(
 
     // Init variables:
     a_rad = size / 2; // integer division   
+    half = (size * size * size) / 2;
 
-    // Compute dimensions of padded REV:
-    a_dimx = dimx + a_rad * 2;
-    a_dimy = dimy + a_rad * 2;
-    a_dimz = dimz + a_rad * 2;
-
-    // Get the replicate padded input:
-    P3D_TRY(tmp_im = (unsigned char*) malloc(a_dimx * a_dimy * a_dimz * sizeof (unsigned char)));
-    P3D_TRY(p3dReplicatePadding3D_8(in_im, tmp_im, dimx, dimy, dimz, a_rad, NULL, NULL));
+    // Replicate padding is performed virtually by clamping coordinates:
+    P3D_TRY(cx = p3dClampTable(dimx, a_rad));
+    P3D_TRY(cy = p3dClampTable(dimy, a_rad));
+    P3D_TRY(cz = p3dClampTable(dimz, a_rad));
 
+    P3D_TRY(col = (unsigned short*) malloc((size_t) omp_get_max_threads() * dimx * (UCHAR_MAX + 1) * sizeof (unsigned short)));
+    P3D_TRY(ccol = (unsigned short*) malloc((size_t) omp_get_max_threads() * dimx * 16 * sizeof (unsigned short)));
+    P3D_TRY(hist = (unsigned int*) malloc((size_t) omp_get_max_threads() * (UCHAR_MAX + 1) * sizeof (unsigned int)));
+    P3D_TRY(chist = (unsigned int*) malloc((size_t) omp_get_max_threads() * 16 * sizeof (unsigned int)));
 
 
 
     // Volume scanning:
-#pragma omp parallel for private(i, j, x, y, z, ct, sum, hist) reduction( + : pr)
-    for (k = a_rad; k < (a_dimz - a_rad); k++) {
-        for (j = a_rad; j < (a_dimy - a_rad); j++) {
-            // Allocate and initialize to zero kernel histogram:
-            hist = (unsigned int*) calloc((UCHAR_MAX + 1), sizeof (unsigned int));
+#pragma omp parallel for private(i, j, x, y, z, row_del, row_add, t_col, t_ccol, t_hist, t_chist) reduction( + : pr)
+    for (k = 0; k < dimz; k++) {
+        t_col = col + (size_t) omp_get_thread_num() * dimx * (UCHAR_MAX + 1);
+        t_ccol = ccol + (size_t) omp_get_thread_num() * dimx * 16;
+        t_hist = hist + (size_t) omp_get_thread_num() * (UCHAR_MAX + 1);
+        t_chist = chist + (size_t) omp_get_thread_num() * 16;
+
+        // Column histograms for the first row of the plane:
+        memset(t_col, 0, (size_t) dimx * (UCHAR_MAX + 1) * sizeof (unsigned short));
+        memset(t_ccol, 0, (size_t) dimx * 16 * sizeof (unsigned short));
+
+        for (z = (k - a_rad); z <= (k + a_rad); z++)
+            for (y = -a_rad; y <= a_rad; y++) {
+                row_add = in_im + IS(0, cy[y], cz[z], in_sy, in_sz);
+                for (x = 0; x < dimx; x++) {
+                    t_col[ I2(row_add[x], x, UCHAR_MAX + 1) ]++;
+                    t_ccol[ I2(row_add[x] >> 4, x, 16) ]++;
+                }
+            }
 
-            // Compute histogram for first step:
-            for (z = (k - a_rad); z <= (k + a_rad); z++)
-                for (y = (j - a_rad); y <= (j + a_rad); y++)
-                    for (x = 0; x <= (2 * a_rad); x++) {
-                        hist[tmp_im[ I(x, y, z, a_dimx, a_dimy) ]]++;
+        for (j = 0; j < dimy; j++) {
+            // Move column histograms one row down:
+            if (j > 0) {
+                for (z = (k - a_rad); z <= (k + a_rad); z++) {
+                    row_del = in_im + IS(0, cy[j - a_rad - 1], cz[z], in_sy, in_sz);
+                    row_add = in_im + IS(0, cy[j + a_rad], cz[z], in_sy, in_sz);
+                    for (x = 0; x < dimx; x++) {
+                        t_col[ I2(row_del[x], x, UCHAR_MAX + 1) ]--;
+                        t_ccol[ I2(row_del[x] >> 4, x, 16) ]--;
+                        t_col[ I2(row_add[x], x, UCHAR_MAX + 1) ]++;
+                        t_ccol[ I2(row_add[x] >> 4, x, 16) ]++;
                     }
+                }
+            }
 
-
-            // Compute median:
-            ct = -1;
-            sum = 0;
-            while (sum <= ((size * size * size) / 2)) {
-                sum += hist[++ct];
+            // Compute kernel histogram for first step:
+            memset(t_hist, 0, (UCHAR_MAX + 1) * sizeof (unsigned int));
+            memset(t_chist, 0, 16 * sizeof (unsigned int));
+            for (x = -a_rad; x <= a_rad; x++) {
+                _p3dMedianFilter_slide8(t_hist, t_col + I2(0, cx[x], UCHAR_MAX + 1), NULL, UCHAR_MAX + 1);
+                _p3dMedianFilter_slide8(t_chist, t_ccol + I2(0, cx[x], 16), NULL, 16);
             }
 
             // Set out voxel with the median:
-            out_im[ I(0, j - a_rad, k - a_rad, dimx, dimy) ] = ct;
-
-            // Increase progress counter:
-            pr++;
-
+            out_im[ IS(0, j, k, out_sy, out_sz) ] = _p3dMedianFilter_hist8(t_hist, t_chist, half);
 
             // Scan along x dimension:
-            for (i = (a_rad + 1); i < (a_dimx - a_rad); i++) {
-                // Update "sliding" histogram:
-                for (z = (k - a_rad); z <= (k + a_rad); z++)
-                    for (y = (j - a_rad); y <= (j + a_rad); y++) {
-                        hist[tmp_im[ I(i - a_rad - 1, y, z, a_dimx, a_dimy) ]]--;
-                        hist[tmp_im[ I(i + a_rad, y, z, a_dimx, a_dimy) ]]++;
-                    }
-
-                // Compute median:
-                ct = -1;
-                sum = 0;
-                while (sum <= ((size * size * size) / 2)) {
-                    sum += hist[++ct];
-                }
+            for (i = 1; i < dimx; i++) {
+                // Update "sliding" histogram with whole columns:
+                _p3dMedianFilter_slide8(t_hist, t_col + I2(0, cx[i + a_rad], UCHAR_MAX + 1),
+                        t_col + I2(0, cx[i - a_rad - 1], UCHAR_MAX + 1), UCHAR_MAX + 1);
+                _p3dMedianFilter_slide8(t_chist, t_ccol + I2(0, cx[i + a_rad], 16),
+                        t_ccol + I2(0, cx[i - a_rad - 1], 16), 16);
 
                 // Set out voxel with the median:
-                out_im[ I(i - a_rad, j - a_rad, k - a_rad, dimx, dimy) ] = ct;
-
-                // Increase progress counter:
-                pr++;
+                out_im[ IS(i, j, k, out_sy, out_sz) ] = _p3dMedianFilter_hist8(t_hist, t_chist, half);
             }
 
-            // Clear histogram:
-            if (hist != NULL) free(hist);
+            // Increase progress counter:
+            pr += dimx;
         }
 
         // Update any progress bar:
-        if (wr_progress != NULL) wr_progress((int) ((double) (pr) / (dimx * dimy * dimz)*100 + 0.5));
+        if (wr_progress != NULL) wr_progress((int) ((double) (pr) / ((double) dimx * dimy * dimz)*100 + 0.5));
     }
 
 
@@ -403,7 +539,13 @@ int p3dMedianFilter3D_8(
     }
 
     // Release resources:
-    if (tmp_im != NULL) free(tmp_im);
+    if (col != NULL) free(col);
+    if (ccol != NULL) free(ccol);
+    if (hist != NULL) free(hist);
+    if (chist != NULL) free(chist);
+    p3dClampTableFree(cx, a_rad);
+    p3dClampTableFree(cy, a_rad);
+    p3dClampTableFree(cz, a_rad);
 
     // Return success:
     return P3D_SUCCESS;
@@ -416,7 +558,13 @@ MEM_ERROR:
     }
 
     // Release resources:	
-    if (tmp_im != NULL) free(tmp_im);
+    if (col != NULL) free(col);
+    if (ccol != NULL) free(ccol);
+    if (hist != NULL) free(hist);
+    if (chist != NULL) free(chist);
+    p3dClampTableFree(cx, a_rad);
+    p3dClampTableFree(cy, a_rad);
+    p3dClampTableFree(cz, a_rad);
 
     // Return error:
     return P3D_MEM_ERROR;
@@ -432,9 +580,9 @@ MEM_ERROR:
     
 }
 
-int p3dMedianFilter3D_16(
-        unsigned short* in_im,
-        unsigned short* out_im,
+int p3dMedianFilter3D_8(
+        unsigned char* in_im,
+        unsigned char* out_im,
         const int dimx,
         const int dimy,
         const int dimz,
@@ -442,18 +590,47 @@ int p3dMedianFilter3D_16(
         int (*wr_log)(const char*, ...),
         int (*wr_progress)(const int, ...)
         ) {
-    // Padded input and related dims:
-    unsigned short* tmp_im;
+    struct VolumeView in_view, out_view;
+
+    // Whole volumes are processed as views of themselves:
+    p3dVolumeView(&in_view, in_im, dimx, dimy, dimz, 0, 0, 0, dimx, dimy, dimz);
+    p3dVolumeView(&out_view, out_im, dimx, dimy, dimz, 0, 0, 0, dimx, dimy, dimz);
+
+    return p3dMedianFilter3D_8_view(&in_view, &out_view, size, wr_log, wr_progress);
+}
+
+int p3dMedianFilter3D_16_view(
+        struct VolumeView* in_view, // IN: input view
+        struct VolumeView* out_view, // OUT: output view (same dimensions)
+        const int size,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    // Input and output are addressed through origin and strides of their views:
+    unsigned short* in_im = (unsigned short*) in_view->base + IV(0, 0, 0, in_view);
+    unsigned short* out_im = (unsigned short*) out_view->base + IV(0, 0, 0, out_view);
+    const size_t in_sy = in_view->stridey, in_sz = in_view->stridez;
+    const size_t out_sy = out_view->stridey, out_sz = out_view->stridez;
+    const int dimx = in_view->dimx, dimy = in_view->dimy, dimz = in_view->dimz;
+
+    // Clamped coordinates for the boundary region:
+    int* cx = NULL;
+    int* cy = NULL;
+    int* cz = NULL;
 
-    int a_dimx, a_dimy, a_dimz;
     int i, j, k;
     int x, y, z;
+    int pr = 0, inner;
 
-    // Variables for computing gaussian kernel:
-    int a_rad, ct;
-
-    // Temporary array:
-    unsigned short* a_vtmp;
+    // Variables for computing kernel:
+    int a_rad;
+    unsigned int half;
+
+    // Fine and coarse histograms (one pair for each thread):
+    unsigned int* hist = NULL;
+    unsigned int* chist = NULL;
+    unsigned int* t_hist;
+    unsigned int* t_chist;
     
     /*char auth_code;
 
@@ -464,6 +641,14 @@ int p3dMedianFilter3D_16(
     if (auth_code == '0') goto AUTH_ERROR;*/
 
 
+    // Output view must have the dimensions of the input view:
+    if (p3dVolumeViewSameDims(in_view, out_view) == P3D_FALSE) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - Error: output view should have the same dimensions of the input view.");
+        }
+        return P3D_IO_ERROR;
+    }
+
     // Start tracking computational time:
     if (wr_log != NULL) {
         p3dResetStartTime();
@@ -473,42 +658,79 @@ int p3dMedianFilter3D_16(
 
     // Init variables:
     a_rad = size / 2; // integer division
+    half = (size * size * size) / 2;
 
-    // Compute dimensions of padded REV:
-    a_dimx = dimx + a_rad * 2;
-    a_dimy = dimy + a_rad * 2;
-    a_dimz = dimz + a_rad * 2;
-
-    // Get the replicate padded input:
-    tmp_im = (unsigned short*) malloc(a_dimx * a_dimy * a_dimz * sizeof (unsigned short));
-    p3dReplicatePadding3D_16(in_im, tmp_im, dimx, dimy, dimz, a_rad, NULL, NULL);
+    // Replicate padding is performed virtually by clamping coordinates:
+    P3D_TRY(cx = p3dClampTable(dimx, a_rad));
+    P3D_TRY(cy = p3dClampTable(dimy, a_rad));
+    P3D_TRY(cz = p3dClampTable(dimz, a_rad));
 
-    // Allocate temp array:
-    a_vtmp = (unsigned short*) malloc(size * size * size * sizeof (unsigned short));
+    P3D_TRY(hist = (unsigned int*) calloc((size_t) omp_get_max_threads() * (USHRT_MAX + 1), sizeof (unsigned int)));
+    P3D_TRY(chist = (unsigned int*) calloc((size_t) omp_get_max_threads() * (UCHAR_MAX + 1), sizeof (unsigned int)));
 
     // Volume scanning:
-#pragma omp parallel for private(i, j, x, y, z, ct)
-    for (k = a_rad; k < (a_dimz - a_rad); k++)
-        for (j = a_rad; j < (a_dimy - a_rad); j++)
-            for (i = a_rad; i < (a_dimx - a_rad); i++) {
-                ct = 0;
-                // Fill temporary array:
-                for (z = (k - a_rad); z <= (k + a_rad); z++)
-                    for (y = (j - a_rad); y <= (j + a_rad); y++)
-                        for (x = (i - a_rad); x <= (i + a_rad); x++)
-                            a_vtmp[ct++] = tmp_im[ I(x, y, z, a_dimx, a_dimy) ];
-
-                out_im[ I(i - a_rad, j - a_rad, k - a_rad, dimx, dimy) ] = P3DMEDIAN_FILTER_MEDIAN(a_vtmp, size * size * size);
+#pragma omp parallel for private(i, j, x, y, z, t_hist, t_chist, inner) reduction( + : pr)
+    for (k = 0; k < dimz; k++) {
+        t_hist = hist + (size_t) omp_get_thread_num() * (USHRT_MAX + 1);
+        t_chist = chist + (size_t) omp_get_thread_num() * (UCHAR_MAX + 1);
+
+        for (j = 0; j < dimy; j++) {
+            inner = (j >= a_rad) && (j < (dimy - a_rad)) && (k >= a_rad) && (k < (dimz - a_rad));
+
+            // Compute histogram for first step:
+            for (z = (k - a_rad); z <= (k + a_rad); z++)
+                for (y = (j - a_rad); y <= (j + a_rad); y++)
+                    for (x = -a_rad; x <= a_rad; x++)
+                        P3DMEDIAN_HIST16_ADD(t_hist, t_chist, in_im[ IS(cx[x], cy[y], cz[z], in_sy, in_sz) ]);
+
+            // Set out voxel with the median:
+            out_im[ IS(0, j, k, out_sy, out_sz) ] = _p3dMedianFilter_hist16(t_hist, t_chist, half);
+            pr++;
+
+            // Scan along x dimension:
+            for (i = 1; i < dimx; i++) {
+                // Update "sliding" histogram:
+                if (inner && ((i - a_rad - 1) >= 0) && ((i + a_rad) < dimx)) {
+                    for (z = (k - a_rad); z <= (k + a_rad); z++)
+                        for (y = (j - a_rad); y <= (j + a_rad); y++) {
+                            P3DMEDIAN_HIST16_DEL(t_hist, t_chist, in_im[ IS(i - a_rad - 1, y, z, in_sy, in_sz) ]);
+                            P3DMEDIAN_HIST16_ADD(t_hist, t_chist, in_im[ IS(i + a_rad, y, z, in_sy, in_sz) ]);
+                        }
+                } else {
+                    for (z = (k - a_rad); z <= (k + a_rad); z++)
+                        for (y = (j - a_rad); y <= (j + a_rad); y++) {
+                            P3DMEDIAN_HIST16_DEL(t_hist, t_chist, in_im[ IS(cx[i - a_rad - 1], cy[y], cz[z], in_sy, in_sz) ]);
+                            P3DMEDIAN_HIST16_ADD(t_hist, t_chist, in_im[ IS(cx[i + a_rad], cy[y], cz[z], in_sy, in_sz) ]);
+                        }
+                }
+
+                // Set out voxel with the median:
+                out_im[ IS(i, j, k, out_sy, out_sz) ] = _p3dMedianFilter_hist16(t_hist, t_chist, half);
+                pr++;
             }
 
+            // Empty histograms for next row (only the last kernel is counted):
+            for (z = (k - a_rad); z <= (k + a_rad); z++)
+                for (y = (j - a_rad); y <= (j + a_rad); y++)
+                    for (x = (dimx - 1 - a_rad); x <= (dimx - 1 + a_rad); x++)
+                        P3DMEDIAN_HIST16_DEL(t_hist, t_chist, in_im[ IS(cx[x], cy[y], cz[z], in_sy, in_sz) ]);
+        }
+
+        // Update any progress bar:
+        if (wr_progress != NULL) wr_progress((int) ((double) (pr) / ((double) dimx * dimy * dimz)*100 + 0.5));
+    }
+
     // Print elapsed time (if required):
     if (wr_log != NULL) {
         wr_log("Pore3D - Median filter applied successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
     }
 
     // Free memory:
-    if (tmp_im != NULL) free(tmp_im);
-    if (a_vtmp != NULL) free(a_vtmp);
+    if (hist != NULL) free(hist);
+    if (chist != NULL) free(chist);
+    p3dClampTableFree(cx, a_rad);
+    p3dClampTableFree(cy, a_rad);
+    p3dClampTableFree(cz, a_rad);
 
     // Return OK:
     return P3D_SUCCESS;
@@ -521,7 +743,11 @@ MEM_ERROR:
     }
 
     // Release resources:
-    if (tmp_im != NULL) free(tmp_im);
+    if (hist != NULL) free(hist);
+    if (chist != NULL) free(chist);
+    p3dClampTableFree(cx, a_rad);
+    p3dClampTableFree(cy, a_rad);
+    p3dClampTableFree(cz, a_rad);
 
     // Return error:
     return P3D_MEM_ERROR;
@@ -533,4 +759,62 @@ MEM_ERROR:
     }
 
     return P3D_AUTH_ERROR;*/
-}
\ No newline at end of file
+}
+
+int p3dMedianFilter3D_16(
+        unsigned short* in_im,
+        unsigned short* out_im,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int size,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    struct VolumeView in_view, out_view;
+
+    // Whole volumes are processed as views of themselves:
+    p3dVolumeView(&in_view, in_im, dimx, dimy, dimz, 0, 0, 0, dimx, dimy, dimz);
+    p3dVolumeView(&out_view, out_im, dimx, dimy, dimz, 0, 0, 0, dimx, dimy, dimz);
+
+    return p3dMedianFilter3D_16_view(&in_view, &out_view, size, wr_log, wr_progress);
+}
+
+int _p3dMedianFilter3D_8_slab(void* in_im, void* out_im, const int dimx, const int dimy, const int dimz, void* params) {
+    return p3dMedianFilter3D_8((unsigned char*) in_im, (unsigned char*) out_im, dimx, dimy, dimz, *((int*) params), NULL, NULL);
+}
+
+int p3dMedianFilter3D_8_stream(
+        char* in_filename,
+        char* out_filename,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int size,
+        const int slab, // IN: number of slices filtered at once
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    int a_size = size;
+    int err;
+
+    // Start tracking computational time:
+    if (wr_log != NULL) {
+        p3dResetStartTime();
+        wr_log("Pore3D - Applying median filter (streaming)...");
+        wr_log("\tKernel size: %d.", size);
+        wr_log("\tSlab size: %d.", slab);
+    }
+
+
+    // Process file by slabs having a halo as thick as the kernel radius:
+    err = _p3dSlabFilter(in_filename, out_filename, dimx, dimy, dimz, 1, P3D_TRUE, P3D_FALSE, slab, size / 2,
+            _p3dMedianFilter3D_8_slab, (void*) &a_size, wr_log, wr_progress);
+
+    // Print elapsed time (if required):
+    if ((wr_log != NULL) && (err == P3D_SUCCESS)) {
+        wr_log("Pore3D - Median filter applied successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
+    }
+
+    return err;
+}
@@ -0,0 +1,622 @@
+/***************************************************************************/
+/* (C) 2016 Elettra - Sincrotrone Trieste S.C.p.A.. All rights reserved.   */
+/*                                                                         */
+/*                                                                         */
+/* This file is part of Pore3D, a software library for quantitative        */
+/* analysis of 3D (volume) images.                                         */
+/*                                                                         */
+/* Pore3D is free software: you can redistribute it and/or modify it       */
+/* under the terms of the GNU General Public License as published by the   */
+/* Free Software Foundation, either version 3 of the License, or (at your  */
+/* option) any later version.                                              */
+/*                                                                         */
+/* Pore3D is distributed in the hope that it will be useful, but WITHOUT   */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or   */
+/* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License    */
+/* for more details.                                                       */
+/*                                                                         */
+/* You should have received a copy of the GNU General Public License       */
+/* along with Pore3D. If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                         */
+/***************************************************************************/
+
+
+//
+// Author: Francesco Brun
+// Last modified: October, 16th 2026
+//
+
+// Combined wavelet-Fourier ring remover (B. Munch, P. Trtik, F. Marone and
+// M. Stampanoni, "Stripe and ring artifact removal with combined wavelet-
+// Fourier filtering", Optics Express 17(10), 2009). In the polar image rings
+// are vertical stripes, i.e. their energy is confined in the vertical detail
+// coefficients of a 2D wavelet decomposition. At each level these
+// coefficients are Fourier transformed along the angle and the frequencies
+// close to zero are damped by 1 - exp(-k^2/(2*sigma^2)) before the inverse
+// transforms.
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <limits.h>
+#include <math.h>
+#include <omp.h>
+
+#include "p3dFilt.h"
+#include "p3dTime.h"
+#include "Common/p3dRingRemoverCommon.h"
+#include "Common/p3dFFT.h"
+
+#define P3D_MUNCH_MAX_WAVELET	4
+#define P3D_MUNCH_FFT_BLOCK		64
+
+// Low-pass filters of the Daubechies wavelets db1 (Haar) to db4:
+static const double _p3dDaubechies[P3D_MUNCH_MAX_WAVELET][2 * P3D_MUNCH_MAX_WAVELET] = {
+    { 0.7071067811865476, 0.7071067811865476},
+    { 0.48296291314469025, 0.836516303737469, 0.22414386804185735, -0.12940952255092145},
+    { 0.3326705529509569, 0.8068915093133388, 0.4598775021193313, -0.13501102001039084,
+        -0.08544127388224149, 0.035226291882100656},
+    { 0.23037781330885523, 0.7148465705525415, 0.6308807679295904, -0.02798376941698385,
+        -0.18703481171888114, 0.030841381835986965, 0.032883011666982945, -0.010597401784997278}
+};
+
+struct MunchWorkspace {
+    int wp, np; // Padded polar image (radii x angles)
+    int levels;
+    double h[2 * P3D_MUNCH_MAX_WAVELET]; // Low-pass and high-pass filters
+    double g[2 * P3D_MUNCH_MAX_WAVELET];
+    int len;
+    double sigma;
+    int threads;
+
+    float* im; // Padded polar image
+    float* tmp; // Same size of IM
+    float* re; // FFT planes (vertical details of the first level)
+    float* im_f;
+    float* wre;
+    float* wim;
+};
+
+// Periodized wavelet analysis of the rows (along x) of the W x H top left
+// region of IM: low-pass coefficients go to [0, W/2), details to [W/2, W):
+static void _p3dMunchRowsAnalysis(struct MunchWorkspace* ws, const int w, const int h) {
+    float* row;
+    float* t;
+    double a, d;
+    int i, j, k, s;
+
+#pragma omp parallel for private(i, k, s, a, d, row, t) num_threads(ws->threads)
+    for (j = 0; j < h; j++) {
+        row = ws->im + (size_t) j * ws->wp;
+        t = ws->tmp + (size_t) j * ws->wp;
+
+        for (i = 0; i < (w / 2); i++) {
+            a = 0.0;
+            d = 0.0;
+            for (k = 0; k < ws->len; k++) {
+                s = (2 * i + k) % w;
+                a += ws->h[k] * row[s];
+                d += ws->g[k] * row[s];
+            }
+            t[i] = (float) a;
+            t[w / 2 + i] = (float) d;
+        }
+        memcpy(row, t, w * sizeof (float));
+    }
+}
+
+// Inverse of _p3dMunchRowsAnalysis:
+static void _p3dMunchRowsSynthesis(struct MunchWorkspace* ws, const int w, const int h) {
+    float* row;
+    float* t;
+    double v;
+    int i, j, k, n;
+
+#pragma omp parallel for private(i, k, n, v, row, t) num_threads(ws->threads)
+    for (j = 0; j < h; j++) {
+        row = ws->im + (size_t) j * ws->wp;
+        t = ws->tmp + (size_t) j * ws->wp;
+
+        // Sample I collects the coefficients N such that (2N + K) mod W = I:
+        for (i = 0; i < w; i++) {
+            v = 0.0;
+            for (k = (i % 2); k < ws->len; k += 2) {
+                n = (((i - k) % w + w) % w) / 2;
+                v += ws->h[k] * row[n] + ws->g[k] * row[w / 2 + n];
+            }
+            t[i] = (float) v;
+        }
+        memcpy(row, t, w * sizeof (float));
+    }
+}
+
+// Periodized wavelet analysis of the columns (along y) of the W x H top left
+// region of IM: low-pass coefficients go to rows [0, H/2), details to rows
+// [H/2, H). Whole rows are combined, so that the inner loop is along x:
+static void _p3dMunchColumnsAnalysis(struct MunchWorkspace* ws, const int w, const int h) {
+    const float* src;
+    float* ta;
+    float* td;
+    int i, j, k;
+
+#pragma omp parallel for private(i, k, src, ta, td) num_threads(ws->threads)
+    for (j = 0; j < (h / 2); j++) {
+        ta = ws->tmp + (size_t) j * ws->wp;
+        td = ws->tmp + (size_t) (h / 2 + j) * ws->wp;
+
+        for (i = 0; i < w; i++) {
+            ta[i] = 0.0f;
+            td[i] = 0.0f;
+        }
+        for (k = 0; k < ws->len; k++) {
+            src = ws->im + (size_t) ((2 * j + k) % h) * ws->wp;
+            for (i = 0; i < w; i++) {
+                ta[i] += (float) ws->h[k] * src[i];
+                td[i] += (float) ws->g[k] * src[i];
+            }
+        }
+    }
+
+#pragma omp parallel for num_threads(ws->threads)
+    for (j = 0; j < h; j++)
+        memcpy(ws->im + (size_t) j * ws->wp, ws->tmp + (size_t) j * ws->wp, w * sizeof (float));
+}
+
+// Inverse of _p3dMunchColumnsAnalysis:
+static void _p3dMunchColumnsSynthesis(struct MunchWorkspace* ws, const int w, const int h) {
+    const float* sa;
+    const float* sd;
+    float* t;
+    int i, j, k, n;
+
+#pragma omp parallel for private(i, k, n, sa, sd, t) num_threads(ws->threads)
+    for (j = 0; j < h; j++) {
+        t = ws->tmp + (size_t) j * ws->wp;
+
+        for (i = 0; i < w; i++)
+            t[i] = 0.0f;
+        for (k = (j % 2); k < ws->len; k += 2) {
+            n = (((j - k) % h + h) % h) / 2;
+            sa = ws->im + (size_t) n * ws->wp;
+            sd = ws->im + (size_t) (h / 2 + n) * ws->wp;
+            for (i = 0; i < w; i++)
+                t[i] += (float) ws->h[k] * sa[i] + (float) ws->g[k] * sd[i];
+        }
+    }
+
+#pragma omp parallel for num_threads(ws->threads)
+    for (j = 0; j < h; j++)
+        memcpy(ws->im + (size_t) j * ws->wp, ws->tmp + (size_t) j * ws->wp, w * sizeof (float));
+}
+
+// Damps the rings in the vertical details (columns [W/2, W) and rows
+// [0, H/2) of IM) after the analysis of a W x H region. Since the damping
+// function is real and even, two real columns are filtered at once as the
+// real and imaginary parts of a complex one:
+static void _p3dMunchDamping(struct MunchWorkspace* ws, const int w, const int h) {
+    const int bw = w / 2, bh = h / 2;
+    const int cw = (bw + 1) / 2;
+    float* row;
+    double damp;
+    int i, j, k, x0;
+
+    // Pack the band in the FFT planes:
+#pragma omp parallel for private(i, row) num_threads(ws->threads)
+    for (j = 0; j < bh; j++) {
+        row = ws->im + (size_t) j * ws->wp + bw;
+        for (i = 0; i < cw; i++) {
+            ws->re[ (size_t) j * cw + i ] = row[i];
+            ws->im_f[ (size_t) j * cw + i ] = ((cw + i) < bw) ? row[cw + i] : 0.0f;
+        }
+    }
+
+    // Transform blocks of columns, damp and transform back:
+#pragma omp parallel for private(i, j, k, damp) num_threads(ws->threads) schedule(dynamic)
+    for (x0 = 0; x0 < cw; x0 += P3D_MUNCH_FFT_BLOCK) {
+        const int bx = MIN(P3D_MUNCH_FFT_BLOCK, cw - x0);
+
+        p3dFFTColumns_float(ws->re + x0, ws->im_f + x0, ws->wre + x0, ws->wim + x0, bh, bx, cw, P3D_FALSE);
+
+        for (j = 0; j < bh; j++) {
+            k = MIN(j, bh - j);
+            damp = 1.0 - exp(-((double) k * k) / (2.0 * ws->sigma * ws->sigma));
+            for (i = 0; i < bx; i++) {
+                ws->re[ (size_t) j * cw + x0 + i ] *= (float) damp;
+                ws->im_f[ (size_t) j * cw + x0 + i ] *= (float) damp;
+            }
+        }
+
+        p3dFFTColumns_float(ws->re + x0, ws->im_f + x0, ws->wre + x0, ws->wim + x0, bh, bx, cw, P3D_TRUE);
+    }
+
+    // Unpack:
+#pragma omp parallel for private(i, row) num_threads(ws->threads)
+    for (j = 0; j < bh; j++) {
+        row = ws->im + (size_t) j * ws->wp + bw;
+        for (i = 0; i < cw; i++) {
+            row[i] = ws->re[ (size_t) j * cw + i ];
+            if ((cw + i) < bw)
+                row[cw + i] = ws->im_f[ (size_t) j * cw + i ];
+        }
+    }
+}
+
+// Geometry of the decomposition: the polar image has POLARX radii and it is
+// padded to a multiple of 2^LEVELS, while the number of angles is chosen as
+// a multiple of 2^LEVELS whose quotient is a good FFT size:
+static void _p3dMunchGeometry(const int polarX, const int decNum, int* levels, int* wp, int* np) {
+    int l = 1;
+
+    // Clamp DECNUM to the deepest level having at least two radii (the shift
+    // never reaches the width of an int):
+    while ((l < decNum) && ((polarX >> (l + 1)) >= 2))
+        l++;
+
+    *levels = l;
+    *wp = ((polarX + (1 << l) - 1) >> l) << l;
+    *np = p3dFFTGoodSize((polarX + (1 << l) - 1) >> l) << l;
+}
+
+static int _p3dMunchEtAlRingRemover2D(
+        void* in_im,
+        void* out_im,
+        const int bytes,
+        const int decNum,
+        const double sigma,
+        const int wavelet,
+        const struct PolarPlan* plan,
+        const int threads
+        ) {
+    struct MunchWorkspace ws;
+    void* p_im = NULL;
+    double v;
+    int i, j, k, l, w, h, wr;
+    int cw;
+
+    memset(&ws, 0, sizeof (struct MunchWorkspace));
+
+    wr = plan->polarX;
+    _p3dMunchGeometry(wr, decNum, &(ws.levels), &(ws.wp), &(ws.np));
+    ws.sigma = sigma;
+    ws.threads = (threads > 0) ? threads : omp_get_max_threads();
+
+    // Quadrature mirror filters:
+    ws.len = 2 * MIN(MAX(wavelet, 1), P3D_MUNCH_MAX_WAVELET);
+    for (k = 0; k < ws.len; k++) {
+        ws.h[k] = _p3dDaubechies[ws.len / 2 - 1][k];
+        ws.g[k] = ((k % 2) ? -1.0 : 1.0) * _p3dDaubechies[ws.len / 2 - 1][ws.len - 1 - k];
+    }
+
+    // Allocate the workspace (FFT planes sized for the first level):
+    cw = (ws.wp / 2 + 1) / 2;
+    P3D_TRY(p_im = malloc((size_t) wr * ws.np * bytes));
+    P3D_TRY(ws.im = (float*) malloc((size_t) ws.wp * ws.np * sizeof (float)));
+    P3D_TRY(ws.tmp = (float*) malloc((size_t) ws.wp * ws.np * sizeof (float)));
+    P3D_TRY(ws.re = (float*) malloc((size_t) cw * (ws.np / 2) * sizeof (float)));
+    P3D_TRY(ws.im_f = (float*) malloc((size_t) cw * (ws.np / 2) * sizeof (float)));
+    P3D_TRY(ws.wre = (float*) malloc((size_t) cw * (ws.np / 2) * sizeof (float)));
+    P3D_TRY(ws.wim = (float*) malloc((size_t) cw * (ws.np / 2) * sizeof (float)));
+
+    // Polar image (radii beyond the last one are mirrored):
+    if (bytes == 2)
+        p3dCartesian2polarPlan_16(plan, (unsigned short*) in_im, (unsigned short*) p_im);
+    else
+        p3dCartesian2polarPlan_8(plan, (unsigned char*) in_im, (unsigned char*) p_im);
+
+#pragma omp parallel for private(i, k) num_threads(ws.threads)
+    for (j = 0; j < ws.np; j++) {
+        for (i = 0; i < ws.wp; i++) {
+            k = (i < wr) ? i : MAX(2 * (wr - 1) - i, 0);
+            ws.im[ (size_t) j * ws.wp + i ] = (bytes == 2) ?
+                    ((unsigned short*) p_im)[ I2(k, j, wr) ] : ((unsigned char*) p_im)[ I2(k, j, wr) ];
+        }
+    }
+
+    // Decomposition with damping of the vertical details at each level:
+    for (l = 0; l < ws.levels; l++) {
+        w = ws.wp >> l;
+        h = ws.np >> l;
+
+        _p3dMunchRowsAnalysis(&ws, w, h);
+        _p3dMunchColumnsAnalysis(&ws, w, h);
+        _p3dMunchDamping(&ws, w, h);
+    }
+
+    // Reconstruction:
+    for (l = ws.levels - 1; l >= 0; l--) {
+        w = ws.wp >> l;
+        h = ws.np >> l;
+
+        _p3dMunchColumnsSynthesis(&ws, w, h);
+        _p3dMunchRowsSynthesis(&ws, w, h);
+    }
+
+    // Back to integers and to cartesian coordinates:
+#pragma omp parallel for private(i, v) num_threads(ws.threads)
+    for (j = 0; j < ws.np; j++) {
+        for (i = 0; i < wr; i++) {
+            v = ws.im[ (size_t) j * ws.wp + i ] + 0.5;
+            if (bytes == 2)
+                ((unsigned short*) p_im)[ I2(i, j, wr) ] = (unsigned short) ((v < 0.0) ? 0.0 : ((v >= USHRT_MAX) ? USHRT_MAX : v));
+            else
+                ((unsigned char*) p_im)[ I2(i, j, wr) ] = (unsigned char) ((v < 0.0) ? 0.0 : ((v >= UCHAR_MAX) ? UCHAR_MAX : v));
+        }
+    }
+
+    if (bytes == 2)
+        p3dPolar2cartesianPlan_16(plan, (unsigned short*) p_im, (unsigned short*) out_im);
+    else
+        p3dPolar2cartesianPlan_8(plan, (unsigned char*) p_im, (unsigned char*) out_im);
+
+    // Release resources:
+    free(p_im);
+    free(ws.im);
+    free(ws.tmp);
+    free(ws.re);
+    free(ws.im_f);
+    free(ws.wre);
+    free(ws.wim);
+
+    return P3D_SUCCESS;
+
+MEM_ERROR:
+
+    // Release resources:
+    if (p_im != NULL) free(p_im);
+    if (ws.im != NULL) free(ws.im);
+    if (ws.tmp != NULL) free(ws.tmp);
+    if (ws.re != NULL) free(ws.re);
+    if (ws.im_f != NULL) free(ws.im_f);
+    if (ws.wre != NULL) free(ws.wre);
+    if (ws.wim != NULL) free(ws.wim);
+
+    return P3D_MEM_ERROR;
+}
+
+// Creates the plan having the number of angles required by the decomposition:
+static int _p3dMunchEtAlPlanCreate(struct PolarPlan** plan, const int dimx, const int dimy,
+        const double centerX, const double centerY, const int decNum, const double precision) {
+    int levels, wp, np;
+
+    _p3dMunchGeometry(_p3dPolarPlanRadii(dimx, dimy, centerX, centerY, precision), decNum, &levels, &wp, &np);
+
+    return _p3dPolarPlanCreate(plan, dimx, dimy, centerX, centerY, precision, np);
+}
+
+static void _p3dMunchEtAlLog(
+        const double centerX,
+        const double centerY,
+        const int decNum,
+        const double sigma,
+        const int wavelet,
+        const double precision,
+        int (*wr_log)(const char*, ...)
+        ) {
+    wr_log("\tCenter of rings: [%0.1f,%0.1f].", centerX, centerY);
+    wr_log("\tDecomposition levels: %d.", decNum);
+    wr_log("\tDamping sigma: %0.3f.", sigma);
+    wr_log("\tWavelet: Daubechies %d.", MIN(MAX(wavelet, 1), P3D_MUNCH_MAX_WAVELET));
+    wr_log("\tPolar/Cartesian precision: %0.3f.", precision);
+}
+
+static int _p3dMunchEtAlRingRemover2D_in_core(
+        void* in_im,
+        void* out_im,
+        const int dimx,
+        const int dimy,
+        const int bytes,
+        const double centerX,
+        const double centerY,
+        const int decNum,
+        const double sigma,
+        const int wavelet,
+        const double precision,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...),
+        int threads
+        ) {
+    struct PolarPlan* plan = NULL;
+
+    // Damping must have a positive width:
+    if (sigma <= 0.0) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - Error: damping sigma should be greater than 0.");
+        }
+        return P3D_IO_ERROR;
+    }
+
+    // Start tracking computational time:
+    if (wr_log != NULL) {
+        p3dResetStartTime();
+        wr_log("Pore3D - Applying Munch et al. ring remover...");
+        _p3dMunchEtAlLog(centerX, centerY, decNum, sigma, wavelet, precision, wr_log);
+    }
+
+    P3D_TRY(_p3dMunchEtAlPlanCreate(&plan, dimx, dimy, centerX, centerY, decNum, precision));
+    P3D_TRY(_p3dMunchEtAlRingRemover2D(in_im, out_im, bytes, decNum, sigma, wavelet, plan, threads));
+
+    // Print elapsed time (if required):
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Munch et al. ring remover applied successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
+    }
+
+    // Release resources:
+    p3dPolarPlanFree(plan);
+
+    return P3D_SUCCESS;
+
+MEM_ERROR:
+
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Not enough (contiguous) memory. Program will exit.");
+    }
+
+    // Release resources:
+    p3dPolarPlanFree(plan);
+
+    return P3D_MEM_ERROR;
+}
+
+int p3dMunchEtAlRingRemover2D_8(
+        unsigned char* in_im,
+        unsigned char* out_im,
+        const int dimx,
+        const int dimy,
+        const double centerX,
+        const double centerY,
+        const int decNum, // IN: number of wavelet decomposition levels
+        const double sigma, // IN: width of the damping in the Fourier domain
+        const int wavelet, // IN: order of the Daubechies wavelet (1 to 4)
+        const double precision,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...),
+        int threads // IN: number of threads (all processors if not positive)
+        ) {
+    return _p3dMunchEtAlRingRemover2D_in_core((void*) in_im, (void*) out_im, dimx, dimy, 1, centerX, centerY,
+            decNum, sigma, wavelet, precision, wr_log, wr_progress, threads);
+}
+
+int p3dMunchEtAlRingRemover2D_16(
+        unsigned short* in_im,
+        unsigned short* out_im,
+        const int dimx,
+        const int dimy,
+        const double centerX,
+        const double centerY,
+        const int decNum, // IN: number of wavelet decomposition levels
+        const double sigma, // IN: width of the damping in the Fourier domain
+        const int wavelet, // IN: order of the Daubechies wavelet (1 to 4)
+        const double precision,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...),
+        int threads // IN: number of threads (all processors if not positive)
+        ) {
+    return _p3dMunchEtAlRingRemover2D_in_core((void*) in_im, (void*) out_im, dimx, dimy, 2, centerX, centerY,
+            decNum, sigma, wavelet, precision, wr_log, wr_progress, threads);
+}
+
+struct MunchEtAlParams {
+    int bytes;
+    int decNum;
+    double sigma;
+    int wavelet;
+    struct PolarPlan* plan;
+};
+
+// Each slice is corrected by a single worker:
+static int _p3dMunchEtAlRingRemover2D_slice(void* in_im, void* out_im, const int dimx, const int dimy, void* params) {
+    struct MunchEtAlParams* p = (struct MunchEtAlParams*) params;
+
+    return _p3dMunchEtAlRingRemover2D(in_im, out_im, p->bytes, p->decNum, p->sigma, p->wavelet, p->plan, 1);
+}
+
+// Batch version: each slice of the RAW volume IN_FILENAME is corrected and
+// written to OUT_FILENAME without loading the whole volume. Slices are
+// corrected in parallel and they all share the same resampling plan.
+
+static int _p3dMunchEtAlRingRemover2D_batch(
+        char* in_filename,
+        char* out_filename,
+        const int dimx,
+        const int dimy,
+        const int bytes,
+        const double centerX,
+        const double centerY,
+        const int decNum,
+        const double sigma,
+        const int wavelet,
+        const double precision,
+        const int flagLittle,
+        const int flagSigned,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...),
+        int threads
+        ) {
+    struct MunchEtAlParams p;
+    int err;
+
+    // Damping must have a positive width:
+    if (sigma <= 0.0) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - Error: damping sigma should be greater than 0.");
+        }
+        return P3D_IO_ERROR;
+    }
+
+    p.bytes = bytes;
+    p.decNum = decNum;
+    p.sigma = sigma;
+    p.wavelet = wavelet;
+    p.plan = NULL;
+
+    // Start tracking computational time:
+    if (wr_log != NULL) {
+        p3dResetStartTime();
+        wr_log("Pore3D - Applying Munch et al. ring remover (batch)...");
+        _p3dMunchEtAlLog(centerX, centerY, decNum, sigma, wavelet, precision, wr_log);
+    }
+
+    // The plan is created once for all the slices:
+    P3D_TRY(_p3dMunchEtAlPlanCreate(&(p.plan), dimx, dimy, centerX, centerY, decNum, precision));
+
+    err = _p3dRingRemoverBatch(in_filename, out_filename, dimx, dimy, bytes, flagLittle, flagSigned, threads,
+            _p3dMunchEtAlRingRemover2D_slice, (void*) &p, wr_log, wr_progress);
+
+    // Print elapsed time (if required):
+    if ((wr_log != NULL) && (err == P3D_SUCCESS)) {
+        wr_log("Pore3D - Munch et al. ring remover applied successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
+    }
+
+    // Release resources:
+    p3dPolarPlanFree(p.plan);
+
+    return err;
+
+MEM_ERROR:
+
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Not enough (contiguous) memory. Program will exit.");
+    }
+
+    return P3D_MEM_ERROR;
+}
+
+int p3dMunchEtAlRingRemover2D_8_batch(
+        char* in_filename,
+        char* out_filename,
+        const int dimx,
+        const int dimy,
+        const double centerX,
+        const double centerY,
+        const int decNum,
+        const double sigma,
+        const int wavelet,
+        const double precision,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...),
+        int threads // IN: slices corrected concurrently (all processors if not positive)
+        ) {
+    return _p3dMunchEtAlRingRemover2D_batch(in_filename, out_filename, dimx, dimy, 1, centerX, centerY,
+            decNum, sigma, wavelet, precision, P3D_TRUE, P3D_FALSE, wr_log, wr_progress, threads);
+}
+
+int p3dMunchEtAlRingRemover2D_16_batch(
+        char* in_filename,
+        char* out_filename,
+        const int dimx,
+        const int dimy,
+        const double centerX,
+        const double centerY,
+        const int decNum,
+        const double sigma,
+        const int wavelet,
+        const double precision,
+        const int flagLittle,
+        const int flagSigned,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...),
+        int threads // IN: slices corrected concurrently (all processors if not positive)
+        ) {
+    return _p3dMunchEtAlRingRemover2D_batch(in_filename, out_filename, dimx, dimy, 2, centerX, centerY,
+            decNum, sigma, wavelet, precision, flagLittle, flagSigned, wr_log, wr_progress, threads);
+}
@@ -84,7 +84,7 @@ int p3dOtsuThresholding_8(
     int i, j, k, m;
     double y, z;
     double ut, vt;
-    int ct;
+    long long ct;
 
     /*char auth_code;
         
@@ -105,12 +105,12 @@ int p3dOtsuThresholding_8(
     P3D_TRY(prob = (double*) calloc((UCHAR_MAX + 1), sizeof (double)));
 
     /* Compute image histogram: */
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         prob[in_im[ ct ]] = prob[in_im[ ct ]] + 1.0;
 
     /* Compute probabilities: */
     for (ct = 0; ct <= UCHAR_MAX; ct++)
-        prob[ct] = prob[ct] / (double) (dimx * dimy * dimz);
+        prob[ct] = prob[ct] / ((double) dimx * dimy * dimz);
 
     /* Compute global mean: */
     ut = _p3dOtsuThresholding_u(prob, UCHAR_MAX);
@@ -145,7 +145,7 @@ int p3dOtsuThresholding_8(
     *thresh = (unsigned char) m;
 
     #pragma omp parallel for
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         out_im[ ct ] = (in_im[ ct ] > (*thresh)) ? OBJECT : BACKGROUND;
 
     // Print elapsed time (if required):
@@ -198,7 +198,7 @@ int p3dOtsuThresholding_16(
     int i, j, k, m;
     double y, z;
     double ut, vt;
-    int ct;
+    long long ct;
 
     /*char auth_code;
         
@@ -219,12 +219,12 @@ int p3dOtsuThresholding_16(
     P3D_TRY(prob = (double*) calloc((USHRT_MAX + 1), sizeof (double)));
 
     /* Compute image histogram: */
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         prob[in_im[ ct ]] = prob[in_im[ ct ]] + 1.0;
 
     /* Compute probabilities: */
     for (ct = 0; ct <= USHRT_MAX; ct++)
-        prob[ct] = prob[ct] / (double) (dimx * dimy * dimz);
+        prob[ct] = prob[ct] / ((double) dimx * dimy * dimz);
 
     /* Compute global mean: */
     ut = _p3dOtsuThresholding_u(prob, USHRT_MAX);
@@ -259,7 +259,7 @@ int p3dOtsuThresholding_16(
     *thresh = (unsigned short) m;
 
     #pragma omp parallel for
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         out_im[ ct ] = (in_im[ ct ] > (*thresh)) ? OBJECT : BACKGROUND;
 
     // Print elapsed time (if required):
@@ -110,7 +110,7 @@ int p3dZeroPadding3D_8(
     a_dimz = dimz + size * 2;
 
     // Set to zero all values:
-    memset(out_rev, 0, a_dimx * a_dimy * a_dimz * sizeof (unsigned char));
+    memset(out_rev, 0, (size_t) a_dimx * a_dimy * a_dimz * sizeof (unsigned char));
 
 
     // Copy original (internal) values:
@@ -143,7 +143,7 @@ int p3dZeroPadding3D_16(
     a_dimz = dimz + size * 2;
 
     // Set to zero all values:
-    memset(out_rev, 0, a_dimx * a_dimy * a_dimz * sizeof (unsigned short));
+    memset(out_rev, 0, (size_t) a_dimx * a_dimy * a_dimz * sizeof (unsigned short));
 
 
     // Copy original (internal) values:
@@ -536,7 +536,7 @@ int _p3dZeroPadding3D_float(
     a_dimz = dimz + size * 2;
 
     // Set to zero all values:
-    memset(out_rev, 0, a_dimx * a_dimy * a_dimz * sizeof (float));
+    memset(out_rev, 0, (size_t) a_dimx * a_dimy * a_dimz * sizeof (float));
 
 
     // Copy original (internal) values:
@@ -573,11 +573,12 @@ int _p3dReplicatePadding3D_float(
     _p3dZeroPadding3D_float(in_rev, out_rev, dimx, dimy, dimz, size);
 
 
-    // Replicate border values:
-#pragma omp parallel for private(i, j, k)
+    // Replicate border values. Each layer is copied from the inner one, so
+    // layers are processed in order and the faces of a layer in parallel:
     for (ct = size; ct > 0; ct--) {
         // Faces:
 
+#pragma omp parallel for private(j)
         for (i = ct; i < (a_dimx - ct); i++)
             for (j = ct; j < (a_dimy - ct); j++) {
                 out_rev[ I(i, j, ct - 1, a_dimx, a_dimy) ] =
@@ -586,6 +587,7 @@ int _p3dReplicatePadding3D_float(
                         out_rev[ I(i, j, a_dimz - 1 - ct, a_dimx, a_dimy) ];
             }
 
+#pragma omp parallel for private(k)
         for (j = ct; j < (a_dimy - ct); j++)
             for (k = ct; k < (a_dimz - ct); k++) {
                 out_rev[ I(ct - 1, j, k, a_dimx, a_dimy) ] =
@@ -594,6 +596,7 @@ int _p3dReplicatePadding3D_float(
                         out_rev[ I(a_dimx - 1 - ct, j, k, a_dimx, a_dimy) ];
             }
 
+#pragma omp parallel for private(k)
         for (i = ct; i < (a_dimx - ct); i++)
             for (k = ct; k < (a_dimz - ct); k++) {
                 out_rev[ I(i, ct - 1, k, a_dimx, a_dimy) ] =
@@ -688,7 +691,7 @@ int _p3dZeroPadding3D_uchar2float(
     a_dimz = dimz + size * 2;
 
     // Set to zero all values:
-    memset(out_rev, 0, a_dimx * a_dimy * a_dimz * sizeof (float));
+    memset(out_rev, 0, (size_t) a_dimx * a_dimy * a_dimz * sizeof (float));
 
 
     // Copy original (internal) values:
@@ -725,11 +728,12 @@ int _p3dReplicatePadding3D_uchar2float(
     _p3dZeroPadding3D_uchar2float(in_rev, out_rev, dimx, dimy, dimz, size);
 
 
-    // Replicate border values:
-#pragma omp parallel for private(i, j, k)
+    // Replicate border values. Each layer is copied from the inner one, so
+    // layers are processed in order and the faces of a layer in parallel:
     for (ct = size; ct > 0; ct--) {
         // Faces:
 
+#pragma omp parallel for private(j)
         for (i = ct; i < (a_dimx - ct); i++)
             for (j = ct; j < (a_dimy - ct); j++) {
                 out_rev[ I(i, j, ct - 1, a_dimx, a_dimy) ] =
@@ -738,6 +742,7 @@ int _p3dReplicatePadding3D_uchar2float(
                         (float) out_rev[ I(i, j, a_dimz - 1 - ct, a_dimx, a_dimy) ];
             }
 
+#pragma omp parallel for private(k)
         for (j = ct; j < (a_dimy - ct); j++)
             for (k = ct; k < (a_dimz - ct); k++) {
                 out_rev[ I(ct - 1, j, k, a_dimx, a_dimy) ] =
@@ -746,6 +751,7 @@ int _p3dReplicatePadding3D_uchar2float(
                         (float) out_rev[ I(a_dimx - 1 - ct, j, k, a_dimx, a_dimy) ];
             }
 
+#pragma omp parallel for private(k)
         for (i = ct; i < (a_dimx - ct); i++)
             for (k = ct; k < (a_dimz - ct); k++) {
                 out_rev[ I(i, ct - 1, k, a_dimx, a_dimy) ] =
@@ -840,7 +846,7 @@ int _p3dZeroPadding3D_ushort2float(
     a_dimz = dimz + size * 2;
 
     // Set to zero all values:
-    memset(out_rev, 0, a_dimx * a_dimy * a_dimz * sizeof (float));
+    memset(out_rev, 0, (size_t) a_dimx * a_dimy * a_dimz * sizeof (float));
 
 
     // Copy original (internal) values:
@@ -877,11 +883,12 @@ int _p3dReplicatePadding3D_ushort2float(
     _p3dZeroPadding3D_ushort2float(in_rev, out_rev, dimx, dimy, dimz, size);
 
 
-    // Replicate border values:
-#pragma omp parallel for private(i, j, k)
+    // Replicate border values. Each layer is copied from the inner one, so
+    // layers are processed in order and the faces of a layer in parallel:
     for (ct = size; ct > 0; ct--) {
         // Faces:
 
+#pragma omp parallel for private(j)
         for (i = ct; i < (a_dimx - ct); i++)
             for (j = ct; j < (a_dimy - ct); j++) {
                 out_rev[ I(i, j, ct - 1, a_dimx, a_dimy) ] =
@@ -890,6 +897,7 @@ int _p3dReplicatePadding3D_ushort2float(
                         (float) out_rev[ I(i, j, a_dimz - 1 - ct, a_dimx, a_dimy) ];
             }
 
+#pragma omp parallel for private(k)
         for (j = ct; j < (a_dimy - ct); j++)
             for (k = ct; k < (a_dimz - ct); k++) {
                 out_rev[ I(ct - 1, j, k, a_dimx, a_dimy) ] =
@@ -898,6 +906,7 @@ int _p3dReplicatePadding3D_ushort2float(
                         (float) out_rev[ I(a_dimx - 1 - ct, j, k, a_dimx, a_dimy) ];
             }
 
+#pragma omp parallel for private(k)
         for (i = ct; i < (a_dimx - ct); i++)
             for (k = ct; k < (a_dimz - ct); k++) {
                 out_rev[ I(i, ct - 1, k, a_dimx, a_dimy) ] =
@@ -95,7 +95,8 @@ int p3dPunThresholding_8(
     double* prob;
     double *Ht, *Pt, *F;
     double HT, x, y, z, to, from;
-    int i, ct, t;
+    int i, t;
+    long long ct;
 
     /*char auth_code;
 
@@ -119,12 +120,12 @@ int p3dPunThresholding_8(
     prob = (double*) calloc((UCHAR_MAX + 1), sizeof (double));
 
     /* Compute image histogram: */
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         prob[in_im[ ct ]] = prob[in_im[ ct ]] + 1.0;
 
     /* Compute probabilities: */
     for (ct = 0; ct <= UCHAR_MAX; ct++)
-        prob[ct] = prob[ct] / (double) (dimx * dimy * dimz);
+        prob[ct] = prob[ct] / ((double) dimx * dimy * dimz);
 
     /* Compute the factors */
     HT = Ht[0] = _p3dPunThresholding_entropy(prob, 0);
@@ -155,7 +156,7 @@ int p3dPunThresholding_8(
 
 
 #pragma omp parallel for
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         out_im[ ct ] = (in_im[ ct ] > (*thresh)) ? OBJECT : BACKGROUND;
 
     // Print elapsed time (if required):
@@ -210,7 +211,8 @@ int p3dPunThresholding_16(
     double* prob;
     double *Ht, *Pt, *F;
     double HT, x, y, z, to, from;
-    int i, ct, t;
+    int i, t;
+    long long ct;
 
     /*char auth_code;
 
@@ -234,12 +236,12 @@ int p3dPunThresholding_16(
     prob = (double*) calloc((USHRT_MAX + 1), sizeof (double));
 
     /* Compute image histogram: */
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         prob[in_im[ ct ]] = prob[in_im[ ct ]] + 1.0;
 
     /* Compute probabilities: */
     for (ct = 0; ct <= USHRT_MAX; ct++)
-        prob[ct] = prob[ct] / (double) (dimx * dimy * dimz);
+        prob[ct] = prob[ct] / ((double) dimx * dimy * dimz);
 
     /* Compute the factors */
     HT = Ht[0] = _p3dPunThresholding_entropy(prob, 0);
@@ -270,7 +272,7 @@ int p3dPunThresholding_16(
 
 
 #pragma omp parallel for
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         out_im[ ct ] = (in_im[ ct ] > (*thresh)) ? OBJECT : BACKGROUND;
 
     // Print elapsed time (if required):
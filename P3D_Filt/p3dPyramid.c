@@ -0,0 +1,697 @@
+/***************************************************************************/
+/* (C) 2016 Elettra - Sincrotrone Trieste S.C.p.A.. All rights reserved.   */
+/*                                                                         */
+/*                                                                         */
+/* This file is part of Pore3D, a software library for quantitative        */
+/* analysis of 3D (volume) images.                                         */
+/*                                                                         */
+/* Pore3D is free software: you can redistribute it and/or modify it       */
+/* under the terms of the GNU General Public License as published by the   */
+/* Free Software Foundation, either version 3 of the License, or (at your  */
+/* option) any later version.                                              */
+/*                                                                         */
+/* Pore3D is distributed in the hope that it will be useful, but WITHOUT   */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or   */
+/* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License    */
+/* for more details.                                                       */
+/*                                                                         */
+/* You should have received a copy of the GNU General Public License       */
+/* along with Pore3D. If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                         */
+/***************************************************************************/
+
+//
+// Author: Francesco Brun
+// Last modified: October, 16th 2026
+//
+
+// Multi-resolution pyramids. Each level halves the previous one along x, y
+// and z (level L has dimensions ceil(dim / 2^L)), so that parameters of an
+// analysis can be tuned on a coarse level before running it at full
+// resolution. Grey-level data are averaged (rounded mean), binary data are
+// reduced either by majority (a coarse voxel is OBJECT if at least half of
+// its fine voxels are OBJECT) or by OR (OBJECT if any of them is OBJECT,
+// which preserves thin structures). Along odd dimensions the last coarse
+// voxel reduces only the available fine voxels.
+//
+// Pyramid levels are stored as RAW files next to the full resolution one:
+// level L of "volume.raw" is "volume_<2^L>x.raw".
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <limits.h>
+#include <omp.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+	#define P3D_HAVE_SSE2
+	#include <emmintrin.h>
+#endif
+
+#include "p3dFilt.h"
+#include "p3dTime.h"
+
+#define P3D_PYRAMID_MAXLEVEL	8
+
+// Scalar reduction of the (up to) 2x2x2 block with origin (2i,2j,2k):
+static unsigned char _p3dHalveBlock_8(unsigned char* in_im, const int i, const int j, const int k,
+        const int dimx, const int dimy, const int dimz, const int mode) {
+    int x, y, z, ct = 0, obj = 0;
+    unsigned int sum = 0;
+    unsigned char v;
+
+    for (z = 2 * k; z < MIN(2 * k + 2, dimz); z++)
+        for (y = 2 * j; y < MIN(2 * j + 2, dimy); y++)
+            for (x = 2 * i; x < MIN(2 * i + 2, dimx); x++) {
+                v = in_im[ I(x, y, z, dimx, dimy) ];
+                sum += v;
+                obj += (v != BACKGROUND) ? 1 : 0;
+                ct++;
+            }
+
+    if (mode == P3D_PYRAMID_OR)
+        return (obj > 0) ? OBJECT : BACKGROUND;
+    if (mode == P3D_PYRAMID_MAJORITY)
+        return ((2 * obj) >= ct) ? OBJECT : BACKGROUND;
+
+    return (unsigned char) ((sum + ct / 2) / ct);
+}
+
+static unsigned short _p3dHalveBlock_16(unsigned short* in_im, const int i, const int j, const int k,
+        const int dimx, const int dimy, const int dimz) {
+    int x, y, z, ct = 0;
+    unsigned int sum = 0;
+
+    for (z = 2 * k; z < MIN(2 * k + 2, dimz); z++)
+        for (y = 2 * j; y < MIN(2 * j + 2, dimy); y++)
+            for (x = 2 * i; x < MIN(2 * i + 2, dimx); x++) {
+                sum += in_im[ I(x, y, z, dimx, dimy) ];
+                ct++;
+            }
+
+    return (unsigned short) ((sum + ct / 2) / ct);
+}
+
+// Halves an 8-bit volume. OUT_IM has dimensions ((dimx+1)/2, (dimy+1)/2,
+// (dimz+1)/2). Complete 2x2x2 blocks are reduced 8 at a time with SSE2.
+void _p3dHalve3D_8(unsigned char* in_im, unsigned char* out_im, const int dimx, const int dimy, const int dimz, const int mode) {
+    const int o_dimx = (dimx + 1) / 2;
+    const int o_dimy = (dimy + 1) / 2;
+    const int o_dimz = (dimz + 1) / 2;
+    unsigned char *r0, *r1, *r2, *r3, *o;
+    int i, j, k;
+
+#ifdef P3D_HAVE_SSE2
+    const __m128i lo_mask = _mm_set1_epi16(0x00FF);
+    const __m128i one8 = _mm_set1_epi8(1);
+    const __m128i four = _mm_set1_epi16(4);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i a, b, c, d, s;
+#endif
+
+#ifdef P3D_HAVE_SSE2
+#pragma omp parallel for private(i, j, r0, r1, r2, r3, o, a, b, c, d, s)
+#else
+#pragma omp parallel for private(i, j, r0, r1, r2, r3, o)
+#endif
+    for (k = 0; k < o_dimz; k++) {
+        for (j = 0; j < o_dimy; j++) {
+            i = 0;
+            o = out_im + I(0, j, k, o_dimx, o_dimy);
+
+            if (((2 * j + 1) < dimy) && ((2 * k + 1) < dimz)) {
+                // The four fine rows of the block row:
+                r0 = in_im + I(0, 2 * j, 2 * k, dimx, dimy);
+                r1 = in_im + I(0, 2 * j + 1, 2 * k, dimx, dimy);
+                r2 = in_im + I(0, 2 * j, 2 * k + 1, dimx, dimy);
+                r3 = in_im + I(0, 2 * j + 1, 2 * k + 1, dimx, dimy);
+
+#ifdef P3D_HAVE_SSE2
+                for (; (2 * i + 16) <= dimx; i += 8) {
+                    a = _mm_loadu_si128((__m128i*) (r0 + 2 * i));
+                    b = _mm_loadu_si128((__m128i*) (r1 + 2 * i));
+                    c = _mm_loadu_si128((__m128i*) (r2 + 2 * i));
+                    d = _mm_loadu_si128((__m128i*) (r3 + 2 * i));
+
+                    if (mode == P3D_PYRAMID_OR) {
+                        s = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+                        s = _mm_or_si128(_mm_and_si128(s, lo_mask), _mm_srli_epi16(s, 8));
+                        // Any non zero byte becomes OBJECT:
+                        s = _mm_andnot_si128(_mm_cmpeq_epi16(s, zero), lo_mask);
+                    } else {
+                        if (mode == P3D_PYRAMID_MAJORITY) {
+                            // Count OBJECT voxels instead of summing values:
+                            a = _mm_min_epu8(a, one8);
+                            b = _mm_min_epu8(b, one8);
+                            c = _mm_min_epu8(c, one8);
+                            d = _mm_min_epu8(d, one8);
+                        }
+                        // Pairwise (x) sums in 16-bit lanes, then sum of the four rows:
+                        s = _mm_add_epi16(_mm_and_si128(a, lo_mask), _mm_srli_epi16(a, 8));
+                        s = _mm_add_epi16(s, _mm_add_epi16(_mm_and_si128(b, lo_mask), _mm_srli_epi16(b, 8)));
+                        s = _mm_add_epi16(s, _mm_add_epi16(_mm_and_si128(c, lo_mask), _mm_srli_epi16(c, 8)));
+                        s = _mm_add_epi16(s, _mm_add_epi16(_mm_and_si128(d, lo_mask), _mm_srli_epi16(d, 8)));
+
+                        if (mode == P3D_PYRAMID_MAJORITY)
+                            s = _mm_and_si128(_mm_cmpgt_epi16(s, _mm_set1_epi16(3)), lo_mask);
+                        else
+                            s = _mm_srli_epi16(_mm_add_epi16(s, four), 3);
+                    }
+                    _mm_storel_epi64((__m128i*) (o + i), _mm_packus_epi16(s, s));
+                }
+#endif
+            }
+
+            // Remaining (and incomplete) blocks:
+            for (; i < o_dimx; i++)
+                o[i] = _p3dHalveBlock_8(in_im, i, j, k, dimx, dimy, dimz, mode);
+        }
+    }
+}
+
+// Halves a 16-bit volume (rounded mean). Complete blocks are reduced 4 at a
+// time with SSE2.
+void _p3dHalve3D_16(unsigned short* in_im, unsigned short* out_im, const int dimx, const int dimy, const int dimz) {
+    const int o_dimx = (dimx + 1) / 2;
+    const int o_dimy = (dimy + 1) / 2;
+    const int o_dimz = (dimz + 1) / 2;
+    unsigned short *r0, *r1, *r2, *r3, *o;
+    int i, j, k;
+
+#ifdef P3D_HAVE_SSE2
+    const __m128i lo_mask = _mm_set1_epi32(0x0000FFFF);
+    const __m128i four = _mm_set1_epi32(4);
+    const __m128i bias32 = _mm_set1_epi32(32768);
+    const __m128i bias16 = _mm_set1_epi16((short) 0x8000);
+    __m128i a, b, c, d, s;
+#endif
+
+#ifdef P3D_HAVE_SSE2
+#pragma omp parallel for private(i, j, r0, r1, r2, r3, o, a, b, c, d, s)
+#else
+#pragma omp parallel for private(i, j, r0, r1, r2, r3, o)
+#endif
+    for (k = 0; k < o_dimz; k++) {
+        for (j = 0; j < o_dimy; j++) {
+            i = 0;
+            o = out_im + I(0, j, k, o_dimx, o_dimy);
+
+            if (((2 * j + 1) < dimy) && ((2 * k + 1) < dimz)) {
+                r0 = in_im + I(0, 2 * j, 2 * k, dimx, dimy);
+                r1 = in_im + I(0, 2 * j + 1, 2 * k, dimx, dimy);
+                r2 = in_im + I(0, 2 * j, 2 * k + 1, dimx, dimy);
+                r3 = in_im + I(0, 2 * j + 1, 2 * k + 1, dimx, dimy);
+
+#ifdef P3D_HAVE_SSE2
+                for (; (2 * i + 8) <= dimx; i += 4) {
+                    a = _mm_loadu_si128((__m128i*) (r0 + 2 * i));
+                    b = _mm_loadu_si128((__m128i*) (r1 + 2 * i));
+                    c = _mm_loadu_si128((__m128i*) (r2 + 2 * i));
+                    d = _mm_loadu_si128((__m128i*) (r3 + 2 * i));
+
+                    // Pairwise (x) sums in 32-bit lanes, then sum of the four rows:
+                    s = _mm_add_epi32(_mm_and_si128(a, lo_mask), _mm_srli_epi32(a, 16));
+                    s = _mm_add_epi32(s, _mm_add_epi32(_mm_and_si128(b, lo_mask), _mm_srli_epi32(b, 16)));
+                    s = _mm_add_epi32(s, _mm_add_epi32(_mm_and_si128(c, lo_mask), _mm_srli_epi32(c, 16)));
+                    s = _mm_add_epi32(s, _mm_add_epi32(_mm_and_si128(d, lo_mask), _mm_srli_epi32(d, 16)));
+                    s = _mm_srli_epi32(_mm_add_epi32(s, four), 3);
+
+                    // Unsigned 32 to 16-bit pack (SSE2 has only the signed one):
+                    s = _mm_packs_epi32(_mm_sub_epi32(s, bias32), _mm_sub_epi32(s, bias32));
+                    s = _mm_xor_si128(s, bias16);
+                    _mm_storel_epi64((__m128i*) (o + i), s);
+                }
+#endif
+            }
+
+            for (; i < o_dimx; i++)
+                o[i] = _p3dHalveBlock_16(in_im, i, j, k, dimx, dimy, dimz);
+        }
+    }
+}
+
+// Name of the RAW file of a pyramid level ("volume.raw" -> "volume_4x.raw"):
+void _p3dPyramidFilename(char* filename, const int level, char* out_filename) {
+    char* ext;
+    size_t len;
+
+    ext = strrchr(filename, '.');
+    if ((ext == NULL) || (strchr(ext, '/') != NULL) || (strchr(ext, '\\') != NULL))
+        ext = filename + strlen(filename);
+
+    len = (size_t) (ext - filename);
+    memcpy(out_filename, filename, len);
+    sprintf(out_filename + len, "_%dx%s", 1 << level, ext);
+}
+
+void p3dPyramidLevelDims(
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int level,
+        int* l_dimx, // OUT: dimensions of the level
+        int* l_dimy,
+        int* l_dimz
+        ) {
+    int l;
+
+    *l_dimx = dimx;
+    *l_dimy = dimy;
+    *l_dimz = dimz;
+
+    for (l = 0; l < level; l++) {
+        *l_dimx = (*l_dimx + 1) / 2;
+        *l_dimy = (*l_dimy + 1) / 2;
+        *l_dimz = (*l_dimz + 1) / 2;
+    }
+}
+
+int p3dDownsample3D_8(
+        unsigned char* in_im,
+        unsigned char* out_im,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int factor, // IN: 2, 4 or 8 (any power of two, 1 copies the input)
+        const int mode, // IN: P3D_PYRAMID_MEAN, P3D_PYRAMID_MAJORITY or P3D_PYRAMID_OR
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    unsigned char *buf[2] = {NULL, NULL};
+    unsigned char *src, *dst;
+    int l_dimx = dimx, l_dimy = dimy, l_dimz = dimz;
+    int f, step;
+
+    // Start tracking computational time:
+    if (wr_log != NULL) {
+        p3dResetStartTime();
+        wr_log("Pore3D - Downsampling image...");
+        wr_log("\tFactor: %d.", factor);
+    }
+
+    // Each step halves the volume, so only powers of two can be reached:
+    if ((factor < 1) || ((factor & (factor - 1)) != 0) || (factor > (1 << P3D_PYRAMID_MAXLEVEL))) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - Error: factor should be a power of two in the range [1, %d].", 1 << P3D_PYRAMID_MAXLEVEL);
+        }
+        return P3D_IO_ERROR;
+    }
+
+    if (factor == 1) {
+        memcpy(out_im, in_im, (size_t) dimx * dimy * dimz * sizeof (unsigned char));
+    } else {
+        // Ping-pong buffers for the intermediate levels (the first one holds
+        // levels 1, 3, ..., the second one levels 2, 4, ...):
+        if (factor > 2) {
+            P3D_TRY(buf[0] = (unsigned char*) malloc((size_t) ((dimx + 1) / 2) * ((dimy + 1) / 2) * ((dimz + 1) / 2) * sizeof (unsigned char)));
+            P3D_TRY(buf[1] = (unsigned char*) malloc((size_t) ((dimx + 3) / 4) * ((dimy + 3) / 4) * ((dimz + 3) / 4) * sizeof (unsigned char)));
+        }
+
+        src = in_im;
+        for (f = 2, step = 0; f <= factor; f *= 2, step++) {
+            // Last halving goes directly into OUT_IM:
+            dst = ((2 * f) > factor) ? out_im : buf[step % 2];
+
+            _p3dHalve3D_8(src, dst, l_dimx, l_dimy, l_dimz, mode);
+
+            l_dimx = (l_dimx + 1) / 2;
+            l_dimy = (l_dimy + 1) / 2;
+            l_dimz = (l_dimz + 1) / 2;
+            src = dst;
+        }
+    }
+
+    // Print elapsed time (if required):
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Image downsampled successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
+    }
+
+    // Release resources:
+    if (buf[0] != NULL) free(buf[0]);
+    if (buf[1] != NULL) free(buf[1]);
+
+    // Return OK:
+    return P3D_SUCCESS;
+
+MEM_ERROR:
+
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Not enough (contiguous) memory. Program will exit.");
+    }
+
+    // Release resources:
+    if (buf[0] != NULL) free(buf[0]);
+    if (buf[1] != NULL) free(buf[1]);
+
+    return P3D_MEM_ERROR;
+}
+
+int p3dWritePyramid8(
+        unsigned char* in_im,
+        char* filename, // IN: full resolution RAW file (levels are written next to it)
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int levels, // IN: number of levels (3 for 2x, 4x and 8x)
+        const int mode, // IN: P3D_PYRAMID_MEAN, P3D_PYRAMID_MAJORITY or P3D_PYRAMID_OR
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    unsigned char *buf[2] = {NULL, NULL};
+    unsigned char *src;
+    char* level_filename = NULL;
+    int l_dimx = dimx, l_dimy = dimy, l_dimz = dimz;
+    int l;
+
+    // Start tracking computational time:
+    if (wr_log != NULL) {
+        p3dResetStartTime();
+        wr_log("Pore3D - Writing multi-resolution pyramid...");
+        wr_log("\tLevels: %d.", levels);
+    }
+
+    if ((levels < 1) || (levels > P3D_PYRAMID_MAXLEVEL)) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - IO error: number of levels should be in the range [1, %d].", P3D_PYRAMID_MAXLEVEL);
+        }
+        return P3D_IO_ERROR;
+    }
+
+    P3D_TRY(level_filename = (char*) malloc((strlen(filename) + 16) * sizeof (char)));
+
+    // Same ping-pong scheme of p3dDownsample3D, each level is saved as soon as
+    // it is computed:
+    P3D_TRY(buf[0] = (unsigned char*) malloc((size_t) ((dimx + 1) / 2) * ((dimy + 1) / 2) * ((dimz + 1) / 2) * sizeof (unsigned char)));
+    if (levels > 1)
+        P3D_TRY(buf[1] = (unsigned char*) malloc((size_t) ((dimx + 3) / 4) * ((dimy + 3) / 4) * ((dimz + 3) / 4) * sizeof (unsigned char)));
+
+    src = in_im;
+    for (l = 1; l <= levels; l++) {
+        _p3dHalve3D_8(src, buf[(l - 1) % 2], l_dimx, l_dimy, l_dimz, mode);
+        src = buf[(l - 1) % 2];
+
+        l_dimx = (l_dimx + 1) / 2;
+        l_dimy = (l_dimy + 1) / 2;
+        l_dimz = (l_dimz + 1) / 2;
+
+        _p3dPyramidFilename(filename, l, level_filename);
+        if (p3dWriteRaw8(src, level_filename, l_dimx, l_dimy, l_dimz, NULL, NULL) != P3D_SUCCESS) {
+            if (wr_log != NULL) {
+                wr_log("Pore3D - IO error: cannot write level file %s. Program will exit.", level_filename);
+            }
+            free(buf[0]);
+            if (buf[1] != NULL) free(buf[1]);
+            free(level_filename);
+
+            return P3D_IO_ERROR;
+        }
+
+        if (wr_log != NULL) {
+            wr_log("\tLevel %d (%dx) written to %s [%d x %d x %d].", l, 1 << l, level_filename, l_dimx, l_dimy, l_dimz);
+        }
+    }
+
+    // Print elapsed time (if required):
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Multi-resolution pyramid written successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
+    }
+
+    // Release resources:
+    free(buf[0]);
+    if (buf[1] != NULL) free(buf[1]);
+    free(level_filename);
+
+    // Return OK:
+    return P3D_SUCCESS;
+
+MEM_ERROR:
+
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Not enough (contiguous) memory. Program will exit.");
+    }
+
+    // Release resources:
+    if (buf[0] != NULL) free(buf[0]);
+    if (buf[1] != NULL) free(buf[1]);
+    if (level_filename != NULL) free(level_filename);
+
+    return P3D_MEM_ERROR;
+}
+
+int p3dReadRawLevel8(
+        char* filename, // IN: full resolution RAW file
+        unsigned char* out_im, // IN: allocated with the dimensions of the level
+        const int dimx, // IN: full resolution dimensions
+        const int dimy,
+        const int dimz,
+        const int level, // IN: 0 for full resolution, L for the 2^L x level
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    char* level_filename;
+    int l_dimx, l_dimy, l_dimz;
+    int err;
+
+    if (level == 0)
+        return p3dReadRaw8(filename, out_im, dimx, dimy, dimz, wr_log, wr_progress);
+
+    if ((level < 0) || (level > P3D_PYRAMID_MAXLEVEL)) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - IO error: pyramid level should be in the range [0, %d].", P3D_PYRAMID_MAXLEVEL);
+        }
+        return P3D_IO_ERROR;
+    }
+
+    p3dPyramidLevelDims(dimx, dimy, dimz, level, &l_dimx, &l_dimy, &l_dimz);
+
+    level_filename = (char*) malloc((strlen(filename) + 16) * sizeof (char));
+    if (level_filename == NULL) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - Not enough (contiguous) memory. Program will exit.");
+        }
+        return P3D_MEM_ERROR;
+    }
+    _p3dPyramidFilename(filename, level, level_filename);
+
+    err = p3dReadRaw8(level_filename, out_im, l_dimx, l_dimy, l_dimz, wr_log, wr_progress);
+
+    free(level_filename);
+
+    return err;
+}
+
+int p3dDownsample3D_16(
+        unsigned short* in_im,
+        unsigned short* out_im,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int factor, // IN: 2, 4 or 8 (any power of two, 1 copies the input)
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    unsigned short *buf[2] = {NULL, NULL};
+    unsigned short *src, *dst;
+    int l_dimx = dimx, l_dimy = dimy, l_dimz = dimz;
+    int f, step;
+
+    // Start tracking computational time:
+    if (wr_log != NULL) {
+        p3dResetStartTime();
+        wr_log("Pore3D - Downsampling image...");
+        wr_log("\tFactor: %d.", factor);
+    }
+
+    // Each step halves the volume, so only powers of two can be reached:
+    if ((factor < 1) || ((factor & (factor - 1)) != 0) || (factor > (1 << P3D_PYRAMID_MAXLEVEL))) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - Error: factor should be a power of two in the range [1, %d].", 1 << P3D_PYRAMID_MAXLEVEL);
+        }
+        return P3D_IO_ERROR;
+    }
+
+    if (factor == 1) {
+        memcpy(out_im, in_im, (size_t) dimx * dimy * dimz * sizeof (unsigned short));
+    } else {
+        // Ping-pong buffers for the intermediate levels (the first one holds
+        // levels 1, 3, ..., the second one levels 2, 4, ...):
+        if (factor > 2) {
+            P3D_TRY(buf[0] = (unsigned short*) malloc((size_t) ((dimx + 1) / 2) * ((dimy + 1) / 2) * ((dimz + 1) / 2) * sizeof (unsigned short)));
+            P3D_TRY(buf[1] = (unsigned short*) malloc((size_t) ((dimx + 3) / 4) * ((dimy + 3) / 4) * ((dimz + 3) / 4) * sizeof (unsigned short)));
+        }
+
+        src = in_im;
+        for (f = 2, step = 0; f <= factor; f *= 2, step++) {
+            // Last halving goes directly into OUT_IM:
+            dst = ((2 * f) > factor) ? out_im : buf[step % 2];
+
+            _p3dHalve3D_16(src, dst, l_dimx, l_dimy, l_dimz);
+
+            l_dimx = (l_dimx + 1) / 2;
+            l_dimy = (l_dimy + 1) / 2;
+            l_dimz = (l_dimz + 1) / 2;
+            src = dst;
+        }
+    }
+
+    // Print elapsed time (if required):
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Image downsampled successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
+    }
+
+    // Release resources:
+    if (buf[0] != NULL) free(buf[0]);
+    if (buf[1] != NULL) free(buf[1]);
+
+    // Return OK:
+    return P3D_SUCCESS;
+
+MEM_ERROR:
+
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Not enough (contiguous) memory. Program will exit.");
+    }
+
+    // Release resources:
+    if (buf[0] != NULL) free(buf[0]);
+    if (buf[1] != NULL) free(buf[1]);
+
+    return P3D_MEM_ERROR;
+}
+
+int p3dWritePyramid16(
+        unsigned short* in_im,
+        char* filename, // IN: full resolution RAW file (levels are written next to it)
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int levels, // IN: number of levels (3 for 2x, 4x and 8x)
+        const int flagLittle, // IN: RAW file endianness
+        const int flagSigned, // IN: RAW file signedness
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    unsigned short *buf[2] = {NULL, NULL};
+    unsigned short *src;
+    char* level_filename = NULL;
+    int l_dimx = dimx, l_dimy = dimy, l_dimz = dimz;
+    int l;
+
+    // Start tracking computational time:
+    if (wr_log != NULL) {
+        p3dResetStartTime();
+        wr_log("Pore3D - Writing multi-resolution pyramid...");
+        wr_log("\tLevels: %d.", levels);
+    }
+
+    if ((levels < 1) || (levels > P3D_PYRAMID_MAXLEVEL)) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - IO error: number of levels should be in the range [1, %d].", P3D_PYRAMID_MAXLEVEL);
+        }
+        return P3D_IO_ERROR;
+    }
+
+    P3D_TRY(level_filename = (char*) malloc((strlen(filename) + 16) * sizeof (char)));
+
+    // Same ping-pong scheme of p3dDownsample3D, each level is saved as soon as
+    // it is computed:
+    P3D_TRY(buf[0] = (unsigned short*) malloc((size_t) ((dimx + 1) / 2) * ((dimy + 1) / 2) * ((dimz + 1) / 2) * sizeof (unsigned short)));
+    if (levels > 1)
+        P3D_TRY(buf[1] = (unsigned short*) malloc((size_t) ((dimx + 3) / 4) * ((dimy + 3) / 4) * ((dimz + 3) / 4) * sizeof (unsigned short)));
+
+    src = in_im;
+    for (l = 1; l <= levels; l++) {
+        _p3dHalve3D_16(src, buf[(l - 1) % 2], l_dimx, l_dimy, l_dimz);
+        src = buf[(l - 1) % 2];
+
+        l_dimx = (l_dimx + 1) / 2;
+        l_dimy = (l_dimy + 1) / 2;
+        l_dimz = (l_dimz + 1) / 2;
+
+        _p3dPyramidFilename(filename, l, level_filename);
+        if (p3dWriteRaw16(src, level_filename, l_dimx, l_dimy, l_dimz, flagLittle, flagSigned, NULL, NULL) != P3D_SUCCESS) {
+            if (wr_log != NULL) {
+                wr_log("Pore3D - IO error: cannot write level file %s. Program will exit.", level_filename);
+            }
+            free(buf[0]);
+            if (buf[1] != NULL) free(buf[1]);
+            free(level_filename);
+
+            return P3D_IO_ERROR;
+        }
+
+        if (wr_log != NULL) {
+            wr_log("\tLevel %d (%dx) written to %s [%d x %d x %d].", l, 1 << l, level_filename, l_dimx, l_dimy, l_dimz);
+        }
+    }
+
+    // Print elapsed time (if required):
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Multi-resolution pyramid written successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
+    }
+
+    // Release resources:
+    free(buf[0]);
+    if (buf[1] != NULL) free(buf[1]);
+    free(level_filename);
+
+    // Return OK:
+    return P3D_SUCCESS;
+
+MEM_ERROR:
+
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Not enough (contiguous) memory. Program will exit.");
+    }
+
+    // Release resources:
+    if (buf[0] != NULL) free(buf[0]);
+    if (buf[1] != NULL) free(buf[1]);
+    if (level_filename != NULL) free(level_filename);
+
+    return P3D_MEM_ERROR;
+}
+
+int p3dReadRawLevel16(
+        char* filename, // IN: full resolution RAW file
+        unsigned short* out_im, // IN: allocated with the dimensions of the level
+        const int dimx, // IN: full resolution dimensions
+        const int dimy,
+        const int dimz,
+        const int level, // IN: 0 for full resolution, L for the 2^L x level
+        const int flagLittle, // IN: RAW file endianness
+        const int flagSigned, // IN: RAW file signedness
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    char* level_filename;
+    int l_dimx, l_dimy, l_dimz;
+    int err;
+
+    if (level == 0)
+        return p3dReadRaw16(filename, out_im, dimx, dimy, dimz, flagLittle, flagSigned, wr_log, wr_progress);
+
+    if ((level < 0) || (level > P3D_PYRAMID_MAXLEVEL)) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - IO error: pyramid level should be in the range [0, %d].", P3D_PYRAMID_MAXLEVEL);
+        }
+        return P3D_IO_ERROR;
+    }
+
+    p3dPyramidLevelDims(dimx, dimy, dimz, level, &l_dimx, &l_dimy, &l_dimz);
+
+    level_filename = (char*) malloc((strlen(filename) + 16) * sizeof (char));
+    if (level_filename == NULL) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - Not enough (contiguous) memory. Program will exit.");
+        }
+        return P3D_MEM_ERROR;
+    }
+    _p3dPyramidFilename(filename, level, level_filename);
+
+    err = p3dReadRaw16(level_filename, out_im, l_dimx, l_dimy, l_dimz, flagLittle, flagSigned, wr_log, wr_progress);
+
+    free(level_filename);
+
+    return err;
+}
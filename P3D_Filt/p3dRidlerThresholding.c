@@ -47,9 +47,9 @@ int p3dRidlerThresholding_8(
 
     double tt, tb, to, t2;
     int t;
-    long N, no, nb;
+    long long N, no, nb;
 
-    int ct;
+    long long ct;
 
     /*char auth_code;
 
@@ -67,11 +67,11 @@ int p3dRidlerThresholding_8(
 
 
     /* Allocate and initialize to zero kernel histogram: */
-    N = dimx * dimy*dimz;
+    N = (long long) dimx * dimy*dimz;
     tb = 0.0;
     to = 0.0;
     no = 0;
-    for (ct = 0; ct < dimx * dimy * dimz; ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         to = to + (in_im[ct]);
     tt = (to / (double) N);
 
@@ -80,7 +80,7 @@ int p3dRidlerThresholding_8(
         nb = 0;
         tb = 0.0;
         to = 0.0;
-        for (ct = 0; ct < dimx * dimy * dimz; ct++) {
+        for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++) {
             if ((double) (in_im[ct]) >= tt) {
                 to = to + (double) (in_im[ct]);
                 no++;
@@ -104,7 +104,7 @@ int p3dRidlerThresholding_8(
 
 
 #pragma omp parallel for
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         out_im[ ct ] = (in_im[ ct ] > (*thresh)) ? OBJECT : BACKGROUND;
 
     // Print elapsed time (if required):
@@ -149,9 +149,9 @@ int p3dRidlerThresholding_16(
 
     double tt, tb, to, t2;
     int t;
-    long N, no, nb;
+    long long N, no, nb;
 
-    int ct;
+    long long ct;
 
     /*char auth_code;
 
@@ -169,11 +169,11 @@ int p3dRidlerThresholding_16(
 
 
     /* Allocate and initialize to zero kernel histogram: */
-    N = dimx * dimy*dimz;
+    N = (long long) dimx * dimy*dimz;
     tb = 0.0;
     to = 0.0;
     no = 0;
-    for (ct = 0; ct < dimx * dimy * dimz; ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         to = to + (in_im[ct]);
     tt = (to / (double) N);
 
@@ -182,7 +182,7 @@ int p3dRidlerThresholding_16(
         nb = 0;
         tb = 0.0;
         to = 0.0;
-        for (ct = 0; ct < dimx * dimy * dimz; ct++) {
+        for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++) {
             if ((double) (in_im[ct]) >= tt) {
                 to = to + (double) (in_im[ct]);
                 no++;
@@ -206,7 +206,7 @@ int p3dRidlerThresholding_16(
 
 
 #pragma omp parallel for
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++)
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++)
         out_im[ ct ] = (in_im[ ct ] > (*thresh)) ? OBJECT : BACKGROUND;
 
     // Print elapsed time (if required):
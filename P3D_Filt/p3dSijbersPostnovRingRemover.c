@@ -73,93 +73,111 @@ double _p3dSijbersPostnovRingRemover_kth_smallest(double* a, int n, int k) {
     return (*da > *db) - (*da < *db);
 }*/
 
-// Should be thread-safe:
-
-int _getSums_8(unsigned char* p_in_im,
-        unsigned char* mask_im,
-        unsigned char* p_mask_im,
-        int p_dim,
-        int i,
-        int j,
-        int winsize,
+// Sum, squared sum and number of elements outside ROI (BAD) of the line J
+// of the polar image within the window [I, I + WINSIZE). Values of the
+// previous window position are updated, so that the cost does not depend
+// on WINSIZE (they are computed from scratch when I is 0). Values are
+// integers, so the result is exact:
+
+static void _p3dSijbersPostnovSums_8(
+        const unsigned char* p_in_im,
+        const unsigned char* p_mask_im,
+        const int p_dim,
+        const int i,
+        const int j,
+        const int winsize,
         double* sum,
-        double* sqrsum
+        double* sqrsum,
+        int* bad
         ) {
+    const unsigned char* line = p_in_im + I2(0, j, p_dim);
+    const unsigned char* m_line = (p_mask_im != NULL) ? (p_mask_im + I2(0, j, p_dim)) : NULL;
+    double val;
     int k;
 
-    // Init sums:
-    *sum = 0.0;
-    *sqrsum = 0.0;
-
-    // Cycle for each element in line to compute mean and
-    // variance of the line. This computation is meaningless
-    // if line is not completely included into ROI.
-    for (k = i; k < (i + winsize); k++) {
-
-        // Check if element is outside ROI:
-        if (mask_im != NULL) {
-            if (p_mask_im[ I2(k, j, p_dim) ] == 0)
-                // If element is outside ROI break computation to improve
-                // performance:
-                return 0; // false
+    if (i == 0) {
+        *sum = 0.0;
+        *sqrsum = 0.0;
+        *bad = 0;
+
+        for (k = 0; k < winsize; k++) {
+            val = line[k];
+            *sum += val;
+            *sqrsum += val * val;
+            if ((m_line != NULL) && (m_line[k] == 0))
+                (*bad)++;
         }
-
-        // Compute sums for further use in mean and variance
-        // computation:
-        *sum += p_in_im[ I2(k, j, p_dim) ];
-        *sqrsum += p_in_im[ I2(k, j, p_dim) ] * p_in_im[ I2(k, j, p_dim) ];
+    } else {
+        // Element I - 1 leaves the window:
+        val = line[i - 1];
+        *sum -= val;
+        *sqrsum -= val * val;
+        if ((m_line != NULL) && (m_line[i - 1] == 0))
+            (*bad)--;
+
+        // Element I + WINSIZE - 1 enters the window:
+        val = line[i + winsize - 1];
+        *sum += val;
+        *sqrsum += val * val;
+        if ((m_line != NULL) && (m_line[i + winsize - 1] == 0))
+            (*bad)++;
     }
-
-    return 1; // true
 }
 
 
 
-// Should be thread-safe:
+// As _p3dSijbersPostnovSums_8 for 16-bit images:
 
-int _getSums_16(unsigned short* p_in_im,
-        unsigned char* mask_im,
-        unsigned char* p_mask_im,
-        int p_dim,
-        int i,
-        int j,
-        int winsize,
+static void _p3dSijbersPostnovSums_16(
+        const unsigned short* p_in_im,
+        const unsigned char* p_mask_im,
+        const int p_dim,
+        const int i,
+        const int j,
+        const int winsize,
         double* sum,
-        double* sqrsum
+        double* sqrsum,
+        int* bad
         ) {
+    const unsigned short* line = p_in_im + I2(0, j, p_dim);
+    const unsigned char* m_line = (p_mask_im != NULL) ? (p_mask_im + I2(0, j, p_dim)) : NULL;
+    double val;
     int k;
 
-    // Init sums:
-    *sum = 0.0;
-    *sqrsum = 0.0;
-
-    // Cycle for each element in line to compute mean and
-    // variance of the line. This computation is meaningless
-    // if line is not completely included into ROI.
-    for (k = i; k < (i + winsize); k++) {
-
-        // Check if element is outside ROI:
-        if (mask_im != NULL) {
-            if (p_mask_im[ I2(k, j, p_dim) ] == 0)
-                // If element is outside ROI break computation to improve
-                // performance:
-                return 0; // false
+    if (i == 0) {
+        *sum = 0.0;
+        *sqrsum = 0.0;
+        *bad = 0;
+
+        for (k = 0; k < winsize; k++) {
+            val = line[k];
+            *sum += val;
+            *sqrsum += val * val;
+            if ((m_line != NULL) && (m_line[k] == 0))
+                (*bad)++;
         }
-
-        // Compute sums for further use in mean and variance
-        // computation:
-        *sum += p_in_im[ I2(k, j, p_dim) ];
-        *sqrsum += p_in_im[ I2(k, j, p_dim) ] * p_in_im[ I2(k, j, p_dim) ];
+    } else {
+        // Element I - 1 leaves the window:
+        val = line[i - 1];
+        *sum -= val;
+        *sqrsum -= val * val;
+        if ((m_line != NULL) && (m_line[i - 1] == 0))
+            (*bad)--;
+
+        // Element I + WINSIZE - 1 enters the window:
+        val = line[i + winsize - 1];
+        *sum += val;
+        *sqrsum += val * val;
+        if ((m_line != NULL) && (m_line[i + winsize - 1] == 0))
+            (*bad)++;
     }
-
-    return 1; // true
 }
 
 
 
 // This procedure removes ring artifacts from CT images.
 
-int p3dSijbersPostnovRingRemover2D_8(
+int p3dSijbersPostnovRingRemover2D_8_plan(
         unsigned char* in_im,
         unsigned char* out_im,
         const int dimx,
@@ -171,35 +189,44 @@ int p3dSijbersPostnovRingRemover2D_8(
         const int iterations,
         const double precision,
         unsigned char* mask_im,
+        struct PolarPlan* plan, // IN: resampling plan (if NULL it is created)
         int (*wr_log)(const char*, ...),
         int (*wr_progress)(const int, ...)
         ) {
     int i, j, k, it_ct; // generic counters
-    double sum, sqrsum;
 
-    double mean, variance;
+    double variance;
     double tmp_val;
     double thresh = in_thresh*256.0;
 
     // Polar images:
-    unsigned char* p_in_im = NULL; // no need for malloc
-    unsigned char* p_mask_im = NULL; // no need for malloc
-    unsigned char* c_out_im = NULL; // no need for malloc
+    unsigned char* p_in_im = NULL;
+    unsigned char* p_mask_im = NULL;
+
+    // Plan owned by this call (if any):
+    struct PolarPlan* tmp_plan = NULL;
 
     int p_dim;
 
-    // Matrix:
-    double* matrix;
-    int* matrix_mask;
+    // Lines statistics:
+    double* line_sum = NULL;
+    double* line_sqrsum = NULL;
+    double* line_mean = NULL;
+    int* line_bad = NULL;
+
+    // Homogeneous lines:
+    int* matrix_mask = NULL;
+    int* rows = NULL;
+    double* columns = NULL;
     double* column;
-    int ct;
+    int ct, need_art;
     int row_ct;
     int prev_rowct;
 
     // Artifacts vectors:
-    double* loc_art;
-    double* glob_art;
-    int* glob_mask;
+    double* loc_art = NULL;
+    double* glob_art = NULL;
+    int* glob_mask = NULL;
 
     /*char auth_code;
 
@@ -223,12 +250,19 @@ int p3dSijbersPostnovRingRemover2D_8(
     }
 
 
-    // STEP2: Transform in polar coordinates. Remember that memory allocation
-    // for output images is performed within the procedure.
+    // STEP2: Transform in polar coordinates (the plan is created for this
+    // geometry if not provided by the caller):
+    if (plan == NULL) {
+        P3D_TRY(p3dPolarPlanCreate(&tmp_plan, dimx, dimy, centerX, centerY, precision));
+        plan = tmp_plan;
+    }
+    p_dim = plan->polarX;
 
-    p3dCartesian2polar_8(in_im, &p_in_im, dimx, dimy, centerX, centerY, precision, &p_dim);
+    P3D_TRY(p_in_im = (unsigned char*) malloc(p_dim * p_dim * sizeof (unsigned char)));
+    p3dCartesian2polarPlan_8(plan, in_im, p_in_im);
     if (mask_im != NULL) {
-        p3dCartesian2polar_8(mask_im, &p_mask_im, dimx, dimy, centerX, centerY, precision, &p_dim);
+        P3D_TRY(p_mask_im = (unsigned char*) malloc(p_dim * p_dim * sizeof (unsigned char)));
+        p3dCartesian2polarPlan_8(plan, mask_im, p_mask_im);
     }
 
 
@@ -236,19 +270,24 @@ int p3dSijbersPostnovRingRemover2D_8(
     // STEP3: Artifact template selection.
 
     // Allocate dynamic memory:
-    loc_art = (double*) malloc(winsize * sizeof (double));
+    P3D_TRY(loc_art = (double*) calloc(winsize, sizeof (double)));
 
+    // Sliding statistics of each line and list of the lines meeting the
+    // homogeneity criterium:
+    P3D_TRY(line_sum = (double*) malloc(p_dim * sizeof (double)));
+    P3D_TRY(line_sqrsum = (double*) malloc(p_dim * sizeof (double)));
+    P3D_TRY(line_mean = (double*) malloc(p_dim * sizeof (double)));
+    P3D_TRY(line_bad = (int*) malloc(p_dim * sizeof (int)));
+    P3D_TRY(matrix_mask = (int*) malloc(p_dim * sizeof (int)));
+    P3D_TRY(rows = (int*) malloc(p_dim * sizeof (int)));
 
-    // Matrix should be a dynamic structure (i.e. a list of array) but for
-    // performance reasons we adopt a matrix allocated with the maximum
-    // dimensions (worst case):
-    matrix = (double*) calloc(winsize*p_dim, sizeof (double));
-    /**/matrix_mask = (int*) malloc(p_dim * sizeof (int));
+    // One column (of maximum length) for each thread:
+    P3D_TRY(columns = (double*) malloc((size_t) omp_get_max_threads() * p_dim * sizeof (double)));
 
     // Now that we know the dimensions of polar image we can allocate
     // the global artifacts vector:
-    glob_art = (double*) malloc(p_dim * sizeof (double));
-    glob_mask = (int*) malloc(p_dim * sizeof (int));
+    P3D_TRY(glob_art = (double*) malloc(p_dim * sizeof (double)));
+    P3D_TRY(glob_mask = (int*) malloc(p_dim * sizeof (int)));
 
     for (it_ct = 0; it_ct < iterations; it_ct++) {
         // Initializations at every iterations:
@@ -260,34 +299,28 @@ int p3dSijbersPostnovRingRemover2D_8(
         // Within a sliding window:
         for (i = 0; i < (p_dim - winsize); i++) {
             // Init counters:
-            ct = 0;
             row_ct = 0;
 
             // Initialization of matrix mask:
-            /**/memset(matrix_mask, 0, p_dim * sizeof (int)); // init to 0 (false)
+            memset(matrix_mask, 0, p_dim * sizeof (int)); // init to 0 (false)
 
             // For each line of polar image:
-#pragma omp parallel for private(sum, sqrsum, mean, variance, k) reduction (+ : row_ct)
+#pragma omp parallel for private(variance) reduction (+ : row_ct)
             for (j = 0; j < p_dim; j++) {
-                // If computation of sum and squared sum is meaningful:
-                if (_getSums_8(p_in_im, mask_im, p_mask_im, p_dim, i, j, winsize, &sum, &sqrsum)) {
+                // Slide the window on the line:
+                _p3dSijbersPostnovSums_8(p_in_im, p_mask_im, p_dim, i, j, winsize,
+                        line_sum + j, line_sqrsum + j, line_bad + j);
+
+                // If line is completely included into ROI:
+                if (line_bad[j] == 0) {
                     // Compute mean and variance of the line:
-                    mean = sum / winsize;
-                    variance = sqrsum / winsize - mean*mean;
+                    line_mean[j] = line_sum[j] / winsize;
+                    variance = line_sqrsum[j] / winsize - line_mean[j] * line_mean[j];
 
                     // If variance is below threshold:
                     if ((variance < thresh) && (variance > 0)) {
-                        // Set that current position in matrix is meaningful:
-                        /**/matrix_mask[j] = 1; // true
-
-                        // For each element subtract mean and add the line
-                        // to the matrix:
-                        for (k = i; k < (i + winsize); k++) {
-                            // Subtract mean from the line and add
-                            // it to a matrix
-                            /**///matrix[ct++] = p_in_im[ I(k,j,p_dim) ] - mean;
-                            matrix[ I2(k - i, j, winsize) ] = p_in_im[ I2(k, j, p_dim) ] - mean;
-                        }
+                        // Set that current line is meaningful:
+                        matrix_mask[j] = 1; // true
 
                         // Increment the number of lines that meets the
                         // homogeneity criterium:
@@ -296,52 +329,34 @@ int p3dSijbersPostnovRingRemover2D_8(
                 }
             }
 
+            // The "local" artifact vector is used below only if the number
+            // of homogeneous lines has grown or if the "global" one is not
+            // defined yet, so that medians are skipped otherwise:
+            need_art = (row_ct > prev_rowct);
+            for (k = 0; k < winsize; k++)
+                if (glob_mask[k] == 0) need_art = 1;
+
+            // Compute median for each column of the lines (minus their mean)
+            // and store the value in the artifact vector for this sliding
+            // window:
+            if ((row_ct > 0) && need_art) {
+                ct = 0;
+                for (j = 0; j < p_dim; j++) {
+                    if (matrix_mask[j] == 1)
+                        rows[ct++] = j;
+                }
 
-            // Compute median for each column and store the value in the
-            // artifact vector for this sliding window:
-
-            // Now that we know the number of rows that meets homogeneity
-            // criterium we can allocate memory for a column:
-            if (row_ct > 0) {
-                // Allocate memory for the column (no OpenMP):
-                //column = (double*) malloc( row_ct*sizeof(double) );
-
-#pragma omp parallel for private(k, ct, column)
+#pragma omp parallel for private(k, column)
                 for (j = 0; j < winsize; j++) {
-                    // Allocate memory for the column:
-                    column = (double*) malloc(row_ct * sizeof (double));
+                    column = columns + (size_t) omp_get_thread_num() * p_dim;
 
                     // Fill the column array:
-                    /*for ( k = 0; k < row_ct; k++ )
-                    {
-                            column[k] = matrix[ I(j,k,winsize) ];
-                    }*/
-                    ct = 0;
-                    for (k = 0; k < p_dim; k++) {
-                        if (matrix_mask[k] == 1)
-                            column[ct++] = matrix[ I2(j, k, winsize) ];
-                    }
+                    for (k = 0; k < row_ct; k++)
+                        column[k] = p_in_im[ I2(i + j, rows[k], p_dim) ] - line_mean[ rows[k] ];
 
-                    // Order the array:
-                    /*qsort( column, row_ct, sizeof(double), _cmp);
-
-                    // Get the median and put in "local" artifact vector:
-                    loc_art[j] = column[ row_ct / 2 ];*/
                     loc_art[j] = P3DISIJBERSPOSTNOV_RINGREMOVER_MEDIAN(column, row_ct);
-
-                    // Free memory for the column:
-                    free(column);
                 }
-
-                // Free memory for the column (no OpenMP):
-                //free(column);
             }
-            /*else
-            {
-                    // Set to zero "local" artifact vector:
-                    memset(loc_art,0,winsize*sizeof(double));
-            }*/
-
 
             // Unwrap the "local" artifact vector of dimension W to the
             // "global" artifact vector of dimension P_DIM using the rule
@@ -392,25 +407,28 @@ int p3dSijbersPostnovRingRemover2D_8(
 
 
 
-    // Return in cartesian coordinates:
-    p3dPolar2cartesian_8(p_in_im, &c_out_im, p_dim, centerX, centerY, dimx, dimy);
-
-    // Copy C_OUT_IM to the output of the procedure:
-    memcpy(out_im, c_out_im, dimx * dimy * sizeof (unsigned char));
+    // Return in cartesian coordinates (directly into the output):
+    p3dPolar2cartesianPlan_8(plan, p_in_im, out_im);
 
     // Free memory:
     free(glob_art);
     free(glob_mask);
     free(loc_art);
-    free(matrix);
+    free(line_sum);
+    free(line_sqrsum);
+    free(line_mean);
+    free(line_bad);
     free(matrix_mask);
+    free(rows);
+    free(columns);
 
     free(p_in_im);
-    free(c_out_im);
 
     if (mask_im != NULL) {
         free(p_mask_im);
     }
+
+    p3dPolarPlanFree(tmp_plan);
     
      // Print elapsed time (if required):
     if (wr_log != NULL) {
@@ -419,6 +437,29 @@ int p3dSijbersPostnovRingRemover2D_8(
 
     return P3D_SUCCESS;
 
+MEM_ERROR:
+
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Not enough (contiguous) memory. Program will exit.");
+    }
+
+    // Release resources:
+    if (glob_art != NULL) free(glob_art);
+    if (glob_mask != NULL) free(glob_mask);
+    if (loc_art != NULL) free(loc_art);
+    if (line_sum != NULL) free(line_sum);
+    if (line_sqrsum != NULL) free(line_sqrsum);
+    if (line_mean != NULL) free(line_mean);
+    if (line_bad != NULL) free(line_bad);
+    if (matrix_mask != NULL) free(matrix_mask);
+    if (rows != NULL) free(rows);
+    if (columns != NULL) free(columns);
+    if (p_in_im != NULL) free(p_in_im);
+    if (p_mask_im != NULL) free(p_mask_im);
+    p3dPolarPlanFree(tmp_plan);
+
+    return P3D_MEM_ERROR;
+
 /*AUTH_ERROR:
 
     if (wr_log != NULL) {
@@ -428,7 +469,7 @@ int p3dSijbersPostnovRingRemover2D_8(
     return P3D_AUTH_ERROR;*/
 }
 
-int p3dSijbersPostnovRingRemover2D_16(
+int p3dSijbersPostnovRingRemover2D_16_plan(
         unsigned short* in_im,
         unsigned short* out_im,
         const int dimx,
@@ -441,35 +482,44 @@ int p3dSijbersPostnovRingRemover2D_16(
         const double precision,
         const int bit12,
         unsigned char* mask_im,
+        struct PolarPlan* plan, // IN: resampling plan (if NULL it is created)
         int (*wr_log)(const char*, ...),
         int (*wr_progress)(const int, ...)
         ) {
     int i, j, k, it_ct; // generic counters
-    double sum, sqrsum;
 
-    double mean, variance;
+    double variance;
     double tmp_val;
     double thresh;
 
     // Polar images:
-    unsigned short* p_in_im = NULL; // no need for malloc
-    unsigned char* p_mask_im = NULL; // no need for malloc
-    unsigned short* c_out_im = NULL; // no need for malloc
+    unsigned short* p_in_im = NULL;
+    unsigned char* p_mask_im = NULL;
+
+    // Plan owned by this call (if any):
+    struct PolarPlan* tmp_plan = NULL;
 
     int p_dim;
 
-    // Matrix:
-    double* matrix;
-    int* matrix_mask;
+    // Lines statistics:
+    double* line_sum = NULL;
+    double* line_sqrsum = NULL;
+    double* line_mean = NULL;
+    int* line_bad = NULL;
+
+    // Homogeneous lines:
+    int* matrix_mask = NULL;
+    int* rows = NULL;
+    double* columns = NULL;
     double* column;
-    int ct;
+    int ct, need_art;
     int row_ct;
     int prev_rowct = 0;
 
     // Artifacts vectors:
-    double* loc_art;
-    double* glob_art;
-    int* glob_mask;
+    double* loc_art = NULL;
+    double* glob_art = NULL;
+    int* glob_mask = NULL;
 
     /*char auth_code;
 
@@ -504,31 +554,43 @@ int p3dSijbersPostnovRingRemover2D_16(
         thresh = in_thresh * 65536.0;
 
 
-    // STEP2: Transform in polar coordinates. Remember that memory allocation
-    // for output images is performed within the procedure.
+    // STEP2: Transform in polar coordinates (the plan is created for this
+    // geometry if not provided by the caller):
+    if (plan == NULL) {
+        P3D_TRY(p3dPolarPlanCreate(&tmp_plan, dimx, dimy, centerX, centerY, precision));
+        plan = tmp_plan;
+    }
+    p_dim = plan->polarX;
 
-    p3dCartesian2polar_16(in_im, &p_in_im, dimx, dimy, centerX, centerY, precision, &p_dim);
+    P3D_TRY(p_in_im = (unsigned short*) malloc(p_dim * p_dim * sizeof (unsigned short)));
+    p3dCartesian2polarPlan_16(plan, in_im, p_in_im);
     if (mask_im != NULL) {
-        p3dCartesian2polar_8(mask_im, &p_mask_im, dimx, dimy, centerX, centerY, precision, &p_dim);
+        P3D_TRY(p_mask_im = (unsigned char*) malloc(p_dim * p_dim * sizeof (unsigned char)));
+        p3dCartesian2polarPlan_8(plan, mask_im, p_mask_im);
     }
 
 
     // STEP3: Artifact template selection.
 
     // Allocate dynamic memory:
-    loc_art = (double*) calloc(winsize, sizeof (double));
+    P3D_TRY(loc_art = (double*) calloc(winsize, sizeof (double)));
 
+    // Sliding statistics of each line and list of the lines meeting the
+    // homogeneity criterium:
+    P3D_TRY(line_sum = (double*) malloc(p_dim * sizeof (double)));
+    P3D_TRY(line_sqrsum = (double*) malloc(p_dim * sizeof (double)));
+    P3D_TRY(line_mean = (double*) malloc(p_dim * sizeof (double)));
+    P3D_TRY(line_bad = (int*) malloc(p_dim * sizeof (int)));
+    P3D_TRY(matrix_mask = (int*) malloc(p_dim * sizeof (int)));
+    P3D_TRY(rows = (int*) malloc(p_dim * sizeof (int)));
 
-    // Matrix should be a dynamic structure (i.e. a list of array) but for
-    // performance reasons we adopt a matrix allocated with the maximum
-    // dimensions (worst case):
-    matrix = (double*) calloc(winsize*p_dim, sizeof (double));
-    /**/matrix_mask = (int*) malloc(p_dim * sizeof (int));
+    // One column (of maximum length) for each thread:
+    P3D_TRY(columns = (double*) malloc((size_t) omp_get_max_threads() * p_dim * sizeof (double)));
 
     // Now that we know the dimensions of polar image we can allocate
     // the global artifacts vector:
-    glob_art = (double*) malloc(p_dim * sizeof (double));
-    glob_mask = (int*) malloc(p_dim * sizeof (int));
+    P3D_TRY(glob_art = (double*) malloc(p_dim * sizeof (double)));
+    P3D_TRY(glob_mask = (int*) malloc(p_dim * sizeof (int)));
 
     for (it_ct = 0; it_ct < iterations; it_ct++) {
         // Initializations at every iterations:
@@ -540,34 +602,28 @@ int p3dSijbersPostnovRingRemover2D_16(
         // Within a sliding window:
         for (i = 0; i < (p_dim - winsize); i++) {
             // Init counters:
-            ct = 0;
             row_ct = 0;
 
             // Initialization of matrix mask:
-            /**/memset(matrix_mask, 0, p_dim * sizeof (int)); // init to 0 (false)
+            memset(matrix_mask, 0, p_dim * sizeof (int)); // init to 0 (false)
 
             // For each line of polar image:
-#pragma omp parallel for private(sum, sqrsum, mean, variance, k) reduction (+ : row_ct)
+#pragma omp parallel for private(variance) reduction (+ : row_ct)
             for (j = 0; j < p_dim; j++) {
-                // If computation of sum and squared sum is meaningful:
-                if (_getSums_16(p_in_im, mask_im, p_mask_im, p_dim, i, j, winsize, &sum, &sqrsum)) {
+                // Slide the window on the line:
+                _p3dSijbersPostnovSums_16(p_in_im, p_mask_im, p_dim, i, j, winsize,
+                        line_sum + j, line_sqrsum + j, line_bad + j);
+
+                // If line is completely included into ROI:
+                if (line_bad[j] == 0) {
                     // Compute mean and variance of the line:
-                    mean = sum / winsize;
-                    variance = sqrsum / winsize - mean*mean;
+                    line_mean[j] = line_sum[j] / winsize;
+                    variance = line_sqrsum[j] / winsize - line_mean[j] * line_mean[j];
 
                     // If variance is below threshold:
                     if ((variance < thresh) && (variance > 0)) {
-                        // Set that current position in matrix is meaningful:
-                        /**/matrix_mask[j] = 1; // true
-
-                        // For each element subtract mean and add the line
-                        // to the matrix:
-                        for (k = i; k < (i + winsize); k++) {
-                            // Subtract mean from the line and add
-                            // it to a matrix
-                            /**///matrix[ct++] = p_in_im[ I(k,j,p_dim) ] - mean;
-                            matrix[ I2(k - i, j, winsize) ] = p_in_im[ I2(k, j, p_dim) ] - mean;
-                        }
+                        // Set that current line is meaningful:
+                        matrix_mask[j] = 1; // true
 
                         // Increment the number of lines that meets the
                         // homogeneity criterium:
@@ -576,56 +632,38 @@ int p3dSijbersPostnovRingRemover2D_16(
                 }
             }
 
+            // The "local" artifact vector is used below only if the number
+            // of homogeneous lines has grown or if the "global" one is not
+            // defined yet, so that medians are skipped otherwise:
+            need_art = (row_ct > prev_rowct);
+            for (k = 0; k < winsize; k++)
+                if (glob_mask[k] == 0) need_art = 1;
+
+            // Compute median for each column of the lines (minus their mean)
+            // and store the value in the artifact vector for this sliding
+            // window:
+            if ((row_ct > 0) && need_art) {
+                ct = 0;
+                for (j = 0; j < p_dim; j++) {
+                    if (matrix_mask[j] == 1)
+                        rows[ct++] = j;
+                }
 
-            // Compute median for each column and store the value in the
-            // artifact vector for this sliding window:
-
-            // Now that we know the number of rows that meets homogeneity
-            // criterium we can allocate memory for a column:
-            if (row_ct > 0) {
-                // Allocate memory for the column (no OpenMP):
-                //column = (double*) malloc( row_ct*sizeof(double) );
-
-#pragma omp parallel for private(k, ct, column)
+#pragma omp parallel for private(k, column)
                 for (j = 0; j < winsize; j++) {
-                    // Allocate memory for the column:
-                    column = (double*) malloc(row_ct * sizeof (double));
+                    column = columns + (size_t) omp_get_thread_num() * p_dim;
 
                     // Fill the column array:
-                    /*for ( k = 0; k < row_ct; k++ )
-                    {
-                            column[k] = matrix[ I(j,k,winsize) ];
-                    }*/
-                    ct = 0;
-                    for (k = 0; k < p_dim; k++) {
-                        if (matrix_mask[k] == 1)
-                            column[ct++] = matrix[ I2(j, k, winsize) ];
-                    }
-
-                    // Order the array:
-                    /*qsort( column, row_ct, sizeof(double), _cmp);
+                    for (k = 0; k < row_ct; k++)
+                        column[k] = p_in_im[ I2(i + j, rows[k], p_dim) ] - line_mean[ rows[k] ];
 
-                    // Get the median and put in "local" artifact vector:
-                    loc_art[j] = column[ row_ct / 2 ];*/
                     loc_art[j] = P3DISIJBERSPOSTNOV_RINGREMOVER_MEDIAN(column, row_ct);
-
-                    // Free memory for the column:
-                    free(column);
                 }
-
-                // Free memory for the column (no OpenMP):
-                //free(column);
             }
-            /*else
-            {
-                    // Set to zero "local" artifact vector:
-                    memset(loc_art,0,winsize*sizeof(double));
-            }*/
-
 
             // Unwrap the "local" artifact vector of dimension W to the
             // "global" artifact vector of dimension P_DIM using the rule
-            // based on number of rows that meets the homogeneity criterium:
+            // based on number of rows that meet the homogeneity criterium:
             for (k = 0; k < winsize; k++) {
                 if ((row_ct > prev_rowct) || (glob_mask[k] == 0)) {
                     glob_art[k + i] = loc_art[k];
@@ -671,26 +709,29 @@ int p3dSijbersPostnovRingRemover2D_16(
     }
 
 
-    // Return in cartesian coordinates:
-    p3dPolar2cartesian_16(p_in_im, &c_out_im, p_dim, centerX, centerY, dimx, dimy);
-
-    // Copy C_OUT_IM to the output of the procedure:
-    memcpy(out_im, c_out_im, dimx * dimy * sizeof (unsigned short));
+    // Return in cartesian coordinates (directly into the output):
+    p3dPolar2cartesianPlan_16(plan, p_in_im, out_im);
 
     // Free memory:
     free(glob_art);
     free(glob_mask);
     free(loc_art);
-    free(matrix);
+    free(line_sum);
+    free(line_sqrsum);
+    free(line_mean);
+    free(line_bad);
     free(matrix_mask);
+    free(rows);
+    free(columns);
 
     free(p_in_im);
-    free(c_out_im);
 
     if (mask_im != NULL) {
         free(p_mask_im);
     }
 
+    p3dPolarPlanFree(tmp_plan);
+
     // Print elapsed time (if required):
     if (wr_log != NULL) {
         wr_log("Pore3D - Sijbers and Postnov ring remover applied successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
@@ -699,6 +740,29 @@ int p3dSijbersPostnovRingRemover2D_16(
 
     return P3D_SUCCESS;
 
+MEM_ERROR:
+
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Not enough (contiguous) memory. Program will exit.");
+    }
+
+    // Release resources:
+    if (glob_art != NULL) free(glob_art);
+    if (glob_mask != NULL) free(glob_mask);
+    if (loc_art != NULL) free(loc_art);
+    if (line_sum != NULL) free(line_sum);
+    if (line_sqrsum != NULL) free(line_sqrsum);
+    if (line_mean != NULL) free(line_mean);
+    if (line_bad != NULL) free(line_bad);
+    if (matrix_mask != NULL) free(matrix_mask);
+    if (rows != NULL) free(rows);
+    if (columns != NULL) free(columns);
+    if (p_in_im != NULL) free(p_in_im);
+    if (p_mask_im != NULL) free(p_mask_im);
+    p3dPolarPlanFree(tmp_plan);
+
+    return P3D_MEM_ERROR;
+
 /*AUTH_ERROR:
 
     if (wr_log != NULL) {
@@ -706,4 +770,215 @@ int p3dSijbersPostnovRingRemover2D_16(
     }
 
     return P3D_AUTH_ERROR;*/
-}
\ No newline at end of file
+}
+
+int p3dSijbersPostnovRingRemover2D_8(
+        unsigned char* in_im,
+        unsigned char* out_im,
+        const int dimx,
+        const int dimy,
+        const double centerX,
+        const double centerY,
+        const int winsize,
+        const double in_thresh,
+        const int iterations,
+        const double precision,
+        unsigned char* mask_im,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    return p3dSijbersPostnovRingRemover2D_8_plan(in_im, out_im, dimx, dimy, centerX, centerY,
+            winsize, in_thresh, iterations, precision, mask_im, NULL, wr_log, wr_progress);
+}
+
+int p3dSijbersPostnovRingRemover2D_16(
+        unsigned short* in_im,
+        unsigned short* out_im,
+        const int dimx,
+        const int dimy,
+        const double centerX,
+        const double centerY,
+        const int winsize,
+        const double in_thresh,
+        const int iterations,
+        const double precision,
+        const int bit12,
+        unsigned char* mask_im,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    return p3dSijbersPostnovRingRemover2D_16_plan(in_im, out_im, dimx, dimy, centerX, centerY,
+            winsize, in_thresh, iterations, precision, bit12, mask_im, NULL, wr_log, wr_progress);
+}
+
+struct SijbersPostnovParams {
+    double centerX, centerY;
+    int winsize;
+    double in_thresh;
+    int iterations;
+    double precision;
+    int bit12;
+    unsigned char* mask_im;
+    struct PolarPlan* plan;
+};
+
+static int _p3dSijbersPostnovRingRemover2D_8_slice(void* in_im, void* out_im, const int dimx, const int dimy, void* params) {
+    struct SijbersPostnovParams* p = (struct SijbersPostnovParams*) params;
+
+    return p3dSijbersPostnovRingRemover2D_8_plan((unsigned char*) in_im, (unsigned char*) out_im, dimx, dimy,
+            p->centerX, p->centerY, p->winsize, p->in_thresh, p->iterations, p->precision, p->mask_im, p->plan, NULL, NULL);
+}
+
+static int _p3dSijbersPostnovRingRemover2D_16_slice(void* in_im, void* out_im, const int dimx, const int dimy, void* params) {
+    struct SijbersPostnovParams* p = (struct SijbersPostnovParams*) params;
+
+    return p3dSijbersPostnovRingRemover2D_16_plan((unsigned short*) in_im, (unsigned short*) out_im, dimx, dimy,
+            p->centerX, p->centerY, p->winsize, p->in_thresh, p->iterations, p->precision, p->bit12, p->mask_im, p->plan, NULL, NULL);
+}
+
+// Batch version: each slice of the RAW volume IN_FILENAME is corrected and
+// written to OUT_FILENAME without loading the whole volume. All the slices
+// share the same resampling plan and the same (2D) mask, read from the RAW
+// file MASK_FILENAME if not NULL.
+
+static int _p3dSijbersPostnovRingRemover2D_batch(
+        char* in_filename,
+        char* out_filename,
+        const int dimx,
+        const int dimy,
+        const int bytes,
+        const double centerX,
+        const double centerY,
+        const int winsize,
+        const double in_thresh,
+        const int iterations,
+        const double precision,
+        const int bit12,
+        char* mask_filename,
+        const int flagLittle,
+        const int flagSigned,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...),
+        int threads
+        ) {
+    struct SijbersPostnovParams p;
+    int err;
+
+    p.centerX = centerX;
+    p.centerY = centerY;
+    p.winsize = winsize;
+    p.in_thresh = in_thresh;
+    p.iterations = iterations;
+    p.precision = precision;
+    p.bit12 = bit12;
+    p.mask_im = NULL;
+    p.plan = NULL;
+
+    // Start tracking computational time:
+    if (wr_log != NULL) {
+        p3dResetStartTime();
+        wr_log("Pore3D - Applying Sijbers and Postnov ring remover (batch)...");
+        wr_log("\tCenter of rings: [%0.1f,%0.1f].", centerX, centerY);
+        wr_log("\tWinsize: %d.", winsize);
+        wr_log("\tThreshold: %0.3f.", in_thresh);
+        wr_log("\tIterations: %d.", iterations);
+        if (bytes == 2) {
+            if (bit12 == P3D_TRUE)
+                wr_log("\t12-bit images flag: true.");
+            else
+                wr_log("\t12-bit images flag: false.");
+        }
+        if (mask_filename != NULL)
+            wr_log("\tMask adopted: %s.", mask_filename);
+        wr_log("\tPolar/Cartesian precision: %0.3f.", precision);
+    }
+
+    // Read the mask (if any):
+    if (mask_filename != NULL) {
+        P3D_TRY(p.mask_im = (unsigned char*) malloc(dimx * dimy * sizeof (unsigned char)));
+        P3D_TRY(err = p3dReadRaw8(mask_filename, p.mask_im, dimx, dimy, 1, NULL, NULL));
+        if (err != P3D_SUCCESS) {
+            if (wr_log != NULL) {
+                wr_log("Pore3D - IO error: error on reading file %s. Program will exit.", mask_filename);
+            }
+            free(p.mask_im);
+
+            return P3D_IO_ERROR;
+        }
+    }
+
+    // The plan is created once for all the slices:
+    P3D_TRY(p3dPolarPlanCreate(&(p.plan), dimx, dimy, centerX, centerY, precision));
+
+    err = _p3dRingRemoverBatch(in_filename, out_filename, dimx, dimy, bytes, flagLittle, flagSigned, threads,
+            (bytes == 2) ? _p3dSijbersPostnovRingRemover2D_16_slice : _p3dSijbersPostnovRingRemover2D_8_slice,
+            (void*) &p, wr_log, wr_progress);
+
+    // Print elapsed time (if required):
+    if ((wr_log != NULL) && (err == P3D_SUCCESS)) {
+        wr_log("Pore3D - Sijbers and Postnov ring remover applied successfully in %dm%0.3fs.", p3dGetElapsedTime_min(), p3dGetElapsedTime_sec());
+    }
+
+    // Release resources:
+    if (p.mask_im != NULL) free(p.mask_im);
+    p3dPolarPlanFree(p.plan);
+
+    return err;
+
+MEM_ERROR:
+
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Not enough (contiguous) memory. Program will exit.");
+    }
+
+    // Release resources:
+    if (p.mask_im != NULL) free(p.mask_im);
+    p3dPolarPlanFree(p.plan);
+
+    return P3D_MEM_ERROR;
+}
+
+int p3dSijbersPostnovRingRemover2D_8_batch(
+        char* in_filename,
+        char* out_filename,
+        const int dimx,
+        const int dimy,
+        const double centerX,
+        const double centerY,
+        const int winsize,
+        const double in_thresh,
+        const int iterations,
+        const double precision,
+        char* mask_filename,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...),
+        int threads // IN: slices corrected concurrently (all processors if not positive)
+        ) {
+    return _p3dSijbersPostnovRingRemover2D_batch(in_filename, out_filename, dimx, dimy, 1, centerX, centerY,
+            winsize, in_thresh, iterations, precision, P3D_FALSE, mask_filename, P3D_TRUE, P3D_FALSE,
+            wr_log, wr_progress, threads);
+}
+
+int p3dSijbersPostnovRingRemover2D_16_batch(
+        char* in_filename,
+        char* out_filename,
+        const int dimx,
+        const int dimy,
+        const double centerX,
+        const double centerY,
+        const int winsize,
+        const double in_thresh,
+        const int iterations,
+        const double precision,
+        const int bit12,
+        char* mask_filename,
+        const int flagLittle,
+        const int flagSigned,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...),
+        int threads // IN: slices corrected concurrently (all processors if not positive)
+        ) {
+    return _p3dSijbersPostnovRingRemover2D_batch(in_filename, out_filename, dimx, dimy, 2, centerX, centerY,
+            winsize, in_thresh, iterations, precision, bit12, mask_filename, flagLittle, flagSigned,
+            wr_log, wr_progress, threads);
+}
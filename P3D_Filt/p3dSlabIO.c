@@ -0,0 +1,440 @@
+/***************************************************************************/
+/* (C) 2016 Elettra - Sincrotrone Trieste S.C.p.A.. All rights reserved.   */
+/*                                                                         */
+/*                                                                         */
+/* This file is part of Pore3D, a software library for quantitative        */
+/* analysis of 3D (volume) images.                                         */
+/*                                                                         */
+/* Pore3D is free software: you can redistribute it and/or modify it       */
+/* under the terms of the GNU General Public License as published by the   */
+/* Free Software Foundation, either version 3 of the License, or (at your  */
+/* option) any later version.                                              */
+/*                                                                         */
+/* Pore3D is distributed in the hope that it will be useful, but WITHOUT   */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or   */
+/* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License    */
+/* for more details.                                                       */
+/*                                                                         */
+/* You should have received a copy of the GNU General Public License       */
+/* along with Pore3D. If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                         */
+/***************************************************************************/
+
+//
+// Author: Francesco Brun
+// Last modified: October, 16th 2026
+//
+
+// Streaming access to RAW volumes by z-slabs. A reader returns slabs made
+// of SLAB core slices plus up to HALO slices above and below (the halo is
+// clamped at the first and last slice of the volume). While the caller
+// processes a slab, the next one is read by a background thread into a
+// second buffer (double buffering). The writer appends slices to a RAW file
+// applying the same conversions of p3dWriteRaw8/16.
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#include "p3dFilt.h"
+#include "p3dTime.h"
+#include "p3dSlabIO.h"
+
+#include "Common/p3dEndianSwap.h"
+
+#ifdef _WINDOWS
+	#define _p3dFseek	_fseeki64
+#else
+	#define _p3dFseek	fseeko
+#endif
+
+struct SlabReader {
+    FILE* fvol;
+    int dimx, dimy, dimz;
+    int bytes; // 1 or 2
+    int flagLittle, flagSigned;
+    int slab, halo;
+
+    // Double buffer and worker thread:
+    unsigned char* buf[2];
+    int cur; // index of the buffer owned by the caller
+    pthread_t thread;
+    int pending;
+
+    // Core range of the next slab to read [next_z0, next_z0 + slab):
+    int next_z0;
+
+    // Description of the slab in the prefetch buffer:
+    int pf_z0, pf_z1, pf_lo, pf_hi;
+    int pf_err;
+};
+
+struct SlabWriter {
+    FILE* fvol;
+    int dimx, dimy, dimz;
+    int bytes;
+    int flagLittle, flagSigned;
+    int written; // number of slices already written
+    unsigned short* tmp_im;
+};
+
+// Reads slices [z0 - lo, z1 + hi) into the prefetch buffer (worker thread):
+void* _p3dSlabReaderFetch(void* args) {
+    struct SlabReader* r = (struct SlabReader*) args;
+    unsigned char* im = r->buf[1 - r->cur];
+    const long long slice = (long long) r->dimx * r->dimy;
+    long long n;
+
+    n = slice * (r->pf_z1 + r->pf_hi - (r->pf_z0 - r->pf_lo));
+
+    r->pf_err = P3D_FALSE;
+    if (_p3dFseek(r->fvol, (long long) (r->pf_z0 - r->pf_lo) * slice * r->bytes, SEEK_SET) != 0) {
+        r->pf_err = P3D_TRUE;
+        return NULL;
+    }
+    if (fread(im, r->bytes, (size_t) n, r->fvol) < ((size_t) n)) {
+        r->pf_err = P3D_TRUE;
+        return NULL;
+    }
+
+    // Convert to host representation (same rules of p3dReadRaw16):
+    if ((r->bytes == 2) && ((r->flagLittle == P3D_FALSE) || (r->flagSigned == P3D_TRUE))) {
+        p3dRawDecode16((unsigned short*) im, (unsigned short*) im, (size_t) n,
+                (r->flagLittle == P3D_FALSE), (r->flagSigned == P3D_TRUE));
+    }
+
+    return NULL;
+}
+
+// Starts reading the slab beginning at next_z0 (if any):
+int _p3dSlabReaderPrefetch(struct SlabReader* r) {
+    r->pending = P3D_FALSE;
+
+    if (r->next_z0 >= r->dimz)
+        return P3D_SUCCESS;
+
+    r->pf_z0 = r->next_z0;
+    r->pf_z1 = MIN(r->next_z0 + r->slab, r->dimz);
+    r->pf_lo = MIN(r->halo, r->pf_z0);
+    r->pf_hi = MIN(r->halo, r->dimz - r->pf_z1);
+    r->next_z0 = r->pf_z1;
+
+    if (pthread_create(&(r->thread), NULL, _p3dSlabReaderFetch, (void*) r) != 0)
+        return P3D_IO_ERROR;
+    r->pending = P3D_TRUE;
+
+    return P3D_SUCCESS;
+}
+
+int p3dSlabReaderOpen(
+        char* filename,
+        struct SlabReader** reader,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int bytes,
+        const int flagLittle,
+        const int flagSigned,
+        const int slab,
+        const int halo,
+        int (*wr_log)(const char*, ...)
+        ) {
+    struct SlabReader* r;
+    size_t buf_size;
+
+    (*reader) = NULL;
+
+    P3D_TRY(r = (struct SlabReader*) calloc(1, sizeof (struct SlabReader)));
+
+    r->dimx = dimx;
+    r->dimy = dimy;
+    r->dimz = dimz;
+    r->bytes = (bytes == 2) ? 2 : 1;
+    r->flagLittle = flagLittle;
+    r->flagSigned = flagSigned;
+    r->slab = MIN(MAX(slab, 1), dimz);
+    r->halo = MAX(halo, 0);
+
+    // Each buffer holds a core slab plus two halos:
+    buf_size = (size_t) dimx * dimy * (r->slab + 2 * r->halo) * r->bytes;
+    P3D_TRY(r->buf[0] = (unsigned char*) malloc(buf_size));
+    P3D_TRY(r->buf[1] = (unsigned char*) malloc(buf_size));
+
+    // Get a handler for the input file:
+    if ((r->fvol = fopen(filename, "rb")) == NULL) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - IO error: cannot open input file %s. Program will exit.", filename);
+        }
+        p3dSlabReaderClose(r);
+
+        return P3D_IO_ERROR;
+    }
+
+    // Start reading the first slab:
+    r->cur = 0;
+    r->next_z0 = 0;
+    if (_p3dSlabReaderPrefetch(r) != P3D_SUCCESS) {
+        p3dSlabReaderClose(r);
+
+        return P3D_IO_ERROR;
+    }
+
+    (*reader) = r;
+
+    return P3D_SUCCESS;
+
+MEM_ERROR:
+
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Not enough (contiguous) memory. Program will exit.");
+    }
+
+    // Release resources:
+    p3dSlabReaderClose(r);
+
+    return P3D_MEM_ERROR;
+}
+
+// Returns in SLAB_IM the slices [z0 - halo_lo, z1 + halo_hi): the core slices
+// [z0, z1) start at offset halo_lo*dimx*dimy. The buffer is owned by the reader
+// and it is valid until the next call. When the volume has been completely
+// read SLAB_IM is set to NULL.
+int p3dSlabReaderNext(
+        struct SlabReader* r,
+        void** slab_im,
+        int* z0,
+        int* z1,
+        int* halo_lo,
+        int* halo_hi
+        ) {
+    (*slab_im) = NULL;
+
+    if (r->pending == P3D_FALSE)
+        return P3D_SUCCESS;
+
+    // Wait for the prefetch and hand over its buffer:
+    pthread_join(r->thread, NULL);
+    r->pending = P3D_FALSE;
+
+    if (r->pf_err == P3D_TRUE)
+        return P3D_IO_ERROR;
+
+    r->cur = 1 - r->cur;
+    (*slab_im) = (void*) r->buf[r->cur];
+    (*z0) = r->pf_z0;
+    (*z1) = r->pf_z1;
+    (*halo_lo) = r->pf_lo;
+    (*halo_hi) = r->pf_hi;
+
+    // Start reading the following slab into the other buffer:
+    return _p3dSlabReaderPrefetch(r);
+}
+
+int p3dSlabReaderClose(
+        struct SlabReader* r
+        ) {
+    if (r == NULL)
+        return P3D_SUCCESS;
+
+    if (r->pending == P3D_TRUE)
+        pthread_join(r->thread, NULL);
+
+    if (r->fvol != NULL) fclose(r->fvol);
+    if (r->buf[0] != NULL) free(r->buf[0]);
+    if (r->buf[1] != NULL) free(r->buf[1]);
+    free(r);
+
+    return P3D_SUCCESS;
+}
+
+int p3dSlabWriterOpen(
+        char* filename,
+        struct SlabWriter** writer,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int bytes,
+        const int flagLittle,
+        const int flagSigned,
+        int (*wr_log)(const char*, ...)
+        ) {
+    struct SlabWriter* w;
+
+    (*writer) = NULL;
+
+    P3D_TRY(w = (struct SlabWriter*) calloc(1, sizeof (struct SlabWriter)));
+
+    w->dimx = dimx;
+    w->dimy = dimy;
+    w->dimz = dimz;
+    w->bytes = (bytes == 2) ? 2 : 1;
+    w->flagLittle = flagLittle;
+    w->flagSigned = flagSigned;
+    w->written = 0;
+
+    if ((w->bytes == 2) && ((flagLittle == P3D_FALSE) || (flagSigned == P3D_TRUE))) {
+        P3D_TRY(w->tmp_im = (unsigned short*) malloc(P3D_RAW_CHUNK * sizeof (unsigned short)));
+    }
+
+    // Get a handler for the output file:
+    if ((w->fvol = fopen(filename, "wb")) == NULL) {
+        if (wr_log != NULL) {
+            wr_log("Pore3D - IO error: cannot open output file %s. Program will exit.", filename);
+        }
+        if (w->tmp_im != NULL) free(w->tmp_im);
+        free(w);
+
+        return P3D_IO_ERROR;
+    }
+
+    (*writer) = w;
+
+    return P3D_SUCCESS;
+
+MEM_ERROR:
+
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Not enough (contiguous) memory. Program will exit.");
+    }
+
+    // Release resources:
+    if (w != NULL) {
+        if (w->tmp_im != NULL) free(w->tmp_im);
+        free(w);
+    }
+
+    return P3D_MEM_ERROR;
+}
+
+// Appends NSLICES slices stored in IN_IM:
+int p3dSlabWriterWrite(
+        struct SlabWriter* w,
+        void* in_im,
+        const int nslices
+        ) {
+    const long long n = (long long) w->dimx * w->dimy * nslices;
+    long long ct, chunk;
+
+    if ((nslices < 0) || ((w->written + nslices) > w->dimz))
+        return P3D_IO_ERROR;
+
+    if (w->tmp_im == NULL) {
+        if (fwrite(in_im, w->bytes, (size_t) n, w->fvol) < ((size_t) n))
+            return P3D_IO_ERROR;
+    } else {
+        for (ct = 0; ct < n; ct += chunk) {
+            chunk = ((n - ct) < P3D_RAW_CHUNK) ? (n - ct) : P3D_RAW_CHUNK;
+
+            p3dRawEncode16(w->tmp_im, ((unsigned short*) in_im) + ct, (size_t) chunk,
+                    (w->flagLittle == P3D_FALSE), (w->flagSigned == P3D_TRUE));
+
+            if (fwrite(w->tmp_im, sizeof (unsigned short), (size_t) chunk, w->fvol) < ((size_t) chunk))
+                return P3D_IO_ERROR;
+        }
+    }
+
+    w->written += nslices;
+
+    return P3D_SUCCESS;
+}
+
+int p3dSlabWriterClose(
+        struct SlabWriter* w
+        ) {
+    int err;
+
+    if (w == NULL)
+        return P3D_SUCCESS;
+
+    err = (fclose(w->fvol) != 0) || (w->written != w->dimz);
+
+    if (w->tmp_im != NULL) free(w->tmp_im);
+    free(w);
+
+    return (err) ? P3D_IO_ERROR : P3D_SUCCESS;
+}
+
+// Applies an in-core neighborhood filter to a RAW file slab by slab. Since
+// each core slice is processed together with HALO real slices above and below
+// (or with the volume boundary, where the in-core filter applies its usual
+// padding), the result equals the one of the in-core filter applied to the
+// whole volume as long as HALO is not smaller than the filter radius.
+int _p3dSlabFilter(
+        char* in_filename,
+        char* out_filename,
+        const int dimx,
+        const int dimy,
+        const int dimz,
+        const int bytes,
+        const int flagLittle,
+        const int flagSigned,
+        const int slab,
+        const int halo,
+        int (*filter)(void*, void*, const int, const int, const int, void*),
+        void* params,
+        int (*wr_log)(const char*, ...),
+        int (*wr_progress)(const int, ...)
+        ) {
+    struct SlabReader* reader = NULL;
+    struct SlabWriter* writer = NULL;
+    unsigned char* out_slab = NULL;
+    void* in_slab;
+    const size_t slice_size = (size_t) dimx * dimy * ((bytes == 2) ? 2 : 1);
+    int z0, z1, lo, hi;
+    int err;
+
+    P3D_TRY(err = p3dSlabReaderOpen(in_filename, &reader, dimx, dimy, dimz, bytes, flagLittle, flagSigned, slab, halo, wr_log));
+    if (err != P3D_SUCCESS) goto IO_ERROR;
+
+    P3D_TRY(err = p3dSlabWriterOpen(out_filename, &writer, dimx, dimy, dimz, bytes, flagLittle, flagSigned, wr_log));
+    if (err != P3D_SUCCESS) goto IO_ERROR;
+
+    P3D_TRY(out_slab = (unsigned char*) malloc(slice_size * (MIN(MAX(slab, 1), dimz) + 2 * MAX(halo, 0))));
+
+    // Filter slab by slab (next slab is read meanwhile):
+    while (((err = p3dSlabReaderNext(reader, &in_slab, &z0, &z1, &lo, &hi)) == P3D_SUCCESS) && (in_slab != NULL)) {
+        P3D_TRY(filter(in_slab, (void*) out_slab, dimx, dimy, lo + (z1 - z0) + hi, params));
+
+        // Only core slices are written:
+        err = p3dSlabWriterWrite(writer, (void*) (out_slab + lo * slice_size), z1 - z0);
+        if (err != P3D_SUCCESS) goto IO_ERROR;
+
+        // Update any progress bar:
+        if (wr_progress != NULL) wr_progress((int) ((double) z1 / dimz * 100 + 0.5));
+    }
+    if (err != P3D_SUCCESS) goto IO_ERROR;
+
+    // Release resources:
+    p3dSlabReaderClose(reader);
+    err = p3dSlabWriterClose(writer);
+    free(out_slab);
+
+    return err;
+
+MEM_ERROR:
+
+    if (wr_log != NULL) {
+        wr_log("Pore3D - Not enough (contiguous) memory. Program will exit.");
+    }
+
+    // Release resources:
+    p3dSlabReaderClose(reader);
+    p3dSlabWriterClose(writer);
+    if (out_slab != NULL) free(out_slab);
+
+    return P3D_MEM_ERROR;
+
+IO_ERROR:
+
+    if (wr_log != NULL) {
+        wr_log("Pore3D - IO error: error on streaming file %s. Program will exit.", in_filename);
+    }
+
+    // Release resources:
+    p3dSlabReaderClose(reader);
+    p3dSlabWriterClose(writer);
+    if (out_slab != NULL) free(out_slab);
+
+    return P3D_IO_ERROR;
+}
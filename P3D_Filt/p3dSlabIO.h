@@ -0,0 +1,33 @@
+/***************************************************************************/
+/* (C) 2016 Elettra - Sincrotrone Trieste S.C.p.A.. All rights reserved.   */
+/*                                                                         */
+/*                                                                         */
+/* This file is part of Pore3D, a software library for quantitative        */
+/* analysis of 3D (volume) images.                                         */
+/*                                                                         */
+/* Pore3D is free software: you can redistribute it and/or modify it       */
+/* under the terms of the GNU General Public License as published by the   */
+/* Free Software Foundation, either version 3 of the License, or (at your  */
+/* option) any later version.                                              */
+/*                                                                         */
+/* Pore3D is distributed in the hope that it will be useful, but WITHOUT   */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or   */
+/* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License    */
+/* for more details.                                                       */
+/*                                                                         */
+/* You should have received a copy of the GNU General Public License       */
+/* along with Pore3D. If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                         */
+/***************************************************************************/
+
+//
+// Author: Francesco Brun
+// Last modified: October, 16th 2026
+//
+
+// Internal helper for the *_stream variants of neighborhood filters. FILTER
+// is called on each slab with the parameters pointed by PARAMS and it has to
+// return P3D_SUCCESS or P3D_MEM_ERROR as the in-core filters do.
+int _p3dSlabFilter(char*, char*, const int, const int, const int, const int, const int, const int, const int, const int,
+        int (*filter)(void*, void*, const int, const int, const int, void*), void*,
+        int (*wr_log)(const char*, ...), int (*wr_progress)(const int, ...));
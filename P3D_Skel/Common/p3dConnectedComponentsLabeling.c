@@ -332,7 +332,8 @@ int p3dConnectedComponentsLabeling (
 	bb_t curr_bb;
 
 	unsigned short m;			// Current label
-	int ct, offset;   	// Counter for local subvolume size
+	int offset;
+	long long ct;   	// Counter for local subvolume size
 	int a,b,c;
 	int i,j,k;
 	int m_ct;			// Counter for volume counting
@@ -342,9 +343,8 @@ int p3dConnectedComponentsLabeling (
 	int a_dimx, a_dimy, a_dimz;
 	int a_rad;
 
-	// Padded and cropped temporary input and output:
-	unsigned char* tmp_in_rev;
-	unsigned short* tmp_out_rev;
+	// Padded and cropped temporary output:
+	unsigned short* tmp_out_rev = NULL;
  
 	// Pointer to a function for kind of connectivity:
 	void (*conn_fun) ( 
@@ -383,18 +383,18 @@ int p3dConnectedComponentsLabeling (
 	a_dimy = dimy + a_rad*2;
 	a_dimz = dimz + a_rad*2;
 
-	// Initialize input:
-	P3D_MEM_TRY ( tmp_in_rev = (unsigned char*) malloc( a_dimx*a_dimy*a_dimz*sizeof(unsigned char) ) );
-	p3dZeroPadding3D_uchar2uchar ( in_rev, tmp_in_rev, dimx, dimy, dimz, a_rad);
-
-
 	// Initialize output label volume with ON_LABEL on non-zero values
-	// of input volume:
-	P3D_MEM_TRY ( tmp_out_rev = (unsigned short*) malloc( a_dimx*a_dimy*a_dimz*sizeof(unsigned short) ) );
+	// of input volume. The zero border is set directly, i.e. without a
+	// zero padded copy of the input:
+	P3D_MEM_TRY ( tmp_out_rev = (unsigned short*) malloc( (size_t) a_dimx*a_dimy*a_dimz*sizeof(unsigned short) ) );
 	
-	#pragma omp parallel for
-	for (ct = 0; ct < (a_dimx*a_dimy*a_dimz); ct++)
-		tmp_out_rev[ct] = ( tmp_in_rev[ct] ) ? ON_LABEL : 0;			
+	#pragma omp parallel for private(a, b)
+	for (c = 0; c < a_dimz; c++)
+		for (b = 0; b < a_dimy; b++)
+			for (a = 0; a < a_dimx; a++)
+				tmp_out_rev[ I(a,b,c,a_dimx,a_dimy) ] = ( (a < a_rad) || (b < a_rad) || (c < a_rad) ||
+					(a >= (dimx + a_rad)) || (b >= (dimy + a_rad)) || (c >= (dimz + a_rad)) ) ? 0 :
+					( ( in_rev[ I(a - a_rad, b - a_rad, c - a_rad, dimx, dimy) ] ) ? ON_LABEL : 0 );
 
 	
 
@@ -526,7 +526,6 @@ int p3dConnectedComponentsLabeling (
 
 
 	// Release resources:
-	if ( tmp_in_rev != NULL ) free(tmp_in_rev);
 	if ( tmp_out_rev != NULL ) free(tmp_out_rev);
 
 	// Return OK:
@@ -535,8 +534,7 @@ int p3dConnectedComponentsLabeling (
 MEM_ERROR: 
 
 	// Release resources:
-	if (tmp_in_rev != NULL) free(tmp_in_rev);
-	if (tmp_out_rev != NULL) free(tmp_in_rev);
+	if (tmp_out_rev != NULL) free(tmp_out_rev);
 
 	// Return error code:
 	return P3D_ERROR;
@@ -566,10 +564,10 @@ int p3dGetMaxVolumeRegion (
 	int err_code;
 
 	// Initialize output by cloning input:
-	memcpy(out_rev, in_rev, dimx*dimy*dimz*sizeof(unsigned char));
+	memcpy(out_rev, in_rev, (size_t) dimx*dimy*dimz*sizeof(unsigned char));
 
 	// Allocate memory for labels REV:
-	lbl_rev = (unsigned short*) malloc (dimx*dimy*dimz*sizeof(unsigned short));
+	lbl_rev = (unsigned short*) malloc ((size_t) dimx*dimy*dimz*sizeof(unsigned short));
 
 	if ( lbl_rev == NULL )
 	{
@@ -412,12 +412,12 @@ int p3dSquaredEuclideanDT(
 	int_type* tmp_out_rev;
 
 	// Counter:
-	int i;
+	long long i;
 
 
 	// Allocate temporary output:
-	P3D_TRY ( tmp_out_rev = (int_type*) malloc(dimx*dimy*dimz*sizeof(int_type)) );
-	P3D_TRY ( tmp_rev = (int_type*) malloc( dimx*dimy*dimz*sizeof(int_type) ) );
+	P3D_TRY ( tmp_out_rev = (int_type*) malloc((size_t) dimx*dimy*dimz*sizeof(int_type)) );
+	P3D_TRY ( tmp_rev = (int_type*) malloc( (size_t) dimx*dimy*dimz*sizeof(int_type) ) );
 
     // Compute transform:
     P3D_TRY ( stepX ( in_rev, tmp_out_rev, dimx, dimy, dimz ) );
@@ -425,7 +425,7 @@ int p3dSquaredEuclideanDT(
     P3D_TRY ( stepZ ( tmp_rev, tmp_out_rev, dimx, dimy, dimz ) ); 
 
 	// Cast output from int_type to unsigned short:
-	for ( i = 0; i < (dimx*dimy*dimz); i++)
+	for ( i = 0; i < ((long long) dimx*dimy*dimz); i++)
 		out_rev[i] = (tmp_out_rev[i] > USHRT_MAX) ? USHRT_MAX : (unsigned short) ( tmp_out_rev[i] );
 
     
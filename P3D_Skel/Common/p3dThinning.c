@@ -500,7 +500,7 @@ void transformNeigh ( int n[27], int dir, int USn[27] )
 void markBoundary ( unsigned char *vol, int L, int M, int N, int dir )
 {
 	int slsz = L*M;
-	int idx;
+	long long idx;
 	int i, j, k;
 
 
@@ -536,7 +536,7 @@ void markBoundary ( unsigned char *vol, int L, int M, int N, int dir )
 		for( j = 1; j < (M-1); j++ ) 
 			for( i = 1; i < (L-1); i++ ) 
 			{
-				idx = k*slsz + j*L + i;
+				idx = (long long) k*slsz + j*L + i;
 
 				if( (vol[idx] == OBJECT) && ( vol[idx + nb[dir]] == 0) ) 
 				{
@@ -553,9 +553,9 @@ void markBoundary ( unsigned char *vol, int L, int M, int N, int dir )
 
 
 
-void bufferizeNeigh ( unsigned char *vol, int idx, int nb[27], const int volNeigh[27] )
+void bufferizeNeigh ( unsigned char *vol, long long idx, int nb[27], const int volNeigh[27] )
 {
-	int nidx;
+	long long nidx;
 	int i, j, k, ii;
 
 	ii = 0;
@@ -582,7 +582,7 @@ int p3dThinning (
 	int dir;
 	int nb[27];
 	int USn[27];
-	int idx;
+	long long idx;
 	int i, j, k;
 
 	// Initialize neighbors array:
@@ -736,7 +736,7 @@ int p3dThinning (
 
 			// Reset all object voxels to OBJECT and delete simple points:
 			#pragma omp parallel for
-			for( idx = 0; idx < (dimx*dimy*dimz); idx++ ) 
+			for( idx = 0; idx < ((long long) dimx*dimy*dimz); idx++ ) 
 			{
 				if(in_rev[idx] == SIMPLE) in_rev[idx] = BACKGROUND;
 				if(in_rev[idx] != BACKGROUND) in_rev[idx] = OBJECT;
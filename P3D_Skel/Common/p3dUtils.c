@@ -965,7 +965,7 @@ int p3dZeroPadding3D_uchar2float (
 	a_dimz = dimz + size*2;
 
 	// Set to zero all values:
-	memset( out_rev, 0, a_dimx*a_dimy*a_dimz*sizeof(float) );
+	memset( out_rev, 0, (size_t) a_dimx*a_dimy*a_dimz*sizeof(float) );
 
 
 	// Copy original (internal) values:
@@ -998,7 +998,7 @@ int p3dZeroPadding3D_uchar2uchar (
 	a_dimz = dimz + size*2;
 
 	// Set to zero all values:
-	memset( out_rev, 0, a_dimx*a_dimy*a_dimz*sizeof(unsigned char) );
+	memset( out_rev, 0, (size_t) a_dimx*a_dimy*a_dimz*sizeof(unsigned char) );
 
 
 	// Copy original (internal) values:
@@ -1012,6 +1012,39 @@ int p3dZeroPadding3D_uchar2uchar (
 	return P3D_SUCCESS;
 }
 
+int p3dZeroPadding3D_view2uchar (	
+    struct VolumeView* in_view,
+	unsigned char* out_rev,
+	const int size
+	)
+{
+	unsigned char* in_rev = (unsigned char*) in_view->base + IV(0,0,0,in_view);
+	const int dimx = in_view->dimx;
+	const int dimy = in_view->dimy;
+	const int dimz = in_view->dimz;
+	int a_dimx, a_dimy, a_dimz;
+	int i,j,k;
+
+	// Compute dimensions of padded REV:
+	a_dimx = dimx + size*2;
+	a_dimy = dimy + size*2;
+	a_dimz = dimz + size*2;
+
+	// Set to zero all values:
+	memset( out_rev, 0, (size_t) a_dimx*a_dimy*a_dimz*sizeof(unsigned char) );
+
+
+	// Copy original (internal) values reading through the strides of the view:
+	for (k = 0; k < dimz; k++)
+		for (j = 0; j < dimy; j++)
+			for (i = 0; i < dimx; i++)			
+				out_rev[ I( i + size, j + size, k + size, a_dimx, a_dimy ) ] = 
+					in_rev[ IS( i, j, k, in_view->stridey, in_view->stridez ) ];
+
+	// Return OK:
+	return P3D_SUCCESS;
+}
+
 
 int p3dReplicatePadding3D_uchar2uchar (	
 	unsigned char* in_rev,
@@ -1276,7 +1309,7 @@ int p3dSpecialPadding3D_uchar2uchar (
 
 
 	// Set to zero all values:
-	memset( out_rev, 0, a_dimx*a_dimy*a_dimz*sizeof(unsigned char) );
+	memset( out_rev, 0, (size_t) a_dimx*a_dimy*a_dimz*sizeof(unsigned char) );
 
 
 	// Copy original (internal) values converting 255 to 1:
@@ -82,7 +82,7 @@
 #ifndef P3D_GVF_MACROS
 	#define P3D_GVF_MACROS
 
-	#define I(i,j,k,N,M)    ( (j)*(N) + (i) + (k)*(N)*(M) ) 
+	#define I(i,j,k,N,M)    ( (size_t)(j)*(N) + (i) + (size_t)(k)*(N)*(M) ) 
 	#define MIN(x,y)        (((x) < (y))?(x):(y))
 	#define MAX(x,y)        (((x) > (y))?(x):(y))
 
@@ -100,6 +100,9 @@
 
 #endif
 
+	// Strided sub-volumes (struct VolumeView):
+	#include "../../P3D_Common/p3dVolumeView.h"
+
 /*
 	Functions:
 */
@@ -181,6 +184,12 @@ int p3dZeroPadding3D_uchar2uchar (
 	const int size
 	);
 
+int p3dZeroPadding3D_view2uchar (	
+    struct VolumeView* in_view,
+	unsigned char* out_im,
+	const int size
+	);
+
 int p3dReplicatePadding3D_uchar2uchar (	
 	unsigned char* in_im,
 	unsigned char* out_im,
@@ -100,7 +100,8 @@ int p3dGVF (
 	int rad = 1;
 	int ct  = 0;
 
-	int i,j,k;
+	int j, k;
+	long long i;
 
 	double r;
 	float  tmp_x, tmp_y, tmp_z;
@@ -215,7 +216,7 @@ int p3dGVF (
 	//
 
 	#pragma omp parallel for private(r)
-	for ( i = 0; i < (dimx*dimy*dimz); i++)
+	for ( i = 0; i < ((long long) dimx*dimy*dimz); i++)
 	{
 		if( in_im[ i ] != BACKGROUND ) 
 		{	  
@@ -124,15 +124,15 @@ int p3dGVFSkeletonization(
     a_dimz = (int) ((double) (dimz) * scale + 0.5) + a_rad * 2;
 
     // Reset output image:
-    memset(skl_im, 0, dimx * dimy * dimz * sizeof (unsigned char));
+    memset(skl_im, 0, (size_t) dimx * dimy * dimz * sizeof (unsigned char));
 
     // Init gradient vector flow:
-    P3D_TRY(gvf_x = (float*) calloc(a_dimx * a_dimy*a_dimz, sizeof (float)));
-    P3D_TRY(gvf_y = (float*) calloc(a_dimx * a_dimy*a_dimz, sizeof (float)));
-    P3D_TRY(gvf_z = (float*) calloc(a_dimx * a_dimy*a_dimz, sizeof (float)));
+    P3D_TRY(gvf_x = (float*) calloc((size_t) a_dimx * a_dimy*a_dimz, sizeof (float)));
+    P3D_TRY(gvf_y = (float*) calloc((size_t) a_dimx * a_dimy*a_dimz, sizeof (float)));
+    P3D_TRY(gvf_z = (float*) calloc((size_t) a_dimx * a_dimy*a_dimz, sizeof (float)));
 
     // Zero padding for temporary image (values 255 are replaced with 1):	
-    P3D_TRY(tmp_im = (unsigned char*) calloc(a_dimx * a_dimy*a_dimz, sizeof (unsigned char)));
+    P3D_TRY(tmp_im = (unsigned char*) calloc((size_t) a_dimx * a_dimy*a_dimz, sizeof (unsigned char)));
 
     //#pragma omp parallel for private(i, j)
     for (k = a_rad; k < (a_dimz - a_rad); k++)
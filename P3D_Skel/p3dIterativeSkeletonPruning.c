@@ -89,11 +89,11 @@ int p3dIterativeSkeletonPruning(
 	a_dimz = dimz + a_rad*2;
 
 	// Initialize input:
-	P3D_TRY( tmp_im = (unsigned char*) malloc( a_dimx*a_dimy*a_dimz*sizeof(unsigned char) ) );
+	P3D_TRY( tmp_im = (unsigned char*) malloc( (size_t) a_dimx*a_dimy*a_dimz*sizeof(unsigned char) ) );
 	P3D_TRY( p3dZeroPadding3D_uchar2uchar ( in_im, tmp_im, dimx, dimy, dimz, a_rad ) );
 	
-	P3D_TRY( tmp_im2 = (unsigned char*) malloc( a_dimx*a_dimy*a_dimz*sizeof(unsigned char) ) );
-	memcpy ( tmp_im2, tmp_im, a_dimx*a_dimy*a_dimz*sizeof(unsigned char) );
+	P3D_TRY( tmp_im2 = (unsigned char*) malloc( (size_t) a_dimx*a_dimy*a_dimz*sizeof(unsigned char) ) );
+	memcpy ( tmp_im2, tmp_im, (size_t) a_dimx*a_dimy*a_dimz*sizeof(unsigned char) );
 
 
 	// Initialize number of pruned objects:
@@ -234,7 +234,7 @@ int p3dIterativeSkeletonPruning(
 					}
 
 			// Copy tmp_im2 into tmp_im:
-			memcpy ( tmp_im, tmp_im2, a_dimx*a_dimy*a_dimz*sizeof(unsigned char) );
+			memcpy ( tmp_im, tmp_im2, (size_t) a_dimx*a_dimy*a_dimz*sizeof(unsigned char) );
 		}
 	}
 
@@ -346,15 +346,16 @@ int isEulerInvariant(
 		return P3D_FALSE;
 }
 
-int p3dLKCSkeletonization(   
-	unsigned char* in_im, 
-	unsigned char* out_im, 
-	const int dimx,
-	const int dimy, 
-	const int dimz,
+int p3dLKCSkeletonization_view(   
+	struct VolumeView* in_view,	// IN: input view
+	unsigned char* out_im,		// OUT: skeleton (dimensions of the view)
 	int (*wr_log)(const char*, ...)
 	)
 {
+	// Dimensions of the input view:
+	const int dimx = in_view->dimx;
+	const int dimy = in_view->dimy;
+	const int dimz = in_view->dimz;
 
 	unsigned char* tmp_im;	
 	
@@ -400,8 +401,8 @@ int p3dLKCSkeletonization(
 
 	// Init output voume with input volume values zero padded:
 	P3D_TRY( eulerLUT = (int*) calloc(256,sizeof(int)) );
-	P3D_TRY( tmp_im = (unsigned char*) malloc( a_dimx*a_dimy*a_dimz*sizeof(unsigned char) ) );
-	P3D_TRY( p3dZeroPadding3D_uchar2uchar ( in_im, tmp_im, dimx, dimy, dimz, a_rad ) );
+	P3D_TRY( tmp_im = (unsigned char*) malloc( (size_t) a_dimx*a_dimy*a_dimz*sizeof(unsigned char) ) );
+	P3D_TRY( p3dZeroPadding3D_view2uchar ( in_view, tmp_im, a_rad ) );
 
 	// Prepare Euler LUT:
 	fillEulerLUT( eulerLUT );
@@ -555,3 +556,28 @@ MEM_ERROR:
     return P3D_AUTH_ERROR;*/
 }
 
+int p3dLKCSkeletonization(   
+	unsigned char* in_im, 
+	unsigned char* out_im, 
+	const int dimx,
+	const int dimy, 
+	const int dimz,
+	int (*wr_log)(const char*, ...)
+	)
+{
+	struct VolumeView in_view;
+
+	// The whole input volume is a view of itself:
+	in_view.base = in_im;
+	in_view.dimx = dimx;
+	in_view.dimy = dimy;
+	in_view.dimz = dimz;
+	in_view.orgx = 0;
+	in_view.orgy = 0;
+	in_view.orgz = 0;
+	in_view.stridey = (size_t) dimx;
+	in_view.stridez = (size_t) dimx*dimy;
+
+	return p3dLKCSkeletonization_view ( &in_view, out_im, wr_log );
+}
+
@@ -66,8 +66,8 @@ extern "C" {
 	#ifndef P3D_MACROS
 	#define P3D_MACROS
 
-	#define I(i,j,k,N,M)    ( (j)*(N) + (i) + (k)*(N)*(M) ) 
-	#define I2(i,j,N)       ( (j)*(N) + (i) ) 
+	#define I(i,j,k,N,M)    ( (size_t)(j)*(N) + (i) + (size_t)(k)*(N)*(M) ) 
+	#define I2(i,j,N)       ( (size_t)(j)*(N) + (i) ) 
 	#define MIN(x,y)        (((x) < (y))?(x):(y))
 	#define MAX(x,y)        (((x) > (y))?(x):(y))
 
@@ -75,6 +75,9 @@ extern "C" {
 	#define P3D_TRY( function ) if ( (function) == P3D_MEM_ERROR) { goto MEM_ERROR; }
 	#endif
 
+	// Strided sub-volumes (struct VolumeView):
+	#include "../P3D_Common/p3dVolumeView.h"
+
 	#ifndef STRUCTS_DEFINED
 	#define STRUCTS_DEFINED  
 
@@ -148,6 +151,18 @@ extern "C" {
 		int (*wr_log)(const char*, ...)
 		);
 
+	int p3dThinningSkeletonization_view(   
+		struct VolumeView* in_view,	// IN: input view
+		unsigned char* out_im,		// OUT: skeleton (dimensions of the view)
+		int (*wr_log)(const char*, ...)
+		);
+
+	int p3dLKCSkeletonization_view(   
+		struct VolumeView* in_view,	// IN: input view
+		unsigned char* out_im,		// OUT: skeleton (dimensions of the view)
+		int (*wr_log)(const char*, ...)
+		);
+
 	int p3dSimpleSkeletonPruning(   
 		unsigned char* in_im,		// IN: Input (binary) skeleton
 		unsigned char* out_im,		// OUT: Labeled skeleton
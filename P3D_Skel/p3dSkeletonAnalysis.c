@@ -60,7 +60,7 @@ int __p3dTmpWriteRaw8(
     }
 
     /* Write raw data to file: */
-    fwrite(in_im, sizeof (unsigned char), dimx * dimy*dimz, fvol);
+    fwrite(in_im, sizeof (unsigned char), (size_t) dimx * dimy*dimz, fvol);
 
     /* Close file handler: */
     fclose(fvol);
@@ -100,7 +100,7 @@ int __p3dTmpWriteRaw16(
     FILE* fvol;
     short* s_tmp_im = NULL;
     unsigned short* us_tmp_im = NULL;
-    int ct;
+    long long ct;
 
     // Start tracking computational time:
     if (wr_log != NULL) {
@@ -126,10 +126,10 @@ int __p3dTmpWriteRaw16(
 
     /* Read data signed/unsigned: */
     if (flagSigned == P3D_TRUE) {
-        s_tmp_im = (short*) malloc(dimx * dimy * dimz * sizeof (short));
+        s_tmp_im = (short*) malloc((size_t) dimx * dimy * dimz * sizeof (short));
 
         /* Convert to signed: */
-        for (ct = 0; ct < (dimx * dimy * dimz); ct++) {
+        for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++) {
             if (flagLittle == P3D_FALSE) {
                 s_tmp_im[ct] = _EndianSwapSignedShort((short) (in_im[ct] - USHRT_MAX / 2));
             } else {
@@ -139,7 +139,7 @@ int __p3dTmpWriteRaw16(
 
         /* Write raw data to file: */
         //fwrite(s_tmp_im, sizeof (short), dimx*dimy, fvol);
-        if (fwrite(s_tmp_im, sizeof (short), dimx * dimy * dimz, fvol) < (dimx * dimy * dimz)) {
+        if (fwrite(s_tmp_im, sizeof (short), (size_t) dimx * dimy * dimz, fvol) < ((size_t) dimx * dimy * dimz)) {
             wr_log("Pore3D - IO error: error on writing file %s. Program will exit.", filename);
 
             return P3D_ERROR;
@@ -150,14 +150,14 @@ int __p3dTmpWriteRaw16(
     } else {
         /* Swap endian if necessary: */
         if (flagLittle == P3D_FALSE) {
-            us_tmp_im = (unsigned short*) malloc(dimx * dimy * dimz * sizeof (unsigned short));
+            us_tmp_im = (unsigned short*) malloc((size_t) dimx * dimy * dimz * sizeof (unsigned short));
 
-            for (ct = 0; ct < (dimx * dimy * dimz); ct++) {
+            for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++) {
                 us_tmp_im[ct] = _EndianSwapUnsignedShort(in_im[ct]);
             }
 
             //fwrite(us_tmp_im, sizeof (unsigned short), dimx*dimy, fvol);
-            if (fwrite(us_tmp_im, sizeof (unsigned short), dimx * dimy * dimz, fvol) < (dimx * dimy * dimz)) {
+            if (fwrite(us_tmp_im, sizeof (unsigned short), (size_t) dimx * dimy * dimz, fvol) < ((size_t) dimx * dimy * dimz)) {
                 wr_log("Pore3D - IO error: error on writing file %s. Program will exit.", filename);
 
                 return P3D_ERROR;
@@ -165,7 +165,7 @@ int __p3dTmpWriteRaw16(
 
             free(us_tmp_im);
         } else {
-            fwrite(in_im, sizeof (unsigned short), dimx * dimy * dimz, fvol);
+            fwrite(in_im, sizeof (unsigned short), (size_t) dimx * dimy * dimz, fvol);
         }
     }
 
@@ -944,7 +944,7 @@ int _p3dSkeletonAnalysis_EndPoints(
     double delta;
 
     // Allocate memory:
-    P3D_TRY(tmp_im = (unsigned short*) calloc(dimx * dimy*dimz, sizeof (unsigned short)));
+    P3D_TRY(tmp_im = (unsigned short*) calloc((size_t) dimx * dimy*dimz, sizeof (unsigned short)));
 
     // Fill the balls:
 #pragma omp parallel for private(i, j, rad, a, b, c, delta)
@@ -1062,8 +1062,8 @@ int _p3dSkeletonAnalysis_NodePoints(
 
 
     // Allocate memory:	
-    P3D_TRY(tmp_im = (unsigned short*) calloc(dimx * dimy*dimz, sizeof (unsigned short)));
-    P3D_TRY(tmp_roi = (unsigned short*) malloc(dimx * dimy * dimz * sizeof (unsigned short)));
+    P3D_TRY(tmp_im = (unsigned short*) calloc((size_t) dimx * dimy*dimz, sizeof (unsigned short)));
+    P3D_TRY(tmp_roi = (unsigned short*) malloc((size_t) dimx * dimy * dimz * sizeof (unsigned short)));
 
     // A ball is filled on each node voxel. The radius of this ball is the value of 
     // the distance transform on the node voxel. While, in principle, the medialness
@@ -1131,7 +1131,7 @@ int _p3dSkeletonAnalysis_NodePoints(
             max_width = 0.0;
 
             // Reset the copy of the ROI of the bounding box:
-            memset(tmp_roi, 0, dimx * dimy * dimz * sizeof (unsigned short));
+            memset(tmp_roi, 0, (size_t) dimx * dimy * dimz * sizeof (unsigned short));
 
             // Scan the bounding box of the cluster of balls:			
             for (k = (curr_bb.min_z - offset); k <= (curr_bb.max_z + offset); k++)
@@ -1286,7 +1286,8 @@ int _p3dSkeletonAnalysis_NodeToNodeBranches(
     bb_t* bbs = NULL;
     bb_t curr_bb;
 
-    int ct, i, j, k, a, b, c, rad;
+    int i, j, k, a, b, c, rad;
+    long long ct;
     int min_coord_x, min_coord_y, min_coord_z;
 
 
@@ -1295,8 +1296,8 @@ int _p3dSkeletonAnalysis_NodeToNodeBranches(
     //
 
     // Allocate memory for temp image skeleton:
-    P3D_TRY(tmp_im = (unsigned char*) calloc(dimx * dimy*dimz, sizeof (unsigned char)));
-    P3D_TRY(tmp_im2 = (unsigned short*) calloc(dimx * dimy*dimz, sizeof (unsigned short)));
+    P3D_TRY(tmp_im = (unsigned char*) calloc((size_t) dimx * dimy*dimz, sizeof (unsigned char)));
+    P3D_TRY(tmp_im2 = (unsigned short*) calloc((size_t) dimx * dimy*dimz, sizeof (unsigned short)));
 
 
 
@@ -1304,7 +1305,7 @@ int _p3dSkeletonAnalysis_NodeToNodeBranches(
     // branch outside nodes_im, i.e. the image with filled balls on skeleton nodes, is 
     // taken into acccount.
 #pragma omp parallel for
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++) {
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++) {
         if (lbl_skl_im[ ct ] == NODETONODE_LABEL) {
             tmp_im [ ct ] = OBJECT;
         }
@@ -1447,7 +1448,8 @@ int _p3dSkeletonAnalysis_NodeToEndBranches(
     bb_t* bbs = NULL;
     bb_t curr_bb;
 
-    int ct, i, j, k;
+    int i, j, k;
+    long long ct;
 
 
     //
@@ -1455,8 +1457,8 @@ int _p3dSkeletonAnalysis_NodeToEndBranches(
     //
 
     // Allocate memory for temp image skeleton:
-    P3D_TRY(tmp_im = (unsigned char*) calloc(dimx * dimy*dimz, sizeof (unsigned char)));
-    P3D_TRY(tmp_im2 = (unsigned short*) calloc(dimx * dimy*dimz, sizeof (unsigned short)));
+    P3D_TRY(tmp_im = (unsigned char*) calloc((size_t) dimx * dimy*dimz, sizeof (unsigned char)));
+    P3D_TRY(tmp_im2 = (unsigned short*) calloc((size_t) dimx * dimy*dimz, sizeof (unsigned short)));
 
 
     // Create temporary matrix removing the filled balls. Doing so, only the part of a 
@@ -1464,7 +1466,7 @@ int _p3dSkeletonAnalysis_NodeToEndBranches(
     // outside ends_im, i.e. the image with filled balls on skeleton ends, is taken into 
     // acccount.
 #pragma omp parallel for
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++) {
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++) {
         if (lbl_skl_im[ ct ] == NODETOEND_LABEL) {
             tmp_im [ ct ] = OBJECT;
         }
@@ -1578,7 +1580,8 @@ int _p3dSkeletonAnalysis_EndToEndBranches(
     bb_t* bbs = NULL;
     bb_t curr_bb;
 
-    int ct, i, j, k;
+    int i, j, k;
+    long long ct;
 
 
 
@@ -1588,19 +1591,19 @@ int _p3dSkeletonAnalysis_EndToEndBranches(
     //
 
     // Allocate memory for labeled skeleton:
-    P3D_TRY(tmp_im = (unsigned char*) malloc(dimx * dimy * dimz * sizeof (unsigned char)));
-    P3D_TRY(tmp_im2 = (unsigned short*) malloc(dimx * dimy * dimz * sizeof (unsigned short)));
+    P3D_TRY(tmp_im = (unsigned char*) malloc((size_t) dimx * dimy * dimz * sizeof (unsigned char)));
+    P3D_TRY(tmp_im2 = (unsigned short*) malloc((size_t) dimx * dimy * dimz * sizeof (unsigned short)));
 
 
     // Set memory of tmp_im:
-    memset(tmp_im, BACKGROUND, dimx * dimy * dimz * sizeof (unsigned char));
+    memset(tmp_im, BACKGROUND, (size_t) dimx * dimy * dimz * sizeof (unsigned char));
 
 
     // Create temporary matrix removing the filled balls. Doing so, only the part of a 
     // branch outside ends_im, i.e. the image with filled balls on skeleton ends, is 
     // taken into acccount.
 #pragma omp parallel for
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++) {
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++) {
         if (lbl_skl_im[ ct ] == ENDTOEND_LABEL) {
             // Assign temporary image:
             tmp_im [ ct ] = OBJECT;
@@ -1728,24 +1731,24 @@ int p3dSkeletonAnalysis(
     // Allocate memory:
     if (nodes_im == NULL) {
         flag_nodes_null = P3D_TRUE;
-        P3D_TRY(nodes_im = (unsigned char*) calloc(dimx * dimy*dimz, sizeof (unsigned char)));
+        P3D_TRY(nodes_im = (unsigned char*) calloc((size_t) dimx * dimy*dimz, sizeof (unsigned char)));
     }
     if (pores_im == NULL) {
         flag_pores_null = P3D_TRUE;
-        P3D_TRY(pores_im = (unsigned char*) calloc(dimx * dimy*dimz, sizeof (unsigned char)));
+        P3D_TRY(pores_im = (unsigned char*) calloc((size_t) dimx * dimy*dimz, sizeof (unsigned char)));
     }
     if (ends_im == NULL) {
         flag_ends_null = P3D_TRUE;
-        P3D_TRY(ends_im = (unsigned char*) calloc(dimx * dimy*dimz, sizeof (unsigned char)));
+        P3D_TRY(ends_im = (unsigned char*) calloc((size_t) dimx * dimy*dimz, sizeof (unsigned char)));
     }
     if (throats_im == NULL) {
         flag_throats_null = P3D_TRUE;
-        P3D_TRY(throats_im = (unsigned char*) calloc(dimx * dimy*dimz, sizeof (unsigned char)));
+        P3D_TRY(throats_im = (unsigned char*) calloc((size_t) dimx * dimy*dimz, sizeof (unsigned char)));
     }
 
-    P3D_TRY(dt_im = (unsigned short*) malloc(dimx * dimy * dimz * sizeof (unsigned short)));
-    P3D_TRY(max_skl_im = (unsigned char*) malloc(dimx * dimy * dimz * sizeof (unsigned char)));
-    P3D_TRY(lbl_skl_im = (unsigned char*) malloc(dimx * dimy * dimz * sizeof (unsigned char)));
+    P3D_TRY(dt_im = (unsigned short*) malloc((size_t) dimx * dimy * dimz * sizeof (unsigned short)));
+    P3D_TRY(max_skl_im = (unsigned char*) malloc((size_t) dimx * dimy * dimz * sizeof (unsigned char)));
+    P3D_TRY(lbl_skl_im = (unsigned char*) malloc((size_t) dimx * dimy * dimz * sizeof (unsigned char)));
 
 
     // Compute distance transform for further use:
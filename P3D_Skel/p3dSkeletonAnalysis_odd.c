@@ -568,7 +568,7 @@ int _p3dSkeletonAnalysis_EndPoints(
     double delta;
 
     // Allocate memory:
-    P3D_TRY(tmp_im = (unsigned short*) calloc(dimx * dimy*dimz, sizeof (unsigned short)));
+    P3D_TRY(tmp_im = (unsigned short*) calloc((size_t) dimx * dimy*dimz, sizeof (unsigned short)));
 
     // Fill the balls:
 #pragma omp parallel for private(i, j, rad, a, b, c, delta)
@@ -687,8 +687,8 @@ int _p3dSkeletonAnalysis_NodePoints(
 
 
     // Allocate memory:	
-    P3D_TRY(tmp_im = (unsigned short*) calloc(dimx * dimy*dimz, sizeof (unsigned short)));
-    P3D_TRY(tmp_roi = (unsigned short*) malloc(dimx * dimy * dimz * sizeof (unsigned short)));
+    P3D_TRY(tmp_im = (unsigned short*) calloc((size_t) dimx * dimy*dimz, sizeof (unsigned short)));
+    P3D_TRY(tmp_roi = (unsigned short*) malloc((size_t) dimx * dimy * dimz * sizeof (unsigned short)));
 
     // A ball is filled on each node voxel. The radius of this ball is the value of 
     // the distance transform on the node voxel. While, in principle, the medialness
@@ -747,7 +747,7 @@ int _p3dSkeletonAnalysis_NodePoints(
             max_width = 0.0;
 
             // Reset the copy of the ROI of the bounding box:
-            memset(tmp_roi, 0, dimx * dimy * dimz * sizeof (unsigned short));
+            memset(tmp_roi, 0, (size_t) dimx * dimy * dimz * sizeof (unsigned short));
 
             // Scan the bounding box of the cluster of balls:			
             for (k = (curr_bb.min_z - offset); k <= (curr_bb.max_z + offset); k++)
@@ -829,7 +829,7 @@ int _p3dSkeletonAnalysis_NodePoints(
                 max_width = 0.0;
 
                 // Reset the copy of the ROI of the bounding box:
-                memset(tmp_roi, 0, dimx * dimy * dimz * sizeof (unsigned short));
+                memset(tmp_roi, 0, (size_t) dimx * dimy * dimz * sizeof (unsigned short));
 
                 // Scan the bounding box of the cluster of balls:			
                 for (k = (curr_bb.min_z - offset); k <= (curr_bb.max_z + offset); k++)
@@ -986,7 +986,8 @@ int _p3dSkeletonAnalysis_NodeToNodeBranches(
     bb_t* bbs = NULL;
     bb_t curr_bb;
 
-    int ct, i, j, k, a, b, c, skip_throat, rad;
+    int i, j, k, a, b, c, skip_throat, rad;
+    long long ct;
     int min_coord_x, min_coord_y, min_coord_z;
 
 
@@ -995,8 +996,8 @@ int _p3dSkeletonAnalysis_NodeToNodeBranches(
     //
 
     // Allocate memory for temp image skeleton:
-    P3D_TRY(tmp_im = (unsigned char*) calloc(dimx * dimy*dimz, sizeof (unsigned char)));
-    P3D_TRY(tmp_im2 = (unsigned short*) calloc(dimx * dimy*dimz, sizeof (unsigned short)));
+    P3D_TRY(tmp_im = (unsigned char*) calloc((size_t) dimx * dimy*dimz, sizeof (unsigned char)));
+    P3D_TRY(tmp_im2 = (unsigned short*) calloc((size_t) dimx * dimy*dimz, sizeof (unsigned short)));
 
 
 
@@ -1004,7 +1005,7 @@ int _p3dSkeletonAnalysis_NodeToNodeBranches(
     // branch outside nodes_im, i.e. the image with filled balls on skeleton nodes, is 
     // taken into acccount.
 #pragma omp parallel for
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++) {
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++) {
         if (lbl_skl_im[ ct ] == NODETONODE_LABEL) {
             tmp_im [ ct ] = OBJECT;
         }
@@ -1147,7 +1148,8 @@ int _p3dSkeletonAnalysis_NodeToEndBranches(
     bb_t* bbs = NULL;
     bb_t curr_bb;
 
-    int ct, i, j, k;
+    int i, j, k;
+    long long ct;
 
 
     //
@@ -1155,8 +1157,8 @@ int _p3dSkeletonAnalysis_NodeToEndBranches(
     //
 
     // Allocate memory for temp image skeleton:
-    P3D_TRY(tmp_im = (unsigned char*) calloc(dimx * dimy*dimz, sizeof (unsigned char)));
-    P3D_TRY(tmp_im2 = (unsigned short*) calloc(dimx * dimy*dimz, sizeof (unsigned short)));
+    P3D_TRY(tmp_im = (unsigned char*) calloc((size_t) dimx * dimy*dimz, sizeof (unsigned char)));
+    P3D_TRY(tmp_im2 = (unsigned short*) calloc((size_t) dimx * dimy*dimz, sizeof (unsigned short)));
 
 
     // Create temporary matrix removing the filled balls. Doing so, only the part of a 
@@ -1164,7 +1166,7 @@ int _p3dSkeletonAnalysis_NodeToEndBranches(
     // outside ends_im, i.e. the image with filled balls on skeleton ends, is taken into 
     // acccount.
 #pragma omp parallel for
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++) {
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++) {
         if (lbl_skl_im[ ct ] == NODETOEND_LABEL) {
             tmp_im [ ct ] = OBJECT;
         }
@@ -1278,7 +1280,8 @@ int _p3dSkeletonAnalysis_EndToEndBranches(
     bb_t* bbs = NULL;
     bb_t curr_bb;
 
-    int ct, i, j, k;
+    int i, j, k;
+    long long ct;
 
 
 
@@ -1288,19 +1291,19 @@ int _p3dSkeletonAnalysis_EndToEndBranches(
     //
 
     // Allocate memory for labeled skeleton:
-    P3D_TRY(tmp_im = (unsigned char*) malloc(dimx * dimy * dimz * sizeof (unsigned char)));
-    P3D_TRY(tmp_im2 = (unsigned short*) malloc(dimx * dimy * dimz * sizeof (unsigned short)));
+    P3D_TRY(tmp_im = (unsigned char*) malloc((size_t) dimx * dimy * dimz * sizeof (unsigned char)));
+    P3D_TRY(tmp_im2 = (unsigned short*) malloc((size_t) dimx * dimy * dimz * sizeof (unsigned short)));
 
 
     // Set memory of tmp_im:
-    memset(tmp_im, BACKGROUND, dimx * dimy * dimz * sizeof (unsigned char));
+    memset(tmp_im, BACKGROUND, (size_t) dimx * dimy * dimz * sizeof (unsigned char));
 
 
     // Create temporary matrix removing the filled balls. Doing so, only the part of a 
     // branch outside ends_im, i.e. the image with filled balls on skeleton ends, is 
     // taken into acccount.
 #pragma omp parallel for
-    for (ct = 0; ct < (dimx * dimy * dimz); ct++) {
+    for (ct = 0; ct < ((long long) dimx * dimy * dimz); ct++) {
         if (lbl_skl_im[ ct ] == ENDTOEND_LABEL) {
             // Assign temporary image:
             tmp_im [ ct ] = OBJECT;
@@ -1436,23 +1439,23 @@ int p3dSkeletonAnalysis(
     // Allocate memory:
     if (nodes_im == NULL) {
         flag_nodes_null = P3D_TRUE;
-        P3D_TRY(nodes_im = (unsigned char*) calloc(dimx * dimy*dimz, sizeof (unsigned char)));
+        P3D_TRY(nodes_im = (unsigned char*) calloc((size_t) dimx * dimy*dimz, sizeof (unsigned char)));
     }
     if (pores_im == NULL) {
         flag_pores_null = P3D_TRUE;
-        P3D_TRY(pores_im = (unsigned char*) calloc(dimx * dimy*dimz, sizeof (unsigned char)));
+        P3D_TRY(pores_im = (unsigned char*) calloc((size_t) dimx * dimy*dimz, sizeof (unsigned char)));
     }
     if (ends_im == NULL) {
         flag_ends_null = P3D_TRUE;
-        P3D_TRY(ends_im = (unsigned char*) calloc(dimx * dimy*dimz, sizeof (unsigned char)));
+        P3D_TRY(ends_im = (unsigned char*) calloc((size_t) dimx * dimy*dimz, sizeof (unsigned char)));
     }
     if (throats_im == NULL) {
         flag_throats_null = P3D_TRUE;
-        P3D_TRY(throats_im = (unsigned char*) calloc(dimx * dimy*dimz, sizeof (unsigned char)));
+        P3D_TRY(throats_im = (unsigned char*) calloc((size_t) dimx * dimy*dimz, sizeof (unsigned char)));
     }
 
-    P3D_TRY(dt_im = (unsigned short*) malloc(dimx * dimy * dimz * sizeof (unsigned short)));
-    P3D_TRY(lbl_skl_im = (unsigned char*) malloc(dimx * dimy * dimz * sizeof (unsigned char)));
+    P3D_TRY(dt_im = (unsigned short*) malloc((size_t) dimx * dimy * dimz * sizeof (unsigned short)));
+    P3D_TRY(lbl_skl_im = (unsigned char*) malloc((size_t) dimx * dimy * dimz * sizeof (unsigned char)));
 
 
     // Compute distance transform for further use:
@@ -83,7 +83,7 @@ int p3dSkeletonLabeling(
 
 
     // Initialize input:
-    P3D_TRY(tmp_im = (unsigned char*) malloc(a_dimx * a_dimy * a_dimz * sizeof (unsigned char)));
+    P3D_TRY(tmp_im = (unsigned char*) malloc((size_t) a_dimx * a_dimy * a_dimz * sizeof (unsigned char)));
     P3D_TRY(p3dZeroPadding3D_uchar2uchar(in_im, tmp_im, dimx, dimy, dimz, a_rad));
 
 
@@ -35,15 +35,16 @@
 #include "Common/p3dUtils.h"
 
 
-int p3dThinningSkeletonization(   
-	unsigned char* in_im, 
-	unsigned char* out_im, 
-	const int dimx,
-	const int dimy, 
-	const int dimz,
+int p3dThinningSkeletonization_view(   
+	struct VolumeView* in_view,	// IN: input view
+	unsigned char* out_im,		// OUT: skeleton (dimensions of the view)
 	int (*wr_log)(const char*, ...)
 	)
 {
+	// Dimensions of the input view:
+	const int dimx = in_view->dimx;
+	const int dimy = in_view->dimy;
+	const int dimz = in_view->dimz;
 
 	unsigned char* tmp_im;
 
@@ -72,8 +73,8 @@ int p3dThinningSkeletonization(
 
 
 	// Init output voume with input volume values zero padded:
-	P3D_TRY( tmp_im = (unsigned char*) malloc( a_dimx*a_dimy*a_dimz*sizeof(unsigned char) ) );
-	P3D_TRY( p3dZeroPadding3D_uchar2uchar ( in_im, tmp_im, dimx, dimy, dimz, a_rad ) );
+	P3D_TRY( tmp_im = (unsigned char*) malloc( (size_t) a_dimx*a_dimy*a_dimz*sizeof(unsigned char) ) );
+	P3D_TRY( p3dZeroPadding3D_view2uchar ( in_view, tmp_im, a_rad ) );
 
 	// Call in-place version:
 	P3D_TRY( p3dThinning ( tmp_im, a_dimx, a_dimy, a_dimz ) );
@@ -119,3 +120,28 @@ MEM_ERROR:
     return P3D_AUTH_ERROR;*/
 }
 
+int p3dThinningSkeletonization(   
+	unsigned char* in_im, 
+	unsigned char* out_im, 
+	const int dimx,
+	const int dimy, 
+	const int dimz,
+	int (*wr_log)(const char*, ...)
+	)
+{
+	struct VolumeView in_view;
+
+	// The whole input volume is a view of itself:
+	in_view.base = in_im;
+	in_view.dimx = dimx;
+	in_view.dimy = dimy;
+	in_view.dimz = dimz;
+	in_view.orgx = 0;
+	in_view.orgy = 0;
+	in_view.orgz = 0;
+	in_view.stridey = (size_t) dimx;
+	in_view.stridez = (size_t) dimx*dimy;
+
+	return p3dThinningSkeletonization_view ( &in_view, out_im, wr_log );
+}
+
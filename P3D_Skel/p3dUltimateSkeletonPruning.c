@@ -82,8 +82,8 @@ int p3dUltimateSkeletonPruning(
 	a_dimz = dimz + a_rad*2;
 
 	// Initialize input:
-	P3D_TRY( tmp_im = (unsigned char*) malloc( a_dimx*a_dimy*a_dimz*sizeof(unsigned char) ) );
-	P3D_TRY( tmp_im2 = (unsigned char*) calloc( a_dimx*a_dimy*a_dimz,sizeof(unsigned char) ) );
+	P3D_TRY( tmp_im = (unsigned char*) malloc( (size_t) a_dimx*a_dimy*a_dimz*sizeof(unsigned char) ) );
+	P3D_TRY( tmp_im2 = (unsigned char*) calloc( (size_t) a_dimx*a_dimy*a_dimz,sizeof(unsigned char) ) );
 
 	P3D_TRY( p3dZeroPadding3D_uchar2uchar ( in_im, tmp_im2, dimx, dimy, dimz, a_rad ) );
 
@@ -0,0 +1,186 @@
+/***************************************************************************/
+/* (C) 2016 Elettra - Sincrotrone Trieste S.C.p.A.. All rights reserved.   */
+/*                                                                         */
+/*                                                                         */
+/* This file is part of Pore3D, a software library for quantitative        */
+/* analysis of 3D (volume) images.                                         */
+/*                                                                         */
+/* Pore3D is free software: you can redistribute it and/or modify it       */
+/* under the terms of the GNU General Public License as published by the   */
+/* Free Software Foundation, either version 3 of the License, or (at your  */
+/* option) any later version.                                              */
+/*                                                                         */
+/* Pore3D is distributed in the hope that it will be useful, but WITHOUT   */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or   */
+/* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License    */
+/* for more details.                                                       */
+/*                                                                         */
+/* You should have received a copy of the GNU General Public License       */
+/* along with Pore3D. If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                         */
+/***************************************************************************/
+
+//
+// Author: Francesco Brun
+// Last modified: October, 16th 2026
+//
+
+// Regression test of the bfloat16 mode of the anisotropic diffusion filter
+// (P3D_AD_BF16) against the float one. The filter source is compiled here a
+// second time with P3D_AD_BF16 defined and its public functions renamed,
+// while the float path is the one of the P3D_Filt library this test is
+// linked against (built without P3D_AD_BF16). Compile with the same flags
+// of P3D_Filt (e.g. -fopenmp -mavx2) and run without arguments, with one
+// and with several threads (OMP_NUM_THREADS). Returns 0 if the outputs of
+// the two paths agree within the tolerance documented in
+// p3dAnisotropicDiffusionFilter.c and if repeated runs give the same output.
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <limits.h>
+
+#include "p3dFilt.h"
+
+#define P3D_AD_BF16
+#define GaussianFiltering3D_float                   _bf16_GaussianFiltering3D_float
+#define _p3dAnisotropicDiffusionFilter3D_float      _bf16_p3dAnisotropicDiffusionFilter3D_float
+#define p3dAnisotropicDiffusionFilter3D_8_tol       _bf16_p3dAnisotropicDiffusionFilter3D_8_tol
+#define p3dAnisotropicDiffusionFilter3D_8           _bf16_p3dAnisotropicDiffusionFilter3D_8
+#define p3dAnisotropicDiffusionFilter3D_16_tol      _bf16_p3dAnisotropicDiffusionFilter3D_16_tol
+#define p3dAnisotropicDiffusionFilter3D_16          _bf16_p3dAnisotropicDiffusionFilter3D_16
+#define _p3dAnisotropicDiffusionFilter3D_16_slab    _bf16_p3dAnisotropicDiffusionFilter3D_16_slab
+#define p3dAnisotropicDiffusionFilter3D_16_stream   _bf16_p3dAnisotropicDiffusionFilter3D_16_stream
+
+#include "../P3D_Filt/p3dAnisotropicDiffusionFilter.c"
+
+#undef GaussianFiltering3D_float
+#undef _p3dAnisotropicDiffusionFilter3D_float
+#undef p3dAnisotropicDiffusionFilter3D_8_tol
+#undef p3dAnisotropicDiffusionFilter3D_8
+#undef p3dAnisotropicDiffusionFilter3D_16_tol
+#undef p3dAnisotropicDiffusionFilter3D_16
+#undef _p3dAnisotropicDiffusionFilter3D_16_slab
+#undef p3dAnisotropicDiffusionFilter3D_16_stream
+
+#define DIMX	80
+#define DIMY	70
+#define DIMZ	60
+
+// Filter parameters and iterations:
+#define AD_M		1
+#define AD_LAMBDA	0.01
+#define AD_SIGMA	1.0
+#define AD_ITER		4
+
+// Tolerance (see P3D_AD_BF16 in p3dAnisotropicDiffusionFilter.c):
+#define TOL_MAX_8	1		// Max difference (grey levels)
+#define TOL_FRAC_8	0.005	// Max fraction of differing voxels
+#define TOL_MAX_16	8		// Max difference (grey levels)
+#define TOL_MEAN_16	0.1		// Max mean absolute difference
+
+static int _fail_ct = 0;
+
+static void _check(const int cond, const char* msg) {
+    printf("%s: %s\n", cond ? "PASS" : "FAIL", msg);
+    if (!cond) _fail_ct++;
+}
+
+// Spheres and tubes with additive noise (fixed seed), values in [0, 1]:
+static double _phantom(const int i, const int j, const int k, unsigned int* seed) {
+    double x = i - DIMX / 2.0, y = j - DIMY / 2.0, z = k - DIMZ / 2.0;
+    double val = 0.2;
+
+    if (x * x + y * y + z * z < 20.0 * 20.0) val = 0.7;
+    if ((x - 15.0) * (x - 15.0) + (y + 10.0) * (y + 10.0) < 6.0 * 6.0) val = 0.9;
+    if (y * y + (z - 12.0) * (z - 12.0) < 4.0 * 4.0) val = 0.4;
+
+    *seed = *seed * 1103515245U + 12345U;
+    val += 0.1 * ((double) ((*seed >> 16) & 0x7FFF) / 0x7FFF - 0.5);
+
+    return (val < 0.0) ? 0.0 : ((val > 1.0) ? 1.0 : val);
+}
+
+int main(void) {
+    const size_t n = (size_t) DIMX * DIMY * DIMZ;
+    unsigned char *in8, *out8, *bf8;
+    unsigned short *in16, *out16, *bf16;
+    unsigned int seed = 1;
+    size_t ct, diff_ct = 0;
+    int i, j, k, d, max_diff;
+    double mean_diff;
+
+    in8 = (unsigned char*) malloc(n * sizeof (unsigned char));
+    out8 = (unsigned char*) malloc(n * sizeof (unsigned char));
+    bf8 = (unsigned char*) malloc(n * sizeof (unsigned char));
+    in16 = (unsigned short*) malloc(n * sizeof (unsigned short));
+    out16 = (unsigned short*) malloc(n * sizeof (unsigned short));
+    bf16 = (unsigned short*) malloc(n * sizeof (unsigned short));
+    if ((in8 == NULL) || (out8 == NULL) || (bf8 == NULL) ||
+            (in16 == NULL) || (out16 == NULL) || (bf16 == NULL)) {
+        printf("Not enough memory to run the test.\n");
+        return EXIT_FAILURE;
+    }
+
+    for (k = 0; k < DIMZ; k++)
+        for (j = 0; j < DIMY; j++)
+            for (i = 0; i < DIMX; i++) {
+                const double val = _phantom(i, j, k, &seed);
+                in8[ I(i, j, k, DIMX, DIMY) ] = (unsigned char) (val * UCHAR_MAX + 0.5);
+                in16[ I(i, j, k, DIMX, DIMY) ] = (unsigned short) (val * USHRT_MAX + 0.5);
+            }
+
+    // 8-bit:
+    _check(p3dAnisotropicDiffusionFilter3D_8(in8, out8, DIMX, DIMY, DIMZ, AD_M, AD_LAMBDA, AD_SIGMA,
+            AD_ITER, NULL, NULL) == P3D_SUCCESS, "p3dAnisotropicDiffusionFilter3D_8 (float) succeeds");
+    _check(_bf16_p3dAnisotropicDiffusionFilter3D_8(in8, bf8, DIMX, DIMY, DIMZ, AD_M, AD_LAMBDA, AD_SIGMA,
+            AD_ITER, NULL, NULL) == P3D_SUCCESS, "p3dAnisotropicDiffusionFilter3D_8 (bfloat16) succeeds");
+
+    // Repeated runs must not depend on thread scheduling:
+    _check(p3dAnisotropicDiffusionFilter3D_8(in8, bf8, DIMX, DIMY, DIMZ, AD_M, AD_LAMBDA, AD_SIGMA,
+            AD_ITER, NULL, NULL) == P3D_SUCCESS, "p3dAnisotropicDiffusionFilter3D_8 (float) succeeds again");
+    _check(memcmp(out8, bf8, n * sizeof (unsigned char)) == 0, "8-bit float path is deterministic");
+    _check(_bf16_p3dAnisotropicDiffusionFilter3D_8(in8, bf8, DIMX, DIMY, DIMZ, AD_M, AD_LAMBDA, AD_SIGMA,
+            AD_ITER, NULL, NULL) == P3D_SUCCESS, "p3dAnisotropicDiffusionFilter3D_8 (bfloat16) succeeds again");
+
+    max_diff = 0;
+    for (ct = 0; ct < n; ct++) {
+        d = abs((int) out8[ct] - (int) bf8[ct]);
+        if (d > 0) diff_ct++;
+        if (d > max_diff) max_diff = d;
+    }
+    printf("8-bit: %lu voxel(s) differ (%.3f%%), max difference %d.\n",
+            (unsigned long) diff_ct, 100.0 * diff_ct / n, max_diff);
+    _check(max_diff <= TOL_MAX_8, "8-bit max difference");
+    _check((double) diff_ct / n <= TOL_FRAC_8, "8-bit fraction of differing voxels");
+
+    // 16-bit:
+    _check(p3dAnisotropicDiffusionFilter3D_16(in16, out16, DIMX, DIMY, DIMZ, AD_M, AD_LAMBDA, AD_SIGMA,
+            AD_ITER, NULL, NULL) == P3D_SUCCESS, "p3dAnisotropicDiffusionFilter3D_16 (float) succeeds");
+    _check(_bf16_p3dAnisotropicDiffusionFilter3D_16(in16, bf16, DIMX, DIMY, DIMZ, AD_M, AD_LAMBDA, AD_SIGMA,
+            AD_ITER, NULL, NULL) == P3D_SUCCESS, "p3dAnisotropicDiffusionFilter3D_16 (bfloat16) succeeds");
+
+    max_diff = 0;
+    mean_diff = 0.0;
+    for (ct = 0; ct < n; ct++) {
+        d = abs((int) out16[ct] - (int) bf16[ct]);
+        mean_diff += d;
+        if (d > max_diff) max_diff = d;
+    }
+    mean_diff /= n;
+    printf("16-bit: max difference %d, mean difference %.4f.\n", max_diff, mean_diff);
+    _check(max_diff <= TOL_MAX_16, "16-bit max difference");
+    _check(mean_diff <= TOL_MEAN_16, "16-bit mean difference");
+
+    free(in8);
+    free(out8);
+    free(bf8);
+    free(in16);
+    free(out16);
+    free(bf16);
+
+    printf("%d check(s) failed.\n", _fail_ct);
+
+    return (_fail_ct == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
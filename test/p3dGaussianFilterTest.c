@@ -0,0 +1,169 @@
+/***************************************************************************/
+/* (C) 2016 Elettra - Sincrotrone Trieste S.C.p.A.. All rights reserved.   */
+/*                                                                         */
+/*                                                                         */
+/* This file is part of Pore3D, a software library for quantitative        */
+/* analysis of 3D (volume) images.                                         */
+/*                                                                         */
+/* Pore3D is free software: you can redistribute it and/or modify it       */
+/* under the terms of the GNU General Public License as published by the   */
+/* Free Software Foundation, either version 3 of the License, or (at your  */
+/* option) any later version.                                              */
+/*                                                                         */
+/* Pore3D is distributed in the hope that it will be useful, but WITHOUT   */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or   */
+/* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License    */
+/* for more details.                                                       */
+/*                                                                         */
+/* You should have received a copy of the GNU General Public License       */
+/* along with Pore3D. If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                         */
+/***************************************************************************/
+
+//
+// Author: Francesco Brun
+// Last modified: October, 16th 2026
+//
+
+// Test of the gaussian filters. The streaming variant must give the same
+// output of the in-core filter, also for kernels larger than the slab, and
+// the recursive variant (p3dGaussianFilter3D_16_iir) must stay within the
+// documented distance from the truncated kernel. Link against P3D_Filt and
+// run without arguments from a writable directory (two temporary RAW files
+// are created and removed). Returns 0 if all the checks pass.
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "p3dFilt.h"
+
+#define DIMX    40
+#define DIMY    36
+#define DIMZ    64
+
+#define IN_FILE     "p3dGaussianFilterTest_in.raw"
+#define OUT_FILE    "p3dGaussianFilterTest_out.raw"
+
+static int _fail_ct = 0;
+
+static void _check(const int cond, const char* msg) {
+    printf("%s: %s\n", cond ? "PASS" : "FAIL", msg);
+    if (!cond) _fail_ct++;
+}
+
+// Random 16-bit volume smoothed by a box average of a few voxels along each
+// direction, so that it has both edges and slow variations:
+static void _makeVolume(unsigned short* im, unsigned int* seed) {
+    const size_t n = (size_t) DIMX * DIMY * DIMZ;
+    double* tmp = (double*) malloc(n * sizeof (double));
+    int i, j, k, t;
+    size_t ct;
+
+    for (ct = 0; ct < n; ct++) {
+        *seed = *seed * 1103515245U + 12345U;
+        tmp[ct] = (double) ((*seed >> 8) % 65536);
+    }
+    for (k = 0; k < DIMZ; k++)
+        for (j = 0; j < DIMY; j++)
+            for (i = 0; i < DIMX; i++) {
+                double sum = 0.0;
+                for (t = -2; t <= 2; t++)
+                    sum += tmp[ I(i, j, (k + t + DIMZ) % DIMZ, DIMX, DIMY) ];
+                im[ I(i, j, k, DIMX, DIMY) ] = (unsigned short) (sum / 5.0);
+            }
+    free(tmp);
+}
+
+static void _testStream(const unsigned short* in_im, const int size, const double sigma, const int slab) {
+    const size_t n = (size_t) DIMX * DIMY * DIMZ;
+    unsigned short* ref_im = (unsigned short*) malloc(n * sizeof (unsigned short));
+    unsigned short* out_im = (unsigned short*) malloc(n * sizeof (unsigned short));
+    size_t ct, err_ct = 0;
+    int err_code;
+    char msg[256];
+
+    err_code = p3dGaussianFilter3D_16((unsigned short*) in_im, ref_im, DIMX, DIMY, DIMZ, size, sigma, NULL, NULL);
+
+    if (err_code == P3D_SUCCESS)
+        err_code = p3dGaussianFilter3D_16_stream(IN_FILE, OUT_FILE, DIMX, DIMY, DIMZ, size, sigma,
+            P3D_TRUE, P3D_FALSE, slab, NULL, NULL);
+    if (err_code == P3D_SUCCESS)
+        err_code = p3dReadRaw16(OUT_FILE, out_im, DIMX, DIMY, DIMZ, P3D_TRUE, P3D_FALSE, NULL, NULL);
+
+    if (err_code == P3D_SUCCESS)
+        for (ct = 0; ct < n; ct++)
+            if (out_im[ct] != ref_im[ct]) err_ct++;
+
+    sprintf(msg, "stream vs in-core, size %d, sigma %0.1f, slab %d (%lu differing voxels)",
+            size, sigma, slab, (unsigned long) err_ct);
+    _check((err_code == P3D_SUCCESS) && (err_ct == 0), msg);
+
+    free(ref_im);
+    free(out_im);
+}
+
+// Distance of the recursive approximation from the truncated kernel, in grey
+// levels over the whole 16-bit range:
+static void _testIIR(const unsigned short* in_im, const int size, const double sigma,
+        const double max_tol, const double mean_tol) {
+    const size_t n = (size_t) DIMX * DIMY * DIMZ;
+    unsigned short* fir_im = (unsigned short*) malloc(n * sizeof (unsigned short));
+    unsigned short* iir_im = (unsigned short*) malloc(n * sizeof (unsigned short));
+    double d, max_d = 0.0, mean_d = 0.0;
+    size_t ct;
+    int err_code;
+    char msg[256];
+
+    err_code = p3dGaussianFilter3D_16((unsigned short*) in_im, fir_im, DIMX, DIMY, DIMZ, size, sigma, NULL, NULL);
+    if (err_code == P3D_SUCCESS)
+        err_code = p3dGaussianFilter3D_16_iir((unsigned short*) in_im, iir_im, DIMX, DIMY, DIMZ, size, sigma, NULL, NULL);
+
+    if (err_code == P3D_SUCCESS) {
+        for (ct = 0; ct < n; ct++) {
+            d = fabs((double) iir_im[ct] - (double) fir_im[ct]);
+            mean_d += d;
+            if (d > max_d) max_d = d;
+        }
+        mean_d /= n;
+    }
+
+    sprintf(msg, "recursive vs truncated kernel, size %d, sigma %0.1f (max %0.0f, mean %0.2f)",
+            size, sigma, max_d, mean_d);
+    _check((err_code == P3D_SUCCESS) && (max_d <= max_tol) && (mean_d <= mean_tol), msg);
+
+    free(fir_im);
+    free(iir_im);
+}
+
+int main(void) {
+    const size_t n = (size_t) DIMX * DIMY * DIMZ;
+    unsigned short* in_im = (unsigned short*) malloc(n * sizeof (unsigned short));
+    unsigned short* out_im = (unsigned short*) malloc(n * sizeof (unsigned short));
+    unsigned int seed = 12345U;
+
+    _makeVolume(in_im, &seed);
+    _check(p3dWriteRaw16(in_im, IN_FILE, DIMX, DIMY, DIMZ, P3D_TRUE, P3D_FALSE, NULL, NULL) == P3D_SUCCESS, "write input file");
+
+    // Truncated kernel smaller and larger than the slab:
+    _testStream(in_im, 7, 1.2, 8);
+    _testStream(in_im, 13, 2.0, 8);
+    _testStream(in_im, 25, 4.0, 8);
+    _testStream(in_im, 25, 4.0, 64);
+
+    // Recursive approximation (the truncated kernel covers 3 sigma). The
+    // distance shrinks as sigma grows:
+    _testIIR(in_im, 13, 2.0, 1000.0, 150.0);
+    _testIIR(in_im, 25, 4.0, 400.0, 60.0);
+
+    // Below 2 sigma the recursive variant is the truncated kernel:
+    _testIIR(in_im, 7, 1.2, 0.0, 0.0);
+
+    remove(IN_FILE);
+    remove(OUT_FILE);
+    free(in_im);
+    free(out_im);
+
+    return (_fail_ct == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,108 @@
+/***************************************************************************/
+/* (C) 2016 Elettra - Sincrotrone Trieste S.C.p.A.. All rights reserved.   */
+/*                                                                         */
+/*                                                                         */
+/* This file is part of Pore3D, a software library for quantitative        */
+/* analysis of 3D (volume) images.                                         */
+/*                                                                         */
+/* Pore3D is free software: you can redistribute it and/or modify it       */
+/* under the terms of the GNU General Public License as published by the   */
+/* Free Software Foundation, either version 3 of the License, or (at your  */
+/* option) any later version.                                              */
+/*                                                                         */
+/* Pore3D is distributed in the hope that it will be useful, but WITHOUT   */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or   */
+/* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License    */
+/* for more details.                                                       */
+/*                                                                         */
+/* You should have received a copy of the GNU General Public License       */
+/* along with Pore3D. If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                         */
+/***************************************************************************/
+
+//
+// Author: Francesco Brun
+// Last modified: October, 16th 2026
+//
+
+// Regression test for volumes larger than 2^31 voxels (64-bit indexing). A
+// synthetic 2048 x 1024 x 1025 volume (about 2.15 GB) is used whose last
+// slice starts exactly at voxel 2^31, so that any index, size or count
+// computed in 32 bits misses or misplaces it. Link against P3D_Filt and
+// P3D_Blob and run with the name of a scratch RAW file (about 2.15 GB of
+// free disk space are needed). Returns 0 if all the checks pass.
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <limits.h>
+
+#include "p3dFilt.h"
+#include "p3dBlob.h"
+
+#define DIMX	2048
+#define DIMY	1024
+#define DIMZ	1025
+
+static int _fail_ct = 0;
+
+static void _check(const int cond, const char* msg) {
+    printf("%s: %s\n", cond ? "PASS" : "FAIL", msg);
+    if (!cond) _fail_ct++;
+}
+
+// Number of OBJECT voxels and whether they are exactly the last slice:
+static int _checkLastSlice(unsigned char* im) {
+    const long long slice = (long long) DIMX * DIMY;
+    long long ct, obj_ct = 0;
+
+    for (ct = 0; ct < slice * DIMZ; ct++) {
+        if (im[ct] == OBJECT) {
+            if (ct < slice * (DIMZ - 1)) return 0;
+            obj_ct++;
+        }
+    }
+
+    return (obj_ct == slice);
+}
+
+int main(int argc, char* argv[]) {
+    const long long slice = (long long) DIMX * DIMY;
+    unsigned char* im;
+    struct MorphometricStats stats;
+    char* filename = (argc > 1) ? argv[1] : "p3dLargeVolumeTest.raw";
+
+    if ((im = (unsigned char*) malloc((size_t) slice * DIMZ * sizeof (unsigned char))) == NULL) {
+        printf("Not enough memory to run the test.\n");
+        return EXIT_FAILURE;
+    }
+
+    _check(slice * (DIMZ - 1) == (1LL << 31), "last slice starts at voxel 2^31");
+
+    // Binary volume whose last slice only is OBJECT:
+    memset(im, BACKGROUND, (size_t) slice * (DIMZ - 1));
+    memset(im + slice * (DIMZ - 1), OBJECT, (size_t) slice);
+    _check(_checkLastSlice(im), "synthetic volume");
+    im[ I(DIMX - 1, DIMY - 1, DIMZ - 1, DIMX, DIMY) ] = BACKGROUND;
+    _check(im[ (size_t) slice * DIMZ - 1 ] == BACKGROUND, "I() addresses the last voxel");
+    im[ I(DIMX - 1, DIMY - 1, DIMZ - 1, DIMX, DIMY) ] = OBJECT;
+
+    // RAW round trip:
+    _check(p3dWriteRaw8(im, filename, DIMX, DIMY, DIMZ, NULL, NULL) == P3D_SUCCESS, "p3dWriteRaw8 succeeds");
+    memset(im, 0, (size_t) slice * DIMZ);
+    _check(p3dReadRaw8(filename, im, DIMX, DIMY, DIMZ, NULL, NULL) == P3D_SUCCESS, "p3dReadRaw8 succeeds");
+    _check(_checkLastSlice(im), "p3dReadRaw8 output");
+    remove(filename);
+
+    // Bone volume fraction (the ray casting part is not checked):
+    _check(p3dMorphometricAnalysis(im, NULL, &stats, DIMX, DIMY, DIMZ, 1.0, NULL) == P3D_SUCCESS,
+            "p3dMorphometricAnalysis succeeds");
+    _check(fabs(stats.BvTv - 1.0 / DIMZ) < 1E-12, "p3dMorphometricAnalysis BV/TV");
+
+    free(im);
+
+    printf("%d check(s) failed.\n", _fail_ct);
+
+    return (_fail_ct == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,160 @@
+/***************************************************************************/
+/* (C) 2016 Elettra - Sincrotrone Trieste S.C.p.A.. All rights reserved.   */
+/*                                                                         */
+/*                                                                         */
+/* This file is part of Pore3D, a software library for quantitative        */
+/* analysis of 3D (volume) images.                                         */
+/*                                                                         */
+/* Pore3D is free software: you can redistribute it and/or modify it       */
+/* under the terms of the GNU General Public License as published by the   */
+/* Free Software Foundation, either version 3 of the License, or (at your  */
+/* option) any later version.                                              */
+/*                                                                         */
+/* Pore3D is distributed in the hope that it will be useful, but WITHOUT   */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or   */
+/* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License    */
+/* for more details.                                                       */
+/*                                                                         */
+/* You should have received a copy of the GNU General Public License       */
+/* along with Pore3D. If not, see <http://www.gnu.org/licenses/>.          */
+/*                                                                         */
+/***************************************************************************/
+
+//
+// Author: Francesco Brun
+// Last modified: October, 16th 2026
+//
+
+// Brute-force reference test of the median filters. Each output voxel is
+// compared with the median of the SIZE^2 (2D) or SIZE^3 (3D) neighborhood
+// collected with replicate padding and sorted, for several kernel sizes and
+// for images smaller than the kernel. Link against P3D_Filt and run without
+// arguments. Returns 0 if all the checks pass.
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <limits.h>
+
+#include "p3dFilt.h"
+
+static int _fail_ct = 0;
+
+static void _check(const int cond, const char* msg) {
+    printf("%s: %s\n", cond ? "PASS" : "FAIL", msg);
+    if (!cond) _fail_ct++;
+}
+
+static int _clamp(const int x, const int dim) {
+    return (x < 0) ? 0 : ((x >= dim) ? (dim - 1) : x);
+}
+
+static int _cmp(const void* a, const void* b) {
+    const unsigned int va = *((const unsigned int*) a), vb = *((const unsigned int*) b);
+    return (va > vb) - (va < vb);
+}
+
+// Median of the neighborhood of (I,J,K) in IM (8 or 16 bit according to
+// BYTES), with DIMZ = 1 and 2D kernel for 2D images:
+static unsigned int _refMedian(const void* im, const int bytes, const int dimx, const int dimy,
+        const int dimz, const int size, const int i, const int j, const int k, unsigned int* buf) {
+    const int rad = size / 2, radz = (dimz > 1) ? rad : 0;
+    int x, y, z, n = 0;
+    size_t idx;
+
+    for (z = k - radz; z <= k + radz; z++)
+        for (y = j - rad; y <= j + rad; y++)
+            for (x = i - rad; x <= i + rad; x++) {
+                idx = I(_clamp(x, dimx), _clamp(y, dimy), _clamp(z, dimz), dimx, dimy);
+                buf[n++] = (bytes == 1) ? ((const unsigned char*) im)[idx] : ((const unsigned short*) im)[idx];
+            }
+    qsort(buf, n, sizeof (unsigned int), _cmp);
+
+    return buf[n / 2];
+}
+
+// Runs the filter for the given case and compares with the reference. Values
+// are drawn in [0, RANGE) to have both ties and (16 bit) several coarse bins:
+static void _testCase(const int bytes, const int flag3D, const int dimx, const int dimy, const int dimz,
+        const int size, const unsigned int range, unsigned int* seed) {
+    const size_t n = (size_t) dimx * dimy * dimz;
+    void* in_im = malloc(n * bytes);
+    void* out_im = malloc(n * bytes);
+    unsigned int* buf = (unsigned int*) malloc((size_t) size * size * size * sizeof (unsigned int));
+    size_t ct, err_ct = 0;
+    int i, j, k, err_code = P3D_SUCCESS;
+    char msg[256];
+
+    for (ct = 0; ct < n; ct++) {
+        *seed = *seed * 1103515245U + 12345U;
+        if (bytes == 1)
+            ((unsigned char*) in_im)[ct] = (unsigned char) ((*seed >> 8) % range);
+        else
+            ((unsigned short*) in_im)[ct] = (unsigned short) ((*seed >> 8) % range);
+    }
+
+    if (bytes == 1) {
+        if (flag3D)
+            err_code = p3dMedianFilter3D_8((unsigned char*) in_im, (unsigned char*) out_im, dimx, dimy, dimz, size, NULL, NULL);
+        else
+            err_code = p3dMedianFilter2D_8((unsigned char*) in_im, (unsigned char*) out_im, dimx, dimy, size, NULL, NULL);
+    } else {
+        if (flag3D)
+            err_code = p3dMedianFilter3D_16((unsigned short*) in_im, (unsigned short*) out_im, dimx, dimy, dimz, size, NULL, NULL);
+        else
+            err_code = p3dMedianFilter2D_16((unsigned short*) in_im, (unsigned short*) out_im, dimx, dimy, size, NULL, NULL);
+    }
+
+    if (err_code == P3D_SUCCESS) {
+        for (k = 0; k < dimz; k++)
+            for (j = 0; j < dimy; j++)
+                for (i = 0; i < dimx; i++) {
+                    const size_t idx = I(i, j, k, dimx, dimy);
+                    const unsigned int val = (bytes == 1) ? ((unsigned char*) out_im)[idx] : ((unsigned short*) out_im)[idx];
+                    if (val != _refMedian(in_im, bytes, dimx, dimy, dimz, size, i, j, k, buf))
+                        err_ct++;
+                }
+    }
+
+    sprintf(msg, "p3dMedianFilter%s_%d %dx%dx%d, size %d (%lu wrong voxels)", flag3D ? "3D" : "2D", bytes * 8,
+            dimx, dimy, dimz, size, (unsigned long) err_ct);
+    _check((err_code == P3D_SUCCESS) && (err_ct == 0), msg);
+
+    free(in_im);
+    free(out_im);
+    free(buf);
+}
+
+int main(void) {
+    // Image sizes (the last ones are smaller than the largest kernels):
+    const int dims[][3] = {
+        { 23, 17, 13},
+        { 8, 9, 7},
+        { 4, 3, 2},
+        { 1, 2, 1},
+        { 1, 1, 1}
+    };
+    const int sizes[] = {1, 3, 5, 7};
+    unsigned int seed = 1;
+    int d, s;
+    unsigned char in8 = 0, out8 = 0;
+
+    for (d = 0; d < (int) (sizeof (dims) / sizeof (dims[0])); d++)
+        for (s = 0; s < (int) (sizeof (sizes) / sizeof (sizes[0])); s++) {
+            _testCase(1, 0, dims[d][0], dims[d][1], 1, sizes[s], 16, &seed);
+            _testCase(2, 0, dims[d][0], dims[d][1], 1, sizes[s], USHRT_MAX + 1, &seed);
+            _testCase(2, 0, dims[d][0], dims[d][1], 1, sizes[s], 300, &seed);
+            _testCase(1, 1, dims[d][0], dims[d][1], dims[d][2], sizes[s], UCHAR_MAX + 1, &seed);
+            _testCase(1, 1, dims[d][0], dims[d][1], dims[d][2], sizes[s], 16, &seed);
+            _testCase(2, 1, dims[d][0], dims[d][1], dims[d][2], sizes[s], USHRT_MAX + 1, &seed);
+            _testCase(2, 1, dims[d][0], dims[d][1], dims[d][2], sizes[s], 300, &seed);
+        }
+
+    // Kernel sizes that would overflow the column histograms are rejected:
+    _check(p3dMedianFilter3D_8(&in8, &out8, 1, 1, 1, 257, NULL, NULL) == P3D_IO_ERROR,
+            "p3dMedianFilter3D_8 rejects size 257");
+
+    printf("%d check(s) failed.\n", _fail_ct);
+
+    return (_fail_ct == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}